@@ -32,6 +32,7 @@
 #include "SQLiteFileSystem.h"
 #include "SQLiteStatement.h"
 #include <sqlite3.h>
+#include <wtf/PassOwnPtr.h>
 #include <wtf/Threading.h>
 #include <wtf/text/CString.h>
 #include <wtf/text/WTFString.h>
@@ -51,6 +52,95 @@ const int SQLResultConstraint = SQLITE_CONSTRAINT;
 
 static const char notOpenErrorMessage[] = "database is not open";
 
+static const size_t statementCacheCapacity = 16;
+
+// SQLite's own automatic checkpoints start at the same size.
+static const int checkpointPageCount = 1000;
+// Beyond this the committing thread checkpoints itself, in case the background checkpoints
+// can't keep up, for example because readers keep using the old pages.
+static const int synchronousCheckpointPageCount = 10 * checkpointPageCount;
+
+// Folds the write-ahead log of a database back into it on a thread of its own. It uses a
+// connection of its own, so that the database stays usable while it runs.
+class SQLiteCheckpointThread {
+    WTF_MAKE_NONCOPYABLE(SQLiteCheckpointThread); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<SQLiteCheckpointThread> create(const String& path)
+    {
+        return adoptPtr(new SQLiteCheckpointThread(path));
+    }
+
+    ~SQLiteCheckpointThread()
+    {
+        if (!m_thread)
+            return;
+        {
+            MutexLocker locker(m_lock);
+            m_shouldQuit = true;
+            m_condition.signal();
+        }
+        waitForThreadCompletion(m_thread);
+    }
+
+    void scheduleCheckpoint()
+    {
+        MutexLocker locker(m_lock);
+        if (m_checkpointPending)
+            return;
+        m_checkpointPending = true;
+        if (!m_thread)
+            m_thread = createThread(threadEntryPoint, this, "[OWB] SQLite checkpoint");
+        m_condition.signal();
+    }
+
+private:
+    explicit SQLiteCheckpointThread(const String& path)
+        : m_thread(0)
+        , m_checkpointPending(false)
+        , m_shouldQuit(false)
+    {
+        // Copy the bytes so that nothing is shared with the thread that opened the database.
+        CString utf8 = path.utf8();
+        m_path = CString(utf8.data(), utf8.length());
+    }
+
+    static void threadEntryPoint(void* context)
+    {
+        static_cast<SQLiteCheckpointThread*>(context)->threadMain();
+    }
+
+    void threadMain()
+    {
+        m_lock.lock();
+        while (true) {
+            while (!m_shouldQuit && !m_checkpointPending)
+                m_condition.wait(m_lock);
+            if (m_shouldQuit)
+                break;
+            m_checkpointPending = false;
+            m_lock.unlock();
+
+            sqlite3* db = 0;
+            int result = sqlite3_open_v2(m_path.data(), &db, SQLITE_OPEN_READWRITE, 0);
+            if (result == SQLITE_OK)
+                result = sqlite3_wal_checkpoint(db, 0);
+            if (result != SQLITE_OK)
+                LOG(SQLDatabase, "Checkpoint of %s failed (%i)", m_path.data(), result);
+            sqlite3_close(db);
+
+            m_lock.lock();
+        }
+        m_lock.unlock();
+    }
+
+    CString m_path;
+    ThreadIdentifier m_thread;
+    Mutex m_lock;
+    ThreadCondition m_condition;
+    bool m_checkpointPending;
+    bool m_shouldQuit;
+};
+
 SQLiteDatabase::SQLiteDatabase()
     : m_db(0)
     , m_pageSize(-1)
@@ -61,6 +151,7 @@ SQLiteDatabase::SQLiteDatabase()
     , m_openError(SQLITE_ERROR)
     , m_openErrorMessage()
     , m_lastChangesCount(0)
+    , m_statementCacheEnabled(true)
 {
 }
 
@@ -92,9 +183,10 @@ bool SQLiteDatabase::open(const String& filename, bool forWebSQLDatabase)
         return false;
     }
 
-    if (isOpen())
+    if (isOpen()) {
         m_openingThread = currentThread();
-    else
+        m_path = filename;
+    } else
         m_openErrorMessage = "sqlite_open returned null";
 
     if (!SQLiteStatement(*this, ASCIILiteral("PRAGMA temp_store = MEMORY;")).executeCommand())
@@ -108,6 +200,8 @@ void SQLiteDatabase::close()
     if (m_db) {
         // FIXME: This is being called on the main thread during JS GC. <rdar://problem/5739818>
         // ASSERT(currentThread() == m_openingThread);
+        m_checkpointThread.clear();
+        clearStatementCache();
         sqlite3* db = m_db;
         {
             MutexLocker locker(m_databaseClosingMutex);
@@ -117,6 +211,7 @@ void SQLiteDatabase::close()
     }
 
     m_openingThread = 0;
+    m_path = String();
     m_openError = SQLITE_ERROR;
     m_openErrorMessage = CString();
 }
@@ -247,6 +342,109 @@ void SQLiteDatabase::setSynchronous(SynchronousPragma sync)
     executeCommand("PRAGMA synchronous = " + String::number(sync));
 }
 
+bool SQLiteDatabase::enableWriteAheadLogging()
+{
+#if SQLITE_VERSION_NUMBER >= 3007000
+    if (!m_db)
+        return false;
+
+    // SQLite answers with the journal mode in effect, which stays the old one if the log can't be used.
+    SQLiteStatement statement(*this, ASCIILiteral("PRAGMA journal_mode = WAL"));
+    if (!equalIgnoringCase(statement.getColumnText(0), "wal")) {
+        LOG(SQLDatabase, "Write-ahead logging is not available for %s", m_path.utf8().data());
+        return false;
+    }
+
+    if (!m_checkpointThread)
+        m_checkpointThread = SQLiteCheckpointThread::create(m_path);
+    // This replaces SQLite's automatic checkpoints.
+    sqlite3_wal_hook(m_db, writeAheadLogHook, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+int SQLiteDatabase::writeAheadLogHook(void* context, sqlite3* db, const char* databaseName, int pageCount)
+{
+#if SQLITE_VERSION_NUMBER >= 3007000
+    SQLiteDatabase* database = static_cast<SQLiteDatabase*>(context);
+    if (pageCount >= synchronousCheckpointPageCount)
+        sqlite3_wal_checkpoint(db, databaseName);
+    else if (pageCount >= checkpointPageCount)
+        database->m_checkpointThread->scheduleCheckpoint();
+#else
+    UNUSED_PARAM(context);
+    UNUSED_PARAM(db);
+    UNUSED_PARAM(databaseName);
+    UNUSED_PARAM(pageCount);
+#endif
+    return SQLITE_OK;
+}
+
+int64_t SQLiteDatabase::setMemoryMappedSize(int64_t size)
+{
+    // Versions of SQLite without memory mapping ignore the pragma and return no row, which reads as 0.
+    SQLiteStatement statement(*this, "PRAGMA mmap_size = " + String::number(size));
+    return statement.getColumnInt64(0);
+}
+
+sqlite3_stmt* SQLiteDatabase::takeCachedStatement(const CString& query)
+{
+    // The authorizer is consulted when a statement is prepared, so a statement prepared with
+    // different permissions must not be reused.
+    if (m_authorizer || !m_statementCacheEnabled)
+        return 0;
+
+    MutexLocker locker(m_statementCacheLock);
+    for (size_t i = m_statementCache.size(); i--; ) {
+        if (m_statementCache[i].query == query) {
+            sqlite3_stmt* statement = m_statementCache[i].statement;
+            m_statementCache.remove(i);
+            return statement;
+        }
+    }
+    return 0;
+}
+
+bool SQLiteDatabase::cacheStatement(const CString& query, sqlite3_stmt* statement)
+{
+    if (m_authorizer || !m_statementCacheEnabled || !m_db || sqlite3_db_handle(statement) != m_db)
+        return false;
+
+    sqlite3_stmt* evictedStatement = 0;
+    {
+        MutexLocker locker(m_statementCacheLock);
+        if (m_statementCache.size() == statementCacheCapacity) {
+            evictedStatement = m_statementCache[0].statement;
+            m_statementCache.remove(0);
+        }
+        CachedStatement cachedStatement = { query, statement };
+        m_statementCache.append(cachedStatement);
+    }
+    if (evictedStatement)
+        sqlite3_finalize(evictedStatement);
+    return true;
+}
+
+void SQLiteDatabase::setStatementCacheEnabled(bool enabled)
+{
+    m_statementCacheEnabled = enabled;
+    if (!enabled)
+        clearStatementCache();
+}
+
+void SQLiteDatabase::clearStatementCache()
+{
+    Vector<CachedStatement> statements;
+    {
+        MutexLocker locker(m_statementCacheLock);
+        statements.swap(m_statementCache);
+    }
+    for (size_t i = 0; i < statements.size(); ++i)
+        sqlite3_finalize(statements[i].statement);
+}
+
 void SQLiteDatabase::setBusyTimeout(int ms)
 {
     if (m_db)
@@ -454,6 +652,8 @@ void SQLiteDatabase::setAuthorizer(PassRefPtr<DatabaseAuthorizer> auth)
 
     MutexLocker locker(m_authorizerLock);
 
+    // Statements prepared so far were not checked by the authorizer.
+    clearStatementCache();
     m_authorizer = auth;
     
     enableAuthorizer(true);
@@ -27,7 +27,9 @@
 #ifndef SQLiteDatabase_h
 #define SQLiteDatabase_h
 
+#include <wtf/OwnPtr.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 #include <wtf/text/CString.h>
 #include <wtf/text/WTFString.h>
 
@@ -36,10 +38,12 @@
 #endif
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace WebCore {
 
 class DatabaseAuthorizer;
+class SQLiteCheckpointThread;
 class SQLiteStatement;
 class SQLiteTransaction;
 
@@ -54,6 +58,7 @@ extern const int SQLResultConstraint;
 
 class SQLiteDatabase {
     WTF_MAKE_NONCOPYABLE(SQLiteDatabase);
+    friend class SQLiteStatement;
     friend class SQLiteTransaction;
 public:
     SQLiteDatabase();
@@ -102,6 +107,15 @@ public:
     // OFF - Calls return immediately after the data has been passed to disk
     enum SynchronousPragma { SyncOff = 0, SyncNormal = 1, SyncFull = 2 };
     void setSynchronous(SynchronousPragma);
+
+    // Write-ahead logging turns most commits into appends to a log, which is folded back into the
+    // database on a background thread instead of by the thread that commits. Returns false, and
+    // keeps the rollback journal, if the database or the file system can't use a log.
+    bool enableWriteAheadLogging();
+
+    // Lets SQLite read up to the given number of bytes of the database through a memory mapping.
+    // Returns the size in effect, which is 0 where SQLite doesn't support memory mapping.
+    int64_t setMemoryMappedSize(int64_t);
     
     int lastError();
     const char* lastErrorMsg();
@@ -113,6 +127,9 @@ public:
     
     void setAuthorizer(PassRefPtr<DatabaseAuthorizer>);
 
+    // On by default. Turning it off finalizes the statements cached so far.
+    void setStatementCacheEnabled(bool);
+
     Mutex& databaseMutex() { return m_lockingMutex; }
     bool isAutoCommitOn() const;
 
@@ -138,6 +155,13 @@ public:
 
 private:
     static int authorizerFunction(void*, int, const char*, const char*, const char*, const char*);
+    static int writeAheadLogHook(void*, sqlite3*, const char*, int);
+
+    // Statements finalized by SQLiteStatement are kept prepared for the next statement with the
+    // same text, up to a few per database.
+    sqlite3_stmt* takeCachedStatement(const CString& query);
+    bool cacheStatement(const CString& query, sqlite3_stmt*);
+    void clearStatementCache();
 
     void enableAuthorizer(bool enable);
     
@@ -162,6 +186,17 @@ private:
     CString m_openErrorMessage;
 
     int m_lastChangesCount;
+
+    struct CachedStatement {
+        CString query;
+        sqlite3_stmt* statement;
+    };
+    Mutex m_statementCacheLock;
+    Vector<CachedStatement> m_statementCache; // Least recently used first.
+    bool m_statementCacheEnabled;
+
+    String m_path;
+    OwnPtr<SQLiteCheckpointThread> m_checkpointThread;
 };
 
 } // namespace WebCore
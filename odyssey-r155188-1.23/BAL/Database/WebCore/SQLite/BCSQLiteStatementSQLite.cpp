@@ -64,7 +64,17 @@ int SQLiteStatement::prepare()
         return SQLITE_INTERRUPT;
 
     CString query = m_query.stripWhiteSpace().utf8();
-    
+
+    m_statement = m_database.takeCachedStatement(query);
+    if (m_statement) {
+        LOG(SQLDatabase, "SQL - reuse - %s", query.data());
+        m_preparedQuery = query;
+#ifndef NDEBUG
+        m_isPrepared = true;
+#endif
+        return SQLITE_OK;
+    }
+
     LOG(SQLDatabase, "SQL - prepare - %s", query.data());
 
     // Pass the length of the string including the null character to sqlite3_prepare_v2;
@@ -80,6 +90,9 @@ int SQLiteStatement::prepare()
     if (tail && *tail)
         error = SQLITE_ERROR;
 
+    if (error == SQLITE_OK)
+        m_preparedQuery = query;
+
 #ifndef NDEBUG
     m_isPrepared = error == SQLITE_OK;
 #endif
@@ -118,8 +131,18 @@ int SQLiteStatement::finalize()
     if (!m_statement)
         return SQLITE_OK;
     LOG(SQLDatabase, "SQL - finalize - %s", m_query.ascii().data());
-    int result = sqlite3_finalize(m_statement);
+    sqlite3_stmt* statement = m_statement;
     m_statement = 0;
+    if (m_preparedQuery.isNull())
+        return sqlite3_finalize(statement);
+
+    // Hand the statement back to the database for reuse. Resetting it reports the same error
+    // finalizing it would.
+    int result = sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    if (!m_database.cacheStatement(m_preparedQuery, statement))
+        sqlite3_finalize(statement);
+    m_preparedQuery = CString();
     return result;
 }
 
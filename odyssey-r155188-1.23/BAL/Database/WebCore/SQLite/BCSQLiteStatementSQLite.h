@@ -98,6 +98,7 @@ private:
     SQLiteDatabase& m_database;
     String m_query;
     sqlite3_stmt* m_statement;
+    CString m_preparedQuery; // The text m_statement was prepared from, which identifies it in the database's cache.
 #ifndef NDEBUG
     bool m_isPrepared;
 #endif
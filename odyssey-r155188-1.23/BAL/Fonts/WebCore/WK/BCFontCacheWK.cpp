@@ -34,6 +34,7 @@
 #include "FontGlyphs.h"
 #include "FontPlatformData.h"
 #include "FontSelector.h"
+#include "ShapedRunCache.h"
 #include "WebKitFontFamilyNames.h"
 #include <wtf/HashMap.h>
 #include <wtf/ListHashSet.h>
@@ -366,6 +367,8 @@ void FontCache::purgeInactiveFontDataIfNeeded()
 
 void FontCache::purgeInactiveFontData(int count)
 {
+    // Cached runs point at font data that may be deleted below and keep their FontGlyphs referenced.
+    shapedRunCache().clear();
     pruneUnreferencedEntriesFromFontGlyphsCache();
 
     if (!gInactiveFontData || m_purgePreventCount)
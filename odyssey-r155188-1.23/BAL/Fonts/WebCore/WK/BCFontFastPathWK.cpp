@@ -28,6 +28,7 @@
 #include "FontGlyphs.h"
 #include "GlyphBuffer.h"
 #include "GlyphPageTreeNode.h"
+#include "ShapedRunCache.h"
 #include "SimpleFontData.h"
 #include "TextRun.h"
 #include "WidthIterator.h"
@@ -127,29 +128,46 @@ int Font::emphasisMarkHeight(const AtomicString& mark) const
     return markFontData->fontMetrics().height();
 }
 
-float Font::getGlyphsAndAdvancesForSimpleText(const TextRun& run, int from, int to, GlyphBuffer& glyphBuffer, ForTextEmphasisOrNot forTextEmphasis) const
-{
-    WidthIterator it(this, run, 0, false, forTextEmphasis);
-    GlyphBuffer localGlyphBuffer;
-    it.advance(run.length(), &localGlyphBuffer);
+// Presents a run that was just shaped by a WidthIterator through the same interface as a ShapedRun.
+class UncachedShapedRun {
+public:
+    UncachedShapedRun(const Font* font, const TextRun& run, bool forTextEmphasis = false)
+        : m_iterator(font, run, 0, false, forTextEmphasis)
+    {
+        m_iterator.advance(run.length(), &m_glyphBuffer);
+    }
+
+    int size() const { return m_glyphBuffer.size(); }
+    float width() const { return m_iterator.m_runWidthSoFar; }
+    int characterIndexOfGlyph(int index) const { return m_iterator.m_characterIndexOfGlyph[index]; }
+    GlyphBufferAdvance advanceAt(int index) const { return m_glyphBuffer.advanceAt(index); }
+    void appendGlyphsTo(GlyphBuffer& glyphBuffer, int from, int count) const { glyphBuffer.add(&m_glyphBuffer, from, count); }
+
+private:
+    WidthIterator m_iterator;
+    GlyphBuffer m_glyphBuffer;
+};
 
-    if (localGlyphBuffer.isEmpty())
+template<typename ShapedRunType>
+static float glyphsAndAdvancesForCharacterRange(const ShapedRunType& shapedRun, const TextRun& run, int from, int to, GlyphBuffer& glyphBuffer)
+{
+    if (!shapedRun.size())
         return 0;
 
-    float totalWidth = it.m_runWidthSoFar;
+    float totalWidth = shapedRun.width();
     float beforeWidth = 0;
     int glyphPos = 0;
-    for (; glyphPos < localGlyphBuffer.size() && it.m_characterIndexOfGlyph[glyphPos] < from; ++glyphPos)
-        beforeWidth += localGlyphBuffer.advanceAt(glyphPos).width();
+    for (; glyphPos < shapedRun.size() && shapedRun.characterIndexOfGlyph(glyphPos) < from; ++glyphPos)
+        beforeWidth += shapedRun.advanceAt(glyphPos).width();
     int glyphFrom = glyphPos;
 
     float afterWidth = totalWidth;
-    glyphPos = localGlyphBuffer.size() - 1;
-    for (; glyphPos >= glyphFrom && it.m_characterIndexOfGlyph[glyphPos] >= to; --glyphPos)
-        afterWidth -= localGlyphBuffer.advanceAt(glyphPos).width();
+    glyphPos = shapedRun.size() - 1;
+    for (; glyphPos >= glyphFrom && shapedRun.characterIndexOfGlyph(glyphPos) >= to; --glyphPos)
+        afterWidth -= shapedRun.advanceAt(glyphPos).width();
     int glyphTo = glyphPos + 1;
 
-    glyphBuffer.add(&localGlyphBuffer, glyphFrom, glyphTo - glyphFrom);
+    shapedRun.appendGlyphsTo(glyphBuffer, glyphFrom, glyphTo - glyphFrom);
 
     if (run.rtl()) {
         glyphBuffer.reverse(0, glyphBuffer.size());
@@ -159,6 +177,31 @@ float Font::getGlyphsAndAdvancesForSimpleText(const TextRun& run, int from, int
     return beforeWidth;
 }
 
+const ShapedRun* Font::cachedShapedRunForSimpleText(const TextRun& run) const
+{
+    if (!ShapedRunCache::canCache(*this, run))
+        return 0;
+
+    if (const ShapedRun* shapedRun = shapedRunCache().find(*this, run))
+        return shapedRun;
+
+    HashSet<const SimpleFontData*> fallbackFonts;
+    WidthIterator it(this, run, &fallbackFonts);
+    GlyphBuffer glyphBuffer;
+    it.advance(run.length(), &glyphBuffer);
+    return shapedRunCache().add(*this, run, ShapedRun::create(glyphBuffer, it.m_characterIndexOfGlyph, it.m_runWidthSoFar, fallbackFonts));
+}
+
+float Font::getGlyphsAndAdvancesForSimpleText(const TextRun& run, int from, int to, GlyphBuffer& glyphBuffer, ForTextEmphasisOrNot forTextEmphasis) const
+{
+    if (forTextEmphasis == NotForTextEmphasis) {
+        if (const ShapedRun* shapedRun = cachedShapedRunForSimpleText(run))
+            return glyphsAndAdvancesForCharacterRange(*shapedRun, run, from, to, glyphBuffer);
+    }
+
+    return glyphsAndAdvancesForCharacterRange(UncachedShapedRun(this, run, forTextEmphasis == ForTextEmphasis), run, from, to, glyphBuffer);
+}
+
 void Font::drawSimpleText(GraphicsContext* context, const TextRun& run, const FloatPoint& point, int from, int to) const
 {
     // This glyph buffer holds our glyphs+advances+font data for each glyph.
@@ -280,6 +323,15 @@ void Font::drawEmphasisMarks(GraphicsContext* context, const TextRun& run, const
 
 float Font::floatWidthForSimpleText(const TextRun& run, HashSet<const SimpleFontData*>* fallbackFonts, GlyphOverflow* glyphOverflow) const
 {
+    // Glyph bounds are not kept in the cache.
+    if (!glyphOverflow) {
+        if (const ShapedRun* shapedRun = cachedShapedRunForSimpleText(run)) {
+            if (fallbackFonts)
+                shapedRun->addFallbackFontsTo(*fallbackFonts);
+            return shapedRun->width();
+        }
+    }
+
     WidthIterator it(this, run, fallbackFonts, glyphOverflow);
     GlyphBuffer glyphBuffer;
     it.advance(run.length(), (typesettingFeatures() & (Kerning | Ligatures)) ? &glyphBuffer : 0);
@@ -294,23 +346,20 @@ float Font::floatWidthForSimpleText(const TextRun& run, HashSet<const SimpleFont
     return it.m_runWidthSoFar;
 }
 
-FloatRect Font::selectionRectForSimpleText(const TextRun& run, const FloatPoint& point, int h, int from, int to) const
+template<typename ShapedRunType>
+static FloatRect selectionRectForShapedRun(const ShapedRunType& shapedRun, const TextRun& run, const FloatPoint& point, int h, int from, int to)
 {
-    GlyphBuffer glyphBuffer;
-    WidthIterator it(this, run);
-    it.advance(run.length(), &glyphBuffer);
-
-    float totalWidth = it.m_runWidthSoFar;
+    float totalWidth = shapedRun.width();
     float beforeWidth = 0;
     int glyphPos = 0;
-    for (; glyphPos < glyphBuffer.size() && it.m_characterIndexOfGlyph[glyphPos] < from; ++glyphPos)
-        beforeWidth += glyphBuffer.advanceAt(glyphPos).width();
+    for (; glyphPos < shapedRun.size() && shapedRun.characterIndexOfGlyph(glyphPos) < from; ++glyphPos)
+        beforeWidth += shapedRun.advanceAt(glyphPos).width();
     int glyphFrom = glyphPos;
 
     float afterWidth = totalWidth;
-    glyphPos = glyphBuffer.size() - 1;
-    for (; glyphPos >= glyphFrom && it.m_characterIndexOfGlyph[glyphPos] >= to; --glyphPos)
-        afterWidth -= glyphBuffer.advanceAt(glyphPos).width();
+    glyphPos = shapedRun.size() - 1;
+    for (; glyphPos >= glyphFrom && shapedRun.characterIndexOfGlyph(glyphPos) >= to; --glyphPos)
+        afterWidth -= shapedRun.advanceAt(glyphPos).width();
 
     // Using roundf() rather than ceilf() for the right edge as a compromise to ensure correct caret positioning.
     if (run.rtl()) {
@@ -320,22 +369,26 @@ FloatRect Font::selectionRectForSimpleText(const TextRun& run, const FloatPoint&
     return FloatRect(floorf(point.x() + beforeWidth), point.y(), roundf(point.x() + afterWidth) - floorf(point.x() + beforeWidth), h);
 }
 
-int Font::offsetForPositionForSimpleText(const TextRun& run, float x, bool includePartialGlyphs) const
+FloatRect Font::selectionRectForSimpleText(const TextRun& run, const FloatPoint& point, int h, int from, int to) const
 {
-    GlyphBuffer glyphBuffer;
-    WidthIterator it(this, run);
-    it.advance(run.length(), &glyphBuffer);
+    if (const ShapedRun* shapedRun = cachedShapedRunForSimpleText(run))
+        return selectionRectForShapedRun(*shapedRun, run, point, h, from, to);
+    return selectionRectForShapedRun(UncachedShapedRun(this, run), run, point, h, from, to);
+}
 
+template<typename ShapedRunType>
+static int offsetForPositionInShapedRun(const ShapedRunType& shapedRun, const TextRun& run, float x, bool includePartialGlyphs)
+{
     int characterOffset = 0;
     if (run.rtl()) {
-        float currentX = it.m_runWidthSoFar;
-        for (int glyphPosition = 0; glyphPosition <= glyphBuffer.size(); ++glyphPosition) {
-            if (glyphPosition == glyphBuffer.size()) {
+        float currentX = shapedRun.width();
+        for (int glyphPosition = 0; glyphPosition <= shapedRun.size(); ++glyphPosition) {
+            if (glyphPosition == shapedRun.size()) {
                 characterOffset = run.length();
                 break;
             }
-            characterOffset = it.m_characterIndexOfGlyph[glyphPosition];
-            float glyphWidth = glyphBuffer.advanceAt(glyphPosition).width();
+            characterOffset = shapedRun.characterIndexOfGlyph(glyphPosition);
+            float glyphWidth = shapedRun.advanceAt(glyphPosition).width();
             if (includePartialGlyphs) {
                 if (currentX - glyphWidth / 2.0f <= x)
                     break;
@@ -347,13 +400,13 @@ int Font::offsetForPositionForSimpleText(const TextRun& run, float x, bool inclu
         }
     } else {
         float currentX = 0;
-        for (int glyphPosition = 0; glyphPosition <= glyphBuffer.size(); ++glyphPosition) {
-            if (glyphPosition == glyphBuffer.size()) {
+        for (int glyphPosition = 0; glyphPosition <= shapedRun.size(); ++glyphPosition) {
+            if (glyphPosition == shapedRun.size()) {
                 characterOffset = run.length();
                 break;
             }
-            characterOffset = it.m_characterIndexOfGlyph[glyphPosition];
-            float glyphWidth = glyphBuffer.advanceAt(glyphPosition).width();
+            characterOffset = shapedRun.characterIndexOfGlyph(glyphPosition);
+            float glyphWidth = shapedRun.advanceAt(glyphPosition).width();
             if (includePartialGlyphs) {
                 if (currentX + glyphWidth / 2.0f >= x)
                     break;
@@ -368,4 +421,11 @@ int Font::offsetForPositionForSimpleText(const TextRun& run, float x, bool inclu
     return characterOffset;
 }
 
+int Font::offsetForPositionForSimpleText(const TextRun& run, float x, bool includePartialGlyphs) const
+{
+    if (const ShapedRun* shapedRun = cachedShapedRunForSimpleText(run))
+        return offsetForPositionInShapedRun(*shapedRun, run, x, includePartialGlyphs);
+    return offsetForPositionInShapedRun(UncachedShapedRun(this, run), run, x, includePartialGlyphs);
+}
+
 } // namespace WebCore
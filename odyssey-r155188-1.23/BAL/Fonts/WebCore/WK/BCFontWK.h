@@ -59,6 +59,7 @@ class FontSelector;
 class GlyphBuffer;
 class GraphicsContext;
 class RenderText;
+class ShapedRun;
 class TextLayout;
 class TextRun;
 
@@ -196,6 +197,8 @@ private:
     float floatWidthForSimpleText(const TextRun&, HashSet<const SimpleFontData*>* fallbackFonts = 0, GlyphOverflow* = 0) const;
     int offsetForPositionForSimpleText(const TextRun&, float position, bool includePartialGlyphs) const;
     FloatRect selectionRectForSimpleText(const TextRun&, const FloatPoint&, int h, int from, int to) const;
+    // Returns 0 if the run can not be cached, see ShapedRunCache::canCache().
+    const ShapedRun* cachedShapedRunForSimpleText(const TextRun&) const;
 
     bool getEmphasisMarkGlyphData(const AtomicString&, GlyphData&) const;
 
@@ -0,0 +1,243 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "ShapedRunCache.h"
+
+#include "Font.h"
+#include "FontGlyphs.h"
+#include "TextRun.h"
+#include <wtf/MainThread.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringHasher.h>
+
+namespace WebCore {
+
+// Single characters are answered from the glyph page directly.
+static const unsigned minimumCachedRunLength = 2;
+// Up to this length, WidthCache remembers the widths of plain text runs.
+static const unsigned maximumWidthCacheRunLength = 15;
+// Longer runs are whole paragraphs of preformatted text that are rarely measured twice.
+static const unsigned maximumCachedRunLength = 4096;
+static const size_t maximumEntries = 4096;
+static const size_t maximumTotalCost = 4 * 1024 * 1024;
+
+enum ShapedRunFlags {
+    RTLFlag = 1 << 0,
+    WordRoundingFlag = 1 << 1,
+    RunRoundingFlag = 1 << 2,
+    SpacingDisabledFlag = 1 << 3,
+    SmallCapsFlag = 1 << 4,
+    VerticalFlag = 1 << 5,
+    TypesettingFeaturesShift = 8
+};
+
+static inline float horizontalGlyphStretch(const TextRun& run)
+{
+#if ENABLE(SVG)
+    return run.horizontalGlyphStretch();
+#else
+    UNUSED_PARAM(run);
+    return 1;
+#endif
+}
+
+ShapedRun::ShapedRun(const GlyphBuffer& glyphBuffer, float width, const HashSet<const SimpleFontData*>& fallbackFonts)
+    : m_width(width)
+{
+    int size = glyphBuffer.size();
+    m_glyphs.reserveInitialCapacity(size);
+    m_advances.reserveInitialCapacity(size);
+    m_fontData.reserveInitialCapacity(size);
+    for (int i = 0; i < size; ++i) {
+        m_glyphs.uncheckedAppend(glyphBuffer.glyphAt(i));
+        m_advances.uncheckedAppend(glyphBuffer.advanceAt(i));
+        m_fontData.uncheckedAppend(glyphBuffer.fontDataAt(i));
+    }
+
+    HashSet<const SimpleFontData*>::const_iterator end = fallbackFonts.end();
+    for (HashSet<const SimpleFontData*>::const_iterator it = fallbackFonts.begin(); it != end; ++it)
+        m_fallbackFonts.append(*it);
+}
+
+void ShapedRun::appendGlyphsTo(GlyphBuffer& glyphBuffer, int from, int count) const
+{
+    ASSERT(from >= 0 && from + count <= size());
+    for (int i = from; i < from + count; ++i)
+        glyphBuffer.add(m_glyphs[i], m_fontData[i], m_advances[i]);
+}
+
+void ShapedRun::addFallbackFontsTo(HashSet<const SimpleFontData*>& fallbackFonts) const
+{
+    for (size_t i = 0; i < m_fallbackFonts.size(); ++i)
+        fallbackFonts.add(m_fallbackFonts[i]);
+}
+
+size_t ShapedRun::cost() const
+{
+    size_t perGlyph = sizeof(Glyph) + sizeof(GlyphBufferAdvance) + sizeof(const SimpleFontData*) + sizeof(int);
+    return sizeof(ShapedRun) + m_glyphs.size() * perGlyph + m_fallbackFonts.size() * sizeof(const SimpleFontData*);
+}
+
+ShapedRunCache& shapedRunCache()
+{
+    DEFINE_STATIC_LOCAL(ShapedRunCache, cache, ());
+    return cache;
+}
+
+ShapedRunCache::ShapedRunCache()
+    : m_totalCost(0)
+{
+}
+
+bool ShapedRunCache::canCache(const Font& font, const TextRun& run)
+{
+    unsigned length = run.length();
+    if (length < minimumCachedRunLength || length > maximumCachedRunLength)
+        return false;
+    // Short runs are cheap to shape on the simple path, unless kerning or ligatures apply. Runs
+    // that need the complex path are always worth keeping.
+    if (length <= maximumWidthCacheRunLength && !(font.typesettingFeatures() & (Kerning | Ligatures)) && font.codePath(run) != Font::Complex)
+        return false;
+    // Tab stops depend on the position of the run on the line.
+    if (run.allowTabs())
+        return false;
+    // Justification is distributed over the whole line the run is on.
+    if (run.expansion())
+        return false;
+#if ENABLE(SVG_FONTS)
+    if (run.renderingContext())
+        return false;
+#endif
+    // The fallback fonts are about to be replaced.
+    if (!font.glyphs() || font.glyphs()->loadingCustomFonts())
+        return false;
+    return isMainThread();
+}
+
+unsigned ShapedRunCache::flagsFor(const Font& font, const TextRun& run)
+{
+    unsigned flags = static_cast<unsigned>(font.typesettingFeatures()) << TypesettingFeaturesShift;
+    if (run.rtl())
+        flags |= RTLFlag;
+    if (run.applyWordRounding())
+        flags |= WordRoundingFlag;
+    if (run.applyRunRounding())
+        flags |= RunRoundingFlag;
+    if (run.spacingDisabled())
+        flags |= SpacingDisabledFlag;
+    if (font.isSmallCaps())
+        flags |= SmallCapsFlag;
+    if (font.fontDescription().orientation() == Vertical)
+        flags |= VerticalFlag;
+    return flags;
+}
+
+unsigned ShapedRunCache::computeHash(const Font& font, const TextRun& run)
+{
+    unsigned textHash = run.is8Bit() ? StringHasher::computeHashAndMaskTop8Bits(run.characters8(), run.length()) : StringHasher::computeHashAndMaskTop8Bits(run.characters16(), run.length());
+    unsigned hashCodes[6] = {
+        textHash,
+        PtrHash<FontGlyphs*>::hash(font.glyphs()),
+        flagsFor(font, run),
+        static_cast<unsigned>(font.letterSpacing()) << 16 | static_cast<unsigned short>(font.wordSpacing()),
+        bitwise_cast<unsigned>(horizontalGlyphStretch(run)),
+        run.length()
+    };
+    return StringHasher::hashMemory<sizeof(hashCodes)>(hashCodes);
+}
+
+bool ShapedRunCache::keyMatches(const Key& key, const Font& font, const TextRun& run)
+{
+    if (key.glyphs != font.glyphs() || key.flags != flagsFor(font, run))
+        return false;
+    if (key.letterSpacing != font.letterSpacing() || key.wordSpacing != font.wordSpacing() || key.horizontalGlyphStretch != horizontalGlyphStretch(run))
+        return false;
+    if (key.text.length() != static_cast<unsigned>(run.length()))
+        return false;
+    return run.is8Bit() ? equal(key.text.impl(), run.characters8(), run.length()) : equal(key.text.impl(), run.characters16(), run.length());
+}
+
+const ShapedRun* ShapedRunCache::find(const Font& font, const TextRun& run)
+{
+    ASSERT(canCache(font, run));
+
+    EntryMap::iterator it = m_entries.find(computeHash(font, run));
+    if (it == m_entries.end() || !keyMatches(it->value->key, font, run)) {
+        ++m_statistics.missCount;
+        return 0;
+    }
+
+    Entry* entry = it->value.get();
+    m_lruList.remove(entry);
+    m_lruList.append(entry);
+    ++m_statistics.hitCount;
+    return entry->run.get();
+}
+
+const ShapedRun* ShapedRunCache::add(const Font& font, const TextRun& run, PassOwnPtr<ShapedRun> shapedRun)
+{
+    ASSERT(canCache(font, run));
+
+    unsigned hash = computeHash(font, run);
+    EntryMap::iterator existing = m_entries.find(hash);
+    // A colliding key simply replaces the older entry.
+    if (existing != m_entries.end())
+        removeEntry(existing->value.get());
+
+    OwnPtr<Entry> entry = adoptPtr(new Entry(hash, shapedRun));
+    entry->key.glyphs = font.glyphs();
+    entry->key.text = run.is8Bit() ? String(run.characters8(), run.length()) : String(run.characters16(), run.length());
+    entry->key.flags = flagsFor(font, run);
+    entry->key.letterSpacing = font.letterSpacing();
+    entry->key.wordSpacing = font.wordSpacing();
+    entry->key.horizontalGlyphStretch = horizontalGlyphStretch(run);
+
+    Entry* newEntry = entry.get();
+    m_totalCost += newEntry->run->cost() + newEntry->key.text.sizeInBytes();
+    m_lruList.append(newEntry);
+    m_entries.set(hash, entry.release());
+
+    pruneToBudget();
+    ASSERT(m_entries.contains(hash));
+    return newEntry->run.get();
+}
+
+void ShapedRunCache::removeEntry(Entry* entry)
+{
+    m_totalCost -= entry->run->cost() + entry->key.text.sizeInBytes();
+    m_lruList.remove(entry);
+    m_entries.remove(entry->hash);
+}
+
+void ShapedRunCache::pruneToBudget()
+{
+    // Never evicts the most recently used entry, which the caller is about to use.
+    while ((m_entries.size() > maximumEntries || m_totalCost > maximumTotalCost) && m_lruList.head() != m_lruList.tail()) {
+        removeEntry(m_lruList.head());
+        ++m_statistics.evictionCount;
+    }
+}
+
+void ShapedRunCache::clear()
+{
+    m_lruList.clear();
+    m_entries.clear();
+    m_totalCost = 0;
+}
+
+} // namespace WebCore
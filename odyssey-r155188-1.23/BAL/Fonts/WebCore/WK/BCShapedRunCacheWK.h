@@ -0,0 +1,166 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ShapedRunCache_h
+#define ShapedRunCache_h
+
+#include "Glyph.h"
+#include "GlyphBuffer.h"
+#include <wtf/DoublyLinkedList.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+class Font;
+class FontGlyphs;
+class SimpleFontData;
+class TextRun;
+
+// The glyphs, advances and fonts WidthIterator produced for a whole run, in logical order.
+class ShapedRun {
+    WTF_MAKE_NONCOPYABLE(ShapedRun); WTF_MAKE_FAST_ALLOCATED;
+public:
+    template<size_t inlineCapacity>
+    static PassOwnPtr<ShapedRun> create(const GlyphBuffer& glyphBuffer, const Vector<int, inlineCapacity>& characterIndexOfGlyph, float width, const HashSet<const SimpleFontData*>& fallbackFonts)
+    {
+        OwnPtr<ShapedRun> run = adoptPtr(new ShapedRun(glyphBuffer, width, fallbackFonts));
+        run->m_characterIndexOfGlyph.append(characterIndexOfGlyph.data(), characterIndexOfGlyph.size());
+        ASSERT(run->m_characterIndexOfGlyph.size() == run->m_glyphs.size());
+        return run.release();
+    }
+
+    int size() const { return m_glyphs.size(); }
+    float width() const { return m_width; }
+    int characterIndexOfGlyph(int index) const { return m_characterIndexOfGlyph[index]; }
+    const GlyphBufferAdvance& advanceAt(int index) const { return m_advances[index]; }
+
+    void appendGlyphsTo(GlyphBuffer&, int from, int count) const;
+    void addFallbackFontsTo(HashSet<const SimpleFontData*>&) const;
+
+    // Rough number of bytes held, used for the cache budget.
+    size_t cost() const;
+
+private:
+    ShapedRun(const GlyphBuffer&, float width, const HashSet<const SimpleFontData*>& fallbackFonts);
+
+    Vector<Glyph> m_glyphs;
+    Vector<GlyphBufferAdvance> m_advances;
+    Vector<const SimpleFontData*> m_fontData;
+    Vector<int> m_characterIndexOfGlyph;
+    Vector<const SimpleFontData*> m_fallbackFonts;
+    float m_width;
+};
+
+// A bounded, least recently used cache of shaped runs shared by every font on the main thread.
+//
+// WidthCache only remembers the widths of short words for one FontGlyphs. This cache keeps the
+// complete glyph buffer of runs of any length, so the width queries made during line layout and
+// preferred width computation, selection and hit testing, and painting of the same text boxes
+// all reuse one shaping pass. Relayout after a resize then only shapes text that changed.
+//
+// Entries keep their FontGlyphs (and with it the realized font data the glyphs point to) alive.
+// FontCache clears the cache before it purges inactive font data, which covers the system
+// fallback fonts that are only referenced from glyph pages.
+class ShapedRunCache {
+    WTF_MAKE_NONCOPYABLE(ShapedRunCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    // Runs whose shaping depends on their position or surroundings are not cached, nor short
+    // runs of plain text, which WidthCache and the glyph pages already answer cheaply.
+    static bool canCache(const Font&, const TextRun&);
+
+    const ShapedRun* find(const Font&, const TextRun&);
+    const ShapedRun* add(const Font&, const TextRun&, PassOwnPtr<ShapedRun>);
+
+    void clear();
+
+    size_t size() const { return m_entries.size(); }
+    size_t totalCost() const { return m_totalCost; }
+
+    struct Statistics {
+        Statistics()
+            : hitCount(0)
+            , missCount(0)
+            , evictionCount(0)
+        {
+        }
+
+        unsigned hitCount;
+        unsigned missCount;
+        // Entries removed to stay within the budget, not by clear().
+        unsigned evictionCount;
+    };
+    const Statistics& statistics() const { return m_statistics; }
+
+private:
+    friend ShapedRunCache& shapedRunCache();
+    ShapedRunCache();
+
+    struct Key {
+        RefPtr<FontGlyphs> glyphs;
+        String text;
+        unsigned flags;
+        short letterSpacing;
+        short wordSpacing;
+        float horizontalGlyphStretch;
+    };
+
+    class Entry : public DoublyLinkedListNode<Entry> {
+        WTF_MAKE_NONCOPYABLE(Entry); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        Entry(unsigned hash, PassOwnPtr<ShapedRun> run)
+            : m_prev(0)
+            , m_next(0)
+            , hash(hash)
+            , run(run)
+        {
+        }
+
+        Entry* m_prev;
+        Entry* m_next;
+        unsigned hash;
+        Key key;
+        OwnPtr<ShapedRun> run;
+    };
+
+    static unsigned flagsFor(const Font&, const TextRun&);
+    static unsigned computeHash(const Font&, const TextRun&);
+    static bool keyMatches(const Key&, const Font&, const TextRun&);
+
+    void removeEntry(Entry*);
+    void pruneToBudget();
+
+    typedef HashMap<unsigned, OwnPtr<Entry>, AlreadyHashed> EntryMap;
+    EntryMap m_entries;
+    // Least recently used first.
+    DoublyLinkedList<Entry> m_lruList;
+    size_t m_totalCost;
+    Statistics m_statistics;
+};
+
+ShapedRunCache& shapedRunCache();
+
+} // namespace WebCore
+
+#endif // ShapedRunCache_h
@@ -86,8 +86,9 @@ void CookieDatabaseBackingStore::open(const String& cookieJar)
         return;
     }
 
-	//m_db.executeCommand("PRAGMA locking_mode=EXCLUSIVE;");
-	//m_db.executeCommand("PRAGMA journal_mode=WAL;");
+    // Cookies are written from the main thread as they change, so keep commits cheap.
+    if (m_db.enableWriteAheadLogging())
+        m_db.setSynchronous(SQLiteDatabase::SyncNormal);
 
     const String primaryKeyFields("PRIMARY KEY (protocol, host, path, name)");
     const String databaseFields("name TEXT, value TEXT, host TEXT, path TEXT, expiry DOUBLE, lastAccessed DOUBLE, isSecure INTEGER, isHttpOnly INTEGER, creationTime DOUBLE, protocol TEXT");
@@ -0,0 +1,172 @@
+#include "SQLiteStatementCacheTest.h"
+
+#include "FileSystem.h"
+#include "SQLiteTransaction.h"
+#include <stdio.h>
+#include <wtf/CurrentTime.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SQLiteStatementCacheTest );
+
+using namespace WebCore;
+
+static const char databasePath[] = "SQLiteStatementCacheTest.db";
+
+static void deleteDatabaseFiles()
+{
+    deleteFile(databasePath);
+    deleteFile(String(databasePath) + "-journal");
+    deleteFile(String(databasePath) + "-wal");
+    deleteFile(String(databasePath) + "-shm");
+}
+
+void SQLiteStatementCacheTest::setUp()
+{
+    deleteDatabaseFiles();
+    CPPUNIT_ASSERT(m_database.open(databasePath));
+    CPPUNIT_ASSERT(m_database.executeCommand("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)"));
+}
+
+void SQLiteStatementCacheTest::tearDown()
+{
+    m_database.close();
+    deleteDatabaseFiles();
+}
+
+void SQLiteStatementCacheTest::reusedStatementsStartOver()
+{
+    for (int i = 0; i < 3; ++i) {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        CPPUNIT_ASSERT(insert.bindText(1, String::number(i)) == SQLResultOk);
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+
+    // A statement left in the middle of its results must come back from the cache at the first row.
+    for (int i = 0; i < 3; ++i) {
+        SQLiteStatement select(m_database, "SELECT name FROM items ORDER BY id");
+        CPPUNIT_ASSERT(select.prepare() == SQLResultOk);
+        for (int j = 0; j <= i; ++j) {
+            CPPUNIT_ASSERT(select.step() == SQLResultRow);
+            CPPUNIT_ASSERT(select.getColumnText(0) == String::number(j));
+        }
+    }
+}
+
+void SQLiteStatementCacheTest::reusedStatementsForgetBindings()
+{
+    {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        CPPUNIT_ASSERT(insert.bindText(1, "bound") == SQLResultOk);
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+    {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+
+    SQLiteStatement count(m_database, "SELECT COUNT(*) FROM items WHERE name IS NULL");
+    CPPUNIT_ASSERT(count.getColumnInt(0) == 1);
+}
+
+void SQLiteStatementCacheTest::writeAheadLogging()
+{
+    // The file system may not support the log, but the database has to stay usable either way.
+    bool enabled = m_database.enableWriteAheadLogging();
+    SQLiteStatement journalMode(m_database, "PRAGMA journal_mode");
+    CPPUNIT_ASSERT(equalIgnoringCase(journalMode.getColumnText(0), "wal") == enabled);
+    journalMode.finalize();
+
+    // Enough commits for several checkpoints.
+    for (int i = 0; i < 5000; ++i) {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        CPPUNIT_ASSERT(insert.bindText(1, String::number(i)) == SQLResultOk);
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+
+    SQLiteStatement count(m_database, "SELECT COUNT(*) FROM items");
+    CPPUNIT_ASSERT(count.getColumnInt(0) == 5000);
+}
+
+double SQLiteStatementCacheTest::timeInlineStatements(bool statementCacheEnabled)
+{
+    const int iterations = 20000;
+
+    m_database.setStatementCacheEnabled(statementCacheEnabled);
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+
+    // The way most callers use statements: constructed for one operation and then thrown away.
+    double start = monotonicallyIncreasingTime();
+    for (int i = 0; i < iterations; ++i) {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        insert.bindText(1, "item");
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+    double time = monotonicallyIncreasingTime() - start;
+
+    transaction.commit();
+    m_database.setStatementCacheEnabled(true);
+    return time;
+}
+
+void SQLiteStatementCacheTest::benchmarkInlineStatements()
+{
+    const int iterations = 20000;
+
+    double uncachedTime = timeInlineStatements(false);
+    double cachedTime = timeInlineStatements(true);
+
+    // The best case: one statement prepared once and reset between operations.
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+    double start = monotonicallyIncreasingTime();
+    SQLiteStatement update(m_database, "UPDATE items SET name = ? WHERE id = ?");
+    CPPUNIT_ASSERT(update.prepare() == SQLResultOk);
+    for (int i = 0; i < iterations; ++i) {
+        update.bindText(1, "renamed");
+        update.bindInt(2, i + 1);
+        CPPUNIT_ASSERT(update.step() == SQLResultDone);
+        update.reset();
+    }
+    double preparedOnceTime = monotonicallyIncreasingTime() - start;
+    update.finalize();
+    transaction.commit();
+
+    printf("\n%d statements constructed inline without the statement cache: %.1f ms, with it: %.1f ms, prepared once: %.1f ms\n",
+        iterations, uncachedTime * 1000, cachedTime * 1000, preparedOnceTime * 1000);
+}
+
+double SQLiteStatementCacheTest::timeCommits(bool writeAheadLogging)
+{
+    const int commits = 200;
+
+    if (writeAheadLogging && !m_database.enableWriteAheadLogging())
+        return -1;
+
+    double start = monotonicallyIncreasingTime();
+    for (int i = 0; i < commits; ++i) {
+        SQLiteStatement insert(m_database, "INSERT INTO items (name) VALUES (?)");
+        CPPUNIT_ASSERT(insert.prepare() == SQLResultOk);
+        insert.bindText(1, "item");
+        CPPUNIT_ASSERT(insert.step() == SQLResultDone);
+    }
+    return monotonicallyIncreasingTime() - start;
+}
+
+void SQLiteStatementCacheTest::benchmarkCommits()
+{
+    double journalTime = timeCommits(false);
+
+    tearDown();
+    setUp();
+    double logTime = timeCommits(true);
+
+    if (logTime < 0)
+        printf("\n200 commits with a rollback journal: %.1f ms, write-ahead logging unavailable\n", journalTime * 1000);
+    else
+        printf("\n200 commits with a rollback journal: %.1f ms, with write-ahead logging: %.1f ms\n", journalTime * 1000, logTime * 1000);
+}
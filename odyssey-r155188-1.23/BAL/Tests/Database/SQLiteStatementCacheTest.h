@@ -0,0 +1,39 @@
+#ifndef SQLiteStatementCache_h_CPPUNIT
+#define SQLiteStatementCache_h_CPPUNIT
+
+#include "config.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include "SQLiteDatabase.h"
+#include "SQLiteStatement.h"
+class SQLiteStatementCacheTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( SQLiteStatementCacheTest );
+//register each method:
+    CPPUNIT_TEST( reusedStatementsStartOver);
+    CPPUNIT_TEST( reusedStatementsForgetBindings);
+    CPPUNIT_TEST( writeAheadLogging);
+
+    // Print timings with the statement cache turned off and on.
+    CPPUNIT_TEST( benchmarkInlineStatements);
+    CPPUNIT_TEST( benchmarkCommits);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void reusedStatementsStartOver();
+    void reusedStatementsForgetBindings();
+    void writeAheadLogging();
+
+    void benchmarkInlineStatements();
+    void benchmarkCommits();
+
+private:
+    double timeInlineStatements(bool statementCacheEnabled);
+    double timeCommits(bool writeAheadLogging);
+
+    WebCore::SQLiteDatabase m_database;
+};
+
+#endif // SQLiteStatementCache_h_CPPUNIT
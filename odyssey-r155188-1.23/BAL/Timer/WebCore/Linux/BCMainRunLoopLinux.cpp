@@ -0,0 +1,274 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "MainRunLoop.h"
+
+#include "Assertions.h"
+#include "MainThread.h"
+#include <wtf/TemporaryChange.h>
+
+#include <errno.h>
+#include <limits>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Override LOG_ERROR macro definition from Assertions.h, so we make sure
+// error messages get logged to the console, even for a release builds
+#if defined(LOG_ERROR)
+#undef LOG_ERROR
+#endif
+
+#define LOG_ERROR(...)                      WTFReportError(__FILE__, __LINE__, WTF_PRETTY_FUNCTION, __VA_ARGS__)
+#define LOG_SYSCALL_ERROR(unused)           LOG_ERROR("Call failed w/ error #%d: %s", errno, strerror(errno))
+
+#define LOG_ERROR_ON_FAILURE(x)             do { if ((x) == -1) { LOG_SYSCALL_ERROR(); } } while(0)
+#define LOG_ERROR_ON_FAILURE_AND_EXIT(x)    do { if ((x) == -1) { LOG_SYSCALL_ERROR(); exit(1); } } while(0)
+
+namespace WebCore {
+
+static const int maxEventsPerIteration = 32;
+
+static MainRunLoop* mainRunLoop;
+
+static uint32_t epollEventsForFdEvents(unsigned events)
+{
+    uint32_t epollEvents = 0;
+    if (events & MainRunLoop::FdReadable)
+        epollEvents |= EPOLLIN;
+    if (events & MainRunLoop::FdWritable)
+        epollEvents |= EPOLLOUT;
+    return epollEvents;
+}
+
+static unsigned fdEventsForEpollEvents(uint32_t epollEvents)
+{
+    unsigned events = 0;
+    if (epollEvents & (EPOLLIN | EPOLLPRI))
+        events |= MainRunLoop::FdReadable;
+    if (epollEvents & EPOLLOUT)
+        events |= MainRunLoop::FdWritable;
+    if (epollEvents & (EPOLLERR | EPOLLHUP))
+        events |= MainRunLoop::FdError;
+    return events;
+}
+
+static void addToEpollSet(int epollFd, int fd)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    LOG_ERROR_ON_FAILURE_AND_EXIT(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event));
+}
+
+MainRunLoop& MainRunLoop::main()
+{
+    if (!mainRunLoop) {
+        ASSERT(isMainThread());
+        mainRunLoop = new MainRunLoop;
+        // Set only once the loop is complete, as other threads may call it right away.
+        WTF::setMainThreadFiredFunction(scheduleDispatchFunctions);
+    }
+    return *mainRunLoop;
+}
+
+MainRunLoop::MainRunLoop()
+    : m_epollFd(epoll_create1(EPOLL_CLOEXEC))
+    , m_timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+    , m_wakeUpFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , m_stopped(false)
+    , m_timerFiredFunction(0)
+{
+    LOG_ERROR_ON_FAILURE_AND_EXIT(m_epollFd);
+    LOG_ERROR_ON_FAILURE_AND_EXIT(m_timerFd);
+    LOG_ERROR_ON_FAILURE_AND_EXIT(m_wakeUpFd);
+
+    addToEpollSet(m_epollFd, m_timerFd);
+    addToEpollSet(m_epollFd, m_wakeUpFd);
+}
+
+bool MainRunLoop::addFdSource(int fd, unsigned events, FdSourceCallback callback, void* context)
+{
+    ASSERT(isMainThread());
+    ASSERT(fd >= 0 && fd != m_epollFd && fd != m_timerFd && fd != m_wakeUpFd);
+    ASSERT(callback);
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = epollEventsForFdEvents(events);
+    event.data.fd = fd;
+
+    bool isNewSource = !m_fdSources.contains(fd);
+    if (epoll_ctl(m_epollFd, isNewSource ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) == -1) {
+        LOG_SYSCALL_ERROR();
+        return false;
+    }
+
+    m_fdSources.set(fd, FdSource(events, callback, context));
+    return true;
+}
+
+void MainRunLoop::removeFdSource(int fd)
+{
+    ASSERT(isMainThread());
+
+    if (!m_fdSources.contains(fd))
+        return;
+    m_fdSources.remove(fd);
+
+    // The descriptor may already be closed, which removed it from the set.
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, 0) == -1 && errno != EBADF && errno != ENOENT)
+        LOG_SYSCALL_ERROR();
+}
+
+void MainRunLoop::run()
+{
+    ASSERT(isMainThread());
+
+    TemporaryChange<bool> stopped(m_stopped, false);
+    while (!m_stopped)
+        iterate(-1);
+}
+
+void MainRunLoop::stop()
+{
+    ASSERT(isMainThread());
+    m_stopped = true;
+}
+
+bool MainRunLoop::iterate(double timeout)
+{
+    ASSERT(isMainThread());
+
+    int timeoutMS = -1;
+    if (timeout >= 0)
+        timeoutMS = timeout * 1000 < std::numeric_limits<int>::max() ? static_cast<int>(ceil(timeout * 1000)) : std::numeric_limits<int>::max();
+
+    struct epoll_event events[maxEventsPerIteration];
+    int count = epoll_wait(m_epollFd, events, maxEventsPerIteration, timeoutMS);
+    if (count == -1) {
+        if (errno != EINTR)
+            LOG_SYSCALL_ERROR();
+        return false;
+    }
+
+    // A callback may remove or replace sources whose events are still in this batch, so they
+    // are looked up again for each event rather than kept in the event data.
+    for (int i = 0; i < count; ++i)
+        dispatch(events[i]);
+
+    return count > 0;
+}
+
+void MainRunLoop::dispatch(const epoll_event& event)
+{
+    int fd = event.data.fd;
+    if (fd == m_timerFd) {
+        timerFired();
+        return;
+    }
+    if (fd == m_wakeUpFd) {
+        wokenUp();
+        return;
+    }
+
+    FdSourceMap::const_iterator it = m_fdSources.find(fd);
+    if (it == m_fdSources.end())
+        return;
+
+    unsigned events = fdEventsForEpollEvents(event.events) & (it->value.events | FdError);
+    if (events)
+        it->value.callback(fd, events, it->value.context);
+}
+
+void MainRunLoop::setTimerFiredFunction(void (*function)())
+{
+    m_timerFiredFunction = function;
+}
+
+void MainRunLoop::setTimerFireInterval(double interval)
+{
+    ASSERT(m_timerFiredFunction);
+
+    // The timer is relative to CLOCK_MONOTONIC, so changes of the wall clock do not move it.
+    // A zero value would disarm it, hence the one nanosecond for timers that are already due.
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    if (interval < 1e-9)
+        timer.it_value.tv_nsec = 1;
+    else if (interval >= std::numeric_limits<time_t>::max())
+        timer.it_value.tv_sec = std::numeric_limits<time_t>::max();
+    else {
+        timer.it_value.tv_sec = static_cast<time_t>(interval);
+        timer.it_value.tv_nsec = static_cast<long>((interval - timer.it_value.tv_sec) * 1000000000.0);
+        if (!timer.it_value.tv_sec && !timer.it_value.tv_nsec)
+            timer.it_value.tv_nsec = 1;
+    }
+
+    LOG_ERROR_ON_FAILURE(timerfd_settime(m_timerFd, 0, &timer, 0));
+}
+
+void MainRunLoop::stopTimer()
+{
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    LOG_ERROR_ON_FAILURE(timerfd_settime(m_timerFd, 0, &timer, 0));
+}
+
+void MainRunLoop::timerFired()
+{
+    // Reading fails with EAGAIN when the timer was re-armed or stopped since epoll reported it.
+    uint64_t expirations;
+    if (read(m_timerFd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return;
+
+    if (m_timerFiredFunction)
+        m_timerFiredFunction();
+}
+
+void MainRunLoop::wakeUp()
+{
+    // Writes add up in the counter until the main thread reads it, so repeated requests
+    // cost a single wakeup.
+    uint64_t increment = 1;
+    if (write(m_wakeUpFd, &increment, sizeof(increment)) == -1 && errno != EAGAIN)
+        LOG_SYSCALL_ERROR();
+}
+
+void MainRunLoop::wokenUp()
+{
+    uint64_t count;
+    if (read(m_wakeUpFd, &count, sizeof(count)) != sizeof(count))
+        return;
+
+    WTF::dispatchFunctionsFromMainThread();
+}
+
+void MainRunLoop::scheduleDispatchFunctions()
+{
+    ASSERT(mainRunLoop);
+    mainRunLoop->wakeUp();
+}
+
+} // namespace WebCore
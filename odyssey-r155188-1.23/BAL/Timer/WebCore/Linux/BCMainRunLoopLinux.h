@@ -0,0 +1,101 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MainRunLoop_h
+#define MainRunLoop_h
+
+#include <wtf/HashMap.h>
+#include <wtf/HashTraits.h>
+#include <wtf/Noncopyable.h>
+
+struct epoll_event;
+
+namespace WebCore {
+
+// The run loop of the main thread on Linux. It waits on a single epoll set holding a timerfd on
+// CLOCK_MONOTONIC for the shared timer, an eventfd signalled by callOnMainThread() and the file
+// descriptors that the embedder or the network layer add as sources. Everything it dispatches
+// runs on the main thread.
+class MainRunLoop {
+    WTF_MAKE_NONCOPYABLE(MainRunLoop); WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum FdEvent {
+        FdReadable = 1 << 0,
+        FdWritable = 1 << 1,
+        // Only reported to the callback: the descriptor hung up or failed.
+        FdError = 1 << 2
+    };
+
+    typedef void (*FdSourceCallback)(int fd, unsigned events, void* context);
+
+    // Must first be called on the main thread after WTF::initializeMainThread(). From then on
+    // callOnMainThread() wakes this loop up.
+    static MainRunLoop& main();
+
+    // Watches fd for the given FdEvent mask. Adding a descriptor that is already watched replaces
+    // its source; a zero mask keeps the source but stops reporting events for it.
+    bool addFdSource(int fd, unsigned events, FdSourceCallback, void* context);
+    void removeFdSource(int fd);
+
+    // Runs until stop() is called. Nested calls are allowed; stop() ends the innermost one.
+    void run();
+    void stop();
+
+    // Waits up to timeout seconds, or indefinitely when it is negative, and dispatches what is
+    // ready. Returns false if nothing was dispatched.
+    bool iterate(double timeout);
+
+    // Lets an embedder with its own loop wait on the epoll set and call iterate(0) when it is readable.
+    int fd() const { return m_epollFd; }
+
+    void setTimerFiredFunction(void (*)());
+    void setTimerFireInterval(double);
+    void stopTimer();
+
+    // Thread safe.
+    void wakeUp();
+
+private:
+    MainRunLoop();
+
+    void dispatch(const epoll_event&);
+    void timerFired();
+    void wokenUp();
+
+    static void scheduleDispatchFunctions();
+
+    struct FdSource {
+        FdSource() : events(0), callback(0), context(0) { }
+        FdSource(unsigned events, FdSourceCallback callback, void* context) : events(events), callback(callback), context(context) { }
+
+        unsigned events;
+        FdSourceCallback callback;
+        void* context;
+    };
+
+    int m_epollFd;
+    int m_timerFd;
+    int m_wakeUpFd;
+    bool m_stopped;
+    void (*m_timerFiredFunction)();
+    typedef HashMap<int, FdSource, IntHash<unsigned>, WTF::UnsignedWithZeroKeyHashTraits<int> > FdSourceMap;
+    FdSourceMap m_fdSources;
+};
+
+} // namespace WebCore
+
+#endif // MainRunLoop_h
@@ -29,22 +29,23 @@
 #ifndef SharedTimer_h
 #define SharedTimer_h
 
-#include "wtf/Noncopyable.h"
-#include "wtf/Platform.h"
+#include <wtf/FastAllocBase.h>
+#include <wtf/Noncopyable.h>
 
 namespace WebCore {
 
     // Each thread has its own single instance of shared timer, which implements this interface.
     // This instance is shared by all timers in the thread.
     // Not intended to be used directly; use the Timer class instead.
-    class SharedTimer : public Noncopyable {
+    class SharedTimer {
+        WTF_MAKE_NONCOPYABLE(SharedTimer); WTF_MAKE_FAST_ALLOCATED;
     public:
+        SharedTimer() { }
         virtual ~SharedTimer() {}
         virtual void setFiredFunction(void (*)()) = 0;
 
-        // The fire time is relative to the classic POSIX epoch of January 1, 1970,
-        // as the result of currentTime() is.
-        virtual void setFireTime(double) = 0;
+        // The fire interval is in seconds relative to the current monotonic clock time.
+        virtual void setFireInterval(double) = 0;
         virtual void stop() = 0;
     };
 
@@ -52,10 +53,10 @@ namespace WebCore {
     // Implemented by port (since it provides the run loop for the main thread).
     // FIXME: make ports implement MainThreadSharedTimer directly instead.
     void setSharedTimerFiredFunction(void (*)());
-    void setSharedTimerFireTime(double);
+    void setSharedTimerFireInterval(double);
     void stopSharedTimer();
 
-    void setTimerEventCallback(void(*)());
+    // Fires the timers right away, for embedders that drive the main thread themselves.
     void fireTimerIfNeeded();
 
     // Implementation of SharedTimer for the main thread.
@@ -66,9 +67,9 @@ namespace WebCore {
             setSharedTimerFiredFunction(function);
         }
 
-        virtual void setFireTime(double fireTime)
+        virtual void setFireInterval(double interval)
         {
-            setSharedTimerFireTime(fireTime);
+            setSharedTimerFireInterval(interval);
         }
 
         virtual void stop()
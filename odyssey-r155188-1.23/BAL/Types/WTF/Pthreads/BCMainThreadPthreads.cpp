@@ -29,25 +29,54 @@
 #include "config.h"
 #include "MainThread.h"
 
+#include "Threading.h"
+
 namespace WTF {
 
 void (*mainThreadFiredFunction)() = NULL;
 
+// Guards the function and whether a dispatch was requested before the port set it, as
+// callOnMainThread() may be used from any thread while the port is still starting up.
+static Mutex* mainThreadFiredFunctionMutex;
+static bool dispatchRequestedBeforeFiredFunction;
+
 void initializeMainThreadPlatform()
 {
+    mainThreadFiredFunctionMutex = new Mutex;
 }
 
 void setMainThreadFiredFunction(void (*f)())
 {
-    if(!mainThreadFiredFunction)
+    ASSERT(mainThreadFiredFunctionMutex);
+
+    bool dispatchRequested;
+    {
+        MutexLocker locker(*mainThreadFiredFunctionMutex);
+        if (mainThreadFiredFunction)
+            return;
         mainThreadFiredFunction = f;
+        dispatchRequested = dispatchRequestedBeforeFiredFunction;
+        dispatchRequestedBeforeFiredFunction = false;
+    }
+
+    if (dispatchRequested)
+        f();
 }
 
 void scheduleDispatchFunctionsOnMainThread()
 {
-    if (mainThreadFiredFunction)
-        mainThreadFiredFunction();
-}
+    ASSERT(mainThreadFiredFunctionMutex);
+
+    void (*firedFunction)();
+    {
+        MutexLocker locker(*mainThreadFiredFunctionMutex);
+        firedFunction = mainThreadFiredFunction;
+        if (!firedFunction)
+            dispatchRequestedBeforeFiredFunction = true;
+    }
 
+    if (firedFunction)
+        firedFunction();
 }
 
+}
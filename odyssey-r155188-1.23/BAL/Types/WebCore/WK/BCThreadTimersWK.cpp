@@ -32,6 +32,7 @@
 #include "Timer.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/MainThread.h>
+#include <wtf/MathExtras.h>
 
 using namespace std;
 
@@ -55,6 +56,7 @@ ThreadTimers::ThreadTimers()
     : m_sharedTimer(0)
     , m_firingTimers(false)
     , m_pendingSharedTimerFireTime(0)
+    , m_coalescingInterval(0)
 {
     if (isMainThread())
         setSharedTimer(mainThreadSharedTimer());
@@ -78,6 +80,16 @@ void ThreadTimers::setSharedTimer(SharedTimer* sharedTimer)
     }
 }
 
+void ThreadTimers::setCoalescingInterval(double interval)
+{
+    ASSERT(interval >= 0);
+    if (m_coalescingInterval == interval)
+        return;
+    m_coalescingInterval = interval;
+    m_pendingSharedTimerFireTime = 0;
+    updateSharedTimer();
+}
+
 void ThreadTimers::updateSharedTimer()
 {
     if (!m_sharedTimer)
@@ -89,6 +101,11 @@ void ThreadTimers::updateSharedTimer()
     } else {
         double nextFireTime = m_timerHeap.first()->m_nextFireTime;
         double currentMonotonicTime = monotonicallyIncreasingTime();
+        // Wake up at the end of the coalescing window the first timer falls in. Every timer due by
+        // then fires in the same pass of sharedTimerFiredInternal(). Timers that are already due
+        // are not delayed.
+        if (m_coalescingInterval && nextFireTime > currentMonotonicTime)
+            nextFireTime = ceil(nextFireTime / m_coalescingInterval) * m_coalescingInterval;
         if (m_pendingSharedTimerFireTime) {
             // No need to restart the timer if both the pending fire time and the new fire time are in the past.
             if (m_pendingSharedTimerFireTime <= currentMonotonicTime && nextFireTime <= currentMonotonicTime)
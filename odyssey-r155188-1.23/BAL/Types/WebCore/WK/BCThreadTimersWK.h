@@ -50,6 +50,11 @@ namespace WebCore {
         void updateSharedTimer();
         void fireTimersInNestedEventLoop();
 
+        // Timers that come due within the same multiple of this interval (in seconds) share one
+        // wakeup of the shared timer, so none of them fires later than one interval. 0 disables it.
+        void setCoalescingInterval(double);
+        double coalescingInterval() const { return m_coalescingInterval; }
+
     private:
         static void sharedTimerFired();
 
@@ -60,6 +65,7 @@ namespace WebCore {
         SharedTimer* m_sharedTimer; // External object, can be a run loop on a worker thread. Normally set/reset by worker thread.
         bool m_firingTimers; // Reentrancy guard.
         double m_pendingSharedTimerFireTime;
+        double m_coalescingInterval;
     };
 
 }
@@ -38,6 +38,8 @@
 #include "Operations.h"
 #include "SourceProvider.h"
 #include "StackVisitor.h"
+#include <stdio.h>
+#include <wtf/Vector.h>
 #include <wtf/text/StringBuilder.h>
 #include <wtf/text/StringHash.h>
 
@@ -279,4 +281,68 @@ JSStringRef JSContextCreateBacktrace(JSContextRef ctx, unsigned maxStackSize)
     return OpaqueJSString::create(builder.toString()).leakRef();
 }
 
+class HeapSnapshotCallbackStream : public PrintStream {
+public:
+    HeapSnapshotCallbackStream(JSHeapSnapshotWriteCallback callback, void* context)
+        : m_callback(callback)
+        , m_context(context)
+    {
+    }
+
+    ~HeapSnapshotCallbackStream()
+    {
+        flush();
+    }
+
+    void vprintf(const char* format, va_list argList) WTF_ATTRIBUTE_PRINTF(2, 0)
+    {
+        va_list firstPassArgList;
+#if OS(WINDOWS)
+        firstPassArgList = argList;
+#else
+        va_copy(firstPassArgList, argList);
+#endif
+        char line[256];
+        int length = vsnprintf(line, sizeof(line), format, firstPassArgList);
+        if (length < 0)
+            return;
+        if (static_cast<size_t>(length) < sizeof(line))
+            m_buffer.append(line, length);
+        else {
+            Vector<char> longLine(length + 1);
+            vsnprintf(longLine.data(), longLine.size(), format, argList);
+            m_buffer.append(longLine.data(), length);
+        }
+
+        if (m_buffer.size() >= bufferSize)
+            flush();
+    }
+
+    void flush()
+    {
+        if (m_buffer.isEmpty())
+            return;
+        m_callback(m_buffer.data(), m_buffer.size(), m_context);
+        m_buffer.shrink(0);
+    }
+
+private:
+    static const size_t bufferSize = 16 * 1024;
 
+    JSHeapSnapshotWriteCallback m_callback;
+    void* m_context;
+    Vector<char> m_buffer;
+};
+
+bool JSContextWriteHeapSnapshot(JSContextRef ctx, JSHeapSnapshotWriteCallback callback, void* context)
+{
+    if (!ctx || !callback) {
+        ASSERT_NOT_REACHED();
+        return false;
+    }
+    ExecState* exec = toJS(ctx);
+    JSLockHolder lock(exec);
+
+    HeapSnapshotCallbackStream stream(callback, context);
+    return exec->vm().heap.writeHeapSnapshot(stream);
+}
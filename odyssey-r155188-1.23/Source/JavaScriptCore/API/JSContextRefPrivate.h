@@ -103,6 +103,36 @@ JS_EXPORT void JSContextGroupSetExecutionTimeLimit(JSContextGroupRef, double lim
 */
 JS_EXPORT void JSContextGroupClearExecutionTimeLimit(JSContextGroupRef) AVAILABLE_IN_WEBKIT_VERSION_4_0;
 
+/*!
+@typedef JSHeapSnapshotWriteCallback
+@abstract The callback invoked with each piece of a heap snapshot written by
+ JSContextWriteHeapSnapshot.
+@param data The next bytes of the snapshot. They are not null terminated.
+@param length The number of bytes in data.
+@param context User specified context data previously passed to
+ JSContextWriteHeapSnapshot.
+@discussion The callback is invoked while the garbage collector runs, and must not
+ call back into JavaScriptCore.
+*/
+typedef void
+(*JSHeapSnapshotWriteCallback) (const char* data, size_t length, void* context);
+
+/*!
+@function
+@abstract Collects garbage and writes a snapshot of the remaining heap.
+@param ctx The execution context whose context group's heap you want a snapshot of.
+@param callback The callback function that receives the snapshot, a piece at a time.
+@param context User data that you can provide to be passed back to you
+ in your callback.
+@result false if the heap could not be collected, in which case nothing was written.
+@discussion The snapshot is text, one record per line. It lists the live cells with
+ their class, structure and size, the memory each one owns outside of its cell, the
+ references between them and the same sizes summed up per class. It is handed to the
+ callback as it is written, so that taking it does not need memory in proportion to
+ the size of the heap.
+*/
+JS_EXPORT bool JSContextWriteHeapSnapshot(JSContextRef ctx, JSHeapSnapshotWriteCallback callback, void* context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@
 #include "BytecodeGenerator.h"
 #include "ClassInfo.h"
 #include "CodeCache.h"
+#include "CodeCacheStorage.h"
 #include "Executable.h"
 #include "JSString.h"
 #include "Operations.h"
@@ -97,6 +98,27 @@ UnlinkedFunctionExecutable::UnlinkedFunctionExecutable(VM* vm, Structure* struct
     , m_sourceLength(node->source().length())
     , m_features(node->features())
     , m_functionNameIsInScopeToggle(node->functionNameIsInScopeToggle())
+    , m_cachedCodeBlockOffsetForCall(0)
+    , m_cachedCodeBlockOffsetForConstruct(0)
+{
+}
+
+UnlinkedFunctionExecutable::UnlinkedFunctionExecutable(VM* vm, Structure* structure)
+    : Base(*vm, structure)
+    , m_numCapturedVariables(0)
+    , m_forceUsesArguments(false)
+    , m_isInStrictContext(false)
+    , m_hasCapturedVariables(false)
+    , m_firstLineOffset(0)
+    , m_lineCount(0)
+    , m_functionStartOffset(0)
+    , m_functionStartColumn(0)
+    , m_startOffset(0)
+    , m_sourceLength(0)
+    , m_features(0)
+    , m_functionNameIsInScopeToggle(FunctionNameIsNotInScope)
+    , m_cachedCodeBlockOffsetForCall(0)
+    , m_cachedCodeBlockOffsetForConstruct(0)
 {
 }
 
@@ -158,22 +180,34 @@ UnlinkedFunctionCodeBlock* UnlinkedFunctionExecutable::codeBlockFor(VM& vm, cons
         break;
     }
 
-    UnlinkedFunctionCodeBlock* result = generateFunctionCodeBlock(vm, this, source, specializationKind, debuggerMode, profilerMode, error);
-    
-    if (error.m_type != ParserError::ErrorNone)
-        return 0;
+    UnlinkedFunctionCodeBlock* result = 0;
+    if (m_cacheFile && debuggerMode == DebuggerOff && profilerMode == ProfilerOff) {
+        if (CodeCacheStorage* diskCache = vm.codeCache()->diskCache())
+            result = diskCache->loadFunctionCodeBlock(vm, this, specializationKind);
+    }
 
+    if (!result) {
+        result = generateFunctionCodeBlock(vm, this, source, specializationKind, debuggerMode, profilerMode, error);
+        if (error.m_type != ParserError::ErrorNone)
+            return 0;
+    }
+
+    setCodeBlockFor(vm, specializationKind, result);
+    return result;
+}
+
+void UnlinkedFunctionExecutable::setCodeBlockFor(VM& vm, CodeSpecializationKind specializationKind, UnlinkedFunctionCodeBlock* codeBlock)
+{
     switch (specializationKind) {
     case CodeForCall:
-        m_codeBlockForCall.set(vm, this, result);
-        m_symbolTableForCall.set(vm, this, result->symbolTable());
+        m_codeBlockForCall.set(vm, this, codeBlock);
+        m_symbolTableForCall.set(vm, this, codeBlock->symbolTable());
         break;
     case CodeForConstruct:
-        m_codeBlockForConstruct.set(vm, this, result);
-        m_symbolTableForConstruct.set(vm, this, result->symbolTable());
+        m_codeBlockForConstruct.set(vm, this, codeBlock);
+        m_symbolTableForConstruct.set(vm, this, codeBlock->symbolTable());
         break;
     }
-    return result;
 }
 
 String UnlinkedFunctionExecutable::paramString() const
@@ -45,6 +45,7 @@
 
 namespace JSC {
 
+class CodeCacheFile;
 class Debugger;
 class FunctionBodyNode;
 class FunctionExecutable;
@@ -81,6 +82,9 @@ struct ExecutableInfo {
 class UnlinkedFunctionExecutable : public JSCell {
 public:
     friend class CodeCache;
+    friend class CodeCacheDecoder;
+    friend class CodeCacheEncoder;
+    friend class CodeCacheStorage;
     typedef JSCell Base;
     static UnlinkedFunctionExecutable* create(VM* vm, const SourceCode& source, FunctionBodyNode* node)
     {
@@ -143,6 +147,10 @@ public:
 
 private:
     UnlinkedFunctionExecutable(VM*, Structure*, const SourceCode&, FunctionBodyNode*);
+    UnlinkedFunctionExecutable(VM*, Structure*);
+
+    void setCodeBlockFor(VM&, CodeSpecializationKind, UnlinkedFunctionCodeBlock*);
+
     WriteBarrier<UnlinkedFunctionCodeBlock> m_codeBlockForCall;
     WriteBarrier<UnlinkedFunctionCodeBlock> m_codeBlockForConstruct;
 
@@ -168,6 +176,12 @@ private:
 
     FunctionNameIsInScopeToggle m_functionNameIsInScopeToggle;
 
+    // Set when the executable was read from the on-disk code cache, or its program was written
+    // to it. An offset of zero means that code block is not in the file.
+    RefPtr<CodeCacheFile> m_cacheFile;
+    unsigned m_cachedCodeBlockOffsetForCall;
+    unsigned m_cachedCodeBlockOffsetForConstruct;
+
 protected:
     void finishCreation(VM& vm)
     {
@@ -234,6 +248,8 @@ struct UnlinkedInstruction {
 
 class UnlinkedCodeBlock : public JSCell {
 public:
+    friend class CodeCacheDecoder;
+    friend class CodeCacheEncoder;
     typedef JSCell Base;
     static const bool needsDestruction = true;
     static const bool hasImmortalStructure = true;
@@ -569,6 +585,7 @@ protected:
 class UnlinkedProgramCodeBlock : public UnlinkedGlobalCodeBlock {
 private:
     friend class CodeCache;
+    friend class CodeCacheDecoder;
     static UnlinkedProgramCodeBlock* create(VM* vm, const ExecutableInfo& info)
     {
         UnlinkedProgramCodeBlock* instance = new (NotNull, allocateCell<UnlinkedProgramCodeBlock>(vm->heap)) UnlinkedProgramCodeBlock(vm, vm->unlinkedProgramCodeBlockStructure.get(), info);
@@ -0,0 +1,192 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "BackgroundSweeper.h"
+
+#include "MarkedSpace.h"
+#include "Options.h"
+
+namespace JSC {
+
+BackgroundSweeper::BackgroundSweeper()
+    : m_thread(0)
+    , m_threadShouldQuit(false)
+    , m_queueIndex(0)
+    , m_blockBeingSwept(0)
+{
+}
+
+BackgroundSweeper::~BackgroundSweeper()
+{
+    if (m_thread) {
+        {
+            MutexLocker locker(m_lock);
+            m_threadShouldQuit = true;
+            m_condition.broadcast();
+        }
+        waitForThreadCompletion(m_thread);
+    }
+    cancel();
+}
+
+bool BackgroundSweeper::canSweepInBackground(MarkedBlock* block)
+{
+    if (block->destructorType() != MarkedBlock::None)
+        return false;
+    // Large allocations are better returned to the block allocator as soon as they die.
+    if (block->capacity() != MarkedBlock::blockSize)
+        return false;
+    if (!block->needsSweeping())
+        return false;
+    // Finalizing weak handles runs client code, which has to happen on the main thread.
+    return block->weakSet().isEmpty();
+}
+
+void BackgroundSweeper::startSweeping(Vector<MarkedBlock*>& blockSnapshot)
+{
+    ASSERT(m_queueIndex == m_queue.size() && m_pendingBlocks.isEmpty() && m_sweptBlocks.isEmpty());
+
+    // Both options look at the dead cells whose first word the free list overwrites.
+    if (!Options::useBackgroundSweeping() || Options::useZombieMode() || Options::objectsAreImmortal())
+        return;
+
+    MutexLocker locker(m_lock);
+    m_queue.clear();
+    m_queueIndex = 0;
+
+    size_t remainingBlockCount = 0;
+    for (size_t i = 0; i < blockSnapshot.size(); ++i) {
+        MarkedBlock* block = blockSnapshot[i];
+        if (!canSweepInBackground(block)) {
+            blockSnapshot[remainingBlockCount++] = block;
+            continue;
+        }
+        block->setQueuedForBackgroundSweep(true);
+        m_queue.append(block);
+        m_pendingBlocks.add(block);
+    }
+    blockSnapshot.shrink(remainingBlockCount);
+
+    if (m_queue.isEmpty())
+        return;
+
+    if (!m_thread) {
+        m_thread = createThread(threadStartFunc, this, "[OWB] JavaScriptCore::Sweeper");
+        RELEASE_ASSERT(m_thread);
+    }
+    m_condition.broadcast();
+}
+
+bool BackgroundSweeper::takeBlock(MarkedBlock* block, MarkedBlock::FreeList& freeList)
+{
+    ASSERT(block->isQueuedForBackgroundSweep());
+    block->setQueuedForBackgroundSweep(false);
+
+    MutexLocker locker(m_lock);
+    HashSet<MarkedBlock*>::iterator pending = m_pendingBlocks.find(block);
+    if (pending != m_pendingBlocks.end()) {
+        m_pendingBlocks.remove(pending);
+        return false;
+    }
+
+    while (m_blockBeingSwept == block)
+        m_condition.wait(m_lock);
+
+    HashMap<MarkedBlock*, SweptBlock>::iterator swept = m_sweptBlocks.find(block);
+    ASSERT(swept != m_sweptBlocks.end());
+    freeList = swept->value.freeList;
+    m_sweptBlocks.remove(swept);
+    return true;
+}
+
+bool BackgroundSweeper::freeEmptyBlocks(MarkedSpace& objectSpace)
+{
+    Vector<MarkedBlock*> emptyBlocks;
+    bool isDone;
+    {
+        MutexLocker locker(m_lock);
+        HashMap<MarkedBlock*, SweptBlock>::iterator end = m_sweptBlocks.end();
+        for (HashMap<MarkedBlock*, SweptBlock>::iterator it = m_sweptBlocks.begin(); it != end; ++it) {
+            if (it->value.isEmpty)
+                emptyBlocks.append(it->key);
+        }
+        for (size_t i = 0; i < emptyBlocks.size(); ++i) {
+            m_sweptBlocks.remove(emptyBlocks[i]);
+            emptyBlocks[i]->setQueuedForBackgroundSweep(false);
+        }
+        isDone = m_pendingBlocks.isEmpty() && !m_blockBeingSwept;
+    }
+
+    for (size_t i = 0; i < emptyBlocks.size(); ++i)
+        objectSpace.freeOrShrinkBlock(emptyBlocks[i]);
+    return isDone;
+}
+
+void BackgroundSweeper::cancel()
+{
+    MutexLocker locker(m_lock);
+    while (m_blockBeingSwept)
+        m_condition.wait(m_lock);
+
+    HashSet<MarkedBlock*>::iterator pendingEnd = m_pendingBlocks.end();
+    for (HashSet<MarkedBlock*>::iterator it = m_pendingBlocks.begin(); it != pendingEnd; ++it)
+        (*it)->setQueuedForBackgroundSweep(false);
+    HashMap<MarkedBlock*, SweptBlock>::iterator sweptEnd = m_sweptBlocks.end();
+    for (HashMap<MarkedBlock*, SweptBlock>::iterator it = m_sweptBlocks.begin(); it != sweptEnd; ++it)
+        it->key->setQueuedForBackgroundSweep(false);
+
+    m_queue.clear();
+    m_queueIndex = 0;
+    m_pendingBlocks.clear();
+    m_sweptBlocks.clear();
+}
+
+void BackgroundSweeper::threadStartFunc(void* sweeper)
+{
+    static_cast<BackgroundSweeper*>(sweeper)->threadMain();
+}
+
+void BackgroundSweeper::threadMain()
+{
+    m_lock.lock();
+    while (true) {
+        while (!m_threadShouldQuit && m_queueIndex == m_queue.size())
+            m_condition.wait(m_lock);
+        if (m_threadShouldQuit)
+            break;
+
+        MarkedBlock* block = m_queue[m_queueIndex++];
+        HashSet<MarkedBlock*>::iterator pending = m_pendingBlocks.find(block);
+        if (pending == m_pendingBlocks.end())
+            continue;
+        m_pendingBlocks.remove(pending);
+        m_blockBeingSwept = block;
+
+        m_lock.unlock();
+        bool isEmpty;
+        MarkedBlock::FreeList freeList = block->sweepInBackground(isEmpty);
+        m_lock.lock();
+
+        m_blockBeingSwept = 0;
+        m_sweptBlocks.add(block, SweptBlock(freeList, isEmpty));
+        m_condition.broadcast();
+    }
+    m_lock.unlock();
+}
+
+} // namespace JSC
@@ -0,0 +1,98 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BackgroundSweeper_h
+#define BackgroundSweeper_h
+
+#include "MarkedBlock.h"
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+class MarkedSpace;
+
+// Builds the free lists of blocks that hold no cells with destructors on a helper thread,
+// while the mutator runs, so that the allocator only has to pick them up.
+//
+// Such a block only needs its mark bits read and its dead cells linked together, which
+// touches nothing the mutator uses between collections. Blocks with destructors, weak
+// handles or large cells are left to the IncrementalSweeper and the allocator on the main
+// thread. A block the allocator reaches before the helper thread is simply swept by the
+// allocator; the helper thread skips it.
+//
+// All results are dropped before the next collection, which changes the mark bits.
+class BackgroundSweeper {
+    WTF_MAKE_NONCOPYABLE(BackgroundSweeper);
+public:
+    BackgroundSweeper();
+    ~BackgroundSweeper();
+
+    // Takes the blocks that can be swept in the background out of the snapshot.
+    void startSweeping(Vector<MarkedBlock*>& blockSnapshot);
+
+    // Called on the main thread for a block queued by startSweeping(). After this, the
+    // helper thread no longer touches the block. Returns true and the block's free list
+    // if the helper thread has swept it, waiting for it to finish if it is sweeping it
+    // right now; returns false if the caller has to sweep the block itself.
+    bool takeBlock(MarkedBlock*, MarkedBlock::FreeList&);
+
+    // Hands the swept blocks that turned out to be empty back to the MarkedSpace.
+    // Returns false while the helper thread still has blocks to sweep.
+    bool freeEmptyBlocks(MarkedSpace&);
+
+    // Waits for the helper thread to finish the block it is sweeping and drops all others.
+    void cancel();
+
+private:
+    struct SweptBlock {
+        SweptBlock() : isEmpty(false) { }
+        SweptBlock(const MarkedBlock::FreeList& freeList, bool isEmpty)
+            : freeList(freeList)
+            , isEmpty(isEmpty)
+        {
+        }
+
+        MarkedBlock::FreeList freeList;
+        bool isEmpty;
+    };
+
+    static bool canSweepInBackground(MarkedBlock*);
+
+    static void threadStartFunc(void*);
+    void threadMain();
+
+    Mutex m_lock;
+    ThreadCondition m_condition;
+    ThreadIdentifier m_thread;
+    bool m_threadShouldQuit;
+
+    // The queue may still name blocks that have been taken back and freed since; only
+    // blocks that are also in m_pendingBlocks are swept.
+    Vector<MarkedBlock*> m_queue;
+    size_t m_queueIndex;
+    HashSet<MarkedBlock*> m_pendingBlocks;
+    MarkedBlock* m_blockBeingSwept;
+    HashMap<MarkedBlock*, SweptBlock> m_sweptBlocks;
+};
+
+} // namespace JSC
+
+#endif // BackgroundSweeper_h
@@ -259,6 +259,17 @@ void CopiedSpace::doneCopying()
     m_shouldDoCopyPhase = false;
 }
 
+void CopiedSpace::didSkipCopying()
+{
+    ASSERT(!m_inCopyingPhase);
+    ASSERT(m_fromSpace->isEmpty());
+
+    for (CopiedBlock* block = m_toSpace->head(); block; block = block->next())
+        block->didSurviveGC();
+    for (CopiedBlock* block = m_oversizeBlocks.head(); block; block = block->next())
+        block->didSurviveGC();
+}
+
 size_t CopiedSpace::size()
 {
     size_t calculatedSize = 0;
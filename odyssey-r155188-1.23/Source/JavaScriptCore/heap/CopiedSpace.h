@@ -62,6 +62,9 @@ public:
 
     void startedCopying();
     void doneCopying();
+    // Eden collections do not visit old objects, so they cannot tell which blocks are
+    // still in use. They keep every block and only forget what they found out.
+    void didSkipCopying();
     bool isInCopyPhase() { return m_inCopyingPhase; }
 
     void pin(CopiedBlock*);
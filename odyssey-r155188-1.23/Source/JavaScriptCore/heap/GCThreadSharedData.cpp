@@ -50,6 +50,12 @@ size_t GCThreadSharedData::childVisitCount()
         result += m_gcThreads[i]->slotVisitor()->visitCount();
     return result;
 }
+
+void GCThreadSharedData::takeChildUnbarrieredCells(Vector<JSCell*>& cells)
+{
+    for (unsigned i = 0; i < m_gcThreads.size(); ++i)
+        m_gcThreads[i]->slotVisitor()->takeUnbarrieredCells(cells);
+}
 #endif
 
 GCThreadSharedData::GCThreadSharedData(VM* vm)
@@ -66,6 +66,7 @@ public:
     void resetChildren();
     size_t childVisitCount();
     size_t childDupStrings();
+    void takeChildUnbarrieredCells(Vector<JSCell*>&);
 #endif
     
 private:
@@ -30,6 +30,7 @@
 #include "GCActivityCallback.h"
 #include "GCIncomingRefCountedSetInlines.h"
 #include "HeapRootVisitor.h"
+#include "HeapSnapshotBuilder.h"
 #include "HeapStatistics.h"
 #include "IncrementalSweeper.h"
 #include "Interpreter.h"
@@ -248,6 +249,10 @@ Heap::Heap(VM* vm, HeapType heapType)
     , m_ramSize(ramSize())
     , m_minBytesPerCycle(minHeapSize(m_heapType, m_ramSize))
     , m_sizeAfterLastCollect(0)
+    , m_sizeAfterLastFullCollect(0)
+    , m_maxEdenSize(m_minBytesPerCycle)
+    , m_shouldDoFullCollection(false)
+    , m_lastCollectionType(FullCollection)
     , m_bytesAllocatedLimit(m_minBytesPerCycle)
     , m_bytesAllocated(0)
     , m_bytesAbandoned(0)
@@ -256,6 +261,7 @@ Heap::Heap(VM* vm, HeapType heapType)
     , m_objectSpace(this)
     , m_storageSpace(this)
     , m_extraMemoryUsage(0)
+    , m_heapSnapshotBuilder(0)
     , m_machineThreads(this)
     , m_sharedData(vm)
     , m_slotVisitor(m_sharedData)
@@ -319,6 +325,9 @@ void Heap::reportAbandonedObjectGraph()
     // are abandoning so we just guess for them.
     double abandonedBytes = 0.10 * m_sizeAfterLastCollect;
 
+    // The abandoned graph is made of old cells, which only a full collection can free.
+    m_shouldDoFullCollection = true;
+
     // We want to accelerate the next collection. Because memory has just 
     // been abandoned, the next collection has the potential to 
     // be more profitable. Since allocation is the trigger for collection, 
@@ -429,7 +438,38 @@ void Heap::getConservativeRegisterRoots(HashSet<JSCell*>& roots)
     }
 }
 
-void Heap::markRoots()
+void Heap::addToRememberedSet(const JSCell* cell)
+{
+    ASSERT(isMarked(cell));
+    MarkedBlock::blockFor(cell)->setRemembered(cell);
+    m_rememberedSet.append(const_cast<JSCell*>(cell));
+}
+
+void Heap::clearRememberedSet()
+{
+    for (size_t i = 0; i < m_rememberedSet.size(); ++i)
+        MarkedBlock::blockFor(m_rememberedSet[i])->clearRemembered(m_rememberedSet[i]);
+    m_rememberedSet.clear();
+}
+
+void Heap::visitOldCells(SlotVisitor& visitor)
+{
+    for (size_t i = 0; i < m_rememberedSet.size(); ++i)
+        visitor.appendOldCell(m_rememberedSet[i]);
+
+    // Visiting the unbarriered cells records them again, for the next eden collection.
+    Vector<JSCell*> unbarrieredCells;
+    unbarrieredCells.swap(m_unbarrieredCells);
+    for (size_t i = 0; i < unbarrieredCells.size(); ++i) {
+        JSCell* cell = unbarrieredCells[i];
+        if (!MarkedBlock::blockFor(cell)->isRemembered(cell))
+            visitor.appendOldCell(cell);
+    }
+
+    clearRememberedSet();
+}
+
+void Heap::markRoots(CollectionType collectionType)
 {
     SamplingRegion samplingRegion("Garbage Collection: Tracing");
 
@@ -466,9 +506,15 @@ void Heap::markRoots()
     }
 #endif
 
-    {
+    if (collectionType == EdenCollection) {
+        GCPHASE(ClearNewlyAllocated);
+        m_objectSpace.clearNewlyAllocated();
+    } else {
         GCPHASE(clearMarks);
         m_objectSpace.clearMarks();
+        // Every cell is visited, so there is nothing to remember.
+        clearRememberedSet();
+        m_unbarrieredCells.clear();
     }
 
     m_sharedData.didStartMarking();
@@ -481,6 +527,13 @@ void Heap::markRoots()
 
         m_vm->smallStrings.visitStrongReferences(visitor);
 
+        if (collectionType == EdenCollection) {
+            GCPHASE(VisitOldCells);
+            MARK_LOG_ROOT(visitor, "Old Cells");
+            visitOldCells(visitor);
+            visitor.donateAndDrain();
+        }
+
         {
             GCPHASE(VisitMachineRoots);
             MARK_LOG_ROOT(visitor, "C++ Stack");
@@ -581,6 +634,12 @@ void Heap::markRoots()
 
     GCCOUNTER(VisitedValueCount, visitor.visitCount());
 
+    ASSERT(m_unbarrieredCells.isEmpty());
+    visitor.takeUnbarrieredCells(m_unbarrieredCells);
+#if ENABLE(PARALLEL_GC)
+    m_sharedData.takeChildUnbarrieredCells(m_unbarrieredCells);
+#endif
+
     m_sharedData.didFinishMarking();
 #if ENABLE(OBJECT_MARK_LOGGING)
     size_t visitCount = visitor.visitCount();
@@ -597,8 +656,15 @@ void Heap::markRoots()
     m_sharedData.reset();
 }
 
-void Heap::copyBackingStores()
+void Heap::copyBackingStores(CollectionType collectionType)
 {
+    // Old objects were not visited, so nothing is known about the blocks that hold their
+    // backing stores.
+    if (collectionType == EdenCollection) {
+        m_storageSpace.didSkipCopying();
+        return;
+    }
+
     m_storageSpace.startedCopying();
     if (m_storageSpace.shouldDoCopyPhase()) {
         m_sharedData.didStartCopying();
@@ -701,6 +767,20 @@ void Heap::collectAllGarbage()
     collect(DoSweep);
 }
 
+bool Heap::writeHeapSnapshot(PrintStream& out)
+{
+    if (!m_isSafeToCollect)
+        return false;
+
+    HeapSnapshotBuilder builder(out);
+    builder.begin();
+    m_heapSnapshotBuilder = &builder;
+    collect(DoSweep);
+    m_heapSnapshotBuilder = 0;
+    builder.end(m_objectSpace);
+    return true;
+}
+
 static double minute = 60.0;
 
 void Heap::collect(SweepToggle sweepToggle)
@@ -709,9 +789,11 @@ void Heap::collect(SweepToggle sweepToggle)
     dataLogF("JSC GC starting collection.\n");
 #endif
     
+    CollectionType collectionType = collectionTypeFor(sweepToggle);
+
     double before = 0;
     if (Options::logGC()) {
-        dataLog("[GC", sweepToggle == DoSweep ? " (eager sweep)" : "", ": ");
+        dataLog("[GC", collectionType == EdenCollection ? " (eden)" : "", sweepToggle == DoSweep ? " (eager sweep)" : "", ": ");
         before = currentTimeMS();
     }
     
@@ -730,9 +812,12 @@ void Heap::collect(SweepToggle sweepToggle)
     m_deferralDepth--; // Decrement deferal manually, so we don't GC when we do so, since we are already GCing!.
     
     m_operationInProgress = Collection;
-    m_extraMemoryUsage = 0;
+    // Eden collections do not visit most old cells, so the costs those reported are kept.
+    if (collectionType == FullCollection)
+        m_extraMemoryUsage = 0;
 
     m_activityCallback->willCollect();
+    m_sweeper->willCollect();
 
     double lastGCStartTime = WTF::monotonicallyIncreasingTime();
     if (lastGCStartTime - m_lastCodeDiscardTime > minute) {
@@ -745,7 +830,7 @@ void Heap::collect(SweepToggle sweepToggle)
         m_objectSpace.canonicalizeCellLivenessData();
     }
 
-    markRoots();
+    markRoots(collectionType);
     
     {
         GCPHASE(ReapingWeakHandles);
@@ -759,13 +844,7 @@ void Heap::collect(SweepToggle sweepToggle)
         m_arrayBuffers.sweep();
     }
 
-    {
-        m_blockSnapshot.resize(m_objectSpace.blocks().set().size());
-        MarkedBlockSnapshotFunctor functor(m_blockSnapshot);
-        m_objectSpace.forEachBlock(functor);
-    }
-
-    copyBackingStores();
+    copyBackingStores(collectionType);
 
     {
         GCPHASE(FinalizeUnconditionalFinalizers);
@@ -789,6 +868,14 @@ void Heap::collect(SweepToggle sweepToggle)
         m_objectSpace.shrink();
     }
 
+    // Taken after the eager sweep, which frees empty blocks, so the sweepers never see a
+    // block that has gone back to the block allocator.
+    {
+        m_blockSnapshot.resize(m_objectSpace.blocks().set().size());
+        MarkedBlockSnapshotFunctor functor(m_blockSnapshot);
+        m_objectSpace.forEachBlock(functor);
+    }
+
     m_sweeper->startSweeping(m_blockSnapshot);
     m_bytesAbandoned = 0;
 
@@ -801,13 +888,8 @@ void Heap::collect(SweepToggle sweepToggle)
     if (Options::gcMaxHeapSize() && currentHeapSize > Options::gcMaxHeapSize())
         HeapStatistics::exitWithFailure();
 
-    m_sizeAfterLastCollect = currentHeapSize;
-
-    // To avoid pathological GC churn in very small and very large heaps, we set
-    // the new allocation limit based on the current size of the heap, with a
-    // fixed minimum.
-    size_t maxHeapSize = max(minHeapSize(m_heapType, m_ramSize), proportionalHeapSize(currentHeapSize, m_ramSize));
-    m_bytesAllocatedLimit = maxHeapSize - currentHeapSize;
+    updateAllocationLimits(collectionType, currentHeapSize);
+    m_lastCollectionType = collectionType;
 
     m_bytesAllocated = 0;
     double lastGCEndTime = WTF::monotonicallyIncreasingTime();
@@ -839,6 +921,37 @@ void Heap::collect(SweepToggle sweepToggle)
 #endif
 }
 
+CollectionType Heap::collectionTypeFor(SweepToggle sweepToggle)
+{
+    if (!isGenerationalCollectionEnabled())
+        return FullCollection;
+    // Eager sweeps are requested when memory is to be given back, which old garbage is part of.
+    if (sweepToggle == DoSweep || m_shouldDoFullCollection)
+        return FullCollection;
+    return EdenCollection;
+}
+
+void Heap::updateAllocationLimits(CollectionType collectionType, size_t currentHeapSize)
+{
+    if (collectionType == FullCollection) {
+        // To avoid pathological GC churn in very small and very large heaps, we set
+        // the new allocation limit based on the current size of the heap, with a
+        // fixed minimum.
+        size_t maxHeapSize = max(minHeapSize(m_heapType, m_ramSize), proportionalHeapSize(currentHeapSize, m_ramSize));
+        m_maxEdenSize = maxHeapSize - currentHeapSize;
+        m_sizeAfterLastFullCollect = currentHeapSize;
+        m_shouldDoFullCollection = false;
+    } else if (currentHeapSize - min(currentHeapSize, m_sizeAfterLastFullCollect) >= m_maxEdenSize) {
+        // Eden collections all get the room the last full collection left. Once the cells
+        // they let survive could have filled that room, the old cells are due to be
+        // collected too.
+        m_shouldDoFullCollection = true;
+    }
+
+    m_sizeAfterLastCollect = currentHeapSize;
+    m_bytesAllocatedLimit = m_maxEdenSize;
+}
+
 bool Heap::collectIfNecessaryOrDefer()
 {
     if (m_deferralDepth)
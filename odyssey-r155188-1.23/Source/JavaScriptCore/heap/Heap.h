@@ -41,6 +41,7 @@
 #include "WriteBarrierSupport.h"
 #include <wtf/HashCountedSet.h>
 #include <wtf/HashSet.h>
+#include <wtf/PrintStream.h>
 
 #define COLLECT_ON_EVERY_ALLOCATION 0
 
@@ -54,6 +55,7 @@ namespace JSC {
     class GlobalCodeBlock;
     class Heap;
     class HeapRootVisitor;
+    class HeapSnapshotBuilder;
     class IncrementalSweeper;
     class JITStubRoutine;
     class JSCell;
@@ -72,6 +74,11 @@ namespace JSC {
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
 
+    // An eden collection only marks the cells allocated since the last collection. Cells
+    // that survived an earlier one keep their mark bits, and the old cells that may point
+    // to young ones are visited again from the remembered set.
+    enum CollectionType { EdenCollection, FullCollection };
+
     enum HeapType { SmallHeap, LargeHeap };
 
     class Heap {
@@ -94,6 +101,7 @@ namespace JSC {
         static void setMarked(const void*);
 
         static bool isWriteBarrierEnabled();
+        static bool isGenerationalCollectionEnabled();
         static void writeBarrier(const JSCell*, JSValue);
         static void writeBarrier(const JSCell*, JSCell*);
         static uint8_t* addressOfCardFor(JSCell*);
@@ -133,7 +141,11 @@ namespace JSC {
         bool isSafeToCollect() const { return m_isSafeToCollect; }
 
         JS_EXPORT_PRIVATE void collectAllGarbage();
+        // Collects all garbage and writes a snapshot of what is left, as described in
+        // HeapSnapshotBuilder.h. Returns false if the heap cannot be collected right now.
+        JS_EXPORT_PRIVATE bool writeHeapSnapshot(PrintStream&);
         enum SweepToggle { DoNotSweep, DoSweep };
+        CollectionType lastCollectionType() const { return m_lastCollectionType; }
         bool shouldCollect();
         void collect(SweepToggle);
         bool collectIfNecessaryOrDefer(); // Returns true if it did collect.
@@ -224,10 +236,16 @@ namespace JSC {
         JS_EXPORT_PRIVATE bool isValidAllocation(size_t);
         JS_EXPORT_PRIVATE void reportExtraMemoryCostSlowCase(size_t);
 
-        void markRoots();
+        CollectionType collectionTypeFor(SweepToggle);
+        void addToRememberedSet(const JSCell*);
+        void clearRememberedSet();
+        void visitOldCells(SlotVisitor&);
+        void updateAllocationLimits(CollectionType, size_t currentHeapSize);
+
+        void markRoots(CollectionType);
         void markProtectedObjects(HeapRootVisitor&);
         void markTempSortVectors(HeapRootVisitor&);
-	void copyBackingStores();
+	void copyBackingStores(CollectionType);
         void harvestWeakReferences();
         void finalizeUnconditionalFinalizers();
         void deleteUnmarkedCompiledCode();
@@ -245,6 +263,11 @@ namespace JSC {
         const size_t m_ramSize;
         const size_t m_minBytesPerCycle;
         size_t m_sizeAfterLastCollect;
+        size_t m_sizeAfterLastFullCollect;
+        // How much may be allocated between two collections.
+        size_t m_maxEdenSize;
+        bool m_shouldDoFullCollection;
+        CollectionType m_lastCollectionType;
 
         size_t m_bytesAllocatedLimit;
         size_t m_bytesAllocated;
@@ -257,6 +280,13 @@ namespace JSC {
         GCIncomingRefCountedSet<ArrayBuffer> m_arrayBuffers;
         size_t m_extraMemoryUsage;
 
+        // Old cells that were stored a reference to a young cell since the last collection.
+        Vector<JSCell*> m_rememberedSet;
+        // Old cells whose classes may store references without a write barrier.
+        Vector<JSCell*> m_unbarrieredCells;
+
+        HeapSnapshotBuilder* m_heapSnapshotBuilder;
+
 #if ENABLE(SIMPLE_HEAP_PROFILING)
         VTableSpectrum m_destroyedTypeCounts;
 #endif
@@ -365,14 +395,38 @@ namespace JSC {
 #endif
     }
 
-    inline void Heap::writeBarrier(const JSCell*, JSCell*)
+    inline bool Heap::isGenerationalCollectionEnabled()
     {
-        WriteBarrierCounters::countWriteBarrier();
+#if ENABLE(JIT)
+        // Only the interpreter's fast paths have write barriers.
+        return false;
+#else
+        // Both options look at cells that an eden collection would leave marked.
+        return Options::useGenerationalGC() && !Options::useZombieMode() && !Options::objectsAreImmortal();
+#endif
     }
 
-    inline void Heap::writeBarrier(const JSCell*, JSValue)
+    inline void Heap::writeBarrier(const JSCell* owner, JSCell* cell)
     {
         WriteBarrierCounters::countWriteBarrier();
+        if (!owner || !cell || !isGenerationalCollectionEnabled())
+            return;
+        // Outside of a collection, a cell is marked if and only if it survived the last one.
+        if (!isMarked(owner) || isMarked(cell))
+            return;
+        MarkedBlock* block = MarkedBlock::blockFor(owner);
+        if (block->isRemembered(owner))
+            return;
+        block->heap()->addToRememberedSet(owner);
+    }
+
+    inline void Heap::writeBarrier(const JSCell* owner, JSValue value)
+    {
+        if (!value.isCell()) {
+            WriteBarrierCounters::countWriteBarrier();
+            return;
+        }
+        writeBarrier(owner, value.asCell());
     }
 
     inline void Heap::reportExtraMemoryCost(size_t cost)
@@ -0,0 +1,114 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "HeapSnapshotBuilder.h"
+
+#include "JSCell.h"
+#include "MarkedSpace.h"
+#include "Operations.h"
+#include <wtf/text/CString.h>
+#include <wtf/text/StringHash.h>
+
+namespace JSC {
+
+class HeapSnapshotBuilder::TypeStatisticsFunctor : public MarkedBlock::VoidFunctor {
+public:
+    TypeStatisticsFunctor(TypeStatisticsMap& typeStatistics)
+        : m_typeStatistics(typeStatistics)
+    {
+    }
+
+    void operator()(JSCell* cell)
+    {
+        TypeStatistics& statistics = m_typeStatistics.add(cell->classInfo(), TypeStatistics()).iterator->value;
+        statistics.count++;
+        statistics.cellBytes += MarkedBlock::blockFor(cell)->cellSize();
+    }
+
+private:
+    TypeStatisticsMap& m_typeStatistics;
+};
+
+HeapSnapshotBuilder::HeapSnapshotBuilder(PrintStream& out)
+    : m_out(out)
+{
+}
+
+void HeapSnapshotBuilder::begin()
+{
+    m_out.printf("JSCHeapSnapshot 1\n");
+}
+
+void HeapSnapshotBuilder::appendRoot(JSCell* cell)
+{
+    MutexLocker locker(m_lock);
+    m_out.printf("R %p\n", cell);
+}
+
+void HeapSnapshotBuilder::appendEdge(JSCell* from, JSCell* to)
+{
+    MutexLocker locker(m_lock);
+    m_out.printf("E %p %p\n", from, to);
+}
+
+void HeapSnapshotBuilder::appendNode(JSCell* cell, size_t copiedBytes, size_t extraBytes)
+{
+    const ClassInfo* classInfo = cell->classInfo();
+    size_t cellSize = MarkedBlock::blockFor(cell)->cellSize();
+
+    MutexLocker locker(m_lock);
+    m_out.printf("N %p %s %p %lu %lu %lu\n", cell, classInfo->className, cell->structure(),
+        static_cast<unsigned long>(cellSize), static_cast<unsigned long>(copiedBytes), static_cast<unsigned long>(extraBytes));
+    if (copiedBytes || extraBytes) {
+        TypeStatistics& statistics = m_typeStatistics.add(classInfo, TypeStatistics()).iterator->value;
+        statistics.copiedBytes += copiedBytes;
+        statistics.extraBytes += extraBytes;
+    }
+}
+
+void HeapSnapshotBuilder::end(MarkedSpace& objectSpace)
+{
+    TypeStatisticsFunctor functor(m_typeStatistics);
+    objectSpace.forEachLiveCell(functor);
+
+    // Several classes share a name (all the constructors are "Function"), and the N lines
+    // only carry the name, so the summary is per name rather than per ClassInfo.
+    HashMap<String, TypeStatistics> statisticsByName;
+    TypeStatisticsMap::iterator end = m_typeStatistics.end();
+    for (TypeStatisticsMap::iterator it = m_typeStatistics.begin(); it != end; ++it) {
+        TypeStatistics& statistics = statisticsByName.add(String(it->key->className), TypeStatistics()).iterator->value;
+        statistics.count += it->value.count;
+        statistics.cellBytes += it->value.cellBytes;
+        statistics.copiedBytes += it->value.copiedBytes;
+        statistics.extraBytes += it->value.extraBytes;
+    }
+    m_typeStatistics.clear();
+
+    HashMap<String, TypeStatistics>::iterator namesEnd = statisticsByName.end();
+    for (HashMap<String, TypeStatistics>::iterator it = statisticsByName.begin(); it != namesEnd; ++it) {
+        const TypeStatistics& statistics = it->value;
+        m_out.printf("T %s %lu %lu %lu %lu\n", it->key.utf8().data(),
+            static_cast<unsigned long>(statistics.count), static_cast<unsigned long>(statistics.cellBytes),
+            static_cast<unsigned long>(statistics.copiedBytes), static_cast<unsigned long>(statistics.extraBytes));
+    }
+
+    m_out.printf("End\n");
+    m_out.flush();
+}
+
+} // namespace JSC
@@ -0,0 +1,86 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef HeapSnapshotBuilder_h
+#define HeapSnapshotBuilder_h
+
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PrintStream.h>
+#include <wtf/Threading.h>
+
+namespace JSC {
+
+class JSCell;
+class MarkedSpace;
+struct ClassInfo;
+
+// Writes a heap snapshot while the SlotVisitors mark during a full collection, so that
+// nothing proportional to the size of the heap is kept in memory. The output is text,
+// one record per line, in no particular order except for the first and the last lines:
+//
+//   JSCHeapSnapshot 1
+//   R <cell>                       a cell reached from a root
+//   E <from> <to>                  a reference from one live cell to another
+//   N <cell> <class> <structure> <cell size> <copied bytes> <extra bytes>
+//   T <class> <count> <cell bytes> <copied bytes> <extra bytes>
+//   End
+//
+// Copied bytes are what the cell owns in the copied space (the butterfly of an object,
+// the vector of a typed array), extra bytes what it reports as allocated outside of the
+// heap (the characters of a string). The T lines sum the N lines up per class name. The
+// output stream is written to during the collection and must not run JavaScript.
+class HeapSnapshotBuilder {
+    WTF_MAKE_NONCOPYABLE(HeapSnapshotBuilder);
+public:
+    HeapSnapshotBuilder(PrintStream&);
+
+    void begin();
+    // Called by the SlotVisitors, possibly from several GC threads.
+    void appendRoot(JSCell*);
+    void appendEdge(JSCell* from, JSCell* to);
+    void appendNode(JSCell*, size_t copiedBytes, size_t extraBytes);
+    // Called after the collection, once the live cells are known.
+    void end(MarkedSpace&);
+
+private:
+    struct TypeStatistics {
+        TypeStatistics()
+            : count(0)
+            , cellBytes(0)
+            , copiedBytes(0)
+            , extraBytes(0)
+        {
+        }
+
+        size_t count;
+        size_t cellBytes;
+        size_t copiedBytes;
+        size_t extraBytes;
+    };
+    typedef HashMap<const ClassInfo*, TypeStatistics> TypeStatisticsMap;
+
+    class TypeStatisticsFunctor;
+
+    PrintStream& m_out;
+    Mutex m_lock;
+    TypeStatisticsMap m_typeStatistics;
+};
+
+} // namespace JSC
+
+#endif // HeapSnapshotBuilder_h
@@ -126,6 +126,12 @@ void IncrementalSweeper::doSweep(double sweepBeginTime)
     }
 
     m_blocksToSweep.clear();
+
+    // Keep coming back until the empty blocks found by the background sweeper are freed.
+    if (!m_backgroundSweeper.freeEmptyBlocks(m_vm->heap.objectSpace())) {
+        scheduleTimer();
+        return;
+    }
     cancelTimer();
 }
 
@@ -146,6 +152,7 @@ void IncrementalSweeper::sweepNextBlock()
 
 void IncrementalSweeper::startSweeping(Vector<MarkedBlock*>& blockSnapshot)
 {
+    m_backgroundSweeper.startSweeping(blockSnapshot);
     m_blocksToSweep = blockSnapshot;
     m_currentBlockToSweepIndex = 0;
     scheduleTimer();
@@ -153,6 +160,7 @@ void IncrementalSweeper::startSweeping(Vector<MarkedBlock*>& blockSnapshot)
 
 void IncrementalSweeper::willFinishSweeping()
 {
+    m_backgroundSweeper.cancel();
     m_currentBlockToSweepIndex = 0;
     m_blocksToSweep.clear();
     if (m_vm)
@@ -175,12 +183,15 @@ PassOwnPtr<IncrementalSweeper> IncrementalSweeper::create(Heap* heap)
     return adoptPtr(new IncrementalSweeper(heap->vm()));
 }
 
-void IncrementalSweeper::startSweeping(Vector<MarkedBlock*>&)
+void IncrementalSweeper::startSweeping(Vector<MarkedBlock*>& blockSnapshot)
 {
+    // Without a timer the allocator sweeps the remaining blocks as it needs them.
+    m_backgroundSweeper.startSweeping(blockSnapshot);
 }
 
 void IncrementalSweeper::willFinishSweeping()
 {
+    m_backgroundSweeper.cancel();
 }
 
 void IncrementalSweeper::sweepNextBlock()
@@ -189,4 +200,10 @@ void IncrementalSweeper::sweepNextBlock()
 
 #endif
 
+void IncrementalSweeper::willCollect()
+{
+    // The collection is about to change the mark bits the free lists were built from.
+    m_backgroundSweeper.cancel();
+}
+
 } // namespace JSC
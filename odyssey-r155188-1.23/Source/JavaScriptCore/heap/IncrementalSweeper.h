@@ -26,6 +26,7 @@
 #ifndef IncrementalSweeper_h
 #define IncrementalSweeper_h
 
+#include "BackgroundSweeper.h"
 #include "HeapTimer.h"
 #include "MarkedBlock.h"
 #include <wtf/HashSet.h>
@@ -44,8 +45,13 @@ public:
     virtual void doWork();
     void sweepNextBlock();
     void willFinishSweeping();
+    void willCollect();
+
+    BackgroundSweeper& backgroundSweeper() { return m_backgroundSweeper; }
 
 private:
+    BackgroundSweeper m_backgroundSweeper;
+
 #if USE(CF) || PLATFORM(BLACKBERRY) || PLATFORM(QT) || OS(MORPHOS)
 #if USE(CF)
     IncrementalSweeper(Heap*, CFRunLoopRef);
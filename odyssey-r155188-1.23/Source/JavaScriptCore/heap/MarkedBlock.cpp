@@ -47,6 +47,7 @@ MarkedBlock::MarkedBlock(Region* region, MarkedAllocator* allocator, size_t cell
     , m_destructorType(destructorType)
     , m_allocator(allocator)
     , m_state(New) // All cells start out unmarked.
+    , m_isQueuedForBackgroundSweep(false)
     , m_weakSet(allocator->heap()->vm())
 {
     ASSERT(allocator);
@@ -108,6 +109,19 @@ MarkedBlock::FreeList MarkedBlock::sweep(SweepMode sweepMode)
 {
     HEAP_LOG_BLOCK_STATE_TRANSITION(this);
 
+    if (m_isQueuedForBackgroundSweep) {
+        FreeList freeList;
+        if (heap()->sweeper()->backgroundSweeper().takeBlock(this, freeList)) {
+            ASSERT(m_state == Marked && m_destructorType == MarkedBlock::None);
+            m_weakSet.sweep();
+            if (sweepMode == SweepOnly)
+                return FreeList();
+            m_newlyAllocated.clear();
+            m_state = FreeListed;
+            return freeList;
+        }
+    }
+
     m_weakSet.sweep();
 
     if (sweepMode == SweepOnly && m_destructorType == MarkedBlock::None)
@@ -120,6 +134,27 @@ MarkedBlock::FreeList MarkedBlock::sweep(SweepMode sweepMode)
     return sweepHelper<MarkedBlock::None>(sweepMode);
 }
 
+MarkedBlock::FreeList MarkedBlock::sweepInBackground(bool& isEmpty)
+{
+    ASSERT(m_state == Marked && m_destructorType == MarkedBlock::None);
+
+    FreeCell* head = 0;
+    size_t count = 0;
+    isEmpty = true;
+    for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
+        if (m_marks.get(i) || (m_newlyAllocated && m_newlyAllocated->get(i))) {
+            isEmpty = false;
+            continue;
+        }
+
+        FreeCell* freeCell = reinterpret_cast<FreeCell*>(&atoms()[i]);
+        freeCell->next = head;
+        head = freeCell;
+        ++count;
+    }
+    return FreeList(head, count * cellSize());
+}
+
 template<MarkedBlock::DestructorType dtorType>
 MarkedBlock::FreeList MarkedBlock::sweepHelper(SweepMode sweepMode)
 {
@@ -52,6 +52,7 @@ namespace JSC {
     
     class Heap;
     class JSCell;
+    class LLIntOffsetsExtractor;
     class MarkedAllocator;
 
     typedef uintptr_t Bits;
@@ -69,6 +70,8 @@ namespace JSC {
     // size.
 
     class MarkedBlock : public HeapBlock<MarkedBlock> {
+        friend class LLIntOffsetsExtractor;
+
     public:
         static const size_t atomSize = 8; // bytes
 #if OS(MORPHOS1)
@@ -127,6 +130,13 @@ namespace JSC {
         enum SweepMode { SweepOnly, SweepToFreeList };
         FreeList sweep(SweepMode = SweepOnly);
 
+        // Builds the free list of a Marked block without destructors, leaving its state
+        // alone. Only reads the mark bits, so it may run on the BackgroundSweeper's thread;
+        // sweep() adopts the free list on the main thread.
+        FreeList sweepInBackground(bool& isEmpty);
+        bool isQueuedForBackgroundSweep() const { return m_isQueuedForBackgroundSweep; }
+        void setQueuedForBackgroundSweep(bool queued) { m_isQueuedForBackgroundSweep = queued; }
+
         void shrink();
 
         void visitWeakSet(HeapRootVisitor&);
@@ -139,6 +149,9 @@ namespace JSC {
         void canonicalizeCellLivenessData(const FreeList&);
 
         void clearMarks();
+        // Eden collections keep the marks of the cells that survived earlier collections;
+        // only the cells allocated since the last collection start out unmarked.
+        void clearNewlyAllocated();
         size_t markCount();
         bool isEmpty();
 
@@ -159,6 +172,11 @@ namespace JSC {
         void setNewlyAllocated(const void*);
         void clearNewlyAllocated(const void*);
 
+        // Set on old cells that the write barrier has added to the Heap's remembered set.
+        bool isRemembered(const void*);
+        void setRemembered(const void*);
+        void clearRemembered(const void*);
+
         bool needsSweeping();
 
         template <typename Functor> void forEachCell(Functor&);
@@ -187,10 +205,13 @@ namespace JSC {
         WTF::Bitmap<atomsPerBlock, WTF::BitmapNotAtomic> m_marks;
 #endif
         OwnPtr<WTF::Bitmap<atomsPerBlock> > m_newlyAllocated;
+        OwnPtr<WTF::Bitmap<atomsPerBlock> > m_remembered;
 
         DestructorType m_destructorType;
         MarkedAllocator* m_allocator;
         BlockState m_state;
+        // Only read and written on the main thread.
+        bool m_isQueuedForBackgroundSweep;
         WeakSet m_weakSet;
     };
 
@@ -290,6 +311,15 @@ namespace JSC {
         m_state = Marked;
     }
 
+    inline void MarkedBlock::clearNewlyAllocated()
+    {
+        HEAP_LOG_BLOCK_STATE_TRANSITION(this);
+
+        ASSERT(m_state != New && m_state != FreeListed);
+        m_newlyAllocated.clear();
+        m_state = Marked;
+    }
+
     inline size_t MarkedBlock::markCount()
     {
         return m_marks.count();
@@ -361,6 +391,23 @@ namespace JSC {
         m_newlyAllocated->clear(atomNumber(p));
     }
 
+    inline bool MarkedBlock::isRemembered(const void* p)
+    {
+        return m_remembered && m_remembered->get(atomNumber(p));
+    }
+
+    inline void MarkedBlock::setRemembered(const void* p)
+    {
+        if (!m_remembered)
+            m_remembered = adoptPtr(new WTF::Bitmap<atomsPerBlock>());
+        m_remembered->set(atomNumber(p));
+    }
+
+    inline void MarkedBlock::clearRemembered(const void* p)
+    {
+        m_remembered->clear(atomNumber(p));
+    }
+
     inline bool MarkedBlock::isLive(const JSCell* cell)
     {
         switch (m_state) {
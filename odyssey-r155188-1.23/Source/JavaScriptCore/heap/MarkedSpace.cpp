@@ -109,6 +109,7 @@ struct LastChanceToFinalize : MarkedBlock::VoidFunctor {
 
 void MarkedSpace::lastChanceToFinalize()
 {
+    m_heap->sweeper()->willFinishSweeping();
     canonicalizeCellLivenessData();
     forEachBlock<LastChanceToFinalize>();
 }
@@ -194,6 +195,7 @@ bool MarkedSpace::isPagedOut(double deadline)
 
 void MarkedSpace::freeBlock(MarkedBlock* block)
 {
+    ASSERT(!block->isQueuedForBackgroundSweep());
     block->allocator()->removeBlock(block);
     m_blocks.remove(block);
     if (block->capacity() == MarkedBlock::blockSize) {
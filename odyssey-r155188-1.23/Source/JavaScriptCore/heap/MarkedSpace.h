@@ -47,6 +47,10 @@ struct ClearMarks : MarkedBlock::VoidFunctor {
     void operator()(MarkedBlock* block) { block->clearMarks(); }
 };
 
+struct ClearNewlyAllocated : MarkedBlock::VoidFunctor {
+    void operator()(MarkedBlock* block) { block->clearNewlyAllocated(); }
+};
+
 struct Sweep : MarkedBlock::VoidFunctor {
     void operator()(MarkedBlock* block) { block->sweep(); }
 };
@@ -104,6 +108,7 @@ public:
     void didConsumeFreeList(MarkedBlock*);
 
     void clearMarks();
+    void clearNewlyAllocated();
     void sweep();
     size_t objectCount();
     size_t size();
@@ -252,6 +257,11 @@ inline void MarkedSpace::clearMarks()
     forEachBlock<ClearMarks>();
 }
 
+inline void MarkedSpace::clearNewlyAllocated()
+{
+    forEachBlock<ClearNewlyAllocated>();
+}
+
 inline size_t MarkedSpace::objectCount()
 {
     return forEachBlock<MarkCount>();
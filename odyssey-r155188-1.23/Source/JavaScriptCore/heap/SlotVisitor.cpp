@@ -6,6 +6,7 @@
 #include "CopiedSpace.h"
 #include "CopiedSpaceInlines.h"
 #include "GCThread.h"
+#include "HeapSnapshotBuilder.h"
 #include "JSArray.h"
 #include "JSDestructibleObject.h"
 #include "VM.h"
@@ -22,6 +23,12 @@ SlotVisitor::SlotVisitor(GCThreadSharedData& shared)
     , m_isInParallelMode(false)
     , m_shared(shared)
     , m_shouldHashCons(false)
+    , m_shouldRememberUnbarrieredCells(false)
+    , m_cellBeingVisited(0)
+    , m_heapSnapshotBuilder(0)
+    , m_currentCell(0)
+    , m_currentCellCopiedBytes(0)
+    , m_currentCellExtraBytes(0)
 #if !ASSERT_DISABLED
     , m_isCheckingForDefaultMarkViolation(false)
     , m_isDraining(false)
@@ -38,9 +45,14 @@ void SlotVisitor::setup()
 {
     m_shared.m_shouldHashCons = m_shared.m_vm->haveEnoughNewStringsToHashCons();
     m_shouldHashCons = m_shared.m_shouldHashCons;
+    m_shouldRememberUnbarrieredCells = Heap::isGenerationalCollectionEnabled();
+    m_heapSnapshotBuilder = m_shared.m_vm->heap.m_heapSnapshotBuilder;
 #if ENABLE(PARALLEL_GC)
-    for (unsigned i = 0; i < m_shared.m_gcThreads.size(); ++i)
+    for (unsigned i = 0; i < m_shared.m_gcThreads.size(); ++i) {
         m_shared.m_gcThreads[i]->slotVisitor()->m_shouldHashCons = m_shared.m_shouldHashCons;
+        m_shared.m_gcThreads[i]->slotVisitor()->m_shouldRememberUnbarrieredCells = m_shouldRememberUnbarrieredCells;
+        m_shared.m_gcThreads[i]->slotVisitor()->m_heapSnapshotBuilder = m_heapSnapshotBuilder;
+    }
 #endif
 }
 
@@ -57,6 +69,19 @@ void SlotVisitor::reset()
         m_uniqueStrings.clear();
         m_shouldHashCons = false;
     }
+    ASSERT(m_unbarrieredCells.isEmpty()); // Should have been taken by now.
+    m_shouldRememberUnbarrieredCells = false;
+    m_heapSnapshotBuilder = 0;
+}
+
+void SlotVisitor::takeUnbarrieredCells(Vector<JSCell*>& cells)
+{
+    if (cells.isEmpty()) {
+        cells.swap(m_unbarrieredCells);
+        return;
+    }
+    cells.appendVector(m_unbarrieredCells);
+    m_unbarrieredCells.clear();
 }
 
 void SlotVisitor::append(ConservativeRoots& conservativeRoots)
@@ -68,9 +93,8 @@ void SlotVisitor::append(ConservativeRoots& conservativeRoots)
         internalAppend(0, roots[i]);
 }
 
-ALWAYS_INLINE static void visitChildren(SlotVisitor& visitor, const JSCell* cell)
+ALWAYS_INLINE static void visitCellChildren(SlotVisitor& visitor, const JSCell* cell)
 {
-    StackStats::probe();
 #if ENABLE(SIMPLE_HEAP_PROFILING)
     m_visitedTypeCounts.count(cell);
 #endif
@@ -92,7 +116,40 @@ ALWAYS_INLINE static void visitChildren(SlotVisitor& visitor, const JSCell* cell
         return;
     }
 
+    visitor.setCellBeingVisited(const_cast<JSCell*>(cell));
     cell->methodTable()->visitChildren(const_cast<JSCell*>(cell), visitor);
+    visitor.setCellBeingVisited(0);
+}
+
+void SlotVisitor::visitChildrenForHeapSnapshot(const JSCell* cell)
+{
+    ASSERT(!m_currentCell);
+    m_currentCell = const_cast<JSCell*>(cell);
+    m_currentCellCopiedBytes = 0;
+    m_currentCellExtraBytes = 0;
+
+    visitCellChildren(*this, cell);
+
+    m_heapSnapshotBuilder->appendNode(m_currentCell, m_currentCellCopiedBytes, m_currentCellExtraBytes);
+    m_currentCell = 0;
+}
+
+void SlotVisitor::appendToHeapSnapshot(JSCell* cell)
+{
+    if (m_currentCell)
+        m_heapSnapshotBuilder->appendEdge(m_currentCell, cell);
+    else
+        m_heapSnapshotBuilder->appendRoot(cell);
+}
+
+ALWAYS_INLINE static void visitChildren(SlotVisitor& visitor, const JSCell* cell)
+{
+    StackStats::probe();
+    if (UNLIKELY(visitor.isBuildingHeapSnapshot())) {
+        visitor.visitChildrenForHeapSnapshot(cell);
+        return;
+    }
+    visitCellChildren(visitor, cell);
 }
 
 void SlotVisitor::donateKnownParallel()
@@ -37,6 +37,7 @@ namespace JSC {
 class ConservativeRoots;
 class GCThreadSharedData;
 class Heap;
+class HeapSnapshotBuilder;
 template<typename T> class Weak;
 template<typename T> class WriteBarrierBase;
 template<typename T> class JITWriteBarrier;
@@ -61,6 +62,18 @@ public:
     template<typename T>
     void appendUnbarrieredWeak(Weak<T>*);
     
+    // Visits the children of a cell that an earlier collection already marked, as eden
+    // collections do for old cells that may point to young ones.
+    void appendOldCell(JSCell*);
+
+    // Cells of classes that store references without a write barrier are remembered while
+    // they are visited, so that eden collections can visit them again. So are cells that
+    // append an unbarriered pointer, value or Weak, and cells that add opaque roots, since
+    // every collection builds the opaque root set anew.
+    void rememberUnbarrieredCell(JSCell*);
+    void takeUnbarrieredCells(Vector<JSCell*>&);
+    void setCellBeingVisited(JSCell* cell) { m_cellBeingVisited = cell; }
+
     void addOpaqueRoot(void*);
     bool containsOpaqueRoot(void*);
     TriState containsOpaqueRootTriState(void*);
@@ -87,6 +100,9 @@ public:
     void copyLater(JSCell*, CopyToken, void*, size_t);
     
     void reportExtraMemoryUsage(size_t size);
+
+    bool isBuildingHeapSnapshot() const { return m_heapSnapshotBuilder; }
+    void visitChildrenForHeapSnapshot(const JSCell*);
     
 #if ENABLE(SIMPLE_HEAP_PROFILING)
     VTableSpectrum m_visitedTypeCounts;
@@ -113,6 +129,8 @@ private:
     void internalAppend(void* from, JSCell*);
     void internalAppend(void* from, JSValue);
     void internalAppend(void* from, JSValue*);
+
+    void rememberCellBeingVisited();
     
     JS_EXPORT_PRIVATE void mergeOpaqueRoots();
     void mergeOpaqueRootsIfNecessary();
@@ -120,6 +138,8 @@ private:
     
     void donateKnownParallel();
 
+    void appendToHeapSnapshot(JSCell*);
+
     MarkStackArray m_stack;
     HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
     
@@ -129,6 +149,16 @@ private:
     GCThreadSharedData& m_shared;
 
     bool m_shouldHashCons; // Local per-thread copy of shared flag for performance reasons
+    bool m_shouldRememberUnbarrieredCells;
+    Vector<JSCell*> m_unbarrieredCells;
+    JSCell* m_cellBeingVisited;
+
+    // Only maintained while a collection takes a heap snapshot.
+    HeapSnapshotBuilder* m_heapSnapshotBuilder;
+    JSCell* m_currentCell;
+    size_t m_currentCellCopiedBytes;
+    size_t m_currentCellExtraBytes;
+
     typedef HashMap<StringImpl*, JSValue> UniqueStringMap;
     UniqueStringMap m_uniqueStrings;
 
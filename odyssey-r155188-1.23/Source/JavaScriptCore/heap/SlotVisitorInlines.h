@@ -47,6 +47,7 @@ template<typename T>
 inline void SlotVisitor::appendUnbarrieredPointer(T** slot)
 {
     ASSERT(slot);
+    rememberCellBeingVisited();
     JSCell* cell = *slot;
     internalAppend(slot, cell);
 }
@@ -60,6 +61,7 @@ ALWAYS_INLINE void SlotVisitor::append(JSValue* slot)
 ALWAYS_INLINE void SlotVisitor::appendUnbarrieredValue(JSValue* slot)
 {
     ASSERT(slot);
+    rememberCellBeingVisited();
     internalAppend(slot, *slot);
 }
 
@@ -73,6 +75,7 @@ template<typename T>
 ALWAYS_INLINE void SlotVisitor::appendUnbarrieredWeak(Weak<T>* weak)
 {
     ASSERT(weak);
+    rememberCellBeingVisited();
     if (weak->get())
         internalAppend(0, weak->get());
 }
@@ -89,6 +92,8 @@ ALWAYS_INLINE void SlotVisitor::internalAppend(void* from, JSCell* cell)
     ASSERT(!m_isCheckingForDefaultMarkViolation);
     if (!cell)
         return;
+    if (UNLIKELY(m_heapSnapshotBuilder))
+        appendToHeapSnapshot(cell);
 #if ENABLE(ALLOCATION_LOGGING)
     dataLogF("JSC GC noticing reference from %p to %p.\n", from, cell);
 #else
@@ -132,6 +137,7 @@ inline void SlotVisitor::addUnconditionalFinalizer(UnconditionalFinalizer* uncon
 
 inline void SlotVisitor::addOpaqueRoot(void* root)
 {
+    rememberCellBeingVisited();
 #if ENABLE(PARALLEL_GC)
     if (Options::numberOfGCMarkers() == 1) {
         // Put directly into the shared HashSet.
@@ -208,9 +214,33 @@ inline void SlotVisitor::donateAndDrain()
     drain();
 }
 
+inline void SlotVisitor::appendOldCell(JSCell* cell)
+{
+    ASSERT(Heap::isMarked(cell));
+    m_visitCount++;
+    m_stack.append(cell);
+}
+
+inline void SlotVisitor::rememberUnbarrieredCell(JSCell* cell)
+{
+    if (m_shouldRememberUnbarrieredCells)
+        m_unbarrieredCells.append(cell);
+}
+
+ALWAYS_INLINE void SlotVisitor::rememberCellBeingVisited()
+{
+    if (!m_cellBeingVisited)
+        return;
+    rememberUnbarrieredCell(m_cellBeingVisited);
+    m_cellBeingVisited = 0;
+}
+
 inline void SlotVisitor::copyLater(JSCell* owner, CopyToken token, void* ptr, size_t bytes)
 {
     ASSERT(bytes);
+    if (UNLIKELY(m_heapSnapshotBuilder))
+        m_currentCellCopiedBytes += bytes;
+
     CopiedBlock* block = CopiedSpace::blockFor(ptr);
     if (block->isOversize()) {
         m_shared.m_copiedSpace->pin(block);
@@ -225,6 +255,9 @@ inline void SlotVisitor::copyLater(JSCell* owner, CopyToken token, void* ptr, si
     
 inline void SlotVisitor::reportExtraMemoryUsage(size_t size)
 {
+    if (UNLIKELY(m_heapSnapshotBuilder))
+        m_currentCellExtraBytes += size;
+
     size_t* counter = &m_shared.m_vm->heap.m_extraMemoryUsage;
     
 #if ENABLE(COMPARE_AND_SWAP)
@@ -26,6 +26,8 @@
 #include "ButterflyInlines.h"
 #include "BytecodeGenerator.h"
 #include "CallFrameInlines.h"
+#include "CodeCache.h"
+#include "CodeCacheStorage.h"
 #include "Completion.h"
 #include "CopiedSpaceInlines.h"
 #include "ExceptionHelpers.h"
@@ -35,9 +37,12 @@
 #include "JSArray.h"
 #include "JSFunction.h"
 #include "JSLock.h"
+#include "JSONObject.h"
 #include "JSProxy.h"
 #include "JSString.h"
+#include "ObjectConstructor.h"
 #include "Operations.h"
+#include "SamplingProfiler.h"
 #include "SamplingTool.h"
 #include "StackVisitor.h"
 #include "StructureRareDataInlines.h"
@@ -47,6 +52,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <wtf/CurrentTime.h>
+#include <wtf/FilePrintStream.h>
 #include <wtf/MainThread.h>
 #include <wtf/StringPrintStream.h>
 #include <wtf/text/StringBuilder.h>
@@ -118,6 +124,15 @@ static EncodedJSValue JSC_HOST_CALL functionReadline(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionPreciseTime(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionNeverInlineFunction(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionNumberOfDFGCompiles(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionStartSamplingProfiler(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionStopSamplingProfiler(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionSamplingProfilerStackTraces(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionHeapSnapshot(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionCreateGlobalObject(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionBytecodeCacheStatistics(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionSetBytecodeCacheMaximumSize(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionDamageBytecodeCache(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionClearCodeCache(ExecState*);
 static NO_RETURN_WITH_VALUE EncodedJSValue JSC_HOST_CALL functionQuit(ExecState*);
 
 #if ENABLE(SAMPLING_FLAGS)
@@ -154,6 +169,7 @@ public:
     Vector<String> m_arguments;
     bool m_profile;
     String m_profilerOutput;
+    String m_bytecodeCacheDirectory;
 
     void parseArguments(int, char**);
 };
@@ -237,6 +253,15 @@ protected:
         addFunction(vm, "preciseTime", functionPreciseTime, 0);
         addFunction(vm, "neverInlineFunction", functionNeverInlineFunction, 1);
         addFunction(vm, "numberOfDFGCompiles", functionNumberOfDFGCompiles, 1);
+        addFunction(vm, "startSamplingProfiler", functionStartSamplingProfiler, 1);
+        addFunction(vm, "stopSamplingProfiler", functionStopSamplingProfiler, 0);
+        addFunction(vm, "samplingProfilerStackTraces", functionSamplingProfilerStackTraces, 1);
+        addFunction(vm, "heapSnapshot", functionHeapSnapshot, 1);
+        addFunction(vm, "createGlobalObject", functionCreateGlobalObject, 0);
+        addFunction(vm, "bytecodeCacheStatistics", functionBytecodeCacheStatistics, 0);
+        addFunction(vm, "setBytecodeCacheMaximumSize", functionSetBytecodeCacheMaximumSize, 1);
+        addFunction(vm, "damageBytecodeCache", functionDamageBytecodeCache, 1);
+        addFunction(vm, "clearCodeCache", functionClearCodeCache, 0);
 #if ENABLE(SAMPLING_FLAGS)
         addFunction(vm, "setSamplingFlags", functionSetSamplingFlags, 1);
         addFunction(vm, "clearSamplingFlags", functionClearSamplingFlags, 1);
@@ -493,6 +518,116 @@ EncodedJSValue JSC_HOST_CALL functionNumberOfDFGCompiles(ExecState* exec)
     return JSValue::encode(numberOfDFGCompiles(exec));
 }
 
+// startSamplingProfiler([interval in milliseconds])
+EncodedJSValue JSC_HOST_CALL functionStartSamplingProfiler(ExecState* exec)
+{
+    double interval = exec->argumentCount() ? exec->argument(0).toNumber(exec) : Options::samplingProfilerInterval();
+    if (!(interval > 0))
+        return JSValue::encode(exec->vm().throwException(exec, createRangeError(exec, "The sampling interval must be positive.")));
+    exec->vm().ensureSamplingProfiler().start(interval / 1000);
+    return JSValue::encode(jsUndefined());
+}
+
+EncodedJSValue JSC_HOST_CALL functionStopSamplingProfiler(ExecState* exec)
+{
+    if (SamplingProfiler* profiler = exec->vm().samplingProfiler())
+        profiler->stop();
+    return JSValue::encode(jsUndefined());
+}
+
+// samplingProfilerStackTraces(["json"]) returns the folded stacks, or the profile as JSON.
+EncodedJSValue JSC_HOST_CALL functionSamplingProfilerStackTraces(ExecState* exec)
+{
+    SamplingProfiler* profiler = exec->vm().samplingProfiler();
+    if (!profiler)
+        return JSValue::encode(jsUndefined());
+    if (exec->argument(0).isString() && exec->argument(0).toString(exec)->value(exec) == "json")
+        return JSValue::encode(JSONParse(exec, profiler->toJSON()));
+    return JSValue::encode(jsString(exec, profiler->foldedStacks()));
+}
+
+// heapSnapshot(path) writes the snapshot to a file and returns whether it could; without
+// a path, the snapshot is returned as a string, which is only sensible for small heaps.
+EncodedJSValue JSC_HOST_CALL functionHeapSnapshot(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    if (exec->argumentCount() >= 1) {
+        String fileName = exec->argument(0).toString(exec)->value(exec);
+        OwnPtr<FilePrintStream> file = FilePrintStream::open(fileName.utf8().data(), "w");
+        if (!file)
+            return JSValue::encode(jsBoolean(false));
+        return JSValue::encode(jsBoolean(exec->heap()->writeHeapSnapshot(*file)));
+    }
+
+    StringPrintStream stream;
+    if (!exec->heap()->writeHeapSnapshot(stream))
+        return JSValue::encode(jsUndefined());
+    return JSValue::encode(jsString(exec, stream.toString()));
+}
+
+// createGlobalObject() returns the global object of a new, empty shell environment, like
+// the one each frame gets.
+EncodedJSValue JSC_HOST_CALL functionCreateGlobalObject(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    GlobalObject* globalObject = GlobalObject::create(exec->vm(), GlobalObject::createStructure(exec->vm(), jsNull()), Vector<String>());
+    return JSValue::encode(globalObject->globalThis());
+}
+
+// The bytecode cache functions need -b; without it they return undefined.
+EncodedJSValue JSC_HOST_CALL functionBytecodeCacheStatistics(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    CodeCacheStorage* diskCache = exec->vm().codeCache()->diskCache();
+    if (!diskCache)
+        return JSValue::encode(jsUndefined());
+
+    CodeCacheStorage::Statistics statistics = diskCache->statistics();
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(exec->vm(), Identifier(exec, "hits"), jsNumber(statistics.hits));
+    result->putDirect(exec->vm(), Identifier(exec, "misses"), jsNumber(statistics.misses));
+    result->putDirect(exec->vm(), Identifier(exec, "rejected"), jsNumber(statistics.rejected));
+    result->putDirect(exec->vm(), Identifier(exec, "functionCodeBlocksDecoded"), jsNumber(statistics.functionCodeBlocksDecoded));
+    result->putDirect(exec->vm(), Identifier(exec, "functionCodeBlocksRejected"), jsNumber(statistics.functionCodeBlocksRejected));
+    result->putDirect(exec->vm(), Identifier(exec, "filesWritten"), jsNumber(statistics.filesWritten));
+    result->putDirect(exec->vm(), Identifier(exec, "bytesWritten"), jsNumber(statistics.bytesWritten));
+    result->putDirect(exec->vm(), Identifier(exec, "filesCompacted"), jsNumber(statistics.filesCompacted));
+    result->putDirect(exec->vm(), Identifier(exec, "filesEvicted"), jsNumber(statistics.filesEvicted));
+    return JSValue::encode(result);
+}
+
+EncodedJSValue JSC_HOST_CALL functionSetBytecodeCacheMaximumSize(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    CodeCacheStorage* diskCache = exec->vm().codeCache()->diskCache();
+    if (!diskCache)
+        return JSValue::encode(jsUndefined());
+    diskCache->setMaximumSize(exec->argument(0).toUInt32(exec));
+    return JSValue::encode(jsUndefined());
+}
+
+// damageBytecodeCache(programs) damages the program code blocks of every cached file if the
+// argument is true, and the function bodies otherwise.
+EncodedJSValue JSC_HOST_CALL functionDamageBytecodeCache(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    CodeCacheStorage* diskCache = exec->vm().codeCache()->diskCache();
+    if (!diskCache)
+        return JSValue::encode(jsUndefined());
+    diskCache->damageFilesForTesting(exec->argument(0).toBoolean(exec));
+    return JSValue::encode(jsUndefined());
+}
+
+// Writes out the bytecode cache and empties the in-memory code cache, so that the next load()
+// of a program reads it back from disk.
+EncodedJSValue JSC_HOST_CALL functionClearCodeCache(ExecState* exec)
+{
+    JSLockHolder lock(exec);
+    exec->vm().codeCache()->synchronizeDiskCache();
+    exec->vm().codeCache()->clear();
+    return JSValue::encode(jsUndefined());
+}
+
 EncodedJSValue JSC_HOST_CALL functionQuit(ExecState*)
 {
     exit(EXIT_SUCCESS);
@@ -736,6 +871,7 @@ static void runInteractive(GlobalObject* globalObject)
 static NO_RETURN void printUsageStatement(bool help = false)
 {
     fprintf(stderr, "Usage: jsc [options] [files] [-- arguments]\n");
+    fprintf(stderr, "  -b <dir>   Caches the bytecode of large scripts in an existing directory and prints cache statistics\n");
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
@@ -783,6 +919,12 @@ void CommandLine::parseArguments(int argc, char** argv)
             m_dump = true;
             continue;
         }
+        if (!strcmp(arg, "-b")) {
+            if (++i == argc)
+                printUsageStatement();
+            m_bytecodeCacheDirectory = argv[i];
+            continue;
+        }
         if (!strcmp(arg, "-p")) {
             if (++i == argc)
                 printUsageStatement();
@@ -856,6 +998,10 @@ int jscmain(int argc, char** argv)
     if (options.m_profile && !vm->m_perBytecodeProfiler)
         vm->m_perBytecodeProfiler = adoptPtr(new Profiler::Database(*vm));
     
+    if (!options.m_bytecodeCacheDirectory.isNull())
+        vm->codeCache()->setDiskCacheDirectory(options.m_bytecodeCacheDirectory);
+    double startTime = monotonicallyIncreasingTime();
+
     GlobalObject* globalObject = GlobalObject::create(*vm, GlobalObject::createStructure(*vm, jsNull()), options.m_arguments);
     bool success = runWithScripts(globalObject, options.m_scripts, options.m_dump);
     if (options.m_interactive && success)
@@ -863,6 +1009,16 @@ int jscmain(int argc, char** argv)
 
     result = success ? 0 : 3;
 
+    // Comparing a run against a cold cache directory with a second one shows what the cache saves.
+    if (CodeCacheStorage* diskCache = vm->codeCache()->diskCache()) {
+        double elapsed = monotonicallyIncreasingTime() - startTime;
+        diskCache->synchronize();
+        CodeCacheStorage::Statistics statistics = diskCache->statistics();
+        fprintf(stderr, "Bytecode cache: %u hits, %u misses (%u rejected), %u function bodies decoded (%u rejected), %u files written (%lu bytes), %u compacted, %u evicted, %.2f ms\n",
+            statistics.hits, statistics.misses, statistics.rejected, statistics.functionCodeBlocksDecoded, statistics.functionCodeBlocksRejected,
+            statistics.filesWritten, static_cast<unsigned long>(statistics.bytesWritten), statistics.filesCompacted, statistics.filesEvicted, elapsed * 1000);
+    }
+
     if (options.m_exitCode)
         printf("jsc exiting %d\n", result);
     
@@ -33,6 +33,7 @@
 #include "Instruction.h"
 #include "JSScope.h"
 #include "LLIntCLoop.h"
+#include "MarkedBlock.h"
 #include "Opcode.h"
 #include "PropertyOffset.h"
 
@@ -134,6 +135,9 @@ void Data::performAssertions(VM& vm)
 #endif
 
     ASSERT(StringImpl::s_hashFlag8BitBuffer == 32);
+
+    ASSERT(MarkedBlock::blockSize == 64 * KB);
+    ASSERT(MarkedBlock::atomSize == 8);
 }
 #if COMPILER(CLANG)
 #pragma clang diagnostic pop
@@ -49,6 +49,7 @@
 #include "LowLevelInterpreter.h"
 #include "ObjectConstructor.h"
 #include "Operations.h"
+#include "SamplingProfiler.h"
 #include "StructureRareDataInlines.h"
 #include <wtf/StringPrintStream.h>
 
@@ -748,6 +749,16 @@ LLINT_SLOW_PATH_DECL(slow_path_put_by_val)
     LLINT_END();
 }
 
+LLINT_SLOW_PATH_DECL(slow_path_write_barrier)
+{
+    // The put_by_id and put_by_val fast paths call this after storing a cell, or a new
+    // structure, into their base. Both have the base in operand 1 and the value in operand 3.
+    JSCell* base = LLINT_OP_C(1).jsValue().asCell();
+    Heap::writeBarrier(base, LLINT_OP_C(3).jsValue());
+    Heap::writeBarrier(base, base->structure());
+    LLINT_END_IMPL();
+}
+
 LLINT_SLOW_PATH_DECL(slow_path_del_by_val)
 {
     LLINT_BEGIN();
@@ -1234,11 +1245,28 @@ LLINT_SLOW_PATH_DECL(slow_path_throw_static_error)
 LLINT_SLOW_PATH_DECL(slow_path_handle_watchdog_timer)
 {
     LLINT_BEGIN_NO_SET_PC();
+    // The loop head stored its location before the call; the interpreter reloads it after.
+    SamplingProfiler* samplingProfiler = vm.samplingProfiler();
+    if (UNLIKELY(samplingProfiler && samplingProfiler->sampleRequested()))
+        samplingProfiler->takeSample(exec);
     if (UNLIKELY(vm.watchdog.didFire(exec)))
         LLINT_THROW(createTerminatedExecutionException(&vm));
     LLINT_RETURN_TWO(0, exec);
 }
 
+LLINT_SLOW_PATH_DECL(slow_path_take_sample)
+{
+    LLINT_BEGIN_NO_SET_PC();
+    SamplingProfiler* samplingProfiler = vm.samplingProfiler();
+    if (samplingProfiler && samplingProfiler->sampleRequested()) {
+        exec->setCurrentVPC(pc);
+        samplingProfiler->takeSample(exec);
+    }
+    // A time limit that has run out is enforced at the next loop head.
+    vm.watchdog.didHandleInterrupt(exec);
+    LLINT_END_IMPL();
+}
+
 LLINT_SLOW_PATH_DECL(slow_path_debug)
 {
     LLINT_BEGIN();
@@ -162,6 +162,11 @@ const Dynamic = 6
 
 const ResolveModeMask = 0xffff
 
+# Copied from MarkedBlock.h
+const MarkedBlockSize = 64 * 1024
+const MarkedBlockMask = ~(MarkedBlockSize - 1)
+const MarkedBlockAtomShift = 3
+
 # Allocation constants
 if JSVALUE64
     const JSFinalObjectSizeClassIndex = 1
@@ -276,6 +281,21 @@ macro checkSwitchToJITForEpilogue()
         end)
 end
 
+# The sampling profiler raises the watchdog flag, which loop_hint polls as well. Polling it on
+# entry, on return and after calls also samples code without loops, and charges time spent in
+# host functions to their caller.
+macro checkSampleRequest()
+    loadp JITStackFrame::vm[sp], t1
+    if FOUR_BYTE_BOOL
+        loadi VM::watchdog+Watchdog::m_timerDidFire[t1], t0
+    else
+        loadb VM::watchdog+Watchdog::m_timerDidFire[t1], t0
+    end
+    btbz t0, .noSampleRequest
+    callSlowPath(_llint_slow_path_take_sample)
+.noSampleRequest:
+end
+
 macro assertNotConstant(index)
     assert(macro (ok) bilt index, FirstConstantRegisterIndex, ok end)
 end
@@ -542,6 +562,32 @@ _llint_op_in:
     callSlowPath(_slow_path_in)
     dispatch(4)
 
+# Replaces cell with 1 if its mark bit is set and 0 otherwise. Outside of a collection a
+# cell is marked if and only if it survived the last one, so the write barrier only has to
+# remember a marked base that was given an unmarked cell.
+macro loadMarkBit(cell, scratch1, scratch2)
+    move cell, scratch1
+    urshiftp MarkedBlockAtomShift, scratch1
+    andi 31, scratch1
+    move cell, scratch2
+    andp MarkedBlockSize - 1, scratch2
+    urshiftp MarkedBlockAtomShift + 5, scratch2
+    andp MarkedBlockMask, cell
+    loadi MarkedBlock::m_marks[cell, scratch2, 4], cell
+    urshifti scratch1, cell
+    andi 1, cell
+end
+
+# Used by the put_by_id transition fast paths after they have stored the new structure
+# into base. Any cell stored into an old base may be young, so only young bases are
+# skipped here.
+macro structureWriteBarrier(base, scratch1, scratch2)
+    loadMarkBit(base, scratch1, scratch2)
+    btiz base, .structureWriteBarrierDone
+    callSlowPath(_llint_slow_path_write_barrier)
+.structureWriteBarrierDone:
+end
+
 macro withInlineStorage(object, propertyStorage, continuation)
     # Indicate that the object is the property storage, and that the
     # property storage register is unused.
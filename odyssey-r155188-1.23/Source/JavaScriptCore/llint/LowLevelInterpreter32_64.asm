@@ -93,6 +93,7 @@ macro dispatchAfterCall()
     storei t1, TagOffset[cfr, t2, 8]
     storei t0, PayloadOffset[cfr, t2, 8]
     valueProfile(t1, t0, 28, t3)
+    checkSampleRequest()
     dispatch(8)
 end
 
@@ -286,8 +287,19 @@ macro loadConstantOrVariablePayloadUnchecked(index, payload)
         payload)
 end
 
-macro writeBarrier(tag, payload)
-    # Nothing to do, since we don't have a generational or incremental collector.
+# Used by the put_by_id and put_by_val fast paths after they have stored tag and payload
+# into their base, which is operand 1. Only an unmarked cell stored into a marked base
+# needs the slow path. Clobbers tag and payload.
+macro writeBarrier(tag, payload, scratch)
+    bineq tag, CellTag, .writeBarrierDone
+    loadMarkBit(payload, tag, scratch)
+    btinz payload, .writeBarrierDone
+    loadi 4[PC], tag
+    loadConstantOrVariablePayloadUnchecked(tag, payload)
+    loadMarkBit(payload, tag, scratch)
+    btiz payload, .writeBarrierDone
+    callSlowPath(_llint_slow_path_write_barrier)
+.writeBarrierDone:
 end
 
 macro valueProfile(tag, payload, operand, scratch)
@@ -361,6 +373,7 @@ _llint_op_enter:
     storei t1, PayloadOffset[cfr, t2, 8]
     btinz t2, .opEnterLoop
 .opEnterDone:
+    checkSampleRequest()
     dispatch(1)
 
 
@@ -989,7 +1002,7 @@ _llint_op_init_global_const:
     loadi 8[PC], t1
     loadi 4[PC], t0
     loadConstantOrVariable(t1, t2, t3)
-    writeBarrier(t2, t3)
+    # Eden collections visit the global object again anyway.
     storei t2, TagOffset[t0]
     storei t3, PayloadOffset[t0]
     dispatch(5)
@@ -1086,9 +1099,9 @@ macro putById(getPropertyStorage)
             bpneq JSCell::m_structure[t0], t1, .opPutByIdSlow
             loadi 20[PC], t1
             loadConstantOrVariable2Reg(t2, scratch, t2)
-            writeBarrier(scratch, t2)
             storei scratch, TagOffset[propertyStorage, t1]
             storei t2, PayloadOffset[propertyStorage, t1]
+            writeBarrier(scratch, t2, t1)
             dispatch(9)
         end)
 end
@@ -1120,11 +1133,11 @@ macro putByIdTransition(additionalChecks, getPropertyStorage)
         macro (propertyStorage, scratch)
             addp t1, propertyStorage, t3
             loadConstantOrVariable2Reg(t2, t1, t2)
-            writeBarrier(t1, t2)
             storei t1, TagOffset[t3]
             loadi 24[PC], t1
             storei t2, PayloadOffset[t3]
             storep t1, JSCell::m_structure[t0]
+            structureWriteBarrier(t0, t1, t2)
             dispatch(9)
         end)
 end
@@ -1338,9 +1351,9 @@ _llint_op_put_by_val:
             const tag = scratch
             const payload = operand
             loadConstantOrVariable2Reg(operand, tag, payload)
-            writeBarrier(tag, payload)
             storei tag, TagOffset[base, index, 8]
             storei payload, PayloadOffset[base, index, 8]
+            writeBarrier(tag, payload, index)
         end)
 
 .opPutByValNotContiguous:
@@ -1350,9 +1363,9 @@ _llint_op_put_by_val:
 .opPutByValArrayStorageStoreResult:
     loadi 12[PC], t2
     loadConstantOrVariable2Reg(t2, t1, t2)
-    writeBarrier(t1, t2)
     storei t1, ArrayStorage::m_vector + TagOffset[t0, t3, 8]
     storei t2, ArrayStorage::m_vector + PayloadOffset[t0, t3, 8]
+    writeBarrier(t1, t2, t3)
     dispatch(5)
 
 .opPutByValArrayStorageEmpty:
@@ -1631,6 +1644,7 @@ _llint_op_tear_off_arguments:
 _llint_op_ret:
     traceExecution()
     checkSwitchToJITForEpilogue()
+    checkSampleRequest()
     loadi 4[PC], t2
     loadConstantOrVariable(t2, t1, t0)
     doReturn()
@@ -1639,6 +1653,7 @@ _llint_op_ret:
 _llint_op_ret_object_or_this:
     traceExecution()
     checkSwitchToJITForEpilogue()
+    checkSampleRequest()
     loadi 4[PC], t2
     loadConstantOrVariable(t2, t1, t0)
     bineq t1, CellTag, .opRetObjectOrThisNotObject
@@ -2064,6 +2079,7 @@ macro putClosureVar()
     loadisFromInstruction(6, t1)
     storei t2, TagOffset[t0, t1, 8]
     storei t3, PayloadOffset[t0, t1, 8]
+    writeBarrier(t2, t3, t0)
 end
 
 
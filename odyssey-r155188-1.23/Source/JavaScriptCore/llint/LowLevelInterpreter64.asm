@@ -48,6 +48,7 @@ macro dispatchAfterCall()
     loadisFromInstruction(1, t1)
     storeq t0, [cfr, t1, 8]
     valueProfile(t0, 7, t2)
+    checkSampleRequest()
     dispatch(8)
 end
 
@@ -172,8 +173,19 @@ macro loadConstantOrVariableCell(index, value, slow)
     btqnz value, tagMask, slow
 end
 
-macro writeBarrier(value)
-    # Nothing to do, since we don't have a generational or incremental collector.
+# Used by the put_by_id and put_by_val fast paths after they have stored value into their
+# base, which is operand 1. Only an unmarked cell stored into a marked base needs the slow
+# path. Clobbers value.
+macro writeBarrier(value, scratch1, scratch2)
+    btqnz value, tagMask, .writeBarrierDone
+    loadMarkBit(value, scratch1, scratch2)
+    btinz value, .writeBarrierDone
+    loadisFromInstruction(1, scratch1)
+    loadConstantOrVariable(scratch1, value)
+    loadMarkBit(value, scratch1, scratch2)
+    btiz value, .writeBarrierDone
+    callSlowPath(_llint_slow_path_write_barrier)
+.writeBarrierDone:
 end
 
 macro valueProfile(value, operand, scratch)
@@ -243,6 +255,7 @@ _llint_op_enter:
     storeq t0, [cfr, t2, 8]
     btinz t2, .opEnterLoop
 .opEnterDone:
+    checkSampleRequest()
     dispatch(1)
 
 
@@ -844,7 +857,7 @@ _llint_op_init_global_const:
     loadisFromInstruction(2, t1)
     loadpFromInstruction(1, t0)
     loadConstantOrVariable(t1, t2)
-    writeBarrier(t2)
+    # Eden collections visit the global object again anyway.
     storeq t2, [t0]
     dispatch(5)
 
@@ -937,8 +950,8 @@ macro putById(getPropertyStorage)
             bpneq JSCell::m_structure[t0], t1, .opPutByIdSlow
             loadisFromInstruction(5, t1)
             loadConstantOrVariable(t2, scratch)
-            writeBarrier(t0)
             storeq scratch, [propertyStorage, t1]
+            writeBarrier(scratch, t1, t2)
             dispatch(9)
         end)
 end
@@ -970,10 +983,10 @@ macro putByIdTransition(additionalChecks, getPropertyStorage)
         macro (propertyStorage, scratch)
             addp t1, propertyStorage, t3
             loadConstantOrVariable(t2, t1)
-            writeBarrier(t1)
             storeq t1, [t3]
             loadpFromInstruction(6, t1)
             storep t1, JSCell::m_structure[t0]
+            structureWriteBarrier(t0, t1, t2)
             dispatch(9)
         end)
 end
@@ -1184,8 +1197,8 @@ _llint_op_put_by_val:
     contiguousPutByVal(
         macro (operand, scratch, address)
             loadConstantOrVariable(operand, scratch)
-            writeBarrier(scratch)
             storep scratch, address
+            writeBarrier(scratch, operand, t3)
         end)
 
 .opPutByValNotContiguous:
@@ -1195,8 +1208,8 @@ _llint_op_put_by_val:
 .opPutByValArrayStorageStoreResult:
     loadisFromInstruction(3, t2)
     loadConstantOrVariable(t2, t1)
-    writeBarrier(t1)
     storeq t1, ArrayStorage::m_vector[t0, t3, 8]
+    writeBarrier(t1, t2, t3)
     dispatch(5)
 
 .opPutByValArrayStorageEmpty:
@@ -1477,6 +1490,7 @@ _llint_op_tear_off_arguments:
 _llint_op_ret:
     traceExecution()
     checkSwitchToJITForEpilogue()
+    checkSampleRequest()
     loadisFromInstruction(1, t2)
     loadConstantOrVariable(t2, t0)
     doReturn()
@@ -1485,6 +1499,7 @@ _llint_op_ret:
 _llint_op_ret_object_or_this:
     traceExecution()
     checkSwitchToJITForEpilogue()
+    checkSampleRequest()
     loadisFromInstruction(1, t2)
     loadConstantOrVariable(t2, t0)
     btqnz t0, tagMask, .opRetObjectOrThisNotObject
@@ -1841,6 +1856,7 @@ macro putClosureVar()
     loadp JSVariableObject::m_registers[t0], t0
     loadisFromInstruction(6, t1)
     storeq t2, [t0, t1, 8]
+    writeBarrier(t2, t0, t1)
 end
 
 
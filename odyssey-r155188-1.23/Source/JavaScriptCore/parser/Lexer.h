@@ -46,18 +46,14 @@ public:
         return m_keywordTable.entry(m_vm, ident);
     }
     
-    ~Keywords()
-    {
-        m_keywordTable.deleteTable();
-    }
-    
 private:
     friend class VM;
     
     Keywords(VM*);
     
     VM* m_vm;
-    const HashTable m_keywordTable;
+    // Shared by all VMs, see SharedIdentifiers.
+    const HashTable& m_keywordTable;
 };
 
 enum LexerFlags {
@@ -0,0 +1,287 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "SamplingProfiler.h"
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "JSONObject.h"
+#include "Operations.h"
+#include "StackVisitor.h"
+#include "VM.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/text/StringBuilder.h>
+
+namespace JSC {
+
+class SamplingProfiler::SampleFunctor {
+public:
+    SampleFunctor(SamplingProfiler& profiler, Vector<unsigned, 32>& frames)
+        : m_profiler(profiler)
+        , m_frames(frames)
+    {
+    }
+
+    StackVisitor::Status operator()(StackVisitor& visitor)
+    {
+        m_frames.append(m_profiler.frameIndex(visitor));
+        return StackVisitor::Continue;
+    }
+
+private:
+    SamplingProfiler& m_profiler;
+    Vector<unsigned, 32>& m_frames;
+};
+
+SamplingProfiler::SamplingProfiler(VM& vm)
+    : m_vm(vm)
+    , m_thread(0)
+    , m_threadShouldQuit(false)
+    , m_isExecuting(false)
+    , m_interval(0)
+    , m_sampleRequested(false)
+    , m_sampleCount(0)
+{
+    m_nodes.append(Node(0, 0));
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void SamplingProfiler::start(double intervalInSeconds)
+{
+    MutexLocker locker(m_lock);
+    m_interval = intervalInSeconds;
+    if (m_thread)
+        return;
+    m_threadShouldQuit = false;
+    m_thread = createThread(threadStartFunc, this, "[OWB] JavaScriptCore::SamplingProfiler");
+}
+
+void SamplingProfiler::stop()
+{
+    if (!m_thread)
+        return;
+    {
+        MutexLocker locker(m_lock);
+        m_threadShouldQuit = true;
+        m_condition.signal();
+    }
+    waitForThreadCompletion(m_thread);
+    m_thread = 0;
+    m_sampleRequested = false;
+}
+
+void SamplingProfiler::didStartExecuting()
+{
+    MutexLocker locker(m_lock);
+    m_isExecuting = true;
+    m_condition.signal();
+}
+
+void SamplingProfiler::didStopExecuting()
+{
+    MutexLocker locker(m_lock);
+    m_isExecuting = false;
+    // A request the script did not get to would be answered at the start of the next one.
+    m_sampleRequested = false;
+}
+
+void SamplingProfiler::clear()
+{
+    m_frameIndices.clear();
+    m_nativeFrameIndices.clear();
+    m_frames.clear();
+    m_nodes.shrink(1);
+    m_nodes[0].selfCount = 0;
+    m_childNodes.clear();
+    m_sampleCount = 0;
+}
+
+void SamplingProfiler::takeSample(ExecState* exec)
+{
+    m_sampleRequested = false;
+
+    Vector<unsigned, 32> frames;
+    SampleFunctor functor(*this, frames);
+    exec->iterate(functor);
+    if (frames.isEmpty())
+        return;
+
+    unsigned node = 0;
+    for (size_t i = frames.size(); i--;)
+        node = childNode(node, frames[i]);
+    ++m_nodes[node].selfCount;
+    ++m_sampleCount;
+}
+
+unsigned SamplingProfiler::frameIndex(StackVisitor& visitor)
+{
+    CodeBlock* codeBlock = visitor->codeBlock();
+    if (!codeBlock) {
+        String name = visitor->functionName();
+        if (name.isEmpty())
+            name = ASCIILiteral("(native)");
+        HashMap<String, unsigned>::AddResult result = m_nativeFrameIndices.add(name, m_frames.size());
+        if (result.isNewEntry)
+            m_frames.append(Frame(name, String(), 0));
+        return result.iterator->value;
+    }
+
+    unsigned line;
+    unsigned column;
+    visitor->computeLineAndColumn(line, column);
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    FrameKey key(executable->sourceID(), std::make_pair(static_cast<unsigned>(executable->source().startOffset()), line));
+    HashMap<FrameKey, unsigned>::AddResult result = m_frameIndices.add(key, m_frames.size());
+    if (result.isNewEntry) {
+        String name = visitor->functionName();
+        if (name.isEmpty())
+            name = ASCIILiteral("(anonymous function)");
+        m_frames.append(Frame(name, visitor->sourceURL(), line));
+    }
+    return result.iterator->value;
+}
+
+unsigned SamplingProfiler::childNode(unsigned parent, unsigned frame)
+{
+    HashMap<std::pair<unsigned, unsigned>, unsigned>::AddResult result = m_childNodes.add(std::make_pair(parent, frame + 1), m_nodes.size());
+    if (result.isNewEntry)
+        m_nodes.append(Node(frame, parent));
+    return result.iterator->value;
+}
+
+String SamplingProfiler::frameDescription(unsigned frameIndex) const
+{
+    const Frame& frame = m_frames[frameIndex];
+    StringBuilder builder;
+    builder.append(frame.name);
+    if (!frame.url.isNull()) {
+        builder.appendLiteral(" (");
+        builder.append(frame.url);
+        builder.append(':');
+        builder.appendNumber(frame.line);
+        builder.append(')');
+    }
+    String description = builder.toString();
+    // Semicolons separate the frames of a folded stack.
+    description.replace(';', ',');
+    description.replace('\n', ' ');
+    return description;
+}
+
+String SamplingProfiler::foldedStacks() const
+{
+    StringBuilder builder;
+    Vector<unsigned, 32> frames;
+    for (size_t i = 1; i < m_nodes.size(); ++i) {
+        if (!m_nodes[i].selfCount)
+            continue;
+        frames.shrink(0);
+        for (unsigned node = i; node; node = m_nodes[node].parent)
+            frames.append(m_nodes[node].frame);
+        for (size_t j = frames.size(); j--;) {
+            builder.append(frameDescription(frames[j]));
+            builder.append(j ? ';' : ' ');
+        }
+        builder.appendNumber(m_nodes[i].selfCount);
+        builder.append('\n');
+    }
+    return builder.toString();
+}
+
+void SamplingProfiler::appendFrameJSON(StringBuilder& builder, unsigned frameIndex) const
+{
+    const Frame& frame = m_frames[frameIndex];
+    builder.appendLiteral("{\"name\":");
+    appendQuotedJSONString(builder, frame.name);
+    if (!frame.url.isNull()) {
+        builder.appendLiteral(",\"url\":");
+        appendQuotedJSONString(builder, frame.url);
+        builder.appendLiteral(",\"line\":");
+        builder.appendNumber(frame.line);
+    }
+    builder.append('}');
+}
+
+// Written out directly rather than through JSON.stringify: the caller may not be running
+// any script, and there is no global object to build the profile in.
+String SamplingProfiler::toJSON() const
+{
+    StringBuilder builder;
+    builder.appendLiteral("{\"interval\":");
+    builder.append(String::numberToStringECMAScript(m_interval * 1000));
+    builder.appendLiteral(",\"sampleCount\":");
+    builder.appendNumber(m_sampleCount);
+
+    builder.appendLiteral(",\"frames\":[");
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        if (i)
+            builder.append(',');
+        appendFrameJSON(builder, i);
+    }
+
+    builder.appendLiteral("],\"nodes\":[");
+    for (size_t i = 1; i < m_nodes.size(); ++i) {
+        if (i > 1)
+            builder.append(',');
+        builder.appendLiteral("{\"frame\":");
+        builder.appendNumber(m_nodes[i].frame);
+        builder.appendLiteral(",\"parent\":");
+        builder.appendNumber(static_cast<int>(m_nodes[i].parent) - 1);
+        builder.appendLiteral(",\"selfCount\":");
+        builder.appendNumber(m_nodes[i].selfCount);
+        builder.append('}');
+    }
+    builder.appendLiteral("]}");
+    return builder.toString();
+}
+
+void SamplingProfiler::threadStartFunc(void* profiler)
+{
+    static_cast<SamplingProfiler*>(profiler)->threadMain();
+}
+
+void SamplingProfiler::threadMain()
+{
+    MutexLocker locker(m_lock);
+    while (true) {
+        while (!m_threadShouldQuit && !m_isExecuting)
+            m_condition.wait(m_lock);
+        if (m_threadShouldQuit)
+            return;
+
+        double nextSampleTime = currentTime() + m_interval;
+        while (!m_threadShouldQuit && currentTime() < nextSampleTime)
+            m_condition.timedWait(m_lock, nextSampleTime);
+        if (m_threadShouldQuit)
+            return;
+        if (!m_isExecuting)
+            continue;
+
+        // The flags are plain stores that the script thread may see late or out of order;
+        // at worst a sample is skipped or taken at the next poll.
+        m_sampleRequested = true;
+        m_vm.watchdog.interrupt();
+    }
+}
+
+} // namespace JSC
@@ -0,0 +1,142 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SamplingProfiler_h
+#define SamplingProfiler_h
+
+#include "JSExportMacros.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace JSC {
+
+class ExecState;
+class StackVisitor;
+class VM;
+
+// Samples the JavaScript call stack at a fixed interval while it runs.
+//
+// A helper thread wakes up once per interval and interrupts the script through the
+// watchdog flag. The interpreter polls that flag at every loop head, function entry and
+// return, and after every call, including calls to host functions; the script thread
+// then records its stack when it reaches the next poll, where the stack is consistent.
+// Time spent in a host function is charged to its caller once it returns.
+//
+// The helper thread only runs while the script thread runs JavaScript: the watchdog tells
+// the profiler when the outermost script starts and ends, and the helper thread blocks in
+// between.
+//
+// Frames are kept per line of each function and stacks are merged into a tree as they are
+// recorded, so memory grows with the number of distinct stacks, not with the run time.
+class SamplingProfiler {
+    WTF_MAKE_NONCOPYABLE(SamplingProfiler);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit SamplingProfiler(VM&);
+    ~SamplingProfiler();
+
+    void start(double intervalInSeconds);
+    void stop();
+    bool isRunning() const { return m_thread; }
+
+    // Drops all samples taken so far.
+    void clear();
+
+    // Called by the watchdog on the script thread when the outermost script starts and ends.
+    void didStartExecuting();
+    void didStopExecuting();
+
+    bool sampleRequested() const { return m_sampleRequested; }
+    // Called on the script thread when it handles the watchdog flag.
+    void takeSample(ExecState*);
+
+    unsigned sampleCount() const { return m_sampleCount; }
+
+    // One line per distinct stack, outermost frame first, frames separated by semicolons and
+    // followed by the number of samples, as flame graph tools expect.
+    JS_EXPORT_PRIVATE String foldedStacks() const;
+    JS_EXPORT_PRIVATE String toJSON() const;
+
+private:
+    struct Frame {
+        Frame() : line(0) { }
+        Frame(const String& name, const String& url, unsigned line)
+            : name(name)
+            , url(url)
+            , line(line)
+        {
+        }
+
+        String name;
+        String url;
+        unsigned line;
+    };
+
+    struct Node {
+        Node(unsigned frame, unsigned parent)
+            : frame(frame)
+            , parent(parent)
+            , selfCount(0)
+        {
+        }
+
+        unsigned frame;
+        unsigned parent;
+        unsigned selfCount;
+    };
+
+    class SampleFunctor;
+
+    unsigned frameIndex(StackVisitor&);
+    unsigned childNode(unsigned parent, unsigned frame);
+    String frameDescription(unsigned frame) const;
+    void appendFrameJSON(StringBuilder&, unsigned frame) const;
+
+    static void threadStartFunc(void*);
+    void threadMain();
+
+    VM& m_vm;
+
+    Mutex m_lock;
+    ThreadCondition m_condition;
+    ThreadIdentifier m_thread;
+    bool m_threadShouldQuit;
+    bool m_isExecuting;
+    double m_interval;
+    // Set by the helper thread, cleared by the script thread.
+    volatile bool m_sampleRequested;
+
+    // Frames of JavaScript functions are keyed by source, function start and line.
+    typedef std::pair<intptr_t, std::pair<unsigned, unsigned> > FrameKey;
+    HashMap<FrameKey, unsigned> m_frameIndices;
+    HashMap<String, unsigned> m_nativeFrameIndices;
+    Vector<Frame> m_frames;
+
+    // m_nodes[0] is the root, above the outermost frame of every stack. Children are keyed
+    // by their parent and their frame plus one, since (0, 0) is the empty key.
+    Vector<Node> m_nodes;
+    HashMap<std::pair<unsigned, unsigned>, unsigned> m_childNodes;
+    unsigned m_sampleCount;
+};
+
+} // namespace JSC
+
+#endif // SamplingProfiler_h
@@ -28,6 +28,7 @@
 #include "CodeCache.h"
 
 #include "BytecodeGenerator.h"
+#include "CodeCacheStorage.h"
 #include "CodeSpecializationKind.h"
 #include "Operations.h"
 #include "Parser.h"
@@ -67,11 +68,27 @@ template <typename T> struct CacheTypes { };
 template <> struct CacheTypes<UnlinkedProgramCodeBlock> {
     typedef JSC::ProgramNode RootNode;
     static const SourceCodeKey::CodeType codeType = SourceCodeKey::ProgramType;
+    static const bool canUseDiskCache = true;
+
+    static UnlinkedProgramCodeBlock* load(CodeCacheStorage* diskCache, VM& vm, CodeCacheStorage::Key& key, const SourceCode& source)
+    {
+        return diskCache->loadProgramCodeBlock(vm, key, source);
+    }
+
+    static void store(CodeCacheStorage* diskCache, CodeCacheStorage::Key& key, const SourceCode& source, UnlinkedProgramCodeBlock* unlinkedCode)
+    {
+        diskCache->storeProgramCodeBlock(key, source, unlinkedCode);
+    }
 };
 
+// Eval code is usually short and generated at run time, so it is not worth a file.
 template <> struct CacheTypes<UnlinkedEvalCodeBlock> {
     typedef JSC::EvalNode RootNode;
     static const SourceCodeKey::CodeType codeType = SourceCodeKey::EvalType;
+    static const bool canUseDiskCache = false;
+
+    static UnlinkedEvalCodeBlock* load(CodeCacheStorage*, VM&, CodeCacheStorage::Key&, const SourceCode&) { return 0; }
+    static void store(CodeCacheStorage*, CodeCacheStorage::Key&, const SourceCode&, UnlinkedEvalCodeBlock*) { }
 };
 
 template <class UnlinkedCodeBlockType, class ExecutableType>
@@ -88,6 +105,19 @@ UnlinkedCodeBlockType* CodeCache::getCodeBlock(VM& vm, ExecutableType* executabl
         return unlinkedCode;
     }
 
+    bool canUseDiskCache = canCache && m_diskCache && CacheTypes<UnlinkedCodeBlockType>::canUseDiskCache && CodeCacheStorage::canCache(source);
+    CodeCacheStorage::Key diskCacheKey;
+    if (canUseDiskCache) {
+        diskCacheKey = CodeCacheStorage::keyFor(source, strictness);
+        if (UnlinkedCodeBlockType* unlinkedCode = CacheTypes<UnlinkedCodeBlockType>::load(m_diskCache.get(), vm, diskCacheKey, source)) {
+            unsigned firstLine = source.firstLine() + unlinkedCode->firstLine();
+            unsigned startColumn = source.firstLine() ? source.startColumn() : 0;
+            executable->recordParse(unlinkedCode->codeFeatures(), unlinkedCode->hasCapturedVariables(), firstLine, firstLine + unlinkedCode->lineCount(), startColumn);
+            addResult.iterator->value = SourceCodeValue(vm, unlinkedCode, m_sourceCode.age());
+            return unlinkedCode;
+        }
+    }
+
     typedef typename CacheTypes<UnlinkedCodeBlockType>::RootNode RootNode;
     RefPtr<RootNode> rootNode = parse<RootNode>(&vm, source, 0, Identifier(), strictness, JSParseProgramCode, error);
     if (!rootNode) {
@@ -112,6 +142,8 @@ UnlinkedCodeBlockType* CodeCache::getCodeBlock(VM& vm, ExecutableType* executabl
     }
 
     addResult.iterator->value = SourceCodeValue(vm, unlinkedCode, m_sourceCode.age());
+    if (canUseDiskCache)
+        CacheTypes<UnlinkedCodeBlockType>::store(m_diskCache.get(), diskCacheKey, source, unlinkedCode);
     return unlinkedCode;
 }
 
@@ -125,6 +157,22 @@ UnlinkedEvalCodeBlock* CodeCache::getEvalCodeBlock(VM& vm, EvalExecutable* execu
     return getCodeBlock<UnlinkedEvalCodeBlock>(vm, executable, source, strictness, debuggerMode, profilerMode, error);
 }
 
+void CodeCache::setDiskCacheDirectory(const String& directory)
+{
+    if (m_diskCache)
+        m_diskCache->synchronize();
+    if (directory.isNull())
+        m_diskCache.clear();
+    else
+        m_diskCache = CodeCacheStorage::create(directory);
+}
+
+void CodeCache::synchronizeDiskCache()
+{
+    if (m_diskCache)
+        m_diskCache->synchronize();
+}
+
 UnlinkedFunctionExecutable* CodeCache::getFunctionExecutableFromGlobalCode(VM& vm, const Identifier& name, const SourceCode& source, ParserError& error)
 {
     SourceCodeKey key = SourceCodeKey(source, name.string(), SourceCodeKey::FunctionType, JSParseNormal);
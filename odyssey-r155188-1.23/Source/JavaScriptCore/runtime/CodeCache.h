@@ -34,12 +34,14 @@
 #include <wtf/CurrentTime.h>
 #include <wtf/FixedArray.h>
 #include <wtf/Forward.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
 #include <wtf/RandomNumber.h>
 #include <wtf/text/WTFString.h>
 
 namespace JSC {
 
+class CodeCacheStorage;
 class EvalExecutable;
 class FunctionBodyNode;
 class Identifier;
@@ -249,6 +251,13 @@ public:
         m_sourceCode.clear();
     }
 
+    // Also keeps the bytecode of large programs in the directory, across runs. A null string
+    // turns that off again.
+    void setDiskCacheDirectory(const String&);
+    CodeCacheStorage* diskCache() const { return m_diskCache.get(); }
+    // Writes the function bodies that were compiled since the programs were cached.
+    void synchronizeDiskCache();
+
 private:
     CodeCache();
 
@@ -256,6 +265,7 @@ private:
     UnlinkedCodeBlockType* getCodeBlock(VM&, ExecutableType*, const SourceCode&, JSParserStrictness, DebuggerMode, ProfilerMode, ParserError&);
 
     CodeCacheMap m_sourceCode;
+    OwnPtr<CodeCacheStorage> m_diskCache;
 };
 
 }
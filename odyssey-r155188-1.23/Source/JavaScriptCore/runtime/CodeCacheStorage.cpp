@@ -0,0 +1,1760 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "CodeCacheStorage.h"
+
+#include "ArgList.h"
+#include "Nodes.h"
+#include "Opcode.h"
+#include "Operations.h"
+#include "SourceCode.h"
+#include "UnlinkedCodeBlock.h"
+#include "WeakInlines.h"
+#include <stdio.h>
+#include <string.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/SHA1.h>
+#include <wtf/StringHasher.h>
+#include <wtf/text/CString.h>
+
+#if HAVE(MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace JSC {
+
+// Parsing and generating bytecode for anything shorter takes less time than the file system lookup.
+static const unsigned minimumCachedSourceLength = 4096;
+
+static const uint32_t fileMagic = 0x4a534243; // 'JSBC', also rejects files written with the other byte order.
+static const uint32_t fileFormatVersion = 2;
+static const uint32_t nullStringLength = 0xffffffff;
+
+static const uint32_t indexMagic = 0x4a534249; // 'JSBI'
+static const uint32_t indexFormatVersion = 1;
+static const char indexFileName[] = "index.jsbi";
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t buildSignature;
+    uint32_t sourceLength;
+    uint32_t strictness;
+    uint32_t programOffset;
+    // Taken by blobs that nothing in the file refers to any more.
+    uint32_t unreferencedBytes;
+    uint8_t sourceDigest[20];
+};
+
+// Precedes every code block blob. File offsets point at the header, and the size counts the
+// bytes after it.
+struct BlobHeader {
+    uint32_t size;
+    uint32_t checksum;
+};
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t useCounter;
+    uint32_t recordCount;
+    uint32_t checksum;
+};
+
+struct IndexFileRecord {
+    uint32_t hash;
+    uint32_t length;
+    uint32_t strictness;
+    uint32_t size;
+    uint32_t lastUse;
+};
+
+// Blobs are padded to a multiple of four bytes, which keeps this hash over pairs of bytes defined.
+static uint32_t checksum(const uint8_t* data, size_t size)
+{
+    return StringHasher::hashMemory(data, size);
+}
+
+enum CodeBlockFlags {
+    NeedsFullScopeChainFlag = 1 << 0,
+    UsesEvalFlag = 1 << 1,
+    IsNumericCompareFunctionFlag = 1 << 2,
+    IsStrictModeFlag = 1 << 3,
+    IsConstructorFlag = 1 << 4,
+    HasCapturedVariablesFlag = 1 << 5
+};
+
+enum ExecutableFlags {
+    ForceUsesArgumentsFlag = 1 << 0,
+    IsInStrictContextFlag = 1 << 1,
+    ExecutableHasCapturedVariablesFlag = 1 << 2
+};
+
+enum ConstantTag {
+    EmptyConstant,
+    UndefinedConstant,
+    NullConstant,
+    TrueConstant,
+    FalseConstant,
+    Int32Constant,
+    DoubleConstant,
+    StringConstant,
+    // Only in constant buffers: the string held by the constant register with the encoded index.
+    ConstantRegisterStringConstant
+};
+
+// Bytecode is only meaningful to the build that generated it: the signature covers the opcode
+// numbering and lengths and the layout of the structures that are stored as raw bytes.
+static uint32_t buildSignature()
+{
+#define OPCODE_SIGNATURE(opcode, length) #opcode #length
+    static const char opcodeTable[] = FOR_EACH_OPCODE_ID(OPCODE_SIGNATURE);
+#undef OPCODE_SIGNATURE
+    static uint32_t signature;
+    if (signature)
+        return signature;
+
+    uint32_t layout[] = {
+        sizeof(UnlinkedInstruction),
+        sizeof(UnlinkedHandlerInfo),
+        sizeof(ExpressionRangeInfo),
+        sizeof(ExpressionRangeInfo::FatPosition),
+        static_cast<uint32_t>(FirstConstantRegisterIndex)
+    };
+    SHA1 sha1;
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(opcodeTable), sizeof(opcodeTable));
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(layout), sizeof(layout));
+    Vector<uint8_t, 20> digest;
+    sha1.computeHash(digest);
+    signature = digest[0] | (digest[1] << 8) | (digest[2] << 16) | (digest[3] << 24);
+    if (!signature)
+        signature = 1;
+    return signature;
+}
+
+// Code generated for the debugger or the profiler must never be reused without them. Walking
+// the stream also rejects instructions that do not decode with this build's opcode lengths.
+static bool isCacheableInstructionStream(const UnlinkedInstruction* instructions, size_t size)
+{
+    size_t index = 0;
+    while (index < size) {
+        int opcode = instructions[index].u.operand;
+        if (opcode < 0 || opcode >= numOpcodeIDs)
+            return false;
+        OpcodeID opcodeID = static_cast<OpcodeID>(opcode);
+        if (opcodeID == op_debug || opcodeID == op_profile_will_call || opcodeID == op_profile_did_call)
+            return false;
+        index += opcodeLength(opcodeID);
+    }
+    return index == size;
+}
+
+CodeCacheFile::CodeCacheFile()
+    : m_data(0)
+    , m_size(0)
+    , m_isMapped(false)
+{
+}
+
+CodeCacheFile::~CodeCacheFile()
+{
+#if HAVE(MMAP)
+    if (m_isMapped)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
+
+PassRefPtr<CodeCacheFile> CodeCacheFile::open(const String& path)
+{
+    CString fileSystemPath = path.utf8();
+    RefPtr<CodeCacheFile> file = adoptRef(new CodeCacheFile);
+#if HAVE(MMAP)
+    int fd = ::open(fileSystemPath.data(), O_RDONLY);
+    if (fd == -1)
+        return 0;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) || fileStat.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return 0;
+    file->m_data = static_cast<const uint8_t*>(data);
+    file->m_size = fileStat.st_size;
+    file->m_isMapped = true;
+#else
+    FILE* handle = fopen(fileSystemPath.data(), "rb");
+    if (!handle)
+        return 0;
+    long size = -1;
+    if (!fseek(handle, 0, SEEK_END))
+        size = ftell(handle);
+    if (size <= 0 || fseek(handle, 0, SEEK_SET)) {
+        fclose(handle);
+        return 0;
+    }
+    file->m_buffer.resize(size);
+    size_t bytesRead = fread(file->m_buffer.data(), 1, size, handle);
+    fclose(handle);
+    if (bytesRead != static_cast<size_t>(size))
+        return 0;
+    file->m_data = file->m_buffer.data();
+    file->m_size = file->m_buffer.size();
+#endif
+    return file.release();
+}
+
+PassRefPtr<CodeCacheFile> CodeCacheFile::adopt(Vector<uint8_t>& buffer)
+{
+    RefPtr<CodeCacheFile> file = adoptRef(new CodeCacheFile);
+    file->m_buffer.swap(buffer);
+    file->m_data = file->m_buffer.data();
+    file->m_size = file->m_buffer.size();
+    return file.release();
+}
+
+// Encodes the code block blobs that go after the end of the previous version of a file.
+// Children are written before their parents, so a blob only refers to offsets that are already
+// known. Executables whose code block is in the previous file, unchanged, keep their offset.
+class CodeCacheEncoder {
+    WTF_MAKE_NONCOPYABLE(CodeCacheEncoder); WTF_MAKE_FAST_ALLOCATED;
+public:
+    CodeCacheEncoder(Vector<uint8_t>& buffer, size_t baseOffset, CodeCacheFile* previousFile)
+        : m_buffer(buffer)
+        , m_baseOffset(baseOffset)
+        , m_previousFile(previousFile)
+        , m_unreferencedBytes(0)
+    {
+    }
+
+    bool encodeProgramCodeBlock(UnlinkedProgramCodeBlock*, unsigned previousOffset, unsigned& offset);
+
+    // The size of the blobs of the previous file that the new ones replace.
+    size_t unreferencedBytes() const { return m_unreferencedBytes; }
+
+    // Points the executables that were visited at the file that now holds their code.
+    void didWrite(CodeCacheFile*);
+
+private:
+    struct ExecutableOffsets {
+        ExecutableOffsets()
+            : codeBlockForCall(0)
+            , codeBlockForConstruct(0)
+            , changed(false)
+        {
+        }
+
+        unsigned codeBlockForCall;
+        unsigned codeBlockForConstruct;
+        bool changed;
+    };
+
+    typedef Vector<UnlinkedFunctionExecutable*> ExecutableTable;
+    typedef HashMap<UnlinkedFunctionExecutable*, unsigned> ExecutableIndexMap;
+
+    unsigned previousOffset(UnlinkedFunctionExecutable*, CodeSpecializationKind);
+    bool encodeExecutableCode(UnlinkedFunctionExecutable*);
+    bool encodeFunctionCodeBlock(UnlinkedFunctionCodeBlock*, unsigned previousOffset, unsigned& offset);
+    bool encodeExecutables(const ExecutableTable&);
+    bool encodeCodeBlock(UnlinkedCodeBlock*, const ExecutableTable&, const ExecutableIndexMap&);
+    bool encodeExecutable(UnlinkedFunctionExecutable*);
+    bool encodeConstant(UnlinkedCodeBlock*, JSValue, bool inConstantBuffer);
+    static void addExecutable(UnlinkedFunctionExecutable*, ExecutableTable&, ExecutableIndexMap&);
+    static void collectExecutables(UnlinkedCodeBlock*, ExecutableTable&, ExecutableIndexMap&);
+
+    void encode(uint32_t value) { encodeBytes(&value, sizeof(value)); }
+    void encode(int32_t value) { encodeBytes(&value, sizeof(value)); }
+    void encode(double value) { encodeBytes(&value, sizeof(value)); }
+    void encodeBytes(const void* data, size_t size) { m_buffer.append(static_cast<const uint8_t*>(data), size); }
+    template<typename T> void encodeArray(const T* data, size_t size)
+    {
+        encode(static_cast<uint32_t>(size));
+        encodeBytes(data, size * sizeof(T));
+    }
+    void encode(const String&);
+    bool encode(const Identifier&);
+
+    size_t beginBlob();
+    void endBlob(size_t start);
+    void didReplaceBlob(unsigned previousOffset);
+
+    Vector<uint8_t>& m_buffer;
+    size_t m_baseOffset;
+    CodeCacheFile* m_previousFile;
+    size_t m_unreferencedBytes;
+    HashMap<UnlinkedFunctionExecutable*, ExecutableOffsets> m_executableOffsets;
+};
+
+size_t CodeCacheEncoder::beginBlob()
+{
+    size_t start = m_buffer.size();
+    m_buffer.grow(start + sizeof(BlobHeader));
+    return start;
+}
+
+void CodeCacheEncoder::endBlob(size_t start)
+{
+    while ((m_buffer.size() - start) % 4)
+        m_buffer.append(0);
+    BlobHeader header;
+    size_t payloadStart = start + sizeof(header);
+    header.size = static_cast<uint32_t>(m_buffer.size() - payloadStart);
+    header.checksum = checksum(m_buffer.data() + payloadStart, header.size);
+    memcpy(m_buffer.data() + start, &header, sizeof(header));
+}
+
+void CodeCacheEncoder::didReplaceBlob(unsigned previousOffset)
+{
+    if (!previousOffset || !m_previousFile || previousOffset > m_previousFile->size() - sizeof(BlobHeader))
+        return;
+    BlobHeader header;
+    memcpy(&header, m_previousFile->data() + previousOffset, sizeof(header));
+    m_unreferencedBytes += sizeof(header) + std::min<size_t>(header.size, m_previousFile->size() - previousOffset - sizeof(header));
+}
+
+void CodeCacheEncoder::encode(const String& string)
+{
+    if (string.isNull()) {
+        encode(nullStringLength);
+        return;
+    }
+    encode(static_cast<uint32_t>(string.length() << 1 | string.is8Bit()));
+    if (string.is8Bit())
+        encodeBytes(string.characters8(), string.length() * sizeof(LChar));
+    else
+        encodeBytes(string.characters16(), string.length() * sizeof(UChar));
+}
+
+bool CodeCacheEncoder::encode(const Identifier& identifier)
+{
+    // Private names are unique by identity, which does not survive a round trip through a file.
+    if (!identifier.isNull() && identifier.impl()->isEmptyUnique())
+        return false;
+    encode(identifier.string());
+    return true;
+}
+
+unsigned CodeCacheEncoder::previousOffset(UnlinkedFunctionExecutable* executable, CodeSpecializationKind kind)
+{
+    if (!m_previousFile || executable->m_cacheFile != m_previousFile)
+        return 0;
+    return kind == CodeForCall ? executable->m_cachedCodeBlockOffsetForCall : executable->m_cachedCodeBlockOffsetForConstruct;
+}
+
+// Returns whether the offsets recorded for the executable differ from the previous file's.
+bool CodeCacheEncoder::encodeExecutableCode(UnlinkedFunctionExecutable* executable)
+{
+    HashMap<UnlinkedFunctionExecutable*, ExecutableOffsets>::AddResult result = m_executableOffsets.add(executable, ExecutableOffsets());
+    if (!result.isNewEntry)
+        return result.iterator->value.changed;
+
+    unsigned previousCall = previousOffset(executable, CodeForCall);
+    unsigned previousConstruct = previousOffset(executable, CodeForConstruct);
+    ExecutableOffsets offsets;
+    offsets.codeBlockForCall = previousCall;
+    offsets.codeBlockForConstruct = previousConstruct;
+    if (UnlinkedFunctionCodeBlock* codeBlock = executable->m_codeBlockForCall.get()) {
+        if (!encodeFunctionCodeBlock(codeBlock, previousCall, offsets.codeBlockForCall))
+            offsets.codeBlockForCall = previousCall;
+    }
+    if (UnlinkedFunctionCodeBlock* codeBlock = executable->m_codeBlockForConstruct.get()) {
+        if (!encodeFunctionCodeBlock(codeBlock, previousConstruct, offsets.codeBlockForConstruct))
+            offsets.codeBlockForConstruct = previousConstruct;
+    }
+    offsets.changed = offsets.codeBlockForCall != previousCall || offsets.codeBlockForConstruct != previousConstruct;
+
+    // The recursion may have rehashed the map.
+    m_executableOffsets.set(executable, offsets);
+    return offsets.changed;
+}
+
+bool CodeCacheEncoder::encodeExecutables(const ExecutableTable& executables)
+{
+    bool changed = false;
+    for (size_t i = 0; i < executables.size(); ++i) {
+        if (encodeExecutableCode(executables[i]))
+            changed = true;
+    }
+    return changed;
+}
+
+void CodeCacheEncoder::addExecutable(UnlinkedFunctionExecutable* executable, ExecutableTable& executables, ExecutableIndexMap& indices)
+{
+    if (indices.add(executable, executables.size()).isNewEntry)
+        executables.append(executable);
+}
+
+void CodeCacheEncoder::collectExecutables(UnlinkedCodeBlock* codeBlock, ExecutableTable& executables, ExecutableIndexMap& indices)
+{
+    for (size_t i = 0; i < codeBlock->numberOfFunctionDecls(); ++i)
+        addExecutable(codeBlock->functionDecl(i), executables, indices);
+    for (size_t i = 0; i < codeBlock->numberOfFunctionExprs(); ++i)
+        addExecutable(codeBlock->functionExpr(i), executables, indices);
+}
+
+bool CodeCacheEncoder::encodeFunctionCodeBlock(UnlinkedFunctionCodeBlock* codeBlock, unsigned previousOffset, unsigned& offset)
+{
+    if (!isCacheableInstructionStream(codeBlock->instructions().data(), codeBlock->instructions().size()))
+        return false;
+
+    ExecutableTable executables;
+    ExecutableIndexMap indices;
+    collectExecutables(codeBlock, executables, indices);
+    bool changed = encodeExecutables(executables);
+    if (!changed && previousOffset) {
+        offset = previousOffset;
+        return true;
+    }
+
+    size_t start = beginBlob();
+    if (!encodeCodeBlock(codeBlock, executables, indices)) {
+        m_buffer.shrink(start);
+        return false;
+    }
+    endBlob(start);
+    didReplaceBlob(previousOffset);
+    offset = static_cast<unsigned>(m_baseOffset + start);
+    return true;
+}
+
+bool CodeCacheEncoder::encodeProgramCodeBlock(UnlinkedProgramCodeBlock* codeBlock, unsigned previousOffset, unsigned& offset)
+{
+    if (!isCacheableInstructionStream(codeBlock->instructions().data(), codeBlock->instructions().size()))
+        return false;
+
+    ExecutableTable executables;
+    ExecutableIndexMap indices;
+    collectExecutables(codeBlock, executables, indices);
+    const UnlinkedProgramCodeBlock::FunctionDeclations& functionDeclarations = codeBlock->functionDeclarations();
+    for (size_t i = 0; i < functionDeclarations.size(); ++i)
+        addExecutable(functionDeclarations[i].second.get(), executables, indices);
+
+    bool changed = encodeExecutables(executables);
+    if (!changed && previousOffset) {
+        offset = previousOffset;
+        return true;
+    }
+
+    size_t start = beginBlob();
+    if (!encodeCodeBlock(codeBlock, executables, indices)) {
+        m_buffer.shrink(start);
+        return false;
+    }
+
+    const UnlinkedProgramCodeBlock::VariableDeclations& variableDeclarations = codeBlock->variableDeclarations();
+    encode(static_cast<uint32_t>(variableDeclarations.size()));
+    for (size_t i = 0; i < variableDeclarations.size(); ++i) {
+        if (!encode(variableDeclarations[i].first)) {
+            m_buffer.shrink(start);
+            return false;
+        }
+        encode(static_cast<uint32_t>(variableDeclarations[i].second));
+    }
+    encode(static_cast<uint32_t>(functionDeclarations.size()));
+    for (size_t i = 0; i < functionDeclarations.size(); ++i) {
+        if (!encode(functionDeclarations[i].first)) {
+            m_buffer.shrink(start);
+            return false;
+        }
+        encode(indices.get(functionDeclarations[i].second.get()));
+    }
+
+    endBlob(start);
+    didReplaceBlob(previousOffset);
+    offset = static_cast<unsigned>(m_baseOffset + start);
+    return true;
+}
+
+bool CodeCacheEncoder::encodeExecutable(UnlinkedFunctionExecutable* executable)
+{
+    if (!encode(executable->m_name) || !encode(executable->m_inferredName))
+        return false;
+
+    FunctionParameters* parameters = executable->m_parameters.get();
+    encode(static_cast<uint32_t>(parameters->size()));
+    for (unsigned i = 0; i < parameters->size(); ++i) {
+        if (!encode(parameters->at(i)))
+            return false;
+    }
+
+    uint32_t flags = 0;
+    if (executable->m_forceUsesArguments)
+        flags |= ForceUsesArgumentsFlag;
+    if (executable->m_isInStrictContext)
+        flags |= IsInStrictContextFlag;
+    if (executable->m_hasCapturedVariables)
+        flags |= ExecutableHasCapturedVariablesFlag;
+    encode(flags);
+    encode(static_cast<uint32_t>(executable->m_numCapturedVariables));
+    encode(static_cast<uint32_t>(executable->m_firstLineOffset));
+    encode(static_cast<uint32_t>(executable->m_lineCount));
+    encode(static_cast<uint32_t>(executable->m_functionStartOffset));
+    encode(static_cast<uint32_t>(executable->m_functionStartColumn));
+    encode(static_cast<uint32_t>(executable->m_startOffset));
+    encode(static_cast<uint32_t>(executable->m_sourceLength));
+    encode(static_cast<uint32_t>(executable->m_features));
+    encode(static_cast<uint32_t>(executable->m_functionNameIsInScopeToggle));
+
+    ExecutableOffsets offsets = m_executableOffsets.get(executable);
+    encode(offsets.codeBlockForCall);
+    encode(offsets.codeBlockForConstruct);
+    return true;
+}
+
+bool CodeCacheEncoder::encodeConstant(UnlinkedCodeBlock* codeBlock, JSValue value, bool inConstantBuffer)
+{
+    if (value.isEmpty()) {
+        encode(static_cast<uint32_t>(EmptyConstant));
+        return true;
+    }
+    if (value.isUndefined()) {
+        encode(static_cast<uint32_t>(UndefinedConstant));
+        return true;
+    }
+    if (value.isNull()) {
+        encode(static_cast<uint32_t>(NullConstant));
+        return true;
+    }
+    if (value.isBoolean()) {
+        encode(static_cast<uint32_t>(value.asBoolean() ? TrueConstant : FalseConstant));
+        return true;
+    }
+    if (value.isInt32()) {
+        encode(static_cast<uint32_t>(Int32Constant));
+        encode(static_cast<int32_t>(value.asInt32()));
+        return true;
+    }
+    if (value.isDouble()) {
+        encode(static_cast<uint32_t>(DoubleConstant));
+        encode(value.asDouble());
+        return true;
+    }
+    if (!value.isString())
+        return false;
+
+    if (inConstantBuffer) {
+        // Array literals share the string cells of the constant pool.
+        const Vector<WriteBarrier<Unknown> >& constants = codeBlock->constantRegisters();
+        for (size_t i = 0; i < constants.size(); ++i) {
+            if (constants[i].get() == value) {
+                encode(static_cast<uint32_t>(ConstantRegisterStringConstant));
+                encode(static_cast<uint32_t>(i));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const String& string = asString(value)->tryGetValue();
+    if (string.isNull())
+        return false;
+    encode(static_cast<uint32_t>(StringConstant));
+    encode(string);
+    return true;
+}
+
+bool CodeCacheEncoder::encodeCodeBlock(UnlinkedCodeBlock* codeBlock, const ExecutableTable& executables, const ExecutableIndexMap& indices)
+{
+    encode(static_cast<uint32_t>(codeBlock->m_codeType));
+    uint32_t flags = 0;
+    if (codeBlock->m_needsFullScopeChain)
+        flags |= NeedsFullScopeChainFlag;
+    if (codeBlock->m_usesEval)
+        flags |= UsesEvalFlag;
+    if (codeBlock->m_isNumericCompareFunction)
+        flags |= IsNumericCompareFunctionFlag;
+    if (codeBlock->m_isStrictMode)
+        flags |= IsStrictModeFlag;
+    if (codeBlock->m_isConstructor)
+        flags |= IsConstructorFlag;
+    if (codeBlock->m_hasCapturedVariables)
+        flags |= HasCapturedVariablesFlag;
+    encode(flags);
+
+    encode(static_cast<int32_t>(codeBlock->m_numParameters));
+    encode(static_cast<int32_t>(codeBlock->m_thisRegister));
+    encode(static_cast<int32_t>(codeBlock->m_argumentsRegister));
+    encode(static_cast<int32_t>(codeBlock->m_activationRegister));
+    encode(static_cast<int32_t>(codeBlock->m_globalObjectRegister));
+    encode(static_cast<int32_t>(codeBlock->m_numVars));
+    encode(static_cast<int32_t>(codeBlock->m_numCapturedVars));
+    encode(static_cast<int32_t>(codeBlock->m_numCalleeRegisters));
+    encode(static_cast<uint32_t>(codeBlock->m_firstLine));
+    encode(static_cast<uint32_t>(codeBlock->m_lineCount));
+    encode(static_cast<uint32_t>(codeBlock->m_features));
+    encode(static_cast<uint32_t>(codeBlock->m_arrayProfileCount));
+    encode(static_cast<uint32_t>(codeBlock->m_arrayAllocationProfileCount));
+    encode(static_cast<uint32_t>(codeBlock->m_objectAllocationProfileCount));
+    encode(static_cast<uint32_t>(codeBlock->m_valueProfileCount));
+    encode(static_cast<uint32_t>(codeBlock->m_llintCallLinkInfoCount));
+
+    encodeArray(codeBlock->m_unlinkedInstructions.data(), codeBlock->m_unlinkedInstructions.size());
+    encodeArray(codeBlock->m_jumpTargets.data(), codeBlock->m_jumpTargets.size());
+    encodeArray(codeBlock->m_propertyAccessInstructions.data(), codeBlock->m_propertyAccessInstructions.size());
+
+    encode(static_cast<uint32_t>(codeBlock->m_identifiers.size()));
+    for (size_t i = 0; i < codeBlock->m_identifiers.size(); ++i) {
+        if (!encode(codeBlock->m_identifiers[i]))
+            return false;
+    }
+
+    encode(static_cast<uint32_t>(codeBlock->m_constantRegisters.size()));
+    for (size_t i = 0; i < codeBlock->m_constantRegisters.size(); ++i) {
+        if (!encodeConstant(codeBlock, codeBlock->m_constantRegisters[i].get(), false))
+            return false;
+    }
+
+    encode(static_cast<uint32_t>(executables.size()));
+    for (size_t i = 0; i < executables.size(); ++i) {
+        if (!encodeExecutable(executables[i]))
+            return false;
+    }
+    encode(static_cast<uint32_t>(codeBlock->m_functionDecls.size()));
+    for (size_t i = 0; i < codeBlock->m_functionDecls.size(); ++i)
+        encode(indices.get(codeBlock->m_functionDecls[i].get()));
+    encode(static_cast<uint32_t>(codeBlock->m_functionExprs.size()));
+    for (size_t i = 0; i < codeBlock->m_functionExprs.size(); ++i)
+        encode(indices.get(codeBlock->m_functionExprs[i].get()));
+
+    SharedSymbolTable* symbolTable = codeBlock->m_symbolTable.get();
+    encode(static_cast<uint32_t>(!!symbolTable));
+    if (symbolTable) {
+        ConcurrentJITLocker locker(symbolTable->m_lock);
+        encode(static_cast<uint32_t>(symbolTable->size(locker)));
+        SymbolTable::Map::iterator end = symbolTable->end(locker);
+        for (SymbolTable::Map::iterator it = symbolTable->begin(locker); it != end; ++it) {
+            bool wasFat;
+            SymbolTableEntry::Fast entry = it->value.getFast(wasFat);
+            // Watchpoints belong to this run.
+            if (wasFat || it->key->isEmptyUnique())
+                return false;
+            encode(String(it->key.get()));
+            encode(static_cast<int32_t>(entry.getIndex()));
+            encode(static_cast<uint32_t>(entry.getAttributes()));
+        }
+        encode(static_cast<int32_t>(symbolTable->parameterCountIncludingThis()));
+        encode(static_cast<uint32_t>(symbolTable->usesNonStrictEval()));
+        encode(static_cast<int32_t>(symbolTable->captureStart()));
+        encode(static_cast<int32_t>(symbolTable->captureEnd()));
+        const SlowArgument* slowArguments = symbolTable->slowArguments();
+        encode(static_cast<uint32_t>(!!slowArguments));
+        if (slowArguments) {
+            for (int i = 0; i < symbolTable->parameterCount(); ++i) {
+                encode(static_cast<uint32_t>(slowArguments[i].status));
+                encode(static_cast<int32_t>(slowArguments[i].index));
+            }
+        }
+    }
+
+    UnlinkedCodeBlock::RareData* rareData = codeBlock->m_rareData.get();
+    encode(static_cast<uint32_t>(!!rareData));
+    if (rareData) {
+        encodeArray(rareData->m_exceptionHandlers.data(), rareData->m_exceptionHandlers.size());
+
+        encode(static_cast<uint32_t>(rareData->m_regexps.size()));
+        for (size_t i = 0; i < rareData->m_regexps.size(); ++i) {
+            RegExp* regExp = rareData->m_regexps[i].get();
+            uint32_t regExpFlags = NoFlags;
+            if (regExp->global())
+                regExpFlags |= FlagGlobal;
+            if (regExp->ignoreCase())
+                regExpFlags |= FlagIgnoreCase;
+            if (regExp->multiline())
+                regExpFlags |= FlagMultiline;
+            encode(regExp->pattern());
+            encode(regExpFlags);
+        }
+
+        encode(static_cast<uint32_t>(rareData->m_constantBuffers.size()));
+        for (size_t i = 0; i < rareData->m_constantBuffers.size(); ++i) {
+            const UnlinkedCodeBlock::ConstantBuffer& buffer = rareData->m_constantBuffers[i];
+            encode(static_cast<uint32_t>(buffer.size()));
+            for (size_t j = 0; j < buffer.size(); ++j) {
+                if (!encodeConstant(codeBlock, buffer[j], true))
+                    return false;
+            }
+        }
+
+        encode(static_cast<uint32_t>(rareData->m_switchJumpTables.size()));
+        for (size_t i = 0; i < rareData->m_switchJumpTables.size(); ++i) {
+            const UnlinkedSimpleJumpTable& table = rareData->m_switchJumpTables[i];
+            encode(static_cast<int32_t>(table.min));
+            encodeArray(table.branchOffsets.data(), table.branchOffsets.size());
+        }
+
+        encode(static_cast<uint32_t>(rareData->m_stringSwitchJumpTables.size()));
+        for (size_t i = 0; i < rareData->m_stringSwitchJumpTables.size(); ++i) {
+            const UnlinkedStringJumpTable::StringOffsetTable& table = rareData->m_stringSwitchJumpTables[i].offsetTable;
+            encode(static_cast<uint32_t>(table.size()));
+            UnlinkedStringJumpTable::StringOffsetTable::const_iterator end = table.end();
+            for (UnlinkedStringJumpTable::StringOffsetTable::const_iterator it = table.begin(); it != end; ++it) {
+                encode(String(it->key.get()));
+                encode(static_cast<int32_t>(it->value));
+            }
+        }
+
+        encodeArray(rareData->m_expressionInfoFatPositions.data(), rareData->m_expressionInfoFatPositions.size());
+    }
+
+    const Vector<ExpressionRangeInfo>& expressionInfo = codeBlock->m_expressionInfo.data();
+    encodeArray(expressionInfo.data(), expressionInfo.size());
+    return true;
+}
+
+void CodeCacheEncoder::didWrite(CodeCacheFile* file)
+{
+    HashMap<UnlinkedFunctionExecutable*, ExecutableOffsets>::iterator end = m_executableOffsets.end();
+    for (HashMap<UnlinkedFunctionExecutable*, ExecutableOffsets>::iterator it = m_executableOffsets.begin(); it != end; ++it) {
+        UnlinkedFunctionExecutable* executable = it->key;
+        executable->m_cacheFile = file;
+        executable->m_cachedCodeBlockOffsetForCall = it->value.codeBlockForCall;
+        executable->m_cachedCodeBlockOffsetForConstruct = it->value.codeBlockForConstruct;
+    }
+}
+
+// Reads blobs back into unlinked code blocks. Every read is bounds checked and a malformed
+// blob fails the whole decode, which callers treat like a cache miss.
+class CodeCacheDecoder {
+    WTF_MAKE_NONCOPYABLE(CodeCacheDecoder);
+public:
+    CodeCacheDecoder(VM& vm, CodeCacheFile* file)
+        : m_vm(vm)
+        , m_file(file)
+        , m_position(0)
+        , m_end(0)
+    {
+    }
+
+    UnlinkedProgramCodeBlock* decodeProgramCodeBlock(unsigned offset);
+    UnlinkedFunctionCodeBlock* decodeFunctionCodeBlock(unsigned offset, CodeSpecializationKind);
+
+private:
+    bool enterBlob(unsigned offset);
+    bool decodeCodeBlockHeader(CodeType expectedCodeType, uint32_t& flags);
+    bool decodeCodeBlock(UnlinkedCodeBlock*, uint32_t flags, MarkedArgumentBuffer& executables);
+    UnlinkedFunctionExecutable* decodeExecutable();
+    bool decodeConstant(UnlinkedCodeBlock*, JSValue&, bool inConstantBuffer);
+
+    size_t remaining() const { return m_end - m_position; }
+    bool decodeBytes(void* data, size_t size)
+    {
+        if (size > remaining())
+            return false;
+        memcpy(data, m_file->data() + m_position, size);
+        m_position += size;
+        return true;
+    }
+    bool decode(uint32_t& value) { return decodeBytes(&value, sizeof(value)); }
+    bool decode(int32_t& value) { return decodeBytes(&value, sizeof(value)); }
+    bool decode(double& value) { return decodeBytes(&value, sizeof(value)); }
+    bool decode(String&);
+    bool decode(Identifier&);
+    // Rejects counts the remaining bytes cannot possibly hold before anything is allocated.
+    bool decodeCount(uint32_t& count, size_t minimumElementSize)
+    {
+        return decode(count) && (!minimumElementSize || count <= remaining() / minimumElementSize);
+    }
+    template<typename T> bool decodeArray(Vector<T>& vector)
+    {
+        uint32_t size;
+        if (!decodeCount(size, sizeof(T)))
+            return false;
+        vector.resize(size);
+        return decodeBytes(vector.data(), size * sizeof(T));
+    }
+    UnlinkedFunctionExecutable* executableAt(MarkedArgumentBuffer& executables, uint32_t index)
+    {
+        if (index >= static_cast<uint32_t>(executables.size()))
+            return 0;
+        return jsCast<UnlinkedFunctionExecutable*>(executables.at(index));
+    }
+
+    VM& m_vm;
+    CodeCacheFile* m_file;
+    size_t m_position;
+    // The end of the blob being decoded.
+    size_t m_end;
+};
+
+bool CodeCacheDecoder::enterBlob(unsigned offset)
+{
+    BlobHeader header;
+    if (offset < sizeof(FileHeader) || offset > m_file->size() - sizeof(header))
+        return false;
+    memcpy(&header, m_file->data() + offset, sizeof(header));
+    size_t start = offset + sizeof(header);
+    if (header.size > m_file->size() - start || header.size % 4 || checksum(m_file->data() + start, header.size) != header.checksum)
+        return false;
+    m_position = start;
+    m_end = start + header.size;
+    return true;
+}
+
+bool CodeCacheDecoder::decode(String& string)
+{
+    uint32_t lengthAndFlag;
+    if (!decode(lengthAndFlag))
+        return false;
+    if (lengthAndFlag == nullStringLength) {
+        string = String();
+        return true;
+    }
+    unsigned length = lengthAndFlag >> 1;
+    if (lengthAndFlag & 1) {
+        if (length > remaining())
+            return false;
+        LChar* characters;
+        string = String::createUninitialized(length, characters);
+        return decodeBytes(characters, length * sizeof(LChar));
+    }
+    if (length > remaining() / sizeof(UChar))
+        return false;
+    UChar* characters;
+    string = String::createUninitialized(length, characters);
+    return decodeBytes(characters, length * sizeof(UChar));
+}
+
+bool CodeCacheDecoder::decode(Identifier& identifier)
+{
+    String string;
+    if (!decode(string))
+        return false;
+    identifier = string.isNull() ? Identifier() : Identifier(&m_vm, string);
+    return true;
+}
+
+bool CodeCacheDecoder::decodeCodeBlockHeader(CodeType expectedCodeType, uint32_t& flags)
+{
+    uint32_t codeType;
+    return decode(codeType) && codeType == static_cast<uint32_t>(expectedCodeType) && decode(flags);
+}
+
+UnlinkedProgramCodeBlock* CodeCacheDecoder::decodeProgramCodeBlock(unsigned offset)
+{
+    uint32_t flags;
+    if (!enterBlob(offset) || !decodeCodeBlockHeader(GlobalCode, flags))
+        return 0;
+
+    ExecutableInfo info(flags & NeedsFullScopeChainFlag, flags & UsesEvalFlag, flags & IsStrictModeFlag, false);
+    UnlinkedProgramCodeBlock* codeBlock = UnlinkedProgramCodeBlock::create(&m_vm, info);
+    MarkedArgumentBuffer executables;
+    if (!decodeCodeBlock(codeBlock, flags, executables))
+        return 0;
+
+    uint32_t count;
+    if (!decodeCount(count, 2 * sizeof(uint32_t)))
+        return 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Identifier name;
+        uint32_t isConstant;
+        if (!decode(name) || !decode(isConstant))
+            return 0;
+        codeBlock->addVariableDeclaration(name, isConstant);
+    }
+    if (!decodeCount(count, 2 * sizeof(uint32_t)))
+        return 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Identifier name;
+        uint32_t index;
+        if (!decode(name) || !decode(index))
+            return 0;
+        UnlinkedFunctionExecutable* executable = executableAt(executables, index);
+        if (!executable)
+            return 0;
+        codeBlock->addFunctionDeclaration(m_vm, name, executable);
+    }
+
+    codeBlock->shrinkToFit();
+    return codeBlock;
+}
+
+UnlinkedFunctionCodeBlock* CodeCacheDecoder::decodeFunctionCodeBlock(unsigned offset, CodeSpecializationKind kind)
+{
+    uint32_t flags;
+    if (!enterBlob(offset) || !decodeCodeBlockHeader(FunctionCode, flags))
+        return 0;
+    if (!!(flags & IsConstructorFlag) != (kind == CodeForConstruct))
+        return 0;
+
+    ExecutableInfo info(flags & NeedsFullScopeChainFlag, flags & UsesEvalFlag, flags & IsStrictModeFlag, flags & IsConstructorFlag);
+    UnlinkedFunctionCodeBlock* codeBlock = UnlinkedFunctionCodeBlock::create(&m_vm, FunctionCode, info);
+    MarkedArgumentBuffer executables;
+    if (!decodeCodeBlock(codeBlock, flags, executables))
+        return 0;
+
+    codeBlock->shrinkToFit();
+    return codeBlock;
+}
+
+UnlinkedFunctionExecutable* CodeCacheDecoder::decodeExecutable()
+{
+    Identifier name;
+    Identifier inferredName;
+    if (!decode(name) || !decode(inferredName))
+        return 0;
+
+    uint32_t parameterCount;
+    if (!decodeCount(parameterCount, sizeof(uint32_t)))
+        return 0;
+    Vector<Identifier> parameters(parameterCount);
+    for (uint32_t i = 0; i < parameterCount; ++i) {
+        if (!decode(parameters[i]))
+            return 0;
+    }
+
+    uint32_t flags;
+    uint32_t numCapturedVariables;
+    uint32_t firstLineOffset;
+    uint32_t lineCount;
+    uint32_t functionStartOffset;
+    uint32_t functionStartColumn;
+    uint32_t startOffset;
+    uint32_t sourceLength;
+    uint32_t features;
+    uint32_t functionNameIsInScopeToggle;
+    uint32_t codeBlockOffsetForCall;
+    uint32_t codeBlockOffsetForConstruct;
+    if (!decode(flags)
+        || !decode(numCapturedVariables)
+        || !decode(firstLineOffset)
+        || !decode(lineCount)
+        || !decode(functionStartOffset)
+        || !decode(functionStartColumn)
+        || !decode(startOffset)
+        || !decode(sourceLength)
+        || !decode(features)
+        || !decode(functionNameIsInScopeToggle)
+        || !decode(codeBlockOffsetForCall)
+        || !decode(codeBlockOffsetForConstruct))
+        return 0;
+    if (functionNameIsInScopeToggle != FunctionNameIsInScope && functionNameIsInScopeToggle != FunctionNameIsNotInScope)
+        return 0;
+
+    UnlinkedFunctionExecutable* executable = new (NotNull, allocateCell<UnlinkedFunctionExecutable>(m_vm.heap)) UnlinkedFunctionExecutable(&m_vm, m_vm.unlinkedFunctionExecutableStructure.get());
+    executable->m_numCapturedVariables = numCapturedVariables;
+    executable->m_forceUsesArguments = flags & ForceUsesArgumentsFlag;
+    executable->m_isInStrictContext = flags & IsInStrictContextFlag;
+    executable->m_hasCapturedVariables = flags & ExecutableHasCapturedVariablesFlag;
+    executable->m_name = name;
+    executable->m_inferredName = inferredName;
+    executable->m_parameters = FunctionParameters::create(parameters);
+    executable->m_firstLineOffset = firstLineOffset;
+    executable->m_lineCount = lineCount;
+    executable->m_functionStartOffset = functionStartOffset;
+    executable->m_functionStartColumn = functionStartColumn;
+    executable->m_startOffset = startOffset;
+    executable->m_sourceLength = sourceLength;
+    executable->m_features = features;
+    executable->m_functionNameIsInScopeToggle = static_cast<FunctionNameIsInScopeToggle>(functionNameIsInScopeToggle);
+    executable->m_cacheFile = m_file;
+    executable->m_cachedCodeBlockOffsetForCall = codeBlockOffsetForCall;
+    executable->m_cachedCodeBlockOffsetForConstruct = codeBlockOffsetForConstruct;
+    executable->finishCreation(m_vm);
+    return executable;
+}
+
+bool CodeCacheDecoder::decodeConstant(UnlinkedCodeBlock* codeBlock, JSValue& value, bool inConstantBuffer)
+{
+    uint32_t tag;
+    if (!decode(tag))
+        return false;
+
+    switch (tag) {
+    case EmptyConstant:
+        value = JSValue();
+        return true;
+    case UndefinedConstant:
+        value = jsUndefined();
+        return true;
+    case NullConstant:
+        value = jsNull();
+        return true;
+    case TrueConstant:
+        value = jsBoolean(true);
+        return true;
+    case FalseConstant:
+        value = jsBoolean(false);
+        return true;
+    case Int32Constant: {
+        int32_t number;
+        if (!decode(number))
+            return false;
+        value = jsNumber(number);
+        return true;
+    }
+    case DoubleConstant: {
+        double number;
+        if (!decode(number))
+            return false;
+        value = JSValue(JSValue::EncodeAsDouble, number);
+        return true;
+    }
+    case StringConstant: {
+        String string;
+        if (inConstantBuffer || !decode(string) || string.isNull())
+            return false;
+        value = jsOwnedString(&m_vm, Identifier(&m_vm, string).string());
+        return true;
+    }
+    case ConstantRegisterStringConstant: {
+        uint32_t index;
+        if (!inConstantBuffer || !decode(index) || index >= codeBlock->numberOfConstantRegisters())
+            return false;
+        value = codeBlock->constantRegisters()[index].get();
+        return value.isString();
+    }
+    }
+    return false;
+}
+
+bool CodeCacheDecoder::decodeCodeBlock(UnlinkedCodeBlock* codeBlock, uint32_t flags, MarkedArgumentBuffer& executables)
+{
+    codeBlock->m_isNumericCompareFunction = flags & IsNumericCompareFunctionFlag;
+    codeBlock->m_hasCapturedVariables = flags & HasCapturedVariablesFlag;
+
+    uint32_t features;
+    if (!decode(codeBlock->m_numParameters)
+        || !decode(codeBlock->m_thisRegister)
+        || !decode(codeBlock->m_argumentsRegister)
+        || !decode(codeBlock->m_activationRegister)
+        || !decode(codeBlock->m_globalObjectRegister)
+        || !decode(codeBlock->m_numVars)
+        || !decode(codeBlock->m_numCapturedVars)
+        || !decode(codeBlock->m_numCalleeRegisters)
+        || !decode(codeBlock->m_firstLine)
+        || !decode(codeBlock->m_lineCount)
+        || !decode(features)
+        || !decode(codeBlock->m_arrayProfileCount)
+        || !decode(codeBlock->m_arrayAllocationProfileCount)
+        || !decode(codeBlock->m_objectAllocationProfileCount)
+        || !decode(codeBlock->m_valueProfileCount)
+        || !decode(codeBlock->m_llintCallLinkInfoCount))
+        return false;
+    codeBlock->m_features = features;
+
+    Vector<UnlinkedInstruction> instructions;
+    if (!decodeArray(instructions) || !isCacheableInstructionStream(instructions.data(), instructions.size()))
+        return false;
+    codeBlock->m_unlinkedInstructions = RefCountedArray<UnlinkedInstruction>(instructions);
+    if (!decodeArray(codeBlock->m_jumpTargets) || !decodeArray(codeBlock->m_propertyAccessInstructions))
+        return false;
+
+    uint32_t count;
+    if (!decodeCount(count, sizeof(uint32_t)))
+        return false;
+    codeBlock->m_identifiers.reserveInitialCapacity(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Identifier identifier;
+        if (!decode(identifier))
+            return false;
+        codeBlock->m_identifiers.uncheckedAppend(identifier);
+    }
+
+    if (!decodeCount(count, sizeof(uint32_t)))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        JSValue value;
+        if (!decodeConstant(codeBlock, value, false))
+            return false;
+        codeBlock->addConstant(value);
+    }
+
+    if (!decodeCount(count, sizeof(uint32_t)))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        UnlinkedFunctionExecutable* executable = decodeExecutable();
+        if (!executable)
+            return false;
+        executables.append(executable);
+    }
+    if (!decodeCount(count, sizeof(uint32_t)))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t index;
+        UnlinkedFunctionExecutable* executable;
+        if (!decode(index) || !(executable = executableAt(executables, index)))
+            return false;
+        codeBlock->addFunctionDecl(executable);
+    }
+    if (!decodeCount(count, sizeof(uint32_t)))
+        return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t index;
+        UnlinkedFunctionExecutable* executable;
+        if (!decode(index) || !(executable = executableAt(executables, index)))
+            return false;
+        codeBlock->addFunctionExpr(executable);
+    }
+
+    uint32_t hasSymbolTable;
+    if (!decode(hasSymbolTable) || !!hasSymbolTable != !!codeBlock->m_symbolTable)
+        return false;
+    if (SharedSymbolTable* symbolTable = codeBlock->m_symbolTable.get()) {
+        if (!decodeCount(count, 3 * sizeof(uint32_t)))
+            return false;
+        ConcurrentJITLocker locker(symbolTable->m_lock);
+        for (uint32_t i = 0; i < count; ++i) {
+            Identifier name;
+            int32_t index;
+            uint32_t attributes;
+            if (!decode(name) || name.isNull() || !decode(index) || !decode(attributes))
+                return false;
+            // SymbolTableEntry packs the index with four flag bits into a pointer sized word.
+            if (index < -(1 << 26) || index >= (1 << 26) || (attributes & ~(ReadOnly | DontEnum)))
+                return false;
+            symbolTable->add(locker, name.impl(), SymbolTableEntry(index, attributes));
+        }
+
+        int32_t parameterCountIncludingThis;
+        uint32_t usesNonStrictEval;
+        int32_t captureStart;
+        int32_t captureEnd;
+        uint32_t hasSlowArguments;
+        if (!decode(parameterCountIncludingThis)
+            || !decode(usesNonStrictEval)
+            || !decode(captureStart)
+            || !decode(captureEnd)
+            || !decode(hasSlowArguments)
+            || parameterCountIncludingThis < 1)
+            return false;
+        symbolTable->setParameterCountIncludingThis(parameterCountIncludingThis);
+        symbolTable->setUsesNonStrictEval(usesNonStrictEval);
+        symbolTable->setCaptureStart(captureStart);
+        symbolTable->setCaptureEnd(captureEnd);
+        if (hasSlowArguments) {
+            int parameterCount = parameterCountIncludingThis - 1;
+            if (static_cast<size_t>(parameterCount) > remaining() / (2 * sizeof(uint32_t)))
+                return false;
+            OwnArrayPtr<SlowArgument> slowArguments = adoptArrayPtr(new SlowArgument[parameterCount]);
+            for (int i = 0; i < parameterCount; ++i) {
+                uint32_t status;
+                if (!decode(status) || status > SlowArgument::Deleted || !decode(slowArguments[i].index))
+                    return false;
+                slowArguments[i].status = static_cast<SlowArgument::Status>(status);
+            }
+            symbolTable->setSlowArguments(slowArguments.release());
+        }
+    }
+
+    uint32_t hasRareData;
+    if (!decode(hasRareData))
+        return false;
+    if (hasRareData) {
+        codeBlock->createRareDataIfNecessary();
+        UnlinkedCodeBlock::RareData* rareData = codeBlock->m_rareData.get();
+        if (!decodeArray(rareData->m_exceptionHandlers))
+            return false;
+
+        if (!decodeCount(count, 2 * sizeof(uint32_t)))
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            String pattern;
+            uint32_t regExpFlags;
+            if (!decode(pattern) || pattern.isNull() || !decode(regExpFlags) || (regExpFlags & ~(FlagGlobal | FlagIgnoreCase | FlagMultiline)))
+                return false;
+            codeBlock->addRegExp(RegExp::create(m_vm, pattern, static_cast<RegExpFlags>(regExpFlags)));
+        }
+
+        if (!decodeCount(count, sizeof(uint32_t)))
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length;
+            if (!decodeCount(length, sizeof(uint32_t)))
+                return false;
+            UnlinkedCodeBlock::ConstantBuffer& buffer = codeBlock->constantBuffer(codeBlock->addConstantBuffer(length));
+            for (uint32_t j = 0; j < length; ++j) {
+                if (!decodeConstant(codeBlock, buffer[j], true))
+                    return false;
+            }
+        }
+
+        if (!decodeCount(count, 2 * sizeof(uint32_t)))
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            UnlinkedSimpleJumpTable& table = codeBlock->addSwitchJumpTable();
+            if (!decode(table.min) || !decodeArray(table.branchOffsets))
+                return false;
+        }
+
+        if (!decodeCount(count, sizeof(uint32_t)))
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            UnlinkedStringJumpTable& table = codeBlock->addStringSwitchJumpTable();
+            uint32_t size;
+            if (!decodeCount(size, 2 * sizeof(uint32_t)))
+                return false;
+            for (uint32_t j = 0; j < size; ++j) {
+                Identifier key;
+                int32_t branchOffset;
+                if (!decode(key) || key.isNull() || !decode(branchOffset))
+                    return false;
+                table.offsetTable.add(key.impl(), branchOffset);
+            }
+        }
+
+        if (!decodeArray(rareData->m_expressionInfoFatPositions))
+            return false;
+    }
+
+    return decodeArray(codeBlock->m_expressionInfo.data());
+}
+
+
+PassOwnPtr<CodeCacheStorage> CodeCacheStorage::create(const String& directory)
+{
+    return adoptPtr(new CodeCacheStorage(directory));
+}
+
+CodeCacheStorage::CodeCacheStorage(const String& directory)
+    : m_directory(directory)
+    , m_indexedSize(0)
+    , m_maximumSize(defaultMaximumSize)
+    , m_useCounter(0)
+    , m_indexIsDirty(false)
+    , m_writerThread(0)
+    , m_writerThreadShouldQuit(false)
+    , m_isWriting(false)
+{
+    readIndex();
+}
+
+CodeCacheStorage::~CodeCacheStorage()
+{
+    if (!m_writerThread)
+        return;
+    {
+        MutexLocker locker(m_writeLock);
+        m_writerThreadShouldQuit = true;
+        m_writeCondition.broadcast();
+    }
+    // The writer thread empties its queue before it quits.
+    waitForThreadCompletion(m_writerThread);
+}
+
+void CodeCacheStorage::setMaximumSize(size_t maximumSize)
+{
+    m_maximumSize = maximumSize;
+    evictFiles(String());
+    if (m_indexIsDirty)
+        writeIndex();
+}
+
+bool CodeCacheStorage::canCache(const SourceCode& source)
+{
+#if ENABLE(BYTECODE_COMMENTS)
+    UNUSED_PARAM(source);
+    return false;
+#else
+    return static_cast<unsigned>(source.length()) >= minimumCachedSourceLength;
+#endif
+}
+
+CodeCacheStorage::Key CodeCacheStorage::keyFor(const SourceCode& source, JSParserStrictness strictness)
+{
+    // The in-memory code cache has just hashed the same string, so this is usually cached.
+    Key key;
+    key.hash = source.toString().impl()->hash();
+    key.length = source.length();
+    key.strictness = strictness;
+    return key;
+}
+
+// Hashes the characters as they are stored rather than converting them first. A program that is
+// loaded with 16-bit characters after it was cached with 8-bit ones, or the other way around,
+// has a different length in bytes and just misses.
+void CodeCacheStorage::computeDigest(Key& key, const SourceCode& source)
+{
+    if (!key.digest.isEmpty())
+        return;
+    String string = source.toString();
+    SHA1 sha1;
+    if (string.is8Bit())
+        sha1.addBytes(string.characters8(), string.length());
+    else
+        sha1.addBytes(reinterpret_cast<const uint8_t*>(string.characters16()), string.length() * sizeof(UChar));
+    sha1.computeHash(key.digest);
+}
+
+String CodeCacheStorage::fileNameForKey(const Key& key)
+{
+    // Hexadecimal, because the file systems this runs on may not be case sensitive.
+    return String::format("%08x-%u-%c.jsbc", key.hash, key.length, key.strictness == JSParseStrict ? 's' : 'n');
+}
+
+String CodeCacheStorage::pathForFileName(const String& fileName) const
+{
+    if (m_directory.isEmpty() || m_directory.endsWith('/') || m_directory.endsWith(':'))
+        return m_directory + fileName;
+    return m_directory + "/" + fileName;
+}
+
+static bool keysMatch(const CodeCacheStorage::Key& a, const CodeCacheStorage::Key& b)
+{
+    return a.hash == b.hash && a.length == b.length && a.strictness == b.strictness && a.digest == b.digest;
+}
+
+CodeCacheStorage::Entry* CodeCacheStorage::entryForKey(const Key& key, UnlinkedProgramCodeBlock* codeBlock)
+{
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (keysMatch(m_entries[i]->key, key)) {
+            m_entries[i]->codeBlock = PassWeak<UnlinkedProgramCodeBlock>(codeBlock);
+            return m_entries[i].get();
+        }
+    }
+    m_entries.append(adoptPtr(new Entry(key, codeBlock)));
+    return m_entries.last().get();
+}
+
+UnlinkedProgramCodeBlock* CodeCacheStorage::loadProgramCodeBlock(VM& vm, Key& key, const SourceCode& source)
+{
+    String fileName = fileNameForKey(key);
+    Index::iterator record = m_index.find(fileName);
+    if (record == m_index.end()) {
+        ++m_statistics.misses;
+        return 0;
+    }
+
+    // The file may have been stored earlier in this run.
+    waitForWrites();
+    RefPtr<CodeCacheFile> file = CodeCacheFile::open(pathForFileName(fileName));
+    if (!file) {
+        m_indexedSize -= record->value.size;
+        m_index.remove(record);
+        m_indexIsDirty = true;
+        ++m_statistics.misses;
+        return 0;
+    }
+
+    computeDigest(key, source);
+    FileHeader header;
+    bool valid = file->size() > sizeof(header);
+    if (valid) {
+        memcpy(&header, file->data(), sizeof(header));
+        valid = header.magic == fileMagic
+            && header.formatVersion == fileFormatVersion
+            && header.buildSignature == buildSignature()
+            && header.sourceLength == key.length
+            && header.strictness == static_cast<uint32_t>(key.strictness)
+            && !memcmp(header.sourceDigest, key.digest.data(), sizeof(header.sourceDigest));
+    }
+
+    UnlinkedProgramCodeBlock* codeBlock = 0;
+    if (valid) {
+        CodeCacheDecoder decoder(vm, file.get());
+        codeBlock = decoder.decodeProgramCodeBlock(header.programOffset);
+    }
+    if (!codeBlock) {
+        ++m_statistics.rejected;
+        ++m_statistics.misses;
+        return 0;
+    }
+    ++m_statistics.hits;
+    record->value.lastUse = ++m_useCounter;
+    m_indexIsDirty = true;
+
+    Entry* entry = entryForKey(key, codeBlock);
+    entry->file = file.release();
+    entry->programOffset = header.programOffset;
+    return codeBlock;
+}
+
+void CodeCacheStorage::storeProgramCodeBlock(Key& key, const SourceCode& source, UnlinkedProgramCodeBlock* codeBlock)
+{
+    computeDigest(key, source);
+    Entry* entry = entryForKey(key, codeBlock);
+    // The code block was generated because the file was missing or unusable; start a new one.
+    entry->file = 0;
+    entry->programOffset = 0;
+    if (write(*entry))
+        writeIndex();
+}
+
+UnlinkedFunctionCodeBlock* CodeCacheStorage::loadFunctionCodeBlock(VM& vm, UnlinkedFunctionExecutable* executable, CodeSpecializationKind kind)
+{
+    unsigned& offset = kind == CodeForCall ? executable->m_cachedCodeBlockOffsetForCall : executable->m_cachedCodeBlockOffsetForConstruct;
+    if (!executable->m_cacheFile || !offset)
+        return 0;
+
+    CodeCacheDecoder decoder(vm, executable->m_cacheFile.get());
+    UnlinkedFunctionCodeBlock* codeBlock = decoder.decodeFunctionCodeBlock(offset, kind);
+    if (!codeBlock) {
+        // The body is compiled from source instead, and the next write replaces the blob.
+        offset = 0;
+        ++m_statistics.functionCodeBlocksRejected;
+        return 0;
+    }
+    ++m_statistics.functionCodeBlocksDecoded;
+    return codeBlock;
+}
+
+static void appendExecutables(UnlinkedCodeBlock* codeBlock, Vector<UnlinkedFunctionExecutable*>& executables)
+{
+    for (size_t i = 0; i < codeBlock->numberOfFunctionDecls(); ++i)
+        executables.append(codeBlock->functionDecl(i));
+    for (size_t i = 0; i < codeBlock->numberOfFunctionExprs(); ++i)
+        executables.append(codeBlock->functionExpr(i));
+}
+
+// A compacted file cannot refer to the previous one, so the function bodies that are only in
+// the previous file are decoded before it is written.
+void CodeCacheStorage::decodeFunctionCodeBlocks(VM& vm, UnlinkedProgramCodeBlock* programCodeBlock, CodeCacheFile* file)
+{
+    Vector<UnlinkedFunctionExecutable*> worklist;
+    appendExecutables(programCodeBlock, worklist);
+    const UnlinkedProgramCodeBlock::FunctionDeclations& functionDeclarations = programCodeBlock->functionDeclarations();
+    for (size_t i = 0; i < functionDeclarations.size(); ++i)
+        worklist.append(functionDeclarations[i].second.get());
+
+    HashSet<UnlinkedFunctionExecutable*> visited;
+    while (!worklist.isEmpty()) {
+        UnlinkedFunctionExecutable* executable = worklist.takeLast();
+        if (!visited.add(executable).isNewEntry)
+            continue;
+        for (unsigned i = 0; i < 2; ++i) {
+            CodeSpecializationKind kind = i ? CodeForConstruct : CodeForCall;
+            UnlinkedFunctionCodeBlock* codeBlock = kind == CodeForCall ? executable->m_codeBlockForCall.get() : executable->m_codeBlockForConstruct.get();
+            if (!codeBlock && executable->m_cacheFile == file) {
+                codeBlock = loadFunctionCodeBlock(vm, executable, kind);
+                if (codeBlock)
+                    executable->setCodeBlockFor(vm, kind, codeBlock);
+            }
+            if (codeBlock)
+                appendExecutables(codeBlock, worklist);
+        }
+    }
+}
+
+bool CodeCacheStorage::write(Entry& entry)
+{
+    UnlinkedProgramCodeBlock* codeBlock = entry.codeBlock.get();
+    if (!codeBlock)
+        return false;
+
+    size_t unreferencedBytes = 0;
+    if (entry.file) {
+        FileHeader previousHeader;
+        memcpy(&previousHeader, entry.file->data(), sizeof(previousHeader));
+        unreferencedBytes = previousHeader.unreferencedBytes;
+    }
+
+    Vector<uint8_t> blobs;
+    size_t baseOffset = entry.file ? entry.file->size() : sizeof(FileHeader);
+    OwnPtr<CodeCacheEncoder> encoder = adoptPtr(new CodeCacheEncoder(blobs, baseOffset, entry.file.get()));
+    unsigned programOffset;
+    if (!encoder->encodeProgramCodeBlock(codeBlock, entry.programOffset, programOffset))
+        return false;
+    if (programOffset == entry.programOffset)
+        return true;
+
+    unreferencedBytes += encoder->unreferencedBytes();
+    bool isCompacting = entry.file && unreferencedBytes > (baseOffset + blobs.size()) / 2;
+    if (isCompacting) {
+        decodeFunctionCodeBlocks(*codeBlock->vm(), codeBlock, entry.file.get());
+        blobs.clear();
+        baseOffset = sizeof(FileHeader);
+        encoder = adoptPtr(new CodeCacheEncoder(blobs, baseOffset, 0));
+        if (!encoder->encodeProgramCodeBlock(codeBlock, 0, programOffset))
+            return false;
+        unreferencedBytes = 0;
+        ++m_statistics.filesCompacted;
+    }
+
+    FileHeader header;
+    header.magic = fileMagic;
+    header.formatVersion = fileFormatVersion;
+    header.buildSignature = buildSignature();
+    header.sourceLength = entry.key.length;
+    header.strictness = entry.key.strictness;
+    header.programOffset = programOffset;
+    header.unreferencedBytes = static_cast<uint32_t>(unreferencedBytes);
+    memcpy(header.sourceDigest, entry.key.digest.data(), sizeof(header.sourceDigest));
+
+    // Blobs are only ever appended, so offsets held by executables decoded from the previous
+    // version of the file stay valid. The superseded blobs are left in place until the file
+    // is compacted.
+    Vector<uint8_t> buffer;
+    buffer.reserveInitialCapacity(baseOffset + blobs.size());
+    buffer.append(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    if (baseOffset > sizeof(header))
+        buffer.append(entry.file->data() + sizeof(header), entry.file->size() - sizeof(header));
+    buffer.append(blobs.data(), blobs.size());
+
+    size_t size = buffer.size();
+    RefPtr<CodeCacheFile> file = CodeCacheFile::adopt(buffer);
+    encoder->didWrite(file.get());
+    entry.file = file;
+    entry.programOffset = programOffset;
+
+    enqueueWrite(pathForFileName(fileNameForKey(entry.key)), file.release());
+    didWriteFile(entry.key, size);
+    return true;
+}
+
+void CodeCacheStorage::synchronize()
+{
+    for (size_t i = 0; i < m_entries.size();) {
+        if (!m_entries[i]->codeBlock) {
+            m_entries.remove(i);
+            continue;
+        }
+        write(*m_entries[i]);
+        ++i;
+    }
+    if (m_indexIsDirty)
+        writeIndex();
+    waitForWrites();
+}
+
+void CodeCacheStorage::readIndex()
+{
+    RefPtr<CodeCacheFile> file = CodeCacheFile::open(pathForFileName(indexFileName));
+    if (!file || file->size() < sizeof(IndexHeader))
+        return;
+
+    IndexHeader header;
+    memcpy(&header, file->data(), sizeof(header));
+    const uint8_t* records = file->data() + sizeof(header);
+    size_t recordsSize = file->size() - sizeof(header);
+    if (header.magic != indexMagic
+        || header.formatVersion != indexFormatVersion
+        || recordsSize % sizeof(IndexFileRecord)
+        || recordsSize / sizeof(IndexFileRecord) != header.recordCount
+        || checksum(records, recordsSize) != header.checksum)
+        return;
+
+    m_useCounter = header.useCounter;
+    for (size_t offset = 0; offset < recordsSize; offset += sizeof(IndexFileRecord)) {
+        IndexFileRecord fileRecord;
+        memcpy(&fileRecord, records + offset, sizeof(fileRecord));
+        if (fileRecord.strictness != JSParseNormal && fileRecord.strictness != JSParseStrict)
+            continue;
+        Key key;
+        key.hash = fileRecord.hash;
+        key.length = fileRecord.length;
+        key.strictness = static_cast<JSParserStrictness>(fileRecord.strictness);
+        IndexRecord record;
+        record.hash = key.hash;
+        record.length = key.length;
+        record.strictness = key.strictness;
+        record.size = fileRecord.size;
+        record.lastUse = fileRecord.lastUse;
+        if (m_index.add(fileNameForKey(key), record).isNewEntry)
+            m_indexedSize += record.size;
+    }
+}
+
+void CodeCacheStorage::writeIndex()
+{
+    Vector<uint8_t> buffer;
+    buffer.grow(sizeof(IndexHeader));
+    Index::iterator end = m_index.end();
+    for (Index::iterator it = m_index.begin(); it != end; ++it) {
+        IndexFileRecord fileRecord;
+        fileRecord.hash = it->value.hash;
+        fileRecord.length = it->value.length;
+        fileRecord.strictness = it->value.strictness;
+        fileRecord.size = it->value.size;
+        fileRecord.lastUse = it->value.lastUse;
+        buffer.append(reinterpret_cast<const uint8_t*>(&fileRecord), sizeof(fileRecord));
+    }
+
+    IndexHeader header;
+    header.magic = indexMagic;
+    header.formatVersion = indexFormatVersion;
+    header.useCounter = m_useCounter;
+    header.recordCount = m_index.size();
+    header.checksum = checksum(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    enqueueWrite(pathForFileName(indexFileName), CodeCacheFile::adopt(buffer));
+    m_indexIsDirty = false;
+}
+
+void CodeCacheStorage::didWriteFile(const Key& key, size_t size)
+{
+    String fileName = fileNameForKey(key);
+    IndexRecord& record = m_index.add(fileName, IndexRecord()).iterator->value;
+    m_indexedSize -= record.size;
+    record.hash = key.hash;
+    record.length = key.length;
+    record.strictness = key.strictness;
+    record.size = size;
+    record.lastUse = ++m_useCounter;
+    m_indexedSize += size;
+    m_indexIsDirty = true;
+    evictFiles(fileName);
+}
+
+void CodeCacheStorage::evictFiles(const String& fileNameToKeep)
+{
+    while (m_indexedSize > m_maximumSize) {
+        Index::iterator end = m_index.end();
+        Index::iterator leastRecentlyUsed = end;
+        for (Index::iterator it = m_index.begin(); it != end; ++it) {
+            if (it->key == fileNameToKeep)
+                continue;
+            if (leastRecentlyUsed == end || it->value.lastUse < leastRecentlyUsed->value.lastUse)
+                leastRecentlyUsed = it;
+        }
+        if (leastRecentlyUsed == end)
+            return;
+
+        String fileName = leastRecentlyUsed->key;
+        m_indexedSize -= leastRecentlyUsed->value.size;
+        m_index.remove(leastRecentlyUsed);
+        m_indexIsDirty = true;
+        ++m_statistics.filesEvicted;
+
+        // Programs that are still running keep decoding from the copy their executables hold,
+        // but the bodies they compile from now on are no longer written.
+        for (size_t i = 0; i < m_entries.size();) {
+            if (fileNameForKey(m_entries[i]->key) == fileName) {
+                m_entries.remove(i);
+                continue;
+            }
+            ++i;
+        }
+        enqueueWrite(pathForFileName(fileName), 0);
+    }
+}
+
+void CodeCacheStorage::damageFilesForTesting(bool programCodeBlocks)
+{
+    waitForWrites();
+    Index::iterator end = m_index.end();
+    for (Index::iterator it = m_index.begin(); it != end; ++it) {
+        String path = pathForFileName(it->key);
+        RefPtr<CodeCacheFile> file = CodeCacheFile::open(path);
+        if (!file || file->size() <= sizeof(FileHeader))
+            continue;
+        Vector<uint8_t> contents;
+        contents.append(file->data(), file->size());
+        file = 0;
+
+        FileHeader header;
+        memcpy(&header, contents.data(), sizeof(header));
+        size_t offset = sizeof(header);
+        while (contents.size() - offset >= sizeof(BlobHeader)) {
+            BlobHeader blobHeader;
+            memcpy(&blobHeader, contents.data() + offset, sizeof(blobHeader));
+            size_t start = offset + sizeof(blobHeader);
+            if (blobHeader.size > contents.size() - start)
+                break;
+            if (blobHeader.size && (offset == header.programOffset) == programCodeBlocks)
+                contents[start + blobHeader.size / 2] ^= 0xff;
+            offset = start + blobHeader.size;
+        }
+        writeFile(path.utf8(), CodeCacheFile::adopt(contents).get());
+    }
+}
+
+CodeCacheStorage::Statistics CodeCacheStorage::statistics()
+{
+    MutexLocker locker(m_writeLock);
+    return m_statistics;
+}
+
+void CodeCacheStorage::enqueueWrite(const String& path, PassRefPtr<CodeCacheFile> contents)
+{
+    CString fileSystemPath = path.utf8();
+    MutexLocker locker(m_writeLock);
+    // Only the last version of a file that is still queued needs to be written.
+    Deque<WriteTask>::iterator end = m_writeQueue.end();
+    for (Deque<WriteTask>::iterator it = m_writeQueue.begin(); it != end; ++it) {
+        if (it->path == fileSystemPath) {
+            it->contents = contents;
+            return;
+        }
+    }
+    m_writeQueue.append(WriteTask(fileSystemPath, contents));
+
+    if (!m_writerThread) {
+        m_writerThread = createThread(writerThreadStartFunc, this, "[OWB] JavaScriptCore::CodeCacheWriter");
+        RELEASE_ASSERT(m_writerThread);
+    }
+    m_writeCondition.broadcast();
+}
+
+void CodeCacheStorage::waitForWrites()
+{
+    MutexLocker locker(m_writeLock);
+    while (!m_writeQueue.isEmpty() || m_isWriting)
+        m_writeCondition.wait(m_writeLock);
+}
+
+// Readers map the files, so they are never rewritten in place.
+bool CodeCacheStorage::writeFile(const CString& path, const CodeCacheFile* contents)
+{
+    Vector<char> temporaryPath;
+    temporaryPath.append(path.data(), path.length());
+    temporaryPath.append(".tmp", sizeof(".tmp"));
+
+    FILE* handle = fopen(temporaryPath.data(), "wb");
+    if (!handle)
+        return false;
+    bool written = fwrite(contents->data(), 1, contents->size(), handle) == contents->size();
+    written = !fclose(handle) && written;
+    if (written && rename(temporaryPath.data(), path.data())) {
+        // Not every file system replaces an existing file on rename.
+        remove(path.data());
+        written = !rename(temporaryPath.data(), path.data());
+    }
+    if (!written) {
+        remove(temporaryPath.data());
+        return false;
+    }
+    return true;
+}
+
+void CodeCacheStorage::writerThreadStartFunc(void* storage)
+{
+    static_cast<CodeCacheStorage*>(storage)->writerThreadMain();
+}
+
+void CodeCacheStorage::writerThreadMain()
+{
+    m_writeLock.lock();
+    while (true) {
+        while (!m_writerThreadShouldQuit && m_writeQueue.isEmpty())
+            m_writeCondition.wait(m_writeLock);
+        if (m_writeQueue.isEmpty())
+            break;
+
+        WriteTask task = m_writeQueue.takeFirst();
+        m_isWriting = true;
+        m_writeLock.unlock();
+        bool written = task.contents ? writeFile(task.path, task.contents.get()) : !remove(task.path.data());
+        m_writeLock.lock();
+
+        m_isWriting = false;
+        if (written && task.contents) {
+            ++m_statistics.filesWritten;
+            m_statistics.bytesWritten += task.contents->size();
+        }
+        m_writeCondition.broadcast();
+    }
+    m_writeLock.unlock();
+}
+
+} // namespace JSC
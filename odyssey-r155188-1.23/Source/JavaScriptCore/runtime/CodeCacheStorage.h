@@ -0,0 +1,242 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CodeCacheStorage_h
+#define CodeCacheStorage_h
+
+#include "CodeSpecializationKind.h"
+#include "ParserModes.h"
+#include "Weak.h"
+#include <wtf/Deque.h>
+#include <wtf/Forward.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace JSC {
+
+class SourceCode;
+class UnlinkedCodeBlock;
+class UnlinkedFunctionCodeBlock;
+class UnlinkedFunctionExecutable;
+class UnlinkedProgramCodeBlock;
+class VM;
+
+// The contents of one cache file, memory mapped where the platform supports it. Executables
+// decoded from the file keep it alive so that their function bodies can be decoded on demand.
+// Files that were just encoded are kept in memory and shared with the writer thread.
+class CodeCacheFile : public ThreadSafeRefCounted<CodeCacheFile> {
+public:
+    static PassRefPtr<CodeCacheFile> open(const String& path);
+    static PassRefPtr<CodeCacheFile> adopt(Vector<uint8_t>&);
+    ~CodeCacheFile();
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    CodeCacheFile();
+
+    const uint8_t* m_data;
+    size_t m_size;
+    bool m_isMapped;
+    Vector<uint8_t> m_buffer;
+};
+
+// Persists the unlinked bytecode of top-level program code across runs.
+//
+// Each program gets a file named after the string hash and the length of its source. The
+// header records a format version and a signature of the opcode table, so that files written
+// by another build are ignored, and the SHA1 of the source, which is checked before anything
+// is decoded. The SHA1 is only computed for programs that have a file in the index.
+//
+// Every code block is a blob with its own checksum, verified before the blob is decoded.
+// Only the program code block is decoded up front; the bodies of the functions it declares
+// are decoded the first time they are called. Function bodies that were compiled during the
+// run are appended to the file by synchronize(), so offsets into the old contents stay valid.
+// Once more than half of a file is taken by blobs that nothing refers to any more, it is
+// written anew instead.
+//
+// An index in the directory records the size of each file and when it was last used. When
+// the files add up to more than the maximum size, the least recently used ones are deleted.
+// Files are written and deleted on a helper thread.
+class CodeCacheStorage {
+    WTF_MAKE_NONCOPYABLE(CodeCacheStorage); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static const size_t defaultMaximumSize = 16 * 1024 * 1024;
+
+    // The directory must exist.
+    static PassOwnPtr<CodeCacheStorage> create(const String& directory);
+    ~CodeCacheStorage();
+
+    void setMaximumSize(size_t);
+
+    struct Key {
+        Key() : hash(0), length(0), strictness(JSParseNormal) { }
+
+        unsigned hash;
+        unsigned length;
+        JSParserStrictness strictness;
+        // Empty until the storage needs it.
+        Vector<uint8_t, 20> digest;
+    };
+
+    // Small scripts are cheaper to compile than to look up on disk.
+    static bool canCache(const SourceCode&);
+    static Key keyFor(const SourceCode&, JSParserStrictness);
+
+    UnlinkedProgramCodeBlock* loadProgramCodeBlock(VM&, Key&, const SourceCode&);
+    void storeProgramCodeBlock(Key&, const SourceCode&, UnlinkedProgramCodeBlock*);
+    UnlinkedFunctionCodeBlock* loadFunctionCodeBlock(VM&, UnlinkedFunctionExecutable*, CodeSpecializationKind);
+
+    // Appends the function bodies compiled since the files of live programs were last written
+    // and waits until everything is on disk.
+    void synchronize();
+
+    // Flips a byte in either the program blob or all other blobs of every file in the index,
+    // so that tests can check that damaged files are not decoded.
+    void damageFilesForTesting(bool programCodeBlocks);
+
+    struct Statistics {
+        Statistics()
+            : hits(0)
+            , misses(0)
+            , rejected(0)
+            , functionCodeBlocksDecoded(0)
+            , functionCodeBlocksRejected(0)
+            , filesWritten(0)
+            , bytesWritten(0)
+            , filesCompacted(0)
+            , filesEvicted(0)
+        {
+        }
+
+        unsigned hits;
+        unsigned misses;
+        // Files that were present but written by another build, for another source or damaged.
+        unsigned rejected;
+        unsigned functionCodeBlocksDecoded;
+        // Function bodies that were damaged and had to be compiled from source.
+        unsigned functionCodeBlocksRejected;
+        unsigned filesWritten;
+        size_t bytesWritten;
+        unsigned filesCompacted;
+        unsigned filesEvicted;
+    };
+    Statistics statistics();
+
+private:
+    explicit CodeCacheStorage(const String& directory);
+
+    struct Entry {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        Entry(const Key& key, UnlinkedProgramCodeBlock* codeBlock)
+            : key(key)
+            , codeBlock(codeBlock)
+            , programOffset(0)
+        {
+        }
+
+        Key key;
+        Weak<UnlinkedProgramCodeBlock> codeBlock;
+        RefPtr<CodeCacheFile> file;
+        // Zero until the program code block has been written.
+        unsigned programOffset;
+    };
+
+    struct IndexRecord {
+        IndexRecord()
+            : hash(0)
+            , length(0)
+            , strictness(JSParseNormal)
+            , size(0)
+            , lastUse(0)
+        {
+        }
+
+        unsigned hash;
+        unsigned length;
+        JSParserStrictness strictness;
+        unsigned size;
+        unsigned lastUse;
+    };
+    // By file name.
+    typedef HashMap<String, IndexRecord> Index;
+
+    struct WriteTask {
+        WriteTask() { }
+        WriteTask(const CString& path, PassRefPtr<CodeCacheFile> contents)
+            : path(path)
+            , contents(contents)
+        {
+        }
+
+        CString path;
+        // Null when the file is to be deleted.
+        RefPtr<CodeCacheFile> contents;
+    };
+
+    static String fileNameForKey(const Key&);
+    static void computeDigest(Key&, const SourceCode&);
+    String pathForFileName(const String&) const;
+    Entry* entryForKey(const Key&, UnlinkedProgramCodeBlock*);
+    bool write(Entry&);
+    void decodeFunctionCodeBlocks(VM&, UnlinkedProgramCodeBlock*, CodeCacheFile*);
+
+    void readIndex();
+    void writeIndex();
+    void didWriteFile(const Key&, size_t);
+    void evictFiles(const String& fileNameToKeep);
+
+    void enqueueWrite(const String& path, PassRefPtr<CodeCacheFile> contents);
+    void waitForWrites();
+    static bool writeFile(const CString& path, const CodeCacheFile*);
+    static void writerThreadStartFunc(void*);
+    void writerThreadMain();
+
+    String m_directory;
+    Vector<OwnPtr<Entry> > m_entries;
+
+    Index m_index;
+    size_t m_indexedSize;
+    size_t m_maximumSize;
+    unsigned m_useCounter;
+    bool m_indexIsDirty;
+
+    // Only touched by the main thread, except for the counts of the writer thread.
+    Statistics m_statistics;
+
+    Mutex m_writeLock;
+    ThreadCondition m_writeCondition;
+    ThreadIdentifier m_writerThread;
+    bool m_writerThreadShouldQuit;
+    bool m_isWriting;
+    Deque<WriteTask> m_writeQueue;
+};
+
+} // namespace JSC
+
+#endif // CodeCacheStorage_h
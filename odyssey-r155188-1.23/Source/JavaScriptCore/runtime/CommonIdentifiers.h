@@ -31,11 +31,17 @@
     macro(ArrayBuffer) \
     macro(BYTES_PER_ELEMENT) \
     macro(Boolean) \
+    macro(DataView) \
     macro(Date) \
     macro(Error) \
     macro(EvalError) \
+    macro(Float32Array) \
+    macro(Float64Array) \
     macro(Function) \
     macro(Infinity) \
+    macro(Int16Array) \
+    macro(Int32Array) \
+    macro(Int8Array) \
     macro(JSON) \
     macro(Math) \
     macro(NaN) \
@@ -51,6 +57,10 @@
     macro(TypeError) \
     macro(URIError) \
     macro(UTC) \
+    macro(Uint16Array) \
+    macro(Uint32Array) \
+    macro(Uint8Array) \
+    macro(Uint8ClampedArray) \
     macro(__defineGetter__) \
     macro(__defineSetter__) \
     macro(__lookupGetter__) \
@@ -254,7 +254,8 @@ namespace JSC {
     HashSet<StringImpl*>::AddResult IdentifierTable::add(U value)
     {
         HashSet<StringImpl*>::AddResult result = m_table.add<V>(value);
-        (*result.iterator)->setIsIdentifier(true);
+        if (!(*result.iterator)->isStatic())
+            (*result.iterator)->setIsIdentifier(true);
         return result;
     }
 
@@ -38,6 +38,7 @@
 #include "JSGlobalObject.h"
 #include "JSLock.h"
 #include "LLIntData.h"
+#include "SharedIdentifiers.h"
 #include "WriteBarrier.h"
 #include <wtf/dtoa.h>
 #include <wtf/LLVMHeaders.h>
@@ -58,6 +59,7 @@ static void initializeThreadingOnce()
     WTF::initializeThreading();
     GlobalJSLock::initialize(); 
     Options::initialize();
+    SharedIdentifiers::initialize();
     if (Options::recordGCPauseTimes())  
         HeapStatistics::initialize();  
 #if ENABLE(WRITE_BARRIER_PROFILING)
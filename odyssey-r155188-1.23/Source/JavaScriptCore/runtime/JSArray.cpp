@@ -34,7 +34,6 @@
 #include "IndexingHeaderInlines.h"
 #include "PropertyNameArray.h"
 #include "Reject.h"
-#include <wtf/AVLTree.h>
 #include <wtf/Assertions.h>
 #include <wtf/OwnPtr.h>
 #include <Operations.h>
@@ -1224,81 +1223,300 @@ void JSArray::sort(ExecState* exec)
     }
 }
 
-struct AVLTreeNodeForArrayCompare {
-    JSValue value;
+// Calls the compare function passed to Array.prototype.sort.
+class ArrayCompareFunctionCaller {
+    WTF_MAKE_NONCOPYABLE(ArrayCompareFunctionCaller);
+public:
+    ArrayCompareFunctionCaller(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+        : m_exec(exec)
+        , m_compareFunction(compareFunction)
+        , m_callType(callType)
+        , m_callData(callData)
+    {
+        if (callType == CallTypeJS)
+            m_cachedCall = adoptPtr(new CachedCall(exec, jsCast<JSFunction*>(compareFunction), 2));
+    }
 
-    // Child pointers.  The high bit of gt is robbed and used as the
-    // balance factor sign.  The high bit of lt is robbed and used as
-    // the magnitude of the balance factor.
-    int32_t gt;
-    int32_t lt;
-};
+    // Whether a has to be placed before b. Once the compare function has thrown, no value is
+    // placed before another, which lets the sort run to its end without calling it again.
+    bool lessThan(JSValue a, JSValue b)
+    {
+        ASSERT(!a.isUndefined());
+        ASSERT(!b.isUndefined());
 
-struct AVLTreeAbstractorForArrayCompare {
-    typedef int32_t handle; // Handle is an index into m_nodes vector.
-    typedef JSValue key;
-    typedef int32_t size;
+        if (m_exec->hadException())
+            return false;
 
-    Vector<AVLTreeNodeForArrayCompare, 0, UnsafeVectorOverflow> m_nodes;
+        double compareResult;
+        if (m_cachedCall) {
+            m_cachedCall->setThis(jsUndefined());
+            m_cachedCall->setArgument(0, a);
+            m_cachedCall->setArgument(1, b);
+            compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
+        } else {
+            MarkedArgumentBuffer arguments;
+            arguments.append(a);
+            arguments.append(b);
+            compareResult = call(m_exec, m_compareFunction, m_callType, m_callData, jsUndefined(), arguments).toNumber(m_exec);
+        }
+        return compareResult < 0;
+    }
+
+private:
     ExecState* m_exec;
     JSValue m_compareFunction;
-    CallType m_compareCallType;
-    const CallData* m_compareCallData;
+    CallType m_callType;
+    const CallData& m_callData;
     OwnPtr<CachedCall> m_cachedCall;
+};
 
-    handle get_less(handle h) { return m_nodes[h].lt & 0x7FFFFFFF; }
-    void set_less(handle h, handle lh) { m_nodes[h].lt &= 0x80000000; m_nodes[h].lt |= lh; }
-    handle get_greater(handle h) { return m_nodes[h].gt & 0x7FFFFFFF; }
-    void set_greater(handle h, handle gh) { m_nodes[h].gt &= 0x80000000; m_nodes[h].gt |= gh; }
-
-    int get_balance_factor(handle h)
+// A stable natural merge sort along the lines of TimSort. Every comparison calls into script,
+// so the sort is arranged to make few of them: ascending and strictly descending stretches of
+// the input are kept as runs, short runs are extended by binary insertion, and the leading and
+// trailing parts of two runs that are already in place are found by galloping before the rest
+// is merged. Nothing depends on the compare function being consistent; an inconsistent one only
+// leaves the values in an unspecified order.
+class ArrayMergeSorter {
+    WTF_MAKE_NONCOPYABLE(ArrayMergeSorter);
+public:
+    // The scratch buffer must hold at least half as many values as are sorted.
+    ArrayMergeSorter(ArrayCompareFunctionCaller& compare, JSValue* values, size_t size, JSValue* scratch)
+        : m_compare(compare)
+        , m_values(values)
+        , m_size(size)
+        , m_scratch(scratch)
     {
-        if (m_nodes[h].gt & 0x80000000)
-            return -1;
-        return static_cast<unsigned>(m_nodes[h].lt) >> 31;
     }
 
-    void set_balance_factor(handle h, int bf)
+    void sort()
     {
-        if (bf == 0) {
-            m_nodes[h].lt &= 0x7FFFFFFF;
-            m_nodes[h].gt &= 0x7FFFFFFF;
-        } else {
-            m_nodes[h].lt |= 0x80000000;
-            if (bf < 0)
-                m_nodes[h].gt |= 0x80000000;
-            else
-                m_nodes[h].gt &= 0x7FFFFFFF;
+        if (m_size < 2)
+            return;
+
+        size_t minimumRunLength = minimumRunLengthFor(m_size);
+        size_t start = 0;
+        while (start < m_size) {
+            size_t runLength = makeAscendingRun(start);
+            if (runLength < minimumRunLength) {
+                size_t extendedLength = std::min(minimumRunLength, m_size - start);
+                binaryInsertionSort(start, start + runLength, start + extendedLength);
+                runLength = extendedLength;
+            }
+            Run run = { start, runLength };
+            m_runs.append(run);
+            mergeCollapse();
+            start += runLength;
         }
+        mergeForceCollapse();
+        ASSERT(m_runs.size() == 1 && m_runs[0].length == m_size);
     }
 
-    int compare_key_key(key va, key vb)
+private:
+    struct Run {
+        size_t start;
+        size_t length;
+    };
+
+    // Inputs shorter than this are sorted by binary insertion alone.
+    static const size_t minimumMergeLength = 64;
+
+    // A run length between minimumMergeLength / 2 and minimumMergeLength for which size divided by
+    // it is a power of two or slightly less, so that the final merges are balanced.
+    static size_t minimumRunLengthFor(size_t size)
     {
-        ASSERT(!va.isUndefined());
-        ASSERT(!vb.isUndefined());
+        size_t lowBits = 0;
+        while (size >= minimumMergeLength) {
+            lowBits |= size & 1;
+            size >>= 1;
+        }
+        return size + lowBits;
+    }
 
-        if (m_exec->hadException())
+    // Returns the length of the run starting at start, reversing it if it is strictly descending.
+    // Descending runs must be strict for the reversal not to reorder equal values.
+    size_t makeAscendingRun(size_t start)
+    {
+        size_t end = start + 1;
+        if (end == m_size)
             return 1;
 
-        double compareResult;
-        if (m_cachedCall) {
-            m_cachedCall->setThis(jsUndefined());
-            m_cachedCall->setArgument(0, va);
-            m_cachedCall->setArgument(1, vb);
-            compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
+        if (m_compare.lessThan(m_values[end], m_values[start])) {
+            ++end;
+            while (end < m_size && m_compare.lessThan(m_values[end], m_values[end - 1]))
+                ++end;
+            std::reverse(m_values + start, m_values + end);
         } else {
-            MarkedArgumentBuffer arguments;
-            arguments.append(va);
-            arguments.append(vb);
-            compareResult = call(m_exec, m_compareFunction, m_compareCallType, *m_compareCallData, jsUndefined(), arguments).toNumber(m_exec);
+            ++end;
+            while (end < m_size && !m_compare.lessThan(m_values[end], m_values[end - 1]))
+                ++end;
+        }
+        return end - start;
+    }
+
+    // Sorts [start, end) given that [start, sortedEnd) is already sorted.
+    void binaryInsertionSort(size_t start, size_t sortedEnd, size_t end)
+    {
+        ASSERT(start < sortedEnd && sortedEnd <= end);
+        for (size_t i = sortedEnd; i < end; ++i) {
+            JSValue pivot = m_values[i];
+            size_t low = start;
+            size_t high = i;
+            while (low < high) {
+                size_t middle = low + (high - low) / 2;
+                if (m_compare.lessThan(pivot, m_values[middle]))
+                    high = middle;
+                else
+                    low = middle + 1;
+            }
+            memmove(m_values + low + 1, m_values + low, (i - low) * sizeof(JSValue));
+            m_values[low] = pivot;
         }
-        return (compareResult < 0) ? -1 : 1; // Not passing equality through, because we need to store all values, even if equivalent.
     }
 
-    int compare_key_node(key k, handle h) { return compare_key_key(k, m_nodes[h].value); }
-    int compare_node_node(handle h1, handle h2) { return compare_key_key(m_nodes[h1].value, m_nodes[h2].value); }
+    // Keeps the run lengths on the stack decreasing at least as fast as the Fibonacci numbers,
+    // which bounds the depth of the stack and keeps merges between runs of similar length.
+    void mergeCollapse()
+    {
+        while (m_runs.size() > 1) {
+            size_t n = m_runs.size() - 2;
+            if ((n > 0 && m_runs[n - 1].length <= m_runs[n].length + m_runs[n + 1].length)
+                || (n > 1 && m_runs[n - 2].length <= m_runs[n - 1].length + m_runs[n].length)) {
+                if (m_runs[n - 1].length < m_runs[n + 1].length)
+                    --n;
+            } else if (m_runs[n].length > m_runs[n + 1].length)
+                break;
+            mergeAt(n);
+        }
+    }
+
+    void mergeForceCollapse()
+    {
+        while (m_runs.size() > 1) {
+            size_t n = m_runs.size() - 2;
+            if (n > 0 && m_runs[n - 1].length < m_runs[n + 1].length)
+                --n;
+            mergeAt(n);
+        }
+    }
+
+    // Merges the runs at index and index + 1 of the stack.
+    void mergeAt(size_t index)
+    {
+        size_t leftStart = m_runs[index].start;
+        size_t leftLength = m_runs[index].length;
+        size_t rightStart = m_runs[index + 1].start;
+        size_t rightLength = m_runs[index + 1].length;
+        ASSERT(leftStart + leftLength == rightStart);
+
+        m_runs[index].length += rightLength;
+        m_runs.remove(index + 1);
+
+        // Values of the left run that the first value of the right run does not go before are
+        // already in place, and so are values of the right run that do not go before the last
+        // value of the left run.
+        size_t inPlace = countNotAfter(m_values[rightStart], m_values + leftStart, leftLength);
+        leftStart += inPlace;
+        leftLength -= inPlace;
+        if (!leftLength)
+            return;
+        rightLength = countBefore(m_values[leftStart + leftLength - 1], m_values + rightStart, rightLength);
+        if (!rightLength)
+            return;
 
-    static handle null() { return 0x7FFFFFFF; }
+        if (leftLength <= rightLength)
+            mergeLow(leftStart, leftLength, rightStart, rightLength);
+        else
+            mergeHigh(leftStart, leftLength, rightStart, rightLength);
+    }
+
+    // Returns the number of leading values of the sorted range that key does not go before,
+    // probing at exponentially growing distances from the start before searching between them.
+    size_t countNotAfter(JSValue key, const JSValue* base, size_t length)
+    {
+        size_t low = 0;
+        size_t probe = 0;
+        while (probe < length && !m_compare.lessThan(key, base[probe])) {
+            low = probe + 1;
+            probe = 2 * probe + 1;
+        }
+        size_t high = std::min(probe, length);
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (m_compare.lessThan(key, base[middle]))
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        return low;
+    }
+
+    // Returns the number of leading values of the sorted range that go before key, probing at
+    // exponentially growing distances from the end before searching between them.
+    size_t countBefore(JSValue key, const JSValue* base, size_t length)
+    {
+        size_t high = length;
+        size_t offset = 1;
+        while (offset <= length && !m_compare.lessThan(base[length - offset], key)) {
+            high = length - offset;
+            offset *= 2;
+        }
+        size_t low = offset <= length ? length - offset + 1 : 0;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (m_compare.lessThan(base[middle], key))
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    // Merges front to back, with the shorter left run moved to the scratch buffer.
+    void mergeLow(size_t leftStart, size_t leftLength, size_t rightStart, size_t rightLength)
+    {
+        memcpy(m_scratch, m_values + leftStart, leftLength * sizeof(JSValue));
+        const JSValue* left = m_scratch;
+        const JSValue* leftEnd = m_scratch + leftLength;
+        const JSValue* right = m_values + rightStart;
+        const JSValue* rightEnd = right + rightLength;
+        JSValue* target = m_values + leftStart;
+
+        while (left < leftEnd && right < rightEnd) {
+            if (m_compare.lessThan(*right, *left))
+                *target++ = *right++;
+            else
+                *target++ = *left++;
+        }
+        // What remains of the right run is already in place.
+        while (left < leftEnd)
+            *target++ = *left++;
+    }
+
+    // Merges back to front, with the shorter right run moved to the scratch buffer.
+    void mergeHigh(size_t leftStart, size_t leftLength, size_t rightStart, size_t rightLength)
+    {
+        memcpy(m_scratch, m_values + rightStart, rightLength * sizeof(JSValue));
+        const JSValue* leftBegin = m_values + leftStart;
+        const JSValue* left = leftBegin + leftLength;
+        const JSValue* right = m_scratch + rightLength;
+        JSValue* target = m_values + rightStart + rightLength;
+
+        while (left > leftBegin && right > m_scratch) {
+            if (m_compare.lessThan(right[-1], left[-1]))
+                *--target = *--left;
+            else
+                *--target = *--right;
+        }
+        // What remains of the left run is already in place.
+        while (right > m_scratch)
+            *--target = *--right;
+    }
+
+    ArrayCompareFunctionCaller& m_compare;
+    JSValue* m_values;
+    size_t m_size;
+    JSValue* m_scratch;
+    Vector<Run, 40> m_runs;
 };
 
 template<IndexingType indexingType>
@@ -1307,86 +1525,77 @@ void JSArray::sortVector(ExecState* exec, JSValue compareFunction, CallType call
     ASSERT(!inSparseIndexingMode());
     ASSERT(indexingType == structure()->indexingType());
     
-    // FIXME: This ignores exceptions raised in the compare function or in toNumber.
-        
-    // The maximum tree depth is compiled in - but the caller is clearly up to no good
-    // if a larger array is passed.
+    // The merge sort probes at up to twice the number of values, which must not overflow
+    // size_t on 32-bit platforms - but the caller is clearly up to no good if a larger array
+    // is passed.
     ASSERT(m_butterfly->publicLength() <= static_cast<unsigned>(std::numeric_limits<int>::max()));
     if (m_butterfly->publicLength() > static_cast<unsigned>(std::numeric_limits<int>::max()))
         return;
         
     unsigned usedVectorLength = relevantLength<indexingType>();
-    unsigned nodeCount = usedVectorLength;
         
-    if (!nodeCount)
+    if (!usedVectorLength)
         return;
         
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44> tree; // Depth 44 is enough for 2^31 items
-    tree.abstractor().m_exec = exec;
-    tree.abstractor().m_compareFunction = compareFunction;
-    tree.abstractor().m_compareCallType = callType;
-    tree.abstractor().m_compareCallData = &callData;
-    tree.abstractor().m_nodes.grow(nodeCount);
-        
-    if (callType == CallTypeJS)
-        tree.abstractor().m_cachedCall = adoptPtr(new CachedCall(exec, jsCast<JSFunction*>(compareFunction), 2));
-        
-    if (!tree.abstractor().m_nodes.begin()) {
+    // The compare function may modify the array, so the values are sorted in a copy that is
+    // only written back once the sort is done.
+    Vector<JSValue, 0, UnsafeVectorOverflow> values;
+    Vector<JSValue, 0, UnsafeVectorOverflow> scratch;
+    if (!values.tryReserveCapacity(usedVectorLength) || !scratch.tryReserveCapacity(usedVectorLength / 2)) {
         throwOutOfMemoryError(exec);
         return;
     }
-        
-    // FIXME: If the compare function modifies the array, the vector, map, etc. could be modified
-    // right out from under us while we're building the tree here.
-        
-    unsigned numDefined = 0;
+    scratch.grow(usedVectorLength / 2);
+
+    // The copies are not visible to the collector. Values the compare function removes from
+    // the array are kept alive here.
+    MarkedArgumentBuffer cells;
+    
     unsigned numUndefined = 0;
     
-    // Iterate over the array, ignoring missing values, counting undefined ones, and inserting all other ones into the tree.
-    for (; numDefined < usedVectorLength; ++numDefined) {
-        if (numDefined >= m_butterfly->vectorLength())
-            break;
-        JSValue v = getHolyIndexQuickly(numDefined);
-        if (!v || v.isUndefined())
-            break;
-        tree.abstractor().m_nodes[numDefined].value = v;
-        tree.insert(numDefined);
-    }
-    for (unsigned i = numDefined; i < usedVectorLength; ++i) {
+    // Iterate over the array, ignoring missing values, counting undefined ones, and copying all other ones.
+    for (unsigned i = 0; i < usedVectorLength; ++i) {
         if (i >= m_butterfly->vectorLength())
             break;
         JSValue v = getHolyIndexQuickly(i);
-        if (v) {
-            if (v.isUndefined())
-                ++numUndefined;
-            else {
-                tree.abstractor().m_nodes[numDefined].value = v;
-                tree.insert(numDefined);
-                ++numDefined;
-            }
+        if (!v)
+            continue;
+        if (v.isUndefined()) {
+            ++numUndefined;
+            continue;
         }
+        values.uncheckedAppend(v);
+        if (v.isCell())
+            cells.append(v);
+    }
+    
+    unsigned numDefined = values.size();
+    if (numDefined > 1) {
+        ArrayCompareFunctionCaller compare(exec, compareFunction, callType, callData);
+        ArrayMergeSorter(compare, values.data(), numDefined, scratch.data()).sort();
     }
     
+    // Leave the array as it was if the compare function threw.
+    if (exec->hadException())
+        return;
+    
     unsigned newUsedVectorLength = numDefined + numUndefined;
         
     // The array size may have changed. Figure out the new bounds.
     unsigned newestUsedVectorLength = currentRelevantLength();
         
-    unsigned elementsToExtractThreshold = min(min(newestUsedVectorLength, numDefined), static_cast<unsigned>(tree.abstractor().m_nodes.size()));
+    unsigned elementsToExtractThreshold = min(newestUsedVectorLength, numDefined);
     unsigned undefinedElementsThreshold = min(newestUsedVectorLength, newUsedVectorLength);
     unsigned clearElementsThreshold = min(newestUsedVectorLength, usedVectorLength);
         
     // Copy the values back into m_storage.
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44>::Iterator iter;
-    iter.start_iter_least(tree);
     VM& vm = exec->vm();
     for (unsigned i = 0; i < elementsToExtractThreshold; ++i) {
         ASSERT(i < butterfly()->vectorLength());
         if (structure()->indexingType() == ArrayWithDouble)
-            butterfly()->contiguousDouble()[i] = tree.abstractor().m_nodes[*iter].value.asNumber();
+            butterfly()->contiguousDouble()[i] = values[i].asNumber();
         else
-            currentIndexingData()[i].set(vm, this, tree.abstractor().m_nodes[*iter].value);
-        ++iter;
+            currentIndexingData()[i].set(vm, this, values[i]);
     }
     // Put undefined values back in.
     switch (structure()->indexingType()) {
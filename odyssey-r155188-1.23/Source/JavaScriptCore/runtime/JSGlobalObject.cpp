@@ -135,6 +135,7 @@ const GlobalObjectMethodTable JSGlobalObject::s_globalObjectMethodTable = { &all
 
 JSGlobalObject::JSGlobalObject(VM& vm, Structure* structure, const GlobalObjectMethodTable* globalObjectMethodTable)
     : Base(vm, structure, 0)
+    , m_lazyTypedArrayProperties(0)
     , m_masqueradesAsUndefinedWatchpoint(adoptRef(new WatchpointSet(InitializedWatching)))
     , m_havingABadTimeWatchpoint(adoptRef(new WatchpointSet(InitializedWatching)))
     , m_varInjectionWatchpoint(adoptRef(new WatchpointSet(InitializedWatching)))
@@ -182,6 +183,7 @@ void JSGlobalObject::put(JSCell* cell, ExecState* exec, PropertyName propertyNam
 
     if (symbolTablePut(thisObject, exec, propertyName, value, slot.isStrictMode()))
         return;
+    thisObject->createLazyProperty(propertyName);
     Base::put(thisObject, exec, propertyName, value, slot);
 }
 
@@ -192,9 +194,68 @@ bool JSGlobalObject::defineOwnProperty(JSObject* object, ExecState* exec, Proper
     // silently ignore attempts to add accessors aliasing vars.
     if (descriptor.isAccessorDescriptor() && symbolTableGet(thisObject, propertyName, slot))
         return false;
+    thisObject->createLazyProperty(propertyName);
     return Base::defineOwnProperty(thisObject, exec, propertyName, descriptor, shouldThrow);
 }
 
+bool JSGlobalObject::deleteProperty(JSCell* cell, ExecState* exec, PropertyName propertyName)
+{
+    JSGlobalObject* thisObject = jsCast<JSGlobalObject*>(cell);
+    thisObject->createLazyProperty(propertyName);
+    return Base::deleteProperty(thisObject, exec, propertyName);
+}
+
+void JSGlobalObject::getOwnNonIndexPropertyNames(JSObject* object, ExecState* exec, PropertyNameArray& propertyNames, EnumerationMode mode)
+{
+    JSGlobalObject* thisObject = jsCast<JSGlobalObject*>(object);
+    // The typed array constructors are DontEnum.
+    if (mode == IncludeDontEnumProperties)
+        thisObject->createLazyProperties();
+    Base::getOwnNonIndexPropertyNames(thisObject, exec, propertyNames, mode);
+}
+
+static const Identifier& typedArrayName(VM& vm, TypedArrayType type)
+{
+    switch (type) {
+    case TypeInt8:
+        return vm.propertyNames->Int8Array;
+    case TypeUint8:
+        return vm.propertyNames->Uint8Array;
+    case TypeUint8Clamped:
+        return vm.propertyNames->Uint8ClampedArray;
+    case TypeInt16:
+        return vm.propertyNames->Int16Array;
+    case TypeUint16:
+        return vm.propertyNames->Uint16Array;
+    case TypeInt32:
+        return vm.propertyNames->Int32Array;
+    case TypeUint32:
+        return vm.propertyNames->Uint32Array;
+    case TypeFloat32:
+        return vm.propertyNames->Float32Array;
+    case TypeFloat64:
+        return vm.propertyNames->Float64Array;
+    case TypeDataView:
+        return vm.propertyNames->DataView;
+    case NotTypedArray:
+        break;
+    }
+    RELEASE_ASSERT_NOT_REACHED();
+    return vm.propertyNames->nullIdentifier;
+}
+
+// Returns the index of the typed array type whose constructor is yet to be put on the global
+// object under the given name, or -1.
+static int lazyTypedArrayIndex(VM& vm, unsigned lazyProperties, PropertyName propertyName)
+{
+    StringImpl* uid = propertyName.uid();
+    for (unsigned i = 0; lazyProperties >> i; ++i) {
+        if ((lazyProperties & (1 << i)) && typedArrayName(vm, indexToTypedArrayType(i)).impl() == uid)
+            return i;
+    }
+    return -1;
+}
+
 int JSGlobalObject::addGlobalVar(const Identifier& ident, ConstantMode constantMode, FunctionMode functionMode)
 {
     ConcurrentJITLocker locker(symbolTable()->m_lock);
@@ -203,9 +264,14 @@ int JSGlobalObject::addGlobalVar(const Identifier& ident, ConstantMode constantM
     if (functionMode == IsFunctionToSpecialize)
         newEntry.attemptToWatch();
     SymbolTable::Map::AddResult result = symbolTable()->add(locker, ident.impl(), newEntry);
-    if (result.isNewEntry)
+    if (result.isNewEntry) {
         addRegisters(1);
-    else {
+        // A declared function replaces a typed array constructor that hasn't been put on the
+        // global object yet, like it replaces one that has.
+        int typedArrayIndex = lazyTypedArrayIndex(vm(), m_lazyTypedArrayProperties, ident);
+        if (typedArrayIndex >= 0)
+            m_lazyTypedArrayProperties &= ~(1 << typedArrayIndex);
+    } else {
         result.iterator->value.notifyWrite();
         index = result.iterator->value.getIndex();
     }
@@ -241,28 +307,6 @@ void JSGlobalObject::reset(JSValue prototype)
     m_objectPrototype->putDirectAccessor(exec, exec->propertyNames().underscoreProto, protoAccessor, Accessor | DontEnum);
     m_functionPrototype->structure()->setPrototypeWithoutTransition(exec->vm(), m_objectPrototype.get());
     
-    m_typedArrays[toIndex(TypeInt8)].prototype.set(exec->vm(), this, JSInt8ArrayPrototype::create(exec, this, JSInt8ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeInt16)].prototype.set(exec->vm(), this, JSInt16ArrayPrototype::create(exec, this, JSInt16ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeInt32)].prototype.set(exec->vm(), this, JSInt32ArrayPrototype::create(exec, this, JSInt32ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeUint8)].prototype.set(exec->vm(), this, JSUint8ArrayPrototype::create(exec, this, JSUint8ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeUint8Clamped)].prototype.set(exec->vm(), this, JSUint8ClampedArrayPrototype::create(exec, this, JSUint8ClampedArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeUint16)].prototype.set(exec->vm(), this, JSUint16ArrayPrototype::create(exec, this, JSUint16ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeUint32)].prototype.set(exec->vm(), this, JSUint32ArrayPrototype::create(exec, this, JSUint32ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeFloat32)].prototype.set(exec->vm(), this, JSFloat32ArrayPrototype::create(exec, this, JSFloat32ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeFloat64)].prototype.set(exec->vm(), this, JSFloat64ArrayPrototype::create(exec, this, JSFloat64ArrayPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    m_typedArrays[toIndex(TypeDataView)].prototype.set(exec->vm(), this, JSDataViewPrototype::create(exec->vm(), JSDataViewPrototype::createStructure(exec->vm(), this, m_objectPrototype.get())));
-    
-    m_typedArrays[toIndex(TypeInt8)].structure.set(exec->vm(), this, JSInt8Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeInt8)].prototype.get()));
-    m_typedArrays[toIndex(TypeInt16)].structure.set(exec->vm(), this, JSInt16Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeInt16)].prototype.get()));
-    m_typedArrays[toIndex(TypeInt32)].structure.set(exec->vm(), this, JSInt32Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeInt32)].prototype.get()));
-    m_typedArrays[toIndex(TypeUint8)].structure.set(exec->vm(), this, JSUint8Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeUint8)].prototype.get()));
-    m_typedArrays[toIndex(TypeUint8Clamped)].structure.set(exec->vm(), this, JSUint8ClampedArray::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeUint8Clamped)].prototype.get()));
-    m_typedArrays[toIndex(TypeUint16)].structure.set(exec->vm(), this, JSUint16Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeUint16)].prototype.get()));
-    m_typedArrays[toIndex(TypeUint32)].structure.set(exec->vm(), this, JSUint32Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeUint32)].prototype.get()));
-    m_typedArrays[toIndex(TypeFloat32)].structure.set(exec->vm(), this, JSFloat32Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeFloat32)].prototype.get()));
-    m_typedArrays[toIndex(TypeFloat64)].structure.set(exec->vm(), this, JSFloat64Array::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeFloat64)].prototype.get()));
-    m_typedArrays[toIndex(TypeDataView)].structure.set(exec->vm(), this, JSDataView::createStructure(exec->vm(), this, m_typedArrays[toIndex(TypeDataView)].prototype.get()));
-
     m_nameScopeStructure.set(exec->vm(), this, JSNameScope::createStructure(exec->vm(), this, jsNull()));
     m_activationStructure.set(exec->vm(), this, JSActivation::createStructure(exec->vm(), this, jsNull()));
     m_strictEvalActivationStructure.set(exec->vm(), this, StrictEvalActivation::createStructure(exec->vm(), this, jsNull()));
@@ -389,22 +433,7 @@ void JSGlobalObject::reset(JSValue prototype)
     putDirectWithoutTransition(exec->vm(), exec->propertyNames().JSON, JSONObject::create(exec, this, JSONObject::createStructure(exec->vm(), this, m_objectPrototype.get())), DontEnum);
     putDirectWithoutTransition(exec->vm(), exec->propertyNames().Math, MathObject::create(exec, this, MathObject::createStructure(exec->vm(), this, m_objectPrototype.get())), DontEnum);
     
-    FixedArray<InternalFunction*, NUMBER_OF_TYPED_ARRAY_TYPES> typedArrayConstructors;
-    typedArrayConstructors[toIndex(TypeInt8)] = JSInt8ArrayConstructor::create(this, JSInt8ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeInt8)].prototype.get(), "Int8Array");
-    typedArrayConstructors[toIndex(TypeInt16)] = JSInt16ArrayConstructor::create(this, JSInt16ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeInt16)].prototype.get(), "Int16Array");
-    typedArrayConstructors[toIndex(TypeInt32)] = JSInt32ArrayConstructor::create(this, JSInt32ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeInt32)].prototype.get(), "Int32Array");
-    typedArrayConstructors[toIndex(TypeUint8)] = JSUint8ArrayConstructor::create(this, JSUint8ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeUint8)].prototype.get(), "Uint8Array");
-    typedArrayConstructors[toIndex(TypeUint8Clamped)] = JSUint8ClampedArrayConstructor::create(this, JSUint8ClampedArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeUint8Clamped)].prototype.get(), "Uint8ClampedArray");
-    typedArrayConstructors[toIndex(TypeUint16)] = JSUint16ArrayConstructor::create(this, JSUint16ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeUint16)].prototype.get(), "Uint16Array");
-    typedArrayConstructors[toIndex(TypeUint32)] = JSUint32ArrayConstructor::create(this, JSUint32ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeUint32)].prototype.get(), "Uint32Array");
-    typedArrayConstructors[toIndex(TypeFloat32)] = JSFloat32ArrayConstructor::create(this, JSFloat32ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeFloat32)].prototype.get(), "Float32Array");
-    typedArrayConstructors[toIndex(TypeFloat64)] = JSFloat64ArrayConstructor::create(this, JSFloat64ArrayConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeFloat64)].prototype.get(), "Float64Array");
-    typedArrayConstructors[toIndex(TypeDataView)] = JSDataViewConstructor::create(this, JSDataViewConstructor::createStructure(exec->vm(), this, m_functionPrototype.get()), m_typedArrays[toIndex(TypeDataView)].prototype.get(), "DataView");
-
-    for (unsigned typedArrayIndex = NUMBER_OF_TYPED_ARRAY_TYPES; typedArrayIndex--;) {
-        m_typedArrays[typedArrayIndex].prototype->putDirectWithoutTransition(exec->vm(), exec->propertyNames().constructor, typedArrayConstructors[typedArrayIndex], DontEnum);
-        putDirectWithoutTransition(exec->vm(), Identifier(exec, typedArrayConstructors[typedArrayIndex]->name(exec)), typedArrayConstructors[typedArrayIndex], DontEnum);
-    }
+    m_lazyTypedArrayProperties = (1 << NUMBER_OF_TYPED_ARRAY_TYPES) - 1;
 
     GlobalPropertyInfo staticGlobals[] = {
         GlobalPropertyInfo(exec->propertyNames().NaN, jsNaN(), DontEnum | DontDelete | ReadOnly),
@@ -553,6 +582,74 @@ void JSGlobalObject::createThrowTypeError(ExecState* exec)
     m_throwTypeErrorGetterSetter.set(exec->vm(), this, getterSetter);
 }
 
+void JSGlobalObject::createTypedArray(TypedArrayType type)
+{
+    ExecState* exec = globalExec();
+    VM& vm = exec->vm();
+    TypedArrayData& typedArray = m_typedArrays[toIndex(type)];
+    ASSERT(!typedArray.structure);
+
+    JSObject* prototype = 0;
+    InternalFunction* constructor = 0;
+    switch (type) {
+#define CREATE_TYPED_ARRAY(name) \
+    case Type ## name: \
+        prototype = JS ## name ## ArrayPrototype::create(exec, this, JS ## name ## ArrayPrototype::createStructure(vm, this, m_objectPrototype.get())); \
+        typedArray.prototype.set(vm, this, prototype); \
+        typedArray.structure.set(vm, this, JS ## name ## Array::createStructure(vm, this, prototype)); \
+        constructor = JS ## name ## ArrayConstructor::create(this, JS ## name ## ArrayConstructor::createStructure(vm, this, m_functionPrototype.get()), prototype, #name "Array"); \
+        break;
+
+    CREATE_TYPED_ARRAY(Int8)
+    CREATE_TYPED_ARRAY(Uint8)
+    CREATE_TYPED_ARRAY(Uint8Clamped)
+    CREATE_TYPED_ARRAY(Int16)
+    CREATE_TYPED_ARRAY(Uint16)
+    CREATE_TYPED_ARRAY(Int32)
+    CREATE_TYPED_ARRAY(Uint32)
+    CREATE_TYPED_ARRAY(Float32)
+    CREATE_TYPED_ARRAY(Float64)
+
+#undef CREATE_TYPED_ARRAY
+
+    case TypeDataView:
+        prototype = JSDataViewPrototype::create(vm, JSDataViewPrototype::createStructure(vm, this, m_objectPrototype.get()));
+        typedArray.prototype.set(vm, this, prototype);
+        typedArray.structure.set(vm, this, JSDataView::createStructure(vm, this, prototype));
+        constructor = JSDataViewConstructor::create(this, JSDataViewConstructor::createStructure(vm, this, m_functionPrototype.get()), prototype, "DataView");
+        break;
+    case NotTypedArray:
+        RELEASE_ASSERT_NOT_REACHED();
+    }
+
+    prototype->putDirectWithoutTransition(vm, exec->propertyNames().constructor, constructor, DontEnum);
+    typedArray.constructor.set(vm, this, constructor);
+}
+
+bool JSGlobalObject::createLazyProperty(PropertyName propertyName)
+{
+    if (!m_lazyTypedArrayProperties)
+        return false;
+    int typedArrayIndex = lazyTypedArrayIndex(vm(), m_lazyTypedArrayProperties, propertyName);
+    if (typedArrayIndex < 0)
+        return false;
+
+    m_lazyTypedArrayProperties &= ~(1 << typedArrayIndex);
+    TypedArrayType type = indexToTypedArrayType(typedArrayIndex);
+    if (!m_typedArrays[typedArrayIndex].constructor)
+        createTypedArray(type);
+    putDirect(vm(), typedArrayName(vm(), type), m_typedArrays[typedArrayIndex].constructor.get(), DontEnum);
+    return true;
+}
+
+void JSGlobalObject::createLazyProperties()
+{
+    for (unsigned i = 0; i < NUMBER_OF_TYPED_ARRAY_TYPES; ++i) {
+        if (m_lazyTypedArrayProperties & (1 << i))
+            createLazyProperty(typedArrayName(vm(), indexToTypedArrayType(i)));
+    }
+}
+
 // Set prototype, and also insert the object prototype at the end of the chain.
 void JSGlobalObject::resetPrototype(VM& vm, JSValue prototype)
 {
@@ -572,6 +669,9 @@ void JSGlobalObject::visitChildren(JSCell* cell, SlotVisitor& visitor)
     ASSERT(thisObject->structure()->typeInfo().overridesVisitChildren());
     Base::visitChildren(thisObject, visitor);
 
+    // The interpreter stores global variables and properties without a write barrier.
+    visitor.rememberUnbarrieredCell(thisObject);
+
     visitor.append(&thisObject->m_globalThis);
 
     visitor.append(&thisObject->m_regExpConstructor);
@@ -644,6 +744,7 @@ void JSGlobalObject::visitChildren(JSCell* cell, SlotVisitor& visitor)
     for (unsigned i = NUMBER_OF_TYPED_ARRAY_TYPES; i--;) {
         visitor.append(&thisObject->m_typedArrays[i].prototype);
         visitor.append(&thisObject->m_typedArrays[i].structure);
+        visitor.append(&thisObject->m_typedArrays[i].constructor);
     }
 }
 
@@ -679,7 +780,9 @@ bool JSGlobalObject::getOwnPropertySlot(JSObject* object, ExecState* exec, Prope
     JSGlobalObject* thisObject = jsCast<JSGlobalObject*>(object);
     if (getStaticFunctionSlot<Base>(exec, ExecState::globalObjectTable(exec), thisObject, propertyName, slot))
         return true;
-    return symbolTableGet(thisObject, propertyName, slot);
+    if (symbolTableGet(thisObject, propertyName, slot))
+        return true;
+    return thisObject->createLazyProperty(propertyName) && Base::getOwnPropertySlot(thisObject, exec, propertyName, slot);
 }
 
 void JSGlobalObject::clearRareData(JSCell* cell)
@@ -212,9 +212,14 @@ protected:
     struct TypedArrayData {
         WriteBarrier<JSObject> prototype;
         WriteBarrier<Structure> structure;
+        WriteBarrier<JSObject> constructor;
     };
     
+    // Few pages use typed arrays, so the prototype, structure and constructor of each type are
+    // only created when first needed, and the constructor is only put on the global object when
+    // its name is first looked up. Bit n is set while the property of type n is yet to be put.
     FixedArray<TypedArrayData, NUMBER_OF_TYPED_ARRAY_TYPES> m_typedArrays;
+    unsigned m_lazyTypedArrayProperties;
         
     void* m_specialPointers[Special::TableSize]; // Special pointers used by the LLInt and JIT.
 
@@ -296,6 +301,8 @@ public:
     JS_EXPORT_PRIVATE static void defineGetter(JSObject*, ExecState*, PropertyName, JSObject* getterFunc, unsigned attributes);
     JS_EXPORT_PRIVATE static void defineSetter(JSObject*, ExecState*, PropertyName, JSObject* setterFunc, unsigned attributes);
     JS_EXPORT_PRIVATE static bool defineOwnProperty(JSObject*, ExecState*, PropertyName, const PropertyDescriptor&, bool shouldThrow);
+    JS_EXPORT_PRIVATE static bool deleteProperty(JSCell*, ExecState*, PropertyName);
+    JS_EXPORT_PRIVATE static void getOwnNonIndexPropertyNames(JSObject*, ExecState*, PropertyNameArray&, EnumerationMode);
 
     // We use this in the code generator as we perform symbol table
     // lookups prior to initializing the properties
@@ -421,7 +428,12 @@ public:
 
     Structure* typedArrayStructure(TypedArrayType type) const
     {
-        return m_typedArrays[toIndex(type)].structure.get();
+        Structure* structure = m_typedArrays[toIndex(type)].structure.get();
+        if (UNLIKELY(!structure)) {
+            const_cast<JSGlobalObject*>(this)->createTypedArray(type);
+            structure = m_typedArrays[toIndex(type)].structure.get();
+        }
+        return structure;
     }
 
     void* actualPointerFor(Special::Pointer pointer)
@@ -539,6 +551,12 @@ private:
 
     void createThrowTypeError(ExecState*);
 
+    JS_EXPORT_PRIVATE void createTypedArray(TypedArrayType);
+    // Puts the typed array constructor the name refers to on the global object if it isn't
+    // there yet. Returns true if it did.
+    JS_EXPORT_PRIVATE bool createLazyProperty(PropertyName);
+    void createLazyProperties();
+
     JS_EXPORT_PRIVATE static void clearRareData(JSCell*);
 };
 
@@ -552,6 +570,8 @@ inline JSGlobalObject* asGlobalObject(JSValue value)
 
 inline bool JSGlobalObject::hasOwnPropertyForWrite(ExecState* exec, PropertyName propertyName)
 {
+    if (m_lazyTypedArrayProperties)
+        createLazyProperty(propertyName);
     PropertySlot slot(this);
     if (Base::getOwnPropertySlot(this, exec, propertyName, slot))
         return true;
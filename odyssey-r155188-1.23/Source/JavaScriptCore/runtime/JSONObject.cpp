@@ -26,6 +26,7 @@
 #include "config.h"
 #include "JSONObject.h"
 
+#include "ArrayPrototype.h"
 #include "BooleanObject.h"
 #include "Error.h"
 #include "ExceptionHelpers.h"
@@ -36,9 +37,12 @@
 #include "LocalScope.h"
 #include "Lookup.h"
 #include "ObjectConstructor.h"
+#include "ObjectPrototype.h"
 #include "Operations.h"
 #include "PropertyNameArray.h"
+#include <wtf/HashMap.h>
 #include <wtf/MathExtras.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/text/StringBuilder.h>
 
 namespace JSC {
@@ -107,7 +111,28 @@ private:
 
     friend class Holder;
 
-    static void appendQuotedString(StringBuilder&, const String&);
+    // Without a replacer or a gap, plain objects and arrays whose values are all plain too are
+    // written straight from their storage. Nothing on this path can run JavaScript: there are
+    // no getters, no toJSON functions on the objects or their prototypes and no holes, so the
+    // objects cannot change while they are written. Anything else makes the fast path give up;
+    // the output is rolled back and the value is written by the generic path, which tries the
+    // fast path again for every object nested in it.
+    struct FastPathProperty {
+        String quotedName;
+        PropertyOffset offset;
+    };
+    struct FastPathShape {
+        bool isArray;
+        Vector<FastPathProperty> properties;
+    };
+    // Only valid while no JavaScript runs, which could collect a structure and reuse its cell.
+    typedef HashMap<Structure*, OwnPtr<FastPathShape> > FastPathShapeMap;
+
+    enum FastStringifyResult { FastStringifyFailed, FastStringifySucceeded, FastStringifySkippedUndefinedValue };
+    bool appendFastStringifiedObject(StringBuilder&, JSObject*, FastPathShapeMap&, unsigned depth);
+    FastStringifyResult appendFastStringifiedValue(StringBuilder&, JSValue, FastPathShapeMap&, unsigned depth);
+    const FastPathShape* fastPathShape(Structure*, FastPathShapeMap&);
+    PassOwnPtr<FastPathShape> createFastPathShape(Structure*);
 
     JSValue toJSON(JSValue, const PropertyNameForFunctionCall&);
 
@@ -126,6 +151,7 @@ private:
     CallType m_replacerCallType;
     CallData m_replacerCallData;
     const String m_gap;
+    bool m_canUseFastPath;
 
     Vector<Holder, 16, UnsafeVectorOverflow> m_holderStack;
     String m_repeatedGap;
@@ -210,10 +236,13 @@ Stringifier::Stringifier(ExecState* exec, const Local<Unknown>& replacer, const
     , m_arrayReplacerPropertyNames(exec)
     , m_replacerCallType(CallTypeNone)
     , m_gap(gap(exec, space.get()))
+    , m_canUseFastPath(m_gap.isEmpty())
 {
     if (!m_replacer.isObject())
         return;
 
+    m_canUseFastPath = false;
+
     if (m_replacer.asObject()->inherits(JSArray::info())) {
         m_usingArrayReplacer = true;
         Handle<JSObject> array = m_replacer.asObject();
@@ -303,7 +332,7 @@ static void appendStringToStringBuilder(StringBuilder& builder, const CharType*
     }
 }
     
-void Stringifier::appendQuotedString(StringBuilder& builder, const String& value)
+void appendQuotedJSONString(StringBuilder& builder, const String& value)
 {
     int length = value.length();
 
@@ -341,8 +370,178 @@ inline JSValue Stringifier::toJSON(JSValue value, const PropertyNameForFunctionC
     return call(m_exec, object, callType, callData, value, args);
 }
 
+// Deeper values are left to the generic path, which also catches cycles.
+static const unsigned maximumFastPathDepth = 64;
+
+static bool hasToJSONProperty(VM& vm, Structure* structure)
+{
+    return structure->get(vm, vm.propertyNames->toJSON) != invalidOffset;
+}
+
+PassOwnPtr<Stringifier::FastPathShape> Stringifier::createFastPathShape(Structure* structure)
+{
+    VM& vm = m_exec->vm();
+    JSGlobalObject* globalObject = structure->globalObject();
+    if (!globalObject || hasToJSONProperty(vm, structure))
+        return nullptr;
+
+    ObjectPrototype* objectPrototype = globalObject->objectPrototype();
+    if (hasToJSONProperty(vm, objectPrototype->structure()) || !objectPrototype->prototype().isNull())
+        return nullptr;
+
+    JSValue prototype = structure->storedPrototype();
+    OwnPtr<FastPathShape> shape = adoptPtr(new FastPathShape);
+    if (structure->classInfo() == JSArray::info()) {
+        ArrayPrototype* arrayPrototype = globalObject->arrayPrototype();
+        if (prototype != JSValue(arrayPrototype) || hasToJSONProperty(vm, arrayPrototype->structure()) || arrayPrototype->prototype() != JSValue(objectPrototype))
+            return nullptr;
+        IndexingType indexingType = structure->indexingType();
+        if (hasIndexedProperties(indexingType) && !hasUndecided(indexingType) && !hasInt32(indexingType) && !hasDouble(indexingType) && !hasContiguous(indexingType))
+            return nullptr;
+        shape->isArray = true;
+        return shape.release();
+    }
+
+    if (structure->typeInfo().type() != FinalObjectType || hasIndexedProperties(structure->indexingType()) || structure->hasGetterSetterProperties())
+        return nullptr;
+    if (!prototype.isNull() && prototype != JSValue(objectPrototype))
+        return nullptr;
+
+    PropertyNameArray propertyNames(m_exec);
+    structure->getPropertyNamesFromStructure(vm, propertyNames, ExcludeDontEnumProperties);
+    shape->isArray = false;
+    shape->properties.resize(propertyNames.size());
+    for (size_t i = 0; i < propertyNames.size(); ++i) {
+        const Identifier& propertyName = propertyNames[i];
+        FastPathProperty& property = shape->properties[i];
+        StringBuilder quotedName;
+        appendQuotedJSONString(quotedName, propertyName.string());
+        quotedName.append(':');
+        property.quotedName = quotedName.toString();
+        property.offset = structure->get(vm, propertyName);
+        ASSERT(isValidOffset(property.offset));
+    }
+    return shape.release();
+}
+
+inline const Stringifier::FastPathShape* Stringifier::fastPathShape(Structure* structure, FastPathShapeMap& shapes)
+{
+    FastPathShapeMap::iterator it = shapes.find(structure);
+    if (it != shapes.end())
+        return it->value.get();
+    return shapes.add(structure, createFastPathShape(structure)).iterator->value.get();
+}
+
+Stringifier::FastStringifyResult Stringifier::appendFastStringifiedValue(StringBuilder& builder, JSValue value, FastPathShapeMap& shapes, unsigned depth)
+{
+    if (value.isInt32()) {
+        builder.appendNumber(value.asInt32());
+        return FastStringifySucceeded;
+    }
+    if (value.isDouble()) {
+        double number = value.asDouble();
+        if (!std::isfinite(number))
+            builder.appendLiteral("null");
+        else
+            builder.append(String::numberToStringECMAScript(number));
+        return FastStringifySucceeded;
+    }
+    if (value.isNull()) {
+        builder.appendLiteral("null");
+        return FastStringifySucceeded;
+    }
+    if (value.isBoolean()) {
+        if (value.isTrue())
+            builder.appendLiteral("true");
+        else
+            builder.appendLiteral("false");
+        return FastStringifySucceeded;
+    }
+    if (value.isUndefined())
+        return FastStringifySkippedUndefinedValue;
+    if (value.isString()) {
+        const String& string = asString(value)->value(m_exec);
+        if (m_exec->hadException())
+            return FastStringifyFailed;
+        appendQuotedJSONString(builder, string);
+        return FastStringifySucceeded;
+    }
+    if (value.isObject() && appendFastStringifiedObject(builder, asObject(value), shapes, depth + 1))
+        return FastStringifySucceeded;
+    return FastStringifyFailed;
+}
+
+bool Stringifier::appendFastStringifiedObject(StringBuilder& builder, JSObject* object, FastPathShapeMap& shapes, unsigned depth)
+{
+    if (depth > maximumFastPathDepth)
+        return false;
+    const FastPathShape* shape = fastPathShape(object->structure(), shapes);
+    if (!shape)
+        return false;
+
+    if (shape->isArray) {
+        IndexingType indexingType = object->structure()->indexingType();
+        Butterfly* butterfly = object->butterfly();
+        unsigned length = asArray(object)->length();
+        builder.append('[');
+        for (unsigned i = 0; i < length; ++i) {
+            // Holes would have to be looked up on the prototype chain.
+            JSValue value;
+            if (hasDouble(indexingType)) {
+                double number = butterfly->contiguousDouble()[i];
+                if (number != number)
+                    return false;
+                value = JSValue(JSValue::EncodeAsDouble, number);
+            } else if (hasInt32(indexingType) || hasContiguous(indexingType))
+                value = butterfly->contiguous()[i].get();
+            if (!value)
+                return false;
+
+            if (i)
+                builder.append(',');
+            FastStringifyResult result = appendFastStringifiedValue(builder, value, shapes, depth);
+            if (result == FastStringifyFailed)
+                return false;
+            if (result == FastStringifySkippedUndefinedValue)
+                builder.appendLiteral("null");
+        }
+        builder.append(']');
+        return true;
+    }
+
+    builder.append('{');
+    bool isFirstProperty = true;
+    for (size_t i = 0; i < shape->properties.size(); ++i) {
+        const FastPathProperty& property = shape->properties[i];
+        unsigned rollBackPoint = builder.length();
+        if (!isFirstProperty)
+            builder.append(',');
+        builder.append(property.quotedName);
+        FastStringifyResult result = appendFastStringifiedValue(builder, object->getDirect(property.offset), shapes, depth);
+        if (result == FastStringifyFailed)
+            return false;
+        if (result == FastStringifySkippedUndefinedValue) {
+            builder.resize(rollBackPoint);
+            continue;
+        }
+        isFirstProperty = false;
+    }
+    builder.append('}');
+    return true;
+}
+
 Stringifier::StringifyResult Stringifier::appendStringifiedValue(StringBuilder& builder, JSValue value, JSObject* holder, const PropertyNameForFunctionCall& propertyName)
 {
+    if (m_canUseFastPath && value.isObject()) {
+        unsigned start = builder.length();
+        FastPathShapeMap shapes;
+        if (appendFastStringifiedObject(builder, asObject(value), shapes, 0))
+            return StringifySucceeded;
+        if (m_exec->hadException())
+            return StringifyFailed;
+        builder.resize(start);
+    }
+
     // Call the toJSON function.
     value = toJSON(value, propertyName);
     if (m_exec->hadException())
@@ -381,7 +580,7 @@ Stringifier::StringifyResult Stringifier::appendStringifiedValue(StringBuilder&
 
     String stringValue;
     if (value.getString(m_exec, stringValue)) {
-        appendQuotedString(builder, stringValue);
+        appendQuotedJSONString(builder, stringValue);
         return StringifySucceeded;
     }
 
@@ -548,7 +747,7 @@ bool Stringifier::Holder::appendNextProperty(Stringifier& stringifier, StringBui
         stringifier.startNewLine(builder);
 
         // Append the property name.
-        appendQuotedString(builder, propertyName.string());
+        appendQuotedJSONString(builder, propertyName.string());
         builder.append(':');
         if (stringifier.willIndent())
             builder.append(' ');
@@ -784,12 +983,12 @@ EncodedJSValue JSC_HOST_CALL JSONProtoFuncParse(ExecState* exec)
     JSValue unfiltered;
     LocalScope scope(exec->vm());
     if (source.is8Bit()) {
-        LiteralParser<LChar> jsonParser(exec, source.characters8(), source.length(), StrictJSON);
+        LiteralParser<LChar> jsonParser(exec, source.characters8(), source.length(), StrictJSON, source.impl());
         unfiltered = jsonParser.tryLiteralParse();
         if (!unfiltered)
             return throwVMError(exec, createSyntaxError(exec, jsonParser.getErrorMessage()));
     } else {
-        LiteralParser<UChar> jsonParser(exec, source.characters16(), source.length(), StrictJSON);
+        LiteralParser<UChar> jsonParser(exec, source.characters16(), source.length(), StrictJSON, source.impl());
         unfiltered = jsonParser.tryLiteralParse();
         if (!unfiltered)
             return throwVMError(exec, createSyntaxError(exec, jsonParser.getErrorMessage()));        
@@ -824,11 +1023,11 @@ JSValue JSONParse(ExecState* exec, const String& json)
     LocalScope scope(exec->vm());
 
     if (json.is8Bit()) {
-        LiteralParser<LChar> jsonParser(exec, json.characters8(), json.length(), StrictJSON);
+        LiteralParser<LChar> jsonParser(exec, json.characters8(), json.length(), StrictJSON, json.impl());
         return jsonParser.tryLiteralParse();
     }
 
-    LiteralParser<UChar> jsonParser(exec, json.characters16(), json.length(), StrictJSON);
+    LiteralParser<UChar> jsonParser(exec, json.characters16(), json.length(), StrictJSON, json.impl());
     return jsonParser.tryLiteralParse();
 }
 
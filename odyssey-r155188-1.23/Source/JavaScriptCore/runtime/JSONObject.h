@@ -62,6 +62,8 @@ namespace JSC {
 
     JS_EXPORT_PRIVATE JSValue JSONParse(ExecState*, const String&);
     String JSONStringify(ExecState*, JSValue, unsigned indent);
+    // Appends a string as a quoted JSON string, for code that writes JSON without any script.
+    JS_EXPORT_PRIVATE void appendQuotedJSONString(StringBuilder&, const String&);
 
 } // namespace JSC
 
@@ -108,9 +108,9 @@ namespace JSC {
         return m_enumerationCache.get();
     }
     
-    inline void StructureRareData::setEnumerationCache(VM& vm, const Structure* owner, JSPropertyNameIterator* value)
+    inline void StructureRareData::setEnumerationCache(VM& vm, JSPropertyNameIterator* value)
     {
-        m_enumerationCache.set(vm, owner, value);
+        m_enumerationCache.set(vm, this, value);
     }
 
 } // namespace JSC
@@ -32,8 +32,6 @@
 
 namespace JSC {
     
-static const unsigned substringFromRopeCutoff = 4;
-
 const ClassInfo JSString::s_info = { "string", 0, 0, 0, CREATE_METHOD_TABLE(JSString) };
 
 void JSRopeString::RopeBuilder::expand()
@@ -84,14 +82,174 @@ void JSRopeString::visitFibers(SlotVisitor& visitor)
         visitor.append(&m_fibers[i]);
 }
 
+static inline void copyCharacters(LChar* destination, const StringImpl* string, unsigned offset, unsigned length)
+{
+    ASSERT(string->is8Bit());
+    StringImpl::copyChars(destination, string->characters8() + offset, length);
+}
+
+static inline void copyCharacters(UChar* destination, const StringImpl* string, unsigned offset, unsigned length)
+{
+    if (string->is8Bit())
+        StringImpl::copyChars(destination, string->characters8() + offset, length);
+    else
+        StringImpl::copyChars(destination, string->characters16() + offset, length);
+}
+
+namespace {
+
+struct StringRange {
+    StringRange()
+        : string(0)
+        , offset(0)
+        , length(0)
+    {
+    }
+
+    StringRange(JSString* string, unsigned offset, unsigned length)
+        : string(string)
+        , offset(offset)
+        , length(length)
+    {
+    }
+
+    JSString* string;
+    unsigned offset;
+    unsigned length;
+};
+
+} // namespace
+
+// Copies a part of a string without resolving it, or any rope in it.
+template<typename CharacterType>
+void JSRopeString::copyRange(CharacterType* destination, JSString* string, unsigned offset, unsigned length)
+{
+    Vector<StringRange, 32, UnsafeVectorOverflow> workQueue; // Putting strings into a Vector is only OK because there are no GC points in this method.
+    workQueue.append(StringRange(string, offset, length));
+
+    while (!workQueue.isEmpty()) {
+        StringRange range = workQueue.last();
+        workQueue.removeLast();
+
+        if (!range.string->isRope()) {
+            copyCharacters(destination, range.string->m_value.impl(), range.offset, range.length);
+            destination += range.length;
+            continue;
+        }
+
+        JSRopeString* rope = static_cast<JSRopeString*>(range.string);
+        if (rope->isSubstring()) {
+            workQueue.append(StringRange(rope->m_fibers[0].get(), rope->m_substringOffset + range.offset, range.length));
+            continue;
+        }
+
+        // Queue the fibers that overlap the range, the last one first.
+        StringRange fiberRanges[s_maxInternalRopeLength];
+        size_t fiberRangeCount = 0;
+        unsigned rangeEnd = range.offset + range.length;
+        unsigned fiberStart = 0;
+        for (size_t i = 0; i < s_maxInternalRopeLength && rope->m_fibers[i] && fiberStart < rangeEnd; ++i) {
+            JSString* fiber = rope->m_fibers[i].get();
+            unsigned fiberEnd = fiberStart + fiber->m_length;
+            if (fiberEnd > range.offset) {
+                unsigned start = std::max(fiberStart, range.offset);
+                unsigned end = std::min(fiberEnd, rangeEnd);
+                fiberRanges[fiberRangeCount++] = StringRange(fiber, start - fiberStart, end - start);
+            }
+            fiberStart = fiberEnd;
+        }
+        while (fiberRangeCount)
+            workQueue.append(fiberRanges[--fiberRangeCount]);
+    }
+}
+
+// The left-most fiber that is not a rope, unless a substring rope comes first.
+JSString* JSRopeString::leftmostFlatFiber() const
+{
+    JSString* fiber = m_fibers[0].get();
+    while (fiber && fiber->isRope()) {
+        JSRopeString* rope = static_cast<JSRopeString*>(fiber);
+        if (rope->isSubstring())
+            return 0;
+        fiber = rope->m_fibers[0].get();
+    }
+    return fiber;
+}
+
+// Flattening usually starts with a copy of the left-most fiber, which in |s += t; f(s);|
+// loops is the string that the previous round flattened. A long string that mostly
+// consists of its left-most fiber is therefore given room to spare, and the next
+// flattening appends to it.
+template<typename CharacterType>
+PassRefPtr<StringImpl> JSRopeString::createFlatteningBuffer(CharacterType*& buffer) const
+{
+    static const unsigned minimumExtensibleLength = 256;
+
+    unsigned capacity = m_length;
+    if (m_length >= minimumExtensibleLength && m_length <= std::numeric_limits<unsigned>::max() - m_length / 2) {
+        JSString* fiber = leftmostFlatFiber();
+        if (fiber && fiber->m_length >= m_length / 2)
+            capacity = m_length + m_length / 2;
+    }
+
+    RefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(capacity, buffer);
+    if (!newImpl && capacity > m_length) {
+        capacity = m_length;
+        newImpl = StringImpl::tryCreateUninitialized(capacity, buffer);
+    }
+    if (!newImpl)
+        return 0;
+    Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+    if (capacity == m_length)
+        return newImpl.release();
+    m_flags |= HasSpareCapacity;
+    return StringImpl::create(newImpl.release(), 0, m_length);
+}
+
+// Appends to the buffer of the left-most fiber when that fiber has room to spare. Only
+// characters past the end of the fiber are written, so the fiber, and any string that
+// shares its characters, stays as it is.
+template<typename CharacterType>
+bool JSRopeString::resolveRopeInLeftmostFiberBuffer() const
+{
+    JSString* fiber = leftmostFlatFiber();
+    if (!fiber || !(fiber->m_flags & HasSpareCapacity))
+        return false;
+
+    StringImpl* buffer = fiber->m_value.impl()->substringBuffer();
+    ASSERT(buffer);
+    // Characters that the buffer upconverted to 16 bits would not see the append.
+    if (buffer->is8Bit() != is8Bit() || buffer->length() < m_length || buffer->has16BitShadow())
+        return false;
+
+    CharacterType* characters = const_cast<CharacterType*>(buffer->getCharacters<CharacterType>());
+    ASSERT(fiber->m_value.impl()->getCharacters<CharacterType>() == characters);
+    unsigned fiberLength = fiber->m_length;
+    copyRange(characters + fiberLength, const_cast<JSRopeString*>(this), fiberLength, m_length - fiberLength);
+    m_value = StringImpl::create(buffer, 0, m_length);
+    fiber->m_flags &= ~HasSpareCapacity;
+    m_flags |= HasSpareCapacity;
+    for (size_t i = 0; i < s_maxInternalRopeLength && m_fibers[i]; ++i)
+        m_fibers[i].clear();
+    ASSERT(!isRope());
+    return true;
+}
+
 void JSRopeString::resolveRope(ExecState* exec) const
 {
     ASSERT(isRope());
 
+    if (isSubstring()) {
+        resolveSubstring(exec);
+        return;
+    }
+
     if (is8Bit()) {
+        if (resolveRopeInLeftmostFiberBuffer<LChar>())
+            return;
+
         LChar* buffer;
-        if (RefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer)) {
-            Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+        if (RefPtr<StringImpl> newImpl = createFlatteningBuffer(buffer)) {
             m_value = newImpl.release();
         } else {
             outOfMemory(exec);
@@ -117,9 +275,11 @@ void JSRopeString::resolveRope(ExecState* exec) const
         return;
     }
 
+    if (resolveRopeInLeftmostFiberBuffer<UChar>())
+        return;
+
     UChar* buffer;
-    if (RefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer)) {
-        Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+    if (RefPtr<StringImpl> newImpl = createFlatteningBuffer(buffer)) {
         m_value = newImpl.release();
     } else {
         outOfMemory(exec);
@@ -173,6 +333,11 @@ void JSRopeString::resolveRopeSlowCase8(LChar* buffer) const
 
         if (currentFiber->isRope()) {
             JSRopeString* currentFiberAsRope = static_cast<JSRopeString*>(currentFiber);
+            if (currentFiberAsRope->isSubstring()) {
+                position -= currentFiber->m_length;
+                copyRange(position, currentFiber, 0, currentFiber->m_length);
+                continue;
+            }
             for (size_t i = 0; i < s_maxInternalRopeLength && currentFiberAsRope->m_fibers[i]; ++i)
                 workQueue.append(currentFiberAsRope->m_fibers[i].get());
             continue;
@@ -191,10 +356,13 @@ void JSRopeString::resolveRopeSlowCase8(LChar* buffer) const
 void JSRopeString::resolveRopeSlowCase(UChar* buffer) const
 {
     UChar* position = buffer + m_length; // We will be working backwards over the rope.
-    Vector<JSString*, 32, UnsafeVectorOverflow> workQueue; // These strings are kept alive by the parent rope, so using a Vector is OK.
+    Vector<JSString*, 32, UnsafeVectorOverflow> workQueue; // Putting strings into a Vector is only OK because there are no GC points in this method.
 
-    for (size_t i = 0; i < s_maxInternalRopeLength && m_fibers[i]; ++i)
+    for (size_t i = 0; i < s_maxInternalRopeLength && m_fibers[i]; ++i) {
         workQueue.append(m_fibers[i].get());
+        // Clearing here works only because there are no GC points in this method.
+        m_fibers[i].clear();
+    }
 
     while (!workQueue.isEmpty()) {
         JSString* currentFiber = workQueue.last();
@@ -202,6 +370,11 @@ void JSRopeString::resolveRopeSlowCase(UChar* buffer) const
 
         if (currentFiber->isRope()) {
             JSRopeString* currentFiberAsRope = static_cast<JSRopeString*>(currentFiber);
+            if (currentFiberAsRope->isSubstring()) {
+                position -= currentFiber->m_length;
+                copyRange(position, currentFiber, 0, currentFiber->m_length);
+                continue;
+            }
             for (size_t i = 0; i < s_maxInternalRopeLength && currentFiberAsRope->m_fibers[i]; ++i)
                 workQueue.append(currentFiberAsRope->m_fibers[i].get());
             continue;
@@ -220,10 +393,99 @@ void JSRopeString::resolveRopeSlowCase(UChar* buffer) const
     ASSERT(!isRope());
 }
 
+void JSRopeString::resolveSubstring(ExecState* exec) const
+{
+    JSString* base = m_fibers[0].get();
+    unsigned offset = m_substringOffset;
+    while (base->isRope() && static_cast<JSRopeString*>(base)->isSubstring()) {
+        offset += static_cast<JSRopeString*>(base)->m_substringOffset;
+        base = static_cast<JSRopeString*>(base)->m_fibers[0].get();
+    }
+
+    if (!base->isRope()) {
+        const String& baseValue = base->m_value;
+        if (shouldCopySubstring(baseValue.length(), m_length)) {
+            RefPtr<StringImpl> newImpl = copySubstringCharacters(baseValue, offset, m_length);
+            Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+            m_value = newImpl.release();
+        } else
+            m_value = StringImpl::create(baseValue.impl(), offset, m_length);
+    } else if (is8Bit()) {
+        LChar* buffer;
+        RefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer);
+        if (!newImpl) {
+            outOfMemory(exec);
+            return;
+        }
+        copyRange(buffer, base, offset, m_length);
+        Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+        m_value = newImpl.release();
+    } else {
+        UChar* buffer;
+        RefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer);
+        if (!newImpl) {
+            outOfMemory(exec);
+            return;
+        }
+        copyRange(buffer, base, offset, m_length);
+        Heap::heap(this)->reportExtraMemoryCost(newImpl->cost());
+        m_value = newImpl.release();
+    }
+
+    m_fibers[0].clear();
+    m_flags &= ~IsSubstring;
+    ASSERT(!isRope());
+}
+
+JSString* JSRopeString::substring(ExecState* exec, unsigned offset, unsigned length)
+{
+    ASSERT(isRope());
+    VM& vm = exec->vm();
+
+    JSRopeString* rope = this;
+    while (rope->isSubstring()) {
+        offset += rope->m_substringOffset;
+        JSString* base = rope->m_fibers[0].get();
+        if (!base->isRope())
+            return jsSubstring(&vm, base->m_value, offset, length);
+        rope = static_cast<JSRopeString*>(base);
+    }
+
+    // A small part is copied out of the rope straight away, which is much cheaper than
+    // flattening all of it. A substring rope would cost about as much, and would keep the whole
+    // rope alive until it is read.
+    if (shouldCopySubstring(rope->m_length, length)) {
+        RefPtr<StringImpl> impl;
+        if (rope->is8Bit()) {
+            LChar* buffer;
+            if ((impl = StringImpl::tryCreateUninitialized(length, buffer)))
+                copyRange(buffer, rope, offset, length);
+        } else {
+            UChar* buffer;
+            if ((impl = StringImpl::tryCreateUninitialized(length, buffer)))
+                copyRange(buffer, rope, offset, length);
+        }
+        if (!impl) {
+            throwOutOfMemoryError(exec);
+            return jsEmptyString(exec);
+        }
+        return jsString(&vm, String(impl.release()));
+    }
+
+    // A large part may keep the rope alive, as a substring of a flat string keeps that alive.
+    // Later substrings would have to search the rope again, so they flatten it instead.
+    if (!(rope->m_flags & HasSubstringRope)) {
+        rope->m_flags |= HasSubstringRope;
+        return createSubstring(vm, rope, offset, length);
+    }
+    return jsSubstring(&vm, rope->value(exec), offset, length);
+}
+
 void JSRopeString::outOfMemory(ExecState* exec) const
 {
     for (size_t i = 0; i < s_maxInternalRopeLength && m_fibers[i]; ++i)
         m_fibers[i].clear();
+    m_flags &= ~IsSubstring;
     ASSERT(isRope());
     ASSERT(m_value.isNull());
     if (exec)
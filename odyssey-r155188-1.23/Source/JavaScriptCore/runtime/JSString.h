@@ -168,6 +168,13 @@ namespace JSC {
         static void visitChildren(JSCell*, SlotVisitor&);
 
         enum {
+            // Set on a flattened JSRopeString whose characters start a buffer with room to
+            // spare, which only this string may append to.
+            HasSpareCapacity = 1u << 5,
+            // Set on a JSRopeString that stands for a part of its first fiber.
+            IsSubstring = 1u << 4,
+            // Set on a JSRopeString whose substring has been taken without flattening it.
+            HasSubstringRope = 1u << 3,
             HashConsLock = 1u << 2,
             IsHashConsSingleton = 1u << 1,
             Is8Bit = 1u
@@ -192,7 +199,8 @@ namespace JSC {
         bool tryHashConsLock();
         void releaseHashConsLock();
 
-        unsigned m_flags;
+        // Some flags describe how the string is represented, which changes as ropes are resolved.
+        mutable unsigned m_flags;
             
         // A string is represented either by a String or a rope of fibers.
         unsigned m_length;
@@ -250,6 +258,7 @@ namespace JSC {
     private:
         JSRopeString(VM& vm)
             : JSString(vm)
+            , m_substringOffset(0)
         {
         }
 
@@ -277,6 +286,16 @@ namespace JSC {
             JSString::finishCreation(vm);
         }
 
+        void finishCreationSubstring(VM& vm, JSString* base, unsigned offset, unsigned length)
+        {
+            Base::finishCreation(vm);
+            m_length = length;
+            setIs8Bit(base->is8Bit());
+            m_flags |= IsSubstring;
+            m_substringOffset = offset;
+            m_fibers[0].set(vm, this, base);
+        }
+
         void append(VM& vm, size_t index, JSString* jsString)
         {
             m_fibers[index].set(vm, this, jsString);
@@ -291,6 +310,13 @@ namespace JSC {
             return newString;
         }
 
+        static JSRopeString* createSubstring(VM& vm, JSString* base, unsigned offset, unsigned length)
+        {
+            JSRopeString* newString = new (NotNull, allocateCell<JSRopeString>(vm.heap)) JSRopeString(vm);
+            newString->finishCreationSubstring(vm, base, offset, length);
+            return newString;
+        }
+
     public:
         static JSString* create(VM& vm, JSString* s1, JSString* s2)
         {
@@ -306,6 +332,9 @@ namespace JSC {
         }
 
         void visitFibers(SlotVisitor&);
+
+        // Takes a substring without flattening the rope when that is cheaper.
+        JS_EXPORT_PRIVATE JSString* substring(ExecState*, unsigned offset, unsigned length);
             
         static ptrdiff_t offsetOfFibers() { return OBJECT_OFFSETOF(JSRopeString, m_fibers); }
 
@@ -315,16 +344,42 @@ namespace JSC {
         friend JSValue jsString(ExecState*, Register*, unsigned);
         friend JSValue jsStringFromArguments(ExecState*, JSValue);
 
+        bool isSubstring() const { return m_flags & IsSubstring; }
+
         JS_EXPORT_PRIVATE void resolveRope(ExecState*) const;
         void resolveRopeSlowCase8(LChar*) const;
         void resolveRopeSlowCase(UChar*) const;
+        void resolveSubstring(ExecState*) const;
+        JSString* leftmostFlatFiber() const;
+        template<typename CharacterType> PassRefPtr<StringImpl> createFlatteningBuffer(CharacterType*&) const;
+        template<typename CharacterType> bool resolveRopeInLeftmostFiberBuffer() const;
+        template<typename CharacterType> static void copyRange(CharacterType*, JSString*, unsigned offset, unsigned length);
         void outOfMemory(ExecState*) const;
             
         JS_EXPORT_PRIVATE JSString* getIndexSlowCase(ExecState*, unsigned);
 
+        // A substring rope has its base in m_fibers[0] and no other fibers.
         mutable FixedArray<WriteBarrier<JSString>, s_maxInternalRopeLength> m_fibers;
+        unsigned m_substringOffset;
     };
 
+    // A substring shares the characters of its string unless it is less than
+    // 1/substringSharingRatio of it. Sharing would then keep a much longer string alive
+    // for the sake of a small part, so the part is copied instead.
+    static const unsigned substringSharingRatio = 8;
+
+    inline bool shouldCopySubstring(unsigned stringLength, unsigned substringLength)
+    {
+        return substringLength < stringLength / substringSharingRatio;
+    }
+
+    inline PassRefPtr<StringImpl> copySubstringCharacters(const String& s, unsigned offset, unsigned length)
+    {
+        if (s.is8Bit())
+            return StringImpl::create(s.characters8() + offset, length);
+        return StringImpl::create(s.characters16() + offset, length);
+    }
+
 
     inline const StringImpl* JSString::tryGetValueImpl() const
     {
@@ -358,6 +413,8 @@ namespace JSC {
         UChar c = s.characterAt(offset);
         if (c <= maxSingleCharacterString)
             return vm->smallStrings.singleCharacterString(c);
+        if (shouldCopySubstring(s.length(), 1))
+            return JSString::create(*vm, String(&c, 1).impl());
         return JSString::create(*vm, StringImpl::create(s.impl(), offset, 1));
     }
 
@@ -411,7 +468,11 @@ namespace JSC {
         VM* vm = &exec->vm();
         if (!length)
             return vm->smallStrings.emptyString();
-        return jsSubstring(vm, s->value(exec), offset, length);
+        if (!offset && length == s->length())
+            return s;
+        if (s->isRope())
+            return static_cast<JSRopeString*>(s)->substring(exec, offset, length);
+        return jsSubstring(vm, s->m_value, offset, length);
     }
 
     inline JSString* jsSubstring8(VM* vm, const String& s, unsigned offset, unsigned length)
@@ -426,6 +487,8 @@ namespace JSC {
             if (c <= maxSingleCharacterString)
                 return vm->smallStrings.singleCharacterString(c);
         }
+        if (shouldCopySubstring(s.length(), length))
+            return JSString::create(*vm, StringImpl::create(s.characters8() + offset, length));
         return JSString::createHasOtherOwner(*vm, StringImpl::create8(s.impl(), offset, length));
     }
 
@@ -441,6 +504,8 @@ namespace JSC {
             if (c <= maxSingleCharacterString)
                 return vm->smallStrings.singleCharacterString(c);
         }
+        if (shouldCopySubstring(s.length(), length))
+            return JSString::create(*vm, copySubstringCharacters(s, offset, length));
         return JSString::createHasOtherOwner(*vm, StringImpl::create(s.impl(), offset, length));
     }
 
@@ -169,6 +169,74 @@ ALWAYS_INLINE const Identifier LiteralParser<CharType>::makeIdentifier(const UCh
     return m_recentIdentifiers[characters[0]];
 }
 
+template <typename CharType>
+Identifier LiteralParser<CharType>::makePropertyName(const LiteralParserToken<CharType>& token, JSValue object, const StructureTransitionCache& transitions)
+{
+    typename StructureTransitionCache::const_iterator transition = transitions.find(asObject(object)->structure());
+    if (transition != transitions.end()) {
+        StringImpl* name = transition->value.propertyName.impl();
+        if (token.stringIs8Bit ? Identifier::equal(name, token.stringToken8, token.stringLength) : Identifier::equal(name, token.stringToken16, token.stringLength))
+            return transition->value.propertyName;
+    }
+    if (token.stringIs8Bit)
+        return makeIdentifier(token.stringToken8, token.stringLength);
+    return makeIdentifier(token.stringToken16, token.stringLength);
+}
+
+template <typename CharType>
+void LiteralParser<CharType>::putProperty(JSObject* object, const Identifier& propertyName, JSValue value, StructureTransitionCache& transitions, MarkedArgumentBuffer& cachedStructures)
+{
+    VM& vm = m_exec->vm();
+    Structure* structure = object->structure();
+    typename StructureTransitionCache::iterator transition = transitions.find(structure);
+    if (transition != transitions.end() && transition->value.propertyName.impl() == propertyName.impl()) {
+        object->setStructureAndReallocateStorageIfNecessary(vm, transition->value.structure);
+        object->putDirect(vm, transition->value.offset, value);
+        return;
+    }
+
+    object->putDirect(vm, propertyName, value);
+
+    Structure* newStructure = object->structure();
+    if (newStructure == structure || structure->isDictionary() || newStructure->isDictionary())
+        return;
+    PropertyOffset offset;
+    if (Structure::addPropertyTransitionToExistingStructure(structure, propertyName, 0, 0, offset) != newStructure)
+        return;
+    typename StructureTransitionCache::AddResult result = transitions.add(structure, StructureTransition());
+    if (result.isNewEntry)
+        cachedStructures.append(structure);
+    cachedStructures.append(newStructure);
+    StructureTransition& entry = result.iterator->value;
+    entry.propertyName = propertyName;
+    entry.structure = newStructure;
+    entry.offset = offset;
+}
+
+template <typename CharType>
+JSValue LiteralParser<CharType>::makeString(const LiteralParserToken<CharType>& token)
+{
+    // Short values repeat often enough for the identifier caches to pay off, and sharing the
+    // source buffer would save little.
+    static const unsigned minimumSharedLength = 16;
+
+    if (token.stringLength >= minimumSharedLength) {
+        // A string with escapes was unescaped into a buffer of its own.
+        if (!token.stringBuffer.isNull())
+            return jsString(m_exec, token.stringBuffer);
+        // Otherwise the token's characters are the source characters after the quote. A value
+        // keeps the whole text alive, so only values that are a good part of it share.
+        if (m_sourceImpl && !shouldCopySubstring(m_sourceImpl->length(), token.stringLength))
+            return jsString(m_exec, String(StringImpl::create(m_sourceImpl, token.start + 1 - m_sourceCharacters, token.stringLength)));
+        if (token.stringIs8Bit)
+            return jsString(m_exec, String(token.stringToken8, token.stringLength));
+        return jsString(m_exec, String(token.stringToken16, token.stringLength));
+    }
+    if (token.stringIs8Bit)
+        return jsString(m_exec, makeIdentifier(token.stringToken8, token.stringLength).string());
+    return jsString(m_exec, makeIdentifier(token.stringToken16, token.stringLength).string());
+}
+
 template <typename CharType>
 template <ParserMode mode> TokenType LiteralParser<CharType>::Lexer::lex(LiteralParserToken<CharType>& token)
 {
@@ -548,6 +616,8 @@ JSValue LiteralParser<CharType>::parse(ParserState initialState)
     JSValue lastValue;
     Vector<ParserState, 16, UnsafeVectorOverflow> stateStack;
     Vector<Identifier, 16, UnsafeVectorOverflow> identifierStack;
+    StructureTransitionCache structureTransitions;
+    MarkedArgumentBuffer cachedStructures;
     while (1) {
         switch(state) {
             startParseArray:
@@ -606,10 +676,7 @@ JSValue LiteralParser<CharType>::parse(ParserState initialState)
                     }
                     
                     m_lexer.next();
-                    if (identifierToken.stringIs8Bit)
-                        identifierStack.append(makeIdentifier(identifierToken.stringToken8, identifierToken.stringLength));
-                    else
-                        identifierStack.append(makeIdentifier(identifierToken.stringToken16, identifierToken.stringLength));
+                    identifierStack.append(makePropertyName(identifierToken, objectStack.last(), structureTransitions));
                     stateStack.append(DoParseObjectEndExpression);
                     goto startParseExpression;
                 }
@@ -638,10 +705,7 @@ JSValue LiteralParser<CharType>::parse(ParserState initialState)
                 }
 
                 m_lexer.next();
-                if (identifierToken.stringIs8Bit)
-                    identifierStack.append(makeIdentifier(identifierToken.stringToken8, identifierToken.stringLength));
-                else
-                    identifierStack.append(makeIdentifier(identifierToken.stringToken16, identifierToken.stringLength));
+                identifierStack.append(makePropertyName(identifierToken, objectStack.last(), structureTransitions));
                 stateStack.append(DoParseObjectEndExpression);
                 goto startParseExpression;
             }
@@ -653,7 +717,7 @@ JSValue LiteralParser<CharType>::parse(ParserState initialState)
                 if (i != PropertyName::NotAnIndex)
                     object->putDirectIndex(m_exec, i, lastValue);
                 else
-                    object->putDirect(m_exec->vm(), ident, lastValue);
+                    putProperty(object, identifierStack.last(), lastValue, structureTransitions, cachedStructures);
                 identifierStack.removeLast();
                 if (m_lexer.currentToken().type == TokComma)
                     goto doParseObjectStartExpression;
@@ -676,10 +740,7 @@ JSValue LiteralParser<CharType>::parse(ParserState initialState)
                     case TokString: {
                         LiteralParserToken<CharType> stringToken = m_lexer.currentToken();
                         m_lexer.next();
-                        if (stringToken.stringIs8Bit)
-                            lastValue = jsString(m_exec, makeIdentifier(stringToken.stringToken8, stringToken.stringLength).string());
-                        else
-                            lastValue = jsString(m_exec, makeIdentifier(stringToken.stringToken16, stringToken.stringLength).string());
+                        lastValue = makeString(stringToken);
                         break;
                     }
                     case TokNumber: {
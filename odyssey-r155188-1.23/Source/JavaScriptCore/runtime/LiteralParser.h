@@ -29,10 +29,14 @@
 #include "Identifier.h"
 #include "JSCJSValue.h"
 #include "JSGlobalObjectFunctions.h"
+#include "PropertyOffset.h"
+#include <wtf/HashMap.h>
 #include <wtf/text/WTFString.h>
 
 namespace JSC {
 
+class MarkedArgumentBuffer;
+
 typedef enum { StrictJSON, NonStrictJSON, JSONP } ParserMode;
 
 enum JSONPPathEntryType {
@@ -87,10 +91,14 @@ ALWAYS_INLINE void setParserTokenString(LiteralParserToken<CharType>&, const Cha
 template <typename CharType>
 class LiteralParser {
 public:
-    LiteralParser(ExecState* exec, const CharType* characters, unsigned length, ParserMode mode)
+    // If the characters belong to sourceImpl, long string values without escapes share its
+    // buffer instead of being copied. They keep the whole source alive as long as they live.
+    LiteralParser(ExecState* exec, const CharType* characters, unsigned length, ParserMode mode, StringImpl* sourceImpl = 0)
         : m_exec(exec)
         , m_lexer(characters, length, mode)
         , m_mode(mode)
+        , m_sourceImpl(sourceImpl)
+        , m_sourceCharacters(characters)
     {
     }
     
@@ -147,13 +155,41 @@ private:
         const CharType* m_end;
     };
     
+    // Documents such as arrays of records build many objects with the same properties in the
+    // same order. For every structure an object had while being built, this remembers the
+    // property that was added next and the structure that followed, so that the next object
+    // with that structure can compare the characters of its key against the remembered name
+    // instead of making an identifier, and take the transition without looking it up.
+    //
+    // An object the parse has dropped, such as the value of a duplicate key, can take the only
+    // references to its structures with it, and a structure allocated later at the same address
+    // would then find the wrong transition. The parse keeps every structure it caches alive.
+    struct StructureTransition {
+        StructureTransition()
+            : structure(0)
+            , offset(invalidOffset)
+        {
+        }
+
+        Identifier propertyName;
+        Structure* structure;
+        PropertyOffset offset;
+    };
+    typedef HashMap<Structure*, StructureTransition> StructureTransitionCache;
+
     class StackGuard;
     JSValue parse(ParserState);
 
+    Identifier makePropertyName(const LiteralParserToken<CharType>&, JSValue object, const StructureTransitionCache&);
+    void putProperty(JSObject*, const Identifier&, JSValue, StructureTransitionCache&, MarkedArgumentBuffer& cachedStructures);
+    JSValue makeString(const LiteralParserToken<CharType>&);
+
     ExecState* m_exec;
     typename LiteralParser<CharType>::Lexer m_lexer;
     ParserMode m_mode;
     String m_parseErrorMessage;
+    StringImpl* m_sourceImpl;
+    const CharType* m_sourceCharacters;
     static unsigned const MaximumCachableCharacter = 128;
     FixedArray<Identifier, MaximumCachableCharacter> m_shortIdentifiers;
     FixedArray<Identifier, MaximumCachableCharacter> m_recentIdentifiers;
@@ -23,33 +23,62 @@
 #include "Executable.h"
 #include "JSFunction.h"
 #include "Operations.h"
+#include "SharedIdentifiers.h"
 
 namespace JSC {
 
-void HashTable::createTable(VM* vm) const
+struct IdentifierKeyTranslator {
+    IdentifierKeyTranslator(VM* vm)
+        : vm(vm)
+    {
+    }
+
+    StringImpl* key(const char* name) const { return Identifier::add(vm, name).leakRef(); }
+
+    VM* vm;
+};
+
+struct SharedKeyTranslator {
+    StringImpl* key(const char* name) const { return SharedIdentifiers::add(name); }
+};
+
+template<typename KeyTranslator>
+static const HashEntry* createEntries(const HashTable& hashTable, const KeyTranslator& translator)
 {
-    ASSERT(!table);
-    int linkIndex = compactHashSizeMask + 1;
-    HashEntry* entries = new HashEntry[compactSize];
-    for (int i = 0; i < compactSize; ++i)
+    int linkIndex = hashTable.compactHashSizeMask + 1;
+    HashEntry* entries = new HashEntry[hashTable.compactSize];
+    for (int i = 0; i < hashTable.compactSize; ++i)
         entries[i].setKey(0);
-    for (int i = 0; values[i].key; ++i) {
-        StringImpl* identifier = Identifier::add(vm, values[i].key).leakRef();
-        int hashIndex = identifier->existingHash() & compactHashSizeMask;
+    for (int i = 0; hashTable.values[i].key; ++i) {
+        const HashTableValue& value = hashTable.values[i];
+        StringImpl* identifier = translator.key(value.key);
+        int hashIndex = identifier->existingHash() & hashTable.compactHashSizeMask;
         HashEntry* entry = &entries[hashIndex];
 
         if (entry->key()) {
             while (entry->next()) {
                 entry = entry->next();
             }
-            ASSERT(linkIndex < compactSize);
+            ASSERT(linkIndex < hashTable.compactSize);
             entry->setNext(&entries[linkIndex++]);
             entry = entry->next();
         }
 
-        entry->initialize(identifier, values[i].attributes, values[i].value1, values[i].value2, values[i].intrinsic);
+        entry->initialize(identifier, value.attributes, value.value1, value.value2, value.intrinsic);
     }
-    table = entries;
+    return entries;
+}
+
+void HashTable::createTable(VM* vm) const
+{
+    ASSERT(!table);
+    table = createEntries(*this, IdentifierKeyTranslator(vm));
+}
+
+void HashTable::createSharedTable() const
+{
+    ASSERT(!table);
+    table = createEntries(*this, SharedKeyTranslator());
 }
 
 void HashTable::deleteTable() const
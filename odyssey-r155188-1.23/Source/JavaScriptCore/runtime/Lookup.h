@@ -135,6 +135,10 @@ namespace JSC {
 
         JS_EXPORT_PRIVATE void deleteTable() const;
 
+        // Builds the table of a built-in object once for all VMs, with shared identifiers as keys.
+        // See SharedIdentifiers.
+        void createSharedTable() const;
+
         // Find an entry in the table, and return the entry.
         ALWAYS_INLINE const HashEntry* entry(VM* vm, PropertyName identifier) const
         {
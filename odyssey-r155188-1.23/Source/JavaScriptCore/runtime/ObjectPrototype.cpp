@@ -223,7 +223,7 @@ EncodedJSValue JSC_HOST_CALL objectProtoFuncToString(ExecState* exec)
             return JSValue::encode(throwOutOfMemoryError(exec));
 
         result = jsNontrivialString(exec, newString.release());
-        thisObject->structure()->setObjectToStringValue(exec->vm(), thisObject, result);
+        thisObject->structure()->setObjectToStringValue(exec->vm(), result);
     }
     return JSValue::encode(result);
 }
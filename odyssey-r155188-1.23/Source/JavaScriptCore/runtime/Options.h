@@ -135,6 +135,8 @@ typedef OptionRange optionRange;
     v(unsigned, numberOfCompilerThreads, computeNumberOfWorkerThreads(2) - 1) \
     \
     v(bool, enableProfiler, false) \
+    v(bool, useSamplingProfiler, false) \
+    v(double, samplingProfilerInterval, 1) \
     \
     v(bool, forceUDis86Disassembler, false) \
     v(bool, forceLLVMDisassembler, false) \
@@ -194,6 +196,8 @@ typedef OptionRange optionRange;
     v(unsigned, opaqueRootMergeThreshold, 1000) \
     v(double, minHeapUtilization, 0.8) \
     v(double, minCopiedBlockUtilization, 0.9) \
+    v(bool, useBackgroundSweeping, true) \
+    v(bool, useGenerationalGC, true) \
     \
     v(bool, forceWeakRandomSeed, false) \
     v(unsigned, forcedWeakRandomSeed, 0) \
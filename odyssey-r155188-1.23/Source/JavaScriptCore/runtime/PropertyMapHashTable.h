@@ -365,6 +365,8 @@ inline std::pair<PropertyTable::find_iterator, bool> PropertyTable::add(const Va
     m_index[iter.second] = entryIndex;
     iter.first = &table()[entryIndex - 1];
     *iter.first = entry;
+    // The entry was made with the Structure as its owner, but it lives in this table.
+    Heap::writeBarrier(this, entry.specificValue.get());
 
     ++m_keyCount;
     
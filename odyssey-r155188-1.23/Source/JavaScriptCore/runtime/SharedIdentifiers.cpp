@@ -0,0 +1,161 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "SharedIdentifiers.h"
+
+#include "CommonIdentifiers.h"
+#include "Identifier.h"
+#include "Lookup.h"
+#include "SmallStrings.h"
+#include <wtf/HashSet.h>
+#include <wtf/Vector.h>
+#include <wtf/WTFThreadData.h>
+
+namespace JSC {
+
+extern const HashTable arrayConstructorTable;
+extern const HashTable arrayPrototypeTable;
+extern const HashTable booleanPrototypeTable;
+extern const HashTable jsonTable;
+extern const HashTable dataViewTable;
+extern const HashTable dateTable;
+extern const HashTable dateConstructorTable;
+extern const HashTable errorPrototypeTable;
+extern const HashTable globalObjectTable;
+extern const HashTable mainTable;
+extern const HashTable numberConstructorTable;
+extern const HashTable numberPrototypeTable;
+JS_EXPORTDATA extern const HashTable objectConstructorTable;
+extern const HashTable privateNamePrototypeTable;
+extern const HashTable regExpTable;
+extern const HashTable regExpConstructorTable;
+extern const HashTable regExpPrototypeTable;
+extern const HashTable stringConstructorTable;
+#if ENABLE(PROMISES)
+extern const HashTable promisePrototypeTable;
+extern const HashTable promiseConstructorTable;
+extern const HashTable promiseResolverPrototypeTable;
+#endif
+
+static const unsigned singleCharacterStringCount = maxSingleCharacterString + 1;
+
+static LChar singleCharacters[singleCharacterStringCount];
+static StringImpl* singleCharacterStrings[singleCharacterStringCount];
+
+// Both are only written by initialize().
+static Vector<StringImpl*>* sharedStrings;
+static HashSet<StringImpl*>* sharedStringSet;
+
+struct SharedStringTranslator {
+    static unsigned hash(const char* name)
+    {
+        return StringHasher::computeHashAndMaskTop8Bits(reinterpret_cast<const LChar*>(name));
+    }
+
+    static bool equal(StringImpl* string, const char* name)
+    {
+        return Identifier::equal(string, reinterpret_cast<const LChar*>(name));
+    }
+
+    static void translate(StringImpl*& location, const char* name, unsigned)
+    {
+        location = StringImpl::createStaticStringImpl(reinterpret_cast<const LChar*>(name), strlen(name));
+        sharedStrings->append(location);
+    }
+};
+
+void SharedIdentifiers::initialize()
+{
+    ASSERT(!sharedStrings);
+    sharedStrings = new Vector<StringImpl*>;
+    sharedStringSet = new HashSet<StringImpl*>;
+
+    for (unsigned i = 0; i < singleCharacterStringCount; ++i) {
+        singleCharacters[i] = i;
+        singleCharacterStrings[i] = StringImpl::createStaticStringImpl(singleCharacters + i, 1);
+        sharedStrings->append(singleCharacterStrings[i]);
+        sharedStringSet->add(singleCharacterStrings[i]);
+    }
+
+    add("__proto__");
+    add("this");
+    add("use strict");
+#define ADD_SHARED_STRING(name) add(#name);
+    JSC_COMMON_IDENTIFIERS_EACH_KEYWORD(ADD_SHARED_STRING)
+    JSC_COMMON_IDENTIFIERS_EACH_PROPERTY_NAME(ADD_SHARED_STRING)
+    JSC_COMMON_STRINGS_EACH_NAME(ADD_SHARED_STRING)
+#undef ADD_SHARED_STRING
+
+    // These tables used to be copied and filled in by every VM.
+    arrayConstructorTable.createSharedTable();
+    arrayPrototypeTable.createSharedTable();
+    booleanPrototypeTable.createSharedTable();
+    dataViewTable.createSharedTable();
+    dateTable.createSharedTable();
+    dateConstructorTable.createSharedTable();
+    errorPrototypeTable.createSharedTable();
+    globalObjectTable.createSharedTable();
+    jsonTable.createSharedTable();
+    mainTable.createSharedTable();
+    numberConstructorTable.createSharedTable();
+    numberPrototypeTable.createSharedTable();
+    objectConstructorTable.createSharedTable();
+    privateNamePrototypeTable.createSharedTable();
+    regExpTable.createSharedTable();
+    regExpConstructorTable.createSharedTable();
+    regExpPrototypeTable.createSharedTable();
+    stringConstructorTable.createSharedTable();
+#if ENABLE(PROMISES)
+    promisePrototypeTable.createSharedTable();
+    promiseConstructorTable.createSharedTable();
+    promiseResolverPrototypeTable.createSharedTable();
+#endif
+}
+
+StringImpl* SharedIdentifiers::singleCharacterString(unsigned char character)
+{
+    ASSERT(singleCharacterStrings[character]);
+    return singleCharacterStrings[character];
+}
+
+StringImpl* SharedIdentifiers::add(const char* name)
+{
+    ASSERT(sharedStringSet);
+    ASSERT(name[0]);
+    if (!name[1])
+        return singleCharacterString(name[0]);
+    return *sharedStringSet->add<SharedStringTranslator>(name).iterator;
+}
+
+IdentifierTable* SharedIdentifiers::addTo(IdentifierTable* identifierTable)
+{
+    ASSERT(sharedStrings);
+
+    // A table gets all shared strings before its first identifier is created, so it either
+    // holds all of them or none.
+    if (!identifierTable->add(sharedStrings->first()).isNewEntry)
+        return identifierTable;
+
+    for (size_t i = 1; i < sharedStrings->size(); ++i) {
+        HashSet<StringImpl*>::AddResult result = identifierTable->add(sharedStrings->at(i));
+        ASSERT_UNUSED(result, *result.iterator == sharedStrings->at(i));
+    }
+    return identifierTable;
+}
+
+} // namespace JSC
@@ -0,0 +1,50 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SharedIdentifiers_h
+#define SharedIdentifiers_h
+
+#include <wtf/text/StringImpl.h>
+
+namespace JSC {
+
+class IdentifierTable;
+
+// The property names every VM starts with - the single character strings, the
+// CommonIdentifiers and the keys of the built-in lookup tables - are created once for the
+// whole process, as static strings whose hashes are computed up front and that are never
+// freed. Every identifier table holds them before its first identifier is created, so the
+// identifiers of all VMs and threads resolve to the same StringImpls and the built-in
+// HashTables can be built once and read by all VMs without a lock.
+class SharedIdentifiers {
+public:
+    // Called once by initializeThreading(), before any VM exists.
+    static void initialize();
+
+    static StringImpl* singleCharacterString(unsigned char);
+
+    // Returns the shared string for the given name, creating it if needed. Only valid while
+    // initialize() runs.
+    static StringImpl* add(const char*);
+
+    // Adds the shared strings to a table that a VM is about to use, if it doesn't hold them yet.
+    static IdentifierTable* addTo(IdentifierTable*);
+};
+
+} // namespace JSC
+
+#endif // SharedIdentifiers_h
@@ -30,38 +30,11 @@
 #include "JSGlobalObject.h"
 #include "JSString.h"
 #include "Operations.h"
-#include <wtf/Noncopyable.h>
-#include <wtf/PassOwnPtr.h>
+#include "SharedIdentifiers.h"
 #include <wtf/text/StringImpl.h>
 
 namespace JSC {
 
-class SmallStringsStorage {
-    WTF_MAKE_NONCOPYABLE(SmallStringsStorage); WTF_MAKE_FAST_ALLOCATED;
-public:
-    SmallStringsStorage();
-
-    StringImpl* rep(unsigned char character)
-    {
-        return m_reps[character].get();
-    }
-
-private:
-    static const unsigned singleCharacterStringCount = maxSingleCharacterString + 1;
-
-    RefPtr<StringImpl> m_reps[singleCharacterStringCount];
-};
-
-SmallStringsStorage::SmallStringsStorage()
-{
-    LChar* characterBuffer = 0;
-    RefPtr<StringImpl> baseString = StringImpl::createUninitialized(singleCharacterStringCount, characterBuffer);
-    for (unsigned i = 0; i < singleCharacterStringCount; ++i) {
-        characterBuffer[i] = i;
-        m_reps[i] = StringImpl::create(baseString, i, 1);
-    }
-}
-
 SmallStrings::SmallStrings()
     : m_emptyString(0)
 #define JSC_COMMON_STRINGS_ATTRIBUTE_INITIALIZE(name) , m_##name(0)
@@ -106,22 +79,19 @@ void SmallStrings::createEmptyString(VM* vm)
 
 void SmallStrings::createSingleCharacterString(VM* vm, unsigned char character)
 {
-    if (!m_storage)
-        m_storage = adoptPtr(new SmallStringsStorage);
     ASSERT(!m_singleCharacterStrings[character]);
-    m_singleCharacterStrings[character] = JSString::createHasOtherOwner(*vm, PassRefPtr<StringImpl>(m_storage->rep(character)));
+    m_singleCharacterStrings[character] = JSString::createHasOtherOwner(*vm, PassRefPtr<StringImpl>(singleCharacterStringRep(character)));
 }
 
 StringImpl* SmallStrings::singleCharacterStringRep(unsigned char character)
 {
-    if (!m_storage)
-        m_storage = adoptPtr(new SmallStringsStorage);
-    return m_storage->rep(character);
+    return SharedIdentifiers::singleCharacterString(character);
 }
 
 void SmallStrings::initialize(VM* vm, JSString*& string, const char* value) const
 {
-    string = JSString::create(*vm, StringImpl::create(value));
+    // The common strings are shared identifiers, so this doesn't allocate a StringImpl.
+    string = JSString::create(*vm, Identifier::add(vm, value));
 }
 
 } // namespace JSC
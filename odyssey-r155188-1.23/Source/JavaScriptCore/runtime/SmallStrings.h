@@ -30,7 +30,6 @@
 
 #include <wtf/FixedArray.h>
 #include <wtf/Noncopyable.h>
-#include <wtf/OwnPtr.h>
 
 #define JSC_COMMON_STRINGS_EACH_NAME(macro) \
     macro(boolean) \
@@ -52,7 +51,6 @@ namespace JSC {
     class HeapRootVisitor;
     class VM;
     class JSString;
-    class SmallStringsStorage;
     class SlotVisitor;
 
     static const unsigned maxSingleCharacterString = 0xFF;
@@ -101,7 +99,6 @@ namespace JSC {
         JSC_COMMON_STRINGS_EACH_NAME(JSC_COMMON_STRINGS_ATTRIBUTE_DECLARATION)
 #undef JSC_COMMON_STRINGS_ATTRIBUTE_DECLARATION
         JSString* m_singleCharacterStrings[singleCharacterStringCount];
-        OwnPtr<SmallStringsStorage> m_storage;
     };
 
 } // namespace JSC
@@ -281,11 +281,11 @@ public:
         return rareData()->objectToStringValue();
     }
 
-    void setObjectToStringValue(VM& vm, const JSCell* owner, JSString* value)
+    void setObjectToStringValue(VM& vm, JSString* value)
     {
         if (!typeInfo().structureHasRareData())
             allocateRareData(vm);
-        rareData()->setObjectToStringValue(vm, owner, value);
+        rareData()->setObjectToStringValue(vm, value);
     }
 
     bool staticFunctionsReified()
@@ -423,7 +423,7 @@ private:
     void setPreviousID(VM& vm, Structure* transition, Structure* structure)
     {
         if (typeInfo().structureHasRareData())
-            rareData()->setPreviousID(vm, transition, structure);
+            rareData()->setPreviousID(vm, structure);
         else
             m_previousOrRareData.set(vm, transition, structure);
     }
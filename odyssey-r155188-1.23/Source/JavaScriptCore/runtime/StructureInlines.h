@@ -135,7 +135,7 @@ inline void Structure::setEnumerationCache(VM& vm, JSPropertyNameIterator* enume
     ASSERT(!isDictionary());
     if (!typeInfo().structureHasRareData())
         allocateRareData(vm);
-    rareData()->setEnumerationCache(vm, this, enumerationCache);
+    rareData()->setEnumerationCache(vm, enumerationCache);
 }
 
 inline JSPropertyNameIterator* Structure::enumerationCache()
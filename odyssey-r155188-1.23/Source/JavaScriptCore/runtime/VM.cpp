@@ -63,6 +63,8 @@
 #include "ParserArena.h"
 #include "RegExpCache.h"
 #include "RegExpObject.h"
+#include "SamplingProfiler.h"
+#include "SharedIdentifiers.h"
 #include "SimpleTypedArrayController.h"
 #include "SourceProviderCache.h"
 #include "StrictEvalActivation.h"
@@ -155,29 +157,29 @@ VM::VM(VMType vmType, HeapType heapType)
     , vmType(vmType)
     , clientData(0)
     , topCallFrame(CallFrame::noCaller()->removeHostCallFrameFlag())
-    , arrayConstructorTable(fastNew<HashTable>(JSC::arrayConstructorTable))
-    , arrayPrototypeTable(fastNew<HashTable>(JSC::arrayPrototypeTable))
-    , booleanPrototypeTable(fastNew<HashTable>(JSC::booleanPrototypeTable))
-    , dataViewTable(fastNew<HashTable>(JSC::dataViewTable))
-    , dateTable(fastNew<HashTable>(JSC::dateTable))
-    , dateConstructorTable(fastNew<HashTable>(JSC::dateConstructorTable))
-    , errorPrototypeTable(fastNew<HashTable>(JSC::errorPrototypeTable))
-    , globalObjectTable(fastNew<HashTable>(JSC::globalObjectTable))
-    , jsonTable(fastNew<HashTable>(JSC::jsonTable))
-    , numberConstructorTable(fastNew<HashTable>(JSC::numberConstructorTable))
-    , numberPrototypeTable(fastNew<HashTable>(JSC::numberPrototypeTable))
-    , objectConstructorTable(fastNew<HashTable>(JSC::objectConstructorTable))
-    , privateNamePrototypeTable(fastNew<HashTable>(JSC::privateNamePrototypeTable))
-    , regExpTable(fastNew<HashTable>(JSC::regExpTable))
-    , regExpConstructorTable(fastNew<HashTable>(JSC::regExpConstructorTable))
-    , regExpPrototypeTable(fastNew<HashTable>(JSC::regExpPrototypeTable))
-    , stringConstructorTable(fastNew<HashTable>(JSC::stringConstructorTable))
+    , arrayConstructorTable(&JSC::arrayConstructorTable)
+    , arrayPrototypeTable(&JSC::arrayPrototypeTable)
+    , booleanPrototypeTable(&JSC::booleanPrototypeTable)
+    , dataViewTable(&JSC::dataViewTable)
+    , dateTable(&JSC::dateTable)
+    , dateConstructorTable(&JSC::dateConstructorTable)
+    , errorPrototypeTable(&JSC::errorPrototypeTable)
+    , globalObjectTable(&JSC::globalObjectTable)
+    , jsonTable(&JSC::jsonTable)
+    , numberConstructorTable(&JSC::numberConstructorTable)
+    , numberPrototypeTable(&JSC::numberPrototypeTable)
+    , objectConstructorTable(&JSC::objectConstructorTable)
+    , privateNamePrototypeTable(&JSC::privateNamePrototypeTable)
+    , regExpTable(&JSC::regExpTable)
+    , regExpConstructorTable(&JSC::regExpConstructorTable)
+    , regExpPrototypeTable(&JSC::regExpPrototypeTable)
+    , stringConstructorTable(&JSC::stringConstructorTable)
 #if ENABLE(PROMISES)
-    , promisePrototypeTable(fastNew<HashTable>(JSC::promisePrototypeTable))
-    , promiseConstructorTable(fastNew<HashTable>(JSC::promiseConstructorTable))
-    , promiseResolverPrototypeTable(fastNew<HashTable>(JSC::promiseResolverPrototypeTable))
+    , promisePrototypeTable(&JSC::promisePrototypeTable)
+    , promiseConstructorTable(&JSC::promiseConstructorTable)
+    , promiseResolverPrototypeTable(&JSC::promiseResolverPrototypeTable)
 #endif
-    , identifierTable(vmType == Default ? wtfThreadData().currentIdentifierTable() : createIdentifierTable())
+    , identifierTable(SharedIdentifiers::addTo(vmType == Default ? wtfThreadData().currentIdentifierTable() : createIdentifierTable()))
     , propertyNames(new CommonIdentifiers(this))
     , emptyList(new MarkedArgumentBuffer)
     , parserArena(adoptPtr(new ParserArena))
@@ -273,6 +275,9 @@ VM::VM(VMType vmType, HeapType heapType)
         m_perBytecodeProfiler->registerToSaveAtExit(pathOut.toCString().data());
     }
 
+    if (Options::useSamplingProfiler())
+        ensureSamplingProfiler().start(Options::samplingProfilerInterval() / 1000);
+
 #if ENABLE(DFG_JIT)
     if (canUseJIT())
         dfgState = adoptPtr(new DFG::LongLivedState());
@@ -299,6 +304,8 @@ VM::~VM()
     
     // Clear this first to ensure that nobody tries to remove themselves from it.
     m_perBytecodeProfiler.clear();
+    watchdog.setSamplingProfiler(0);
+    m_samplingProfiler.clear();
     
     ASSERT(m_apiLock->currentThreadIsHoldingLock());
     m_apiLock->willDestroyVM(this);
@@ -309,52 +316,6 @@ VM::~VM()
     interpreter = reinterpret_cast<Interpreter*>(0xbbadbeef);
 #endif
 
-    arrayPrototypeTable->deleteTable();
-    arrayConstructorTable->deleteTable();
-    booleanPrototypeTable->deleteTable();
-    dataViewTable->deleteTable();
-    dateTable->deleteTable();
-    dateConstructorTable->deleteTable();
-    errorPrototypeTable->deleteTable();
-    globalObjectTable->deleteTable();
-    jsonTable->deleteTable();
-    numberConstructorTable->deleteTable();
-    numberPrototypeTable->deleteTable();
-    objectConstructorTable->deleteTable();
-    privateNamePrototypeTable->deleteTable();
-    regExpTable->deleteTable();
-    regExpConstructorTable->deleteTable();
-    regExpPrototypeTable->deleteTable();
-    stringConstructorTable->deleteTable();
-#if ENABLE(PROMISES)
-    promisePrototypeTable->deleteTable();
-    promiseConstructorTable->deleteTable();
-    promiseResolverPrototypeTable->deleteTable();
-#endif
-
-    fastDelete(const_cast<HashTable*>(arrayConstructorTable));
-    fastDelete(const_cast<HashTable*>(arrayPrototypeTable));
-    fastDelete(const_cast<HashTable*>(booleanPrototypeTable));
-    fastDelete(const_cast<HashTable*>(dataViewTable));
-    fastDelete(const_cast<HashTable*>(dateTable));
-    fastDelete(const_cast<HashTable*>(dateConstructorTable));
-    fastDelete(const_cast<HashTable*>(errorPrototypeTable));
-    fastDelete(const_cast<HashTable*>(globalObjectTable));
-    fastDelete(const_cast<HashTable*>(jsonTable));
-    fastDelete(const_cast<HashTable*>(numberConstructorTable));
-    fastDelete(const_cast<HashTable*>(numberPrototypeTable));
-    fastDelete(const_cast<HashTable*>(objectConstructorTable));
-    fastDelete(const_cast<HashTable*>(privateNamePrototypeTable));
-    fastDelete(const_cast<HashTable*>(regExpTable));
-    fastDelete(const_cast<HashTable*>(regExpConstructorTable));
-    fastDelete(const_cast<HashTable*>(regExpPrototypeTable));
-    fastDelete(const_cast<HashTable*>(stringConstructorTable));
-#if ENABLE(PROMISES)
-    fastDelete(const_cast<HashTable*>(promisePrototypeTable));
-    fastDelete(const_cast<HashTable*>(promiseConstructorTable));
-    fastDelete(const_cast<HashTable*>(promiseResolverPrototypeTable));
-#endif
-
     delete emptyList;
 
     delete propertyNames;
@@ -500,6 +461,15 @@ void VM::discardAllCode()
     heap.reportAbandonedObjectGraph();
 }
 
+SamplingProfiler& VM::ensureSamplingProfiler()
+{
+    if (!m_samplingProfiler) {
+        m_samplingProfiler = adoptPtr(new SamplingProfiler(*this));
+        watchdog.setSamplingProfiler(m_samplingProfiler.get());
+    }
+    return *m_samplingProfiler;
+}
+
 void VM::dumpSampleData(ExecState* exec)
 {
     interpreter->dumpSampleData(exec);
@@ -80,6 +80,7 @@ namespace JSC {
     class NativeExecutable;
     class ParserArena;
     class RegExpCache;
+    class SamplingProfiler;
     class SourceProvider;
     class SourceProviderCache;
     struct StackFrame;
@@ -222,6 +223,7 @@ namespace JSC {
         ExecState* topCallFrame;
         Watchdog watchdog;
 
+        // These are shared by all VMs, see SharedIdentifiers.
         const HashTable* arrayConstructorTable;
         const HashTable* arrayPrototypeTable;
         const HashTable* booleanPrototypeTable;
@@ -294,6 +296,9 @@ namespace JSC {
             return m_enabledProfiler;
         }
 
+        SamplingProfiler* samplingProfiler() { return m_samplingProfiler.get(); }
+        JS_EXPORT_PRIVATE SamplingProfiler& ensureSamplingProfiler();
+
 #if ENABLE(JIT) && ENABLE(LLINT)
         bool canUseJIT() { return m_canUseJIT; }
 #elif ENABLE(JIT)
@@ -392,6 +397,7 @@ namespace JSC {
 
         LegacyProfiler* m_enabledProfiler;
         OwnPtr<Profiler::Database> m_perBytecodeProfiler;
+        OwnPtr<SamplingProfiler> m_samplingProfiler;
         RefPtr<TypedArrayController> m_typedArrayController;
         RegExpCache* m_regExpCache;
         BumpPointerAllocator m_regExpAllocator;
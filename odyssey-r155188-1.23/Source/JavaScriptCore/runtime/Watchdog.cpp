@@ -27,6 +27,7 @@
 #include "Watchdog.h"
 
 #include "CallFrame.h"
+#include "SamplingProfiler.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/MathExtras.h>
 
@@ -45,6 +46,7 @@ Watchdog::Watchdog()
     , m_callback(0)
     , m_callbackData1(0)
     , m_callbackData2(0)
+    , m_samplingProfiler(0)
 {
     initTimer();
 }
@@ -95,6 +97,9 @@ bool Watchdog::didFire(ExecState* exec)
     if (!m_timerDidFire)
         return false;
     m_timerDidFire = false;
+    // Without a time limit, the flag was only set by interrupt().
+    if (!isEnabled())
+        return false;
     stopCountdown();
 
     double currentTime = currentCPUTime();
@@ -135,6 +140,21 @@ bool Watchdog::isEnabled()
     return (m_limit != NO_LIMIT);
 }
 
+void Watchdog::didHandleInterrupt(ExecState* exec)
+{
+    if (didFire(exec))
+        m_timerDidFire = true;
+}
+
+void Watchdog::setSamplingProfiler(SamplingProfiler* samplingProfiler)
+{
+    if (m_samplingProfiler && isArmed())
+        m_samplingProfiler->didStopExecuting();
+    m_samplingProfiler = samplingProfiler;
+    if (m_samplingProfiler && isArmed())
+        m_samplingProfiler->didStartExecuting();
+}
+
 void Watchdog::fire()
 {
     m_didFire = true;
@@ -143,15 +163,21 @@ void Watchdog::fire()
 void Watchdog::arm()
 {
     m_reentryCount++;
-    if (m_reentryCount == 1)
+    if (m_reentryCount == 1) {
         startCountdownIfNeeded();
+        if (m_samplingProfiler)
+            m_samplingProfiler->didStartExecuting();
+    }
 }
 
 void Watchdog::disarm()
 {
     ASSERT(m_reentryCount > 0);
-    if (m_reentryCount == 1)
+    if (m_reentryCount == 1) {
         stopCountdown();
+        if (m_samplingProfiler)
+            m_samplingProfiler->didStopExecuting();
+    }
     m_reentryCount--;
 }
 
@@ -33,6 +33,7 @@
 namespace JSC {
 
 class ExecState;
+class SamplingProfiler;
 class VM;
 
 class Watchdog {
@@ -57,6 +58,18 @@ public:
     JS_EXPORT_PRIVATE bool didFire() { return m_didFire; }
     JS_EXPORT_PRIVATE void fire();
 
+    // Makes the script thread call didFire(ExecState*) at its next check, without firing.
+    // May be called from any thread.
+    void interrupt() { m_timerDidFire = true; }
+    // Called on the script thread once an interrupt has been handled somewhere other than
+    // didFire(ExecState*), where execution cannot be terminated. Checks the time limit and
+    // clears the flag, unless the limit has run out and the next check has to terminate.
+    void didHandleInterrupt(ExecState*);
+
+    // The sampling profiler is told when the script thread starts and stops running
+    // JavaScript, so that it only samples while there is something to sample.
+    void setSamplingProfiler(SamplingProfiler*);
+
     void* timerDidFireAddress() { return &m_timerDidFire; }
 
 private:
@@ -76,8 +89,9 @@ private:
     // m_timerDidFire (above) indicates whether the timer fired. The Watchdog
     // still needs to check if the allowed CPU time has elapsed. If so, then
     // the Watchdog fires and m_didFire will be set.
-    // NOTE: m_timerDidFire is only set by the platform specific timer
-    // (probably from another thread) but is only cleared in the script thread.
+    // NOTE: m_timerDidFire is only set by the platform specific timer or by
+    // interrupt() (probably from another thread) but is only cleared in the
+    // script thread.
     bool m_timerDidFire;
     bool m_didFire;
 
@@ -93,6 +107,8 @@ private:
     void* m_callbackData1;
     void* m_callbackData2;
 
+    SamplingProfiler* m_samplingProfiler;
+
 #if PLATFORM(MAC) || PLATFORM(IOS)
     dispatch_queue_t m_queue;
     dispatch_source_t m_timer;
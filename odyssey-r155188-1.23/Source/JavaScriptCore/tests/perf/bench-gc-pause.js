@@ -0,0 +1,25 @@
+// Measures the longest gap between two short slices of work while a large, long-lived heap
+// sits next to a stream of short-lived objects. Compare with --useGenerationalGC=true and
+// run with --logGC=true to see the eden and full collections.
+(function () {
+    var retained = new Array(400000);
+    for (var i = 0; i < retained.length; ++i)
+        retained[i] = { index: i, name: "r" + i, data: [i, i + 1, i + 2] };
+
+    var sliceCount = 2000;
+    var allocationsPerSlice = 5000;
+    var maximumSlice = 0;
+    var start = preciseTime();
+    for (var i = 0; i < sliceCount; ++i) {
+        var sliceStart = preciseTime();
+        for (var j = 0; j < allocationsPerSlice; ++j)
+            var a = { x: j, y: i };
+        retained[(i * 7919) % retained.length].data = [i];
+        var sliceTime = preciseTime() - sliceStart;
+        if (sliceTime > maximumSlice)
+            maximumSlice = sliceTime;
+    }
+    var total = preciseTime() - start;
+
+    print("Total: " + Math.round(total * 1000) + " ms, longest slice: " + (maximumSlice * 1000).toFixed(2) + " ms");
+})();
@@ -0,0 +1,24 @@
+// Measures creating global objects, as each frame and tab does, and how much of the heap
+// they take. Prints timings in milliseconds and the heap growth per global object.
+(function () {
+    var count = 2000;
+    var globals = new Array(count);
+    gc();
+    var heapBefore = heapSnapshot().split("\n").filter(function (line) { return line.charAt(0) == "N"; }).length;
+
+    var start = preciseTime();
+    for (var i = 0; i < count; ++i)
+        globals[i] = createGlobalObject();
+    var total = preciseTime() - start;
+
+    gc();
+    var heapAfter = heapSnapshot().split("\n").filter(function (line) { return line.charAt(0) == "N"; }).length;
+
+    print("Created " + count + " global objects: " + Math.round(total * 1000) + " ms, " + ((total * 1000000) / count).toFixed(1) + " us each");
+    print("Cells per global object: " + ((heapAfter - heapBefore) / count).toFixed(1));
+
+    start = preciseTime();
+    for (var i = 0; i < count; ++i)
+        new globals[i].Float64Array(4);
+    print("First typed array in each: " + Math.round((preciseTime() - start) * 1000) + " ms");
+})();
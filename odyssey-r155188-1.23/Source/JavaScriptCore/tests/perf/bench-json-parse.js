@@ -0,0 +1,15 @@
+// Parses a large array of records with the same shape, as API responses tend to be.
+(function () {
+    var records = [];
+    for (var i = 0; i < 100000; ++i)
+        records.push({ id: i, name: "user" + i, email: "user" + i + "@example.com", active: !(i % 3), score: i / 7, tags: ["a", "b"], address: { street: "Main Street " + i, city: "Springfield" } });
+    var json = JSON.stringify(records);
+
+    var iterations = 5;
+    var start = preciseTime();
+    for (var i = 0; i < iterations; ++i)
+        var result = JSON.parse(json);
+    var time = preciseTime() - start;
+
+    print("Parsed " + Math.round(json.length / 1024) + " KB " + iterations + " times in " + Math.round(time * 1000) + " ms");
+})();
@@ -0,0 +1,16 @@
+// Stringifies a large tree of plain objects and arrays, as saving application state does.
+(function () {
+    var records = [];
+    for (var i = 0; i < 100000; ++i)
+        records.push({ id: i, name: "user" + i, active: !(i % 3), score: i / 7, tags: ["a", "b"], address: { street: "Main Street " + i, city: "Springfield" } });
+    var state = { version: 1, records: records };
+
+    var iterations = 5;
+    var length = 0;
+    var start = preciseTime();
+    for (var i = 0; i < iterations; ++i)
+        length += JSON.stringify(state).length;
+    var time = preciseTime() - start;
+
+    print("Stringified " + Math.round(length / iterations / 1024) + " KB " + iterations + " times in " + Math.round(time * 1000) + " ms");
+})();
@@ -0,0 +1,44 @@
+// Builds pages out of templates the way client-side rendering does: long strings are
+// concatenated, read back and sliced. Each phase is timed separately.
+(function () {
+    function time(name, iterations, body)
+    {
+        var start = preciseTime();
+        for (var i = 0; i < iterations; ++i)
+            body(i);
+        print(name + ": " + Math.round((preciseTime() - start) * 1000) + " ms");
+    }
+
+    var row = "<tr><td class=\"name\">{name}</td><td class=\"value\">{value}</td></tr>\n";
+
+    // Appending to a string that is read after every append flattens it every time.
+    time("append and read", 5, function () {
+        var html = "";
+        for (var i = 0; i < 4000; ++i) {
+            html += row.replace("{name}", "n" + i).replace("{value}", i);
+            if (html.charCodeAt(html.length - 1) != 10)
+                throw "bad page";
+        }
+    });
+
+    // Small slices out of a long rope that is never read as a whole.
+    time("slice long ropes", 20, function () {
+        var page = "";
+        for (var i = 0; i < 5000; ++i)
+            page += row;
+        var length = 0;
+        for (var i = 0; i < 5; ++i)
+            length += page.slice(i * 1000, i * 1000 + 100).length + page.substr(page.length - 64 * (i + 1), 64).length;
+        if (length != 5 * 164)
+            throw "bad slices";
+    });
+
+    // Small substrings of a huge flat string, kept while the string itself dies.
+    var kept = [];
+    time("substrings of huge strings", 20, function (iteration) {
+        var page = new Array(10000).join(row) + iteration;
+        for (var i = 0; i < 100; ++i)
+            kept.push(page.substring(i * 37, i * 37 + 20));
+    });
+    gc();
+})();
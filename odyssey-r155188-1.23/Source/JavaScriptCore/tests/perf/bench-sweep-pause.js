@@ -0,0 +1,25 @@
+// Measures allocation throughput and the longest gap between two short slices of work while
+// most of the heap dies every cycle. Compare with --useBackgroundSweeping=false.
+(function () {
+    var retained = new Array(50000);
+    for (var i = 0; i < retained.length; ++i)
+        retained[i] = { index: i };
+
+    var sliceCount = 2000;
+    var allocationsPerSlice = 5000;
+    var maximumSlice = 0;
+    var start = preciseTime();
+    for (var i = 0; i < sliceCount; ++i) {
+        var sliceStart = preciseTime();
+        for (var j = 0; j < allocationsPerSlice; ++j)
+            var a = { x: j, y: i };
+        retained[(i * 31) % retained.length] = { index: i };
+        var sliceTime = preciseTime() - sliceStart;
+        if (sliceTime > maximumSlice)
+            maximumSlice = sliceTime;
+    }
+    var total = preciseTime() - start;
+
+    print("Allocations: " + Math.round(sliceCount * allocationsPerSlice / total / 1000) + "k/s");
+    print("Total: " + Math.round(total * 1000) + " ms, longest slice: " + (maximumSlice * 1000).toFixed(2) + " ms");
+})();
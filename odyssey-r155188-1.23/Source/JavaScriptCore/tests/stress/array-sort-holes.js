@@ -0,0 +1,83 @@
+// Sorts arrays with holes and undefined values, with and without a compare function, and
+// checks that the defined values come first in order, followed by the undefined values and
+// then the holes, and that the compare function never sees either. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function makeArray(length, holeEvery, undefinedEvery, unshifted)
+{
+    var array = [];
+    if (unshifted)
+        array.unshift(0);
+    array.length = length;
+    var counts = { defined: 0, undefined: 0, holes: 0 };
+    for (var i = 0; i < length; ++i) {
+        if (i % holeEvery == 0) {
+            delete array[i];
+            ++counts.holes;
+        } else if (i % undefinedEvery == 0) {
+            array[i] = undefined;
+            ++counts.undefined;
+        } else {
+            array[i] = "k" + String(1000 + (i * 37) % length);
+            ++counts.defined;
+        }
+    }
+    return { array: array, counts: counts };
+}
+
+function verify(array, counts, where)
+{
+    check(array.length == counts.defined + counts.undefined + counts.holes, where + ": length");
+    for (var i = 0; i < counts.defined; ++i) {
+        check(typeof array[i] == "string", where + ": not a defined value at " + i);
+        if (i)
+            check(array[i - 1] <= array[i], where + ": out of order at " + i);
+    }
+    for (var i = counts.defined; i < counts.defined + counts.undefined; ++i)
+        check(i in array && array[i] === undefined, where + ": not undefined at " + i);
+    for (var i = counts.defined + counts.undefined; i < array.length; ++i)
+        check(!(i in array), where + ": not a hole at " + i);
+}
+
+function compare(a, b)
+{
+    check(a !== undefined && b !== undefined, "compare function saw undefined");
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+var shapes = [[10, 3, 4], [100, 7, 5], [1000, 2, 3], [1000, 1000, 2], [5, 1, 2]];
+for (var s = 0; s < shapes.length; ++s) {
+    for (var unshifted = 0; unshifted < 2; ++unshifted) {
+        var made = makeArray(shapes[s][0], shapes[s][1], shapes[s][2], unshifted);
+        made.array.sort(compare);
+        verify(made.array, made.counts, "compare " + shapes[s] + (unshifted ? " unshifted" : ""));
+
+        made = makeArray(shapes[s][0], shapes[s][1], shapes[s][2], unshifted);
+        made.array.sort();
+        verify(made.array, made.counts, "default " + shapes[s] + (unshifted ? " unshifted" : ""));
+    }
+}
+
+// Holes in Int32 and Double arrays.
+var ints = [5, 3, , 1, , 4, 2];
+ints.sort(function(a, b) { return a - b; });
+check(ints.join() == "1,2,3,4,5,,", "int32 with holes: " + ints.join());
+check(!(5 in ints) && !(6 in ints), "int32 holes not at the end");
+
+var doubles = [5.5, 3.5, , 1.5, , 4.5, 2.5];
+doubles.sort(function(a, b) { return a - b; });
+check(doubles.join() == "1.5,2.5,3.5,4.5,5.5,,", "double with holes: " + doubles.join());
+check(!(5 in doubles) && !(6 in doubles), "double holes not at the end");
+
+// Only holes and undefined values.
+var empty = [, undefined, , undefined];
+empty.sort(compare);
+check(empty[0] === undefined && empty[1] === undefined && 0 in empty && 1 in empty, "undefined values not first");
+check(!(2 in empty) && !(3 in empty), "holes not last");
+
+print("PASS");
@@ -0,0 +1,105 @@
+// Sorts arrays whose compare function shrinks, grows, reshapes or clears them, and checks that
+// the sort neither crashes nor loses the values it was handed. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function makeObjects(n)
+{
+    var array = [];
+    for (var i = 0; i < n; ++i)
+        array.push({ value: (i * 31) % n });
+    return array;
+}
+
+function makeInts(n)
+{
+    var array = [];
+    for (var i = 0; i < n; ++i)
+        array.push((i * 31) % n);
+    return array;
+}
+
+function numeric(x)
+{
+    return typeof x == "object" ? x.value : x;
+}
+
+// Shrinking: values past the new end are dropped, the rest are a sorted prefix.
+var shrunk = makeObjects(1000);
+var calls = 0;
+shrunk.sort(function(a, b) {
+    if (++calls == 50)
+        shrunk.length = 100;
+    return a.value - b.value;
+});
+check(shrunk.length == 100, "shrunk length " + shrunk.length);
+for (var i = 1; i < shrunk.length; ++i)
+    check(shrunk[i - 1].value <= shrunk[i].value, "shrunk out of order at " + i);
+
+// Clearing: the objects removed from the array must stay alive until the sort is done.
+var cleared = makeObjects(2000);
+calls = 0;
+var removed = [];
+cleared.sort(function(a, b) {
+    if (++calls == 10) {
+        cleared.length = 0;
+        gc();
+    }
+    removed.push(a);
+    return a.value - b.value;
+});
+check(cleared.length == 0, "cleared length " + cleared.length);
+for (var i = 0; i < removed.length; ++i)
+    check(typeof removed[i].value == "number", "removed object " + i + " was collected");
+
+// Growing: the sorted values are written back over the start of the array, values pushed
+// during the sort stay after them.
+var grown = makeInts(500);
+calls = 0;
+grown.sort(function(a, b) {
+    if (++calls <= 100)
+        grown.push(-1);
+    return a - b;
+});
+check(grown.length == 600, "grown length " + grown.length);
+for (var i = 1; i < 500; ++i)
+    check(grown[i - 1] <= grown[i], "grown out of order at " + i);
+
+// Reshaping Int32 storage into doubles, contiguous values and array storage while sorting.
+var reshapes = [
+    function(array) { array[0] = 0.5; },
+    function(array) { array[0] = "string"; },
+    function(array) { array.unshift(-1); array.shift(); },
+    function(array) { array[100000] = 1; },
+    function(array) { array.length = 0; array[5] = 1; }
+];
+for (var r = 0; r < reshapes.length; ++r) {
+    var array = makeInts(300);
+    calls = 0;
+    array.sort(function(a, b) {
+        if (++calls == 20)
+            reshapes[r](array);
+        return a - b;
+    });
+    var length = Math.min(array.length, 300);
+    for (var i = 1; i < length; ++i) {
+        if (typeof array[i - 1] == "number" && typeof array[i] == "number")
+            check(array[i - 1] <= array[i], "reshape " + r + " out of order at " + i);
+    }
+}
+
+// An inconsistent comparator must still give back a permutation of the values.
+var random = makeObjects(3000);
+var seen = {};
+random.sort(function(a, b) { return (a.value ^ b.value ^ calls++) & 1 ? 1 : -1; });
+check(random.length == 3000, "inconsistent comparator changed the length");
+for (var i = 0; i < random.length; ++i) {
+    check(!seen[random[i].value], "inconsistent comparator duplicated " + random[i].value);
+    seen[random[i].value] = true;
+}
+
+print("PASS");
@@ -0,0 +1,94 @@
+// Sorts arrays of records by a key with few distinct values, in every indexing shape and in
+// presorted, reversed, run-structured and random orders, and checks that records with equal
+// keys keep their order. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+var seed = 1;
+function random()
+{
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    return seed;
+}
+
+function checkStable(array, key, where)
+{
+    for (var i = 1; i < array.length; ++i) {
+        var a = key(array[i - 1]);
+        var b = key(array[i]);
+        check(a <= b, where + ": out of order at " + i);
+        if (a == b)
+            check(array[i - 1].index < array[i].index, where + ": equal keys reordered at " + i);
+    }
+}
+
+var orders = {
+    presorted: function(i, n) { return i; },
+    reversed: function(i, n) { return n - i; },
+    runs: function(i, n) { return (i % 37) + ((i / 37) | 0) % 3; },
+    random: function(i, n) { return random() % 1000; }
+};
+
+var sizes = [2, 7, 31, 32, 33, 64, 100, 1000, 10000];
+for (var name in orders) {
+    for (var s = 0; s < sizes.length; ++s) {
+        var n = sizes[s];
+        var records = [];
+        for (var i = 0; i < n; ++i)
+            records.push({ key: orders[name](i, n) % 10, index: i });
+        records.sort(function(a, b) { return a.key - b.key; });
+        checkStable(records, function(record) { return record.key; }, name + " " + n);
+    }
+}
+
+// Equal numbers can only be told apart by where they came from, so the Int32 and Double
+// shapes sort indices into a parallel array of keys.
+var keys = [];
+for (var i = 0; i < 5000; ++i)
+    keys.push(random() % 50);
+var doubleKeys = keys.map(function(key) { return key + 0.5; });
+
+var indices = [];
+for (var i = 0; i < keys.length; ++i)
+    indices.push(i);
+indices.sort(function(a, b) { return keys[a] - keys[b]; });
+for (var i = 1; i < indices.length; ++i) {
+    check(keys[indices[i - 1]] <= keys[indices[i]], "int32 indices out of order at " + i);
+    if (keys[indices[i - 1]] == keys[indices[i]])
+        check(indices[i - 1] < indices[i], "int32 indices reordered at " + i);
+}
+
+var doubleIndices = [];
+for (var i = 0; i < doubleKeys.length; ++i)
+    doubleIndices.push(i + 0.25);
+doubleIndices.sort(function(a, b) { return doubleKeys[a | 0] - doubleKeys[b | 0]; });
+for (var i = 1; i < doubleIndices.length; ++i) {
+    var a = doubleIndices[i - 1] | 0;
+    var b = doubleIndices[i] | 0;
+    check(doubleKeys[a] <= doubleKeys[b], "double indices out of order at " + i);
+    if (doubleKeys[a] == doubleKeys[b])
+        check(a < b, "double indices reordered at " + i);
+}
+
+// A comparator that always answers 0 must not move anything.
+var strings = [];
+for (var i = 0; i < 1000; ++i)
+    strings.push("s" + (random() % 100));
+var copy = strings.slice();
+strings.sort(function() { return 0; });
+for (var i = 0; i < strings.length; ++i)
+    check(strings[i] === copy[i], "comparator returning 0 moved " + i);
+
+// Array storage.
+var stored = [];
+stored.unshift(0);
+for (var i = 0; i < 2000; ++i)
+    stored[i] = { key: random() % 7, index: i };
+stored.sort(function(a, b) { return a.key - b.key; });
+checkStable(stored, function(record) { return record.key; }, "array storage");
+
+print("PASS");
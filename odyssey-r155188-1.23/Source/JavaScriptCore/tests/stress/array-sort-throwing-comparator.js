@@ -0,0 +1,68 @@
+// Throws from the compare function after some number of calls, for arrays of every indexing
+// shape, and checks that the exception reaches the caller and the array is left exactly as it
+// was. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function Abort() { }
+
+function makeArrays()
+{
+    var int32 = [];
+    var doubles = [];
+    var contiguous = [];
+    var storage = [];
+    storage.unshift(0);
+    for (var i = 0; i < 500; ++i) {
+        var value = (i * 7919) % 500;
+        int32.push(value);
+        doubles.push(value + 0.5);
+        contiguous.push("v" + value);
+        storage[i] = { value: value };
+    }
+    contiguous[17] = undefined;
+    storage[23] = undefined;
+    delete storage[42];
+    return { int32: int32, doubles: doubles, contiguous: contiguous, storage: storage };
+}
+
+function valueOf(x)
+{
+    if (typeof x == "object")
+        return x.value;
+    if (typeof x == "string")
+        return parseInt(x.substring(1));
+    return x;
+}
+
+var limits = [0, 1, 10, 100, 1000, 3000];
+for (var l = 0; l < limits.length; ++l) {
+    var arrays = makeArrays();
+    for (var name in arrays) {
+        var array = arrays[name];
+        var before = array.slice();
+        var calls = 0;
+        var thrown = null;
+        try {
+            array.sort(function(a, b) {
+                if (calls++ == limits[l])
+                    throw new Abort();
+                return valueOf(a) - valueOf(b);
+            });
+        } catch (e) {
+            thrown = e;
+        }
+        check(thrown instanceof Abort, name + " after " + limits[l] + " calls: exception lost");
+        check(array.length == before.length, name + " after " + limits[l] + " calls: length changed");
+        for (var i = 0; i < before.length; ++i) {
+            check((i in array) == (i in before), name + " after " + limits[l] + " calls: hole moved at " + i);
+            check(array[i] === before[i], name + " after " + limits[l] + " calls: changed at " + i);
+        }
+    }
+}
+
+print("PASS");
@@ -0,0 +1,66 @@
+// Churns through objects without destructors while keeping a changing set of them alive, so
+// that collections start while the background sweeper is still building free lists and the
+// allocator picks up blocks in every state. Run with and without --useBackgroundSweeping=false.
+// Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function makeNode(id)
+{
+    return { id: id, next: null, payload: [id, id * 2, "n" + id], self: null };
+}
+
+var retained = new Array(20000);
+var nextId = 0;
+
+function verify(node, index)
+{
+    check(node.payload[0] === node.id && node.payload[1] === node.id * 2, "payload of node " + node.id + " at " + index);
+    check(node.payload[2] === "n" + node.id, "label of node " + node.id + " at " + index);
+    check(node.self === node, "self reference of node " + node.id + " at " + index);
+    if (node.next)
+        check(node.next.id < node.id, "link of node " + node.id + " at " + index);
+}
+
+for (var i = 0; i < retained.length; ++i) {
+    retained[i] = makeNode(nextId++);
+    retained[i].self = retained[i];
+}
+
+for (var round = 0; round < 200; ++round) {
+    // Garbage of several cell sizes.
+    for (var j = 0; j < 20000; ++j) {
+        var garbage = { a: j, b: j + 1 };
+        if (j % 3)
+            garbage = [j, j, j, j, j, j, j, j];
+        if (!(j % 7))
+            garbage = { a: 1, b: 2, c: 3, d: 4, e: 5, f: 6, g: 7, h: 8, i: 9, j: 10 };
+    }
+
+    // Replace a slice of the retained nodes, linking new ones to survivors.
+    for (var j = 0; j < 2000; ++j) {
+        var index = (round * 7919 + j * 104729) % retained.length;
+        var node = makeNode(nextId++);
+        node.self = node;
+        node.next = retained[(index + 1) % retained.length];
+        if (node.next.id > node.id)
+            node.next = null;
+        retained[index] = node;
+    }
+
+    // Collect while the previous cycle's sweeping is still in flight.
+    if (!(round % 10))
+        gc();
+
+    for (var j = 0; j < retained.length; j += 97)
+        verify(retained[j], j);
+}
+
+for (var i = 0; i < retained.length; ++i)
+    verify(retained[i], i);
+
+print("PASS");
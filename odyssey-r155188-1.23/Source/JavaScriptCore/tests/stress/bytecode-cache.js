@@ -0,0 +1,59 @@
+// Stores a program in the bytecode cache, loads it back and runs it, then checks that damaged
+// function bodies and a damaged program code block are compiled from source instead of being
+// decoded. Run from this directory as "jsc -b <empty directory> bytecode-cache.js".
+// Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+var program = "resources/bytecode-cache-program.js";
+var expected = 39201;
+
+function loadProgram()
+{
+    bytecodeCacheResult = undefined;
+    load(program);
+    check(bytecodeCacheResult === expected, "result: " + bytecodeCacheResult);
+}
+
+var before = bytecodeCacheStatistics();
+check(before, "not run with -b");
+
+loadProgram();
+var stored = bytecodeCacheStatistics();
+check(stored.hits + stored.misses == before.hits + before.misses + 1, "first load was not looked up");
+
+clearCodeCache();
+loadProgram();
+var loaded = bytecodeCacheStatistics();
+check(loaded.hits == stored.hits + 1, "reloaded program did not hit");
+check(loaded.functionCodeBlocksDecoded > stored.functionCodeBlocksDecoded, "no function bodies decoded");
+check(loaded.functionCodeBlocksRejected == stored.functionCodeBlocksRejected, "intact function bodies rejected");
+
+clearCodeCache();
+damageBytecodeCache(false);
+loadProgram();
+var damagedFunctions = bytecodeCacheStatistics();
+check(damagedFunctions.hits == loaded.hits + 1, "program with damaged function bodies did not hit");
+check(damagedFunctions.functionCodeBlocksRejected > loaded.functionCodeBlocksRejected, "damaged function bodies decoded");
+
+clearCodeCache();
+damageBytecodeCache(true);
+loadProgram();
+var damagedProgram = bytecodeCacheStatistics();
+check(damagedProgram.hits == damagedFunctions.hits, "damaged program hit");
+check(damagedProgram.rejected == damagedFunctions.rejected + 1, "damaged program not rejected");
+
+// The load above stored the program again. Shrinking the cache below its size deletes it.
+clearCodeCache();
+setBytecodeCacheMaximumSize(1);
+var evicted = bytecodeCacheStatistics();
+check(evicted.filesEvicted > damagedProgram.filesEvicted, "nothing evicted");
+loadProgram();
+check(bytecodeCacheStatistics().misses == evicted.misses + 1, "evicted program did not miss");
+setBytecodeCacheMaximumSize(16 * 1024 * 1024);
+
+print("PASS");
@@ -0,0 +1,132 @@
+// Stores young objects into old ones in every way the interpreter and the runtime can, then
+// allocates enough garbage for eden collections to run before checking that nothing
+// reachable only through an old object was freed. Run with and without
+// --useGenerationalGC=true. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function makeValue(id)
+{
+    return { id: id, label: "v" + id, list: [id, id + 1] };
+}
+
+function verifyValue(value, id, where)
+{
+    check(value && value.id === id, where + ": expected value " + id);
+    check(value.label === "v" + id, where + ": label of value " + id);
+    check(value.list[0] === id && value.list[1] === id + 1, where + ": list of value " + id);
+}
+
+function allocateGarbage()
+{
+    for (var i = 0; i < 50000; ++i) {
+        var garbage = { a: i, b: [i, i, i, i] };
+        garbage.c = "g" + i;
+    }
+}
+
+var count = 2000;
+var objects = [];
+var arrays = [];
+var sparseArrays = [];
+var closures = [];
+var constructors = [];
+var dictionaryArrays = [];
+var globalSlot = null;
+var rounds = 20;
+
+function makeClosure()
+{
+    var captured = null;
+    return {
+        set: function (value) { captured = value; },
+        get: function () { return captured; }
+    };
+}
+
+function makeConstructor()
+{
+    return function () { this.constructed = true; };
+}
+
+function makeGetter(value)
+{
+    return function () { return value; };
+}
+
+for (var i = 0; i < count; ++i) {
+    objects.push({ slot: null });
+    arrays.push([null, null, null]);
+    var sparse = [];
+    sparse[100000] = null;
+    sparseArrays.push(sparse);
+    closures.push(makeClosure());
+    constructors.push(makeConstructor());
+}
+
+// Arrays with a vector and a sparse map that is not in sparse mode yet, one per round.
+for (var round = 0; round < rounds; ++round) {
+    var arraysOfRound = [];
+    for (var i = 0; i < count; ++i) {
+        var array = [null, null];
+        array[100000] = null;
+        arraysOfRound.push(array);
+    }
+    dictionaryArrays.push(arraysOfRound);
+}
+
+// Everything allocated so far becomes old.
+gc();
+
+for (var round = 0; round < rounds; ++round) {
+    var base = round * count * 12;
+    for (var i = 0; i < count; ++i) {
+        objects[i].slot = makeValue(base + i);
+        // A transition to a new structure.
+        objects[i]["extra" + round] = makeValue(base + count + i);
+        arrays[i][1] = makeValue(base + 2 * count + i);
+        arrays[i].push(makeValue(base + 3 * count + i));
+        sparseArrays[i][100000] = makeValue(base + 4 * count + i);
+        closures[i].set(makeValue(base + 5 * count + i));
+        Object.defineProperty(objects[i], "defined", { value: makeValue(base + 6 * count + i), configurable: true });
+        // The old function caches a young structure for the objects it constructs.
+        constructors[i].prototype = makeValue(base + 8 * count + i);
+        new constructors[i]();
+        // Entries of an old sparse map written through property descriptors.
+        Object.defineProperty(sparseArrays[i], 100001, { value: makeValue(base + 9 * count + i), writable: true, configurable: true });
+        Object.defineProperty(sparseArrays[i], 100002, { get: makeGetter(makeValue(base + 10 * count + i)), configurable: true });
+        // A young element that moves into the old sparse map when the array enters sparse mode.
+        dictionaryArrays[round][i][0] = makeValue(base + 11 * count + i);
+        Object.defineProperty(dictionaryArrays[round][i], 1, { value: null, writable: false });
+    }
+    globalSlot = makeValue(base + 7 * count);
+
+    allocateGarbage();
+
+    for (var i = 0; i < count; ++i) {
+        verifyValue(objects[i].slot, base + i, "property " + i);
+        verifyValue(objects[i]["extra" + round], base + count + i, "new property " + i);
+        verifyValue(arrays[i][1], base + 2 * count + i, "element " + i);
+        verifyValue(arrays[i][arrays[i].length - 1], base + 3 * count + i, "pushed element " + i);
+        verifyValue(sparseArrays[i][100000], base + 4 * count + i, "sparse element " + i);
+        verifyValue(closures[i].get(), base + 5 * count + i, "closure variable " + i);
+        verifyValue(objects[i].defined, base + 6 * count + i, "defined property " + i);
+        var constructed = new constructors[i]();
+        check(constructed.constructed, "constructed object " + i);
+        verifyValue(Object.getPrototypeOf(constructed), base + 8 * count + i, "constructor prototype " + i);
+        verifyValue(sparseArrays[i][100001], base + 9 * count + i, "defined sparse element " + i);
+        verifyValue(sparseArrays[i][100002], base + 10 * count + i, "sparse getter " + i);
+        verifyValue(dictionaryArrays[round][i][0], base + 11 * count + i, "element moved to sparse map " + i);
+    }
+    verifyValue(globalSlot, base + 7 * count, "global variable");
+
+    // Let the young values of this round grow old from time to time.
+    if (!(round % 5))
+        gc();
+}
+
+print("PASS");
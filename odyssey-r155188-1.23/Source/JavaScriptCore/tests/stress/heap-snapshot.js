@@ -0,0 +1,56 @@
+// Takes a heap snapshot of a small known graph and checks that the snapshot is consistent:
+// every reference leads to a listed cell, the per-class summary counts the listed cells and
+// the storage of typed arrays is attributed to them. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+var retained = [];
+for (var i = 0; i < 1000; ++i)
+    retained.push({ index: i, vector: new Float64Array(100) });
+
+var lines = heapSnapshot().split("\n");
+check(lines[0] == "JSCHeapSnapshot 1", "header: " + lines[0]);
+check(lines[lines.length - 2] == "End", "last record: " + lines[lines.length - 2]);
+
+var nodes = {};
+var nodeCounts = {};
+var typeCounts = {};
+var references = [];
+var largeVectors = 0;
+for (var i = 1; i < lines.length - 2; ++i) {
+    var fields = lines[i].split(" ");
+    switch (fields[0]) {
+    case "N":
+        check(fields.length == 7, "node: " + lines[i]);
+        nodes[fields[1]] = fields[2];
+        nodeCounts[fields[2]] = (nodeCounts[fields[2]] || 0) + 1;
+        if (fields[2] == "Float64Array" && +fields[5] >= 100 * 8)
+            ++largeVectors;
+        break;
+    case "E":
+        references.push(fields[2]);
+        break;
+    case "R":
+        references.push(fields[1]);
+        break;
+    case "T":
+        check(fields.length == 6, "summary: " + lines[i]);
+        typeCounts[fields[1]] = +fields[2];
+        break;
+    default:
+        check(false, "unknown record: " + lines[i]);
+    }
+}
+
+for (var i = 0; i < references.length; ++i)
+    check(references[i] in nodes, "reference to an unlisted cell " + references[i]);
+for (var className in nodeCounts)
+    check(typeCounts[className] >= nodeCounts[className], "summary of " + className);
+check(nodeCounts["Float64Array"] >= 1000, "typed arrays: " + nodeCounts["Float64Array"]);
+check(largeVectors >= 1000, "typed arrays owning their vector: " + largeVectors);
+
+print("PASS");
@@ -0,0 +1,93 @@
+// Parses documents whose objects share, almost share and reorder their properties, and checks
+// every value against what the source says. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+var longText = "a string that is long enough to share the buffer of the source";
+
+var records = [];
+for (var i = 0; i < 1000; ++i) {
+    var record;
+    switch (i % 5) {
+    case 0:
+        record = '{"id":' + i + ',"name":"n' + i + '","text":"' + longText + i + '"}';
+        break;
+    case 1:
+        // Same keys in another order.
+        record = '{"name":"n' + i + '","id":' + i + ',"text":"' + longText + i + '"}';
+        break;
+    case 2:
+        // A key that only shares its first characters with the usual one.
+        record = '{"id":' + i + ',"nam":"n' + i + '","text":"' + longText + i + '"}';
+        break;
+    case 3:
+        // A duplicate key, an index key and an escaped string.
+        record = '{"id":-1,"id":' + i + ',"0":"zero","text":"' + longText + '\\n' + i + '"}';
+        break;
+    case 4:
+        // Fewer keys, then more.
+        record = '{"id":' + i + ',"name":"n' + i + '","text":"' + longText + i + '","extra":{"id":' + i + '}}';
+        break;
+    }
+    records.push(record);
+}
+
+var parsed = JSON.parse("[" + records.join(",") + "]");
+check(parsed.length === records.length, "length");
+
+for (var i = 0; i < parsed.length; ++i) {
+    var record = parsed[i];
+    check(record.id === i, "id of " + i);
+    switch (i % 5) {
+    case 0:
+    case 1:
+        check(record.name === "n" + i, "name of " + i);
+        check(record.text === longText + i, "text of " + i);
+        check(Object.keys(record).join() === (i % 5 ? "name,id,text" : "id,name,text"), "keys of " + i);
+        break;
+    case 2:
+        check(record.nam === "n" + i && !("name" in record), "nam of " + i);
+        break;
+    case 3:
+        check(record[0] === "zero", "index key of " + i);
+        check(record.text === longText + "\n" + i, "escaped text of " + i);
+        check(Object.keys(record).join() === "0,id,text", "keys of " + i);
+        break;
+    case 4:
+        check(record.extra.id === i, "nested id of " + i);
+        check(Object.keys(record).join() === "id,name,text,extra", "keys of " + i);
+        break;
+    }
+}
+
+// Objects dropped for a duplicate key take their structures with them. The parse allocates
+// enough to collect in between, so the cached transitions must not outlive their structures.
+var dropped = [];
+for (var i = 0; i < 2000; ++i)
+    dropped.push('{"v":{"a' + (i % 50) + '":"' + longText + '","b":' + i + '},"v":{"a' + (i % 50) + '":' + i + ',"b":' + i + ',"c":[' + i + ']}}');
+parsed = JSON.parse("[" + dropped.join(",") + "]");
+for (var i = 0; i < parsed.length; ++i) {
+    var value = parsed[i].v;
+    check(value["a" + (i % 50)] === i && value.b === i && value.c[0] === i, "value of dropped " + i);
+    check(Object.keys(value).join() === "a" + (i % 50) + ",b,c", "keys of dropped " + i);
+}
+
+// Shared strings stay intact after the source is gone.
+var texts = [];
+for (var i = 0; i < 100; ++i)
+    texts.push(JSON.parse('{"text":"' + longText + i + '"}').text);
+gc();
+for (var i = 0; i < texts.length; ++i)
+    check(texts[i] === longText + i, "text " + i + " after collection");
+
+// A short value copies its characters instead of keeping a long text alive.
+var padding = new Array(2000).join("x");
+var shortValue = JSON.parse('{"padding":"' + padding + '","text":"' + longText + '"}').text;
+gc();
+check(shortValue === longText, "short value of a long text");
+
+print("PASS");
@@ -0,0 +1,85 @@
+// Compares JSON.stringify without a replacer against the generic path, which an identity
+// replacer forces, for values the fast path writes itself and for values it has to give up
+// on. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function identity(key, value)
+{
+    return value;
+}
+
+function compare(value, name)
+{
+    var expected = JSON.stringify(value, identity);
+    var actual = JSON.stringify(value);
+    check(actual === expected, name + ": " + actual + " !== " + expected);
+}
+
+var withAccessor = { a: 1 };
+Object.defineProperty(withAccessor, "b", { get: function () { return 2; }, enumerable: true });
+var withHidden = { a: 1 };
+Object.defineProperty(withHidden, "hidden", { value: 2, enumerable: false });
+var withDeleted = { a: 1, b: 2, c: 3 };
+delete withDeleted.b;
+var holes = [1, 2];
+holes[4] = 5;
+var noPrototype = Object.create(null);
+noPrototype.x = "y";
+
+var values = {
+    "plain": { a: 1, b: "two", c: [3, 4.5, true, false, null], d: { e: "\"quoted\"\n\u0001" } },
+    "undefined and functions": { a: undefined, b: function () { }, c: [undefined, function () { }], d: 1 },
+    "numbers": [0, -0, 1 / 3, -1e21, 1e-7, NaN, Infinity, -Infinity, 2147483647, 2147483648],
+    "nested toJSON": { a: 1, b: { toJSON: function () { return "custom"; } }, c: [new Date(0)] },
+    "accessor": { x: withAccessor },
+    "hidden property": withHidden,
+    "deleted property": withDeleted,
+    "holes": holes,
+    "null prototype": noPrototype,
+    "boxed primitives": [new Number(1), new String("s"), new Boolean(false)],
+    "index keys": { 1: "one", 0: "zero", a: "a" },
+    "empty": [{}, [], new Array(3)],
+    "unicode": ["é", "€", "😀"],
+    "ropes": { a: "left" + Math.random().toString().length + "right" }
+};
+
+for (var name in values)
+    compare(values[name], name);
+
+var deep = [];
+var current = deep;
+for (var i = 0; i < 200; ++i) {
+    var next = [{ i: i }];
+    current.push(next);
+    current = next;
+}
+compare(deep, "deep");
+
+var records = [];
+for (var i = 0; i < 1000; ++i)
+    records.push(i % 100 ? { id: i, name: "n" + i } : { id: i, name: "n" + i, when: new Date(i) });
+compare(records, "records");
+
+var cyclic = { a: [{}] };
+cyclic.a[0].b = cyclic;
+var threw = false;
+try {
+    JSON.stringify(cyclic);
+} catch (e) {
+    threw = e instanceof TypeError;
+}
+check(threw, "cycle");
+
+Object.prototype.toJSON = function () { return "from prototype"; };
+check(JSON.stringify({ a: 1 }) === "\"from prototype\"", "toJSON on Object.prototype");
+delete Object.prototype.toJSON;
+Array.prototype.toJSON = function () { return "array"; };
+check(JSON.stringify({ a: [1] }) === "{\"a\":\"array\"}", "toJSON on Array.prototype");
+delete Array.prototype.toJSON;
+
+print("PASS");
@@ -0,0 +1,53 @@
+// The typed array constructors are only put on a global object when first needed. Checks
+// that this can't be observed: lookups, enumeration, assignment, deletion and declarations
+// in fresh global objects behave as if the constructors had been there from the start.
+// Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+var names = ["Int8Array", "Uint8Array", "Uint8ClampedArray", "Int16Array", "Uint16Array",
+    "Int32Array", "Uint32Array", "Float32Array", "Float64Array", "DataView"];
+
+for (var i = 0; i < names.length; ++i) {
+    var global = createGlobalObject();
+    var name = names[i];
+    check(global.hasOwnProperty(name), "hasOwnProperty " + name);
+    var descriptor = Object.getOwnPropertyDescriptor(global, name);
+    check(descriptor && descriptor.writable && descriptor.configurable && !descriptor.enumerable, "attributes of " + name);
+    check(typeof global[name] == "function", "typeof " + name);
+    check(global[name] !== this[name], name + " belongs to the new global object");
+    check(global[name].prototype.constructor === global[name], name + ".prototype.constructor");
+    var view = name == "DataView" ? new global[name](new global.ArrayBuffer(8)) : new global[name](8);
+    check(Object.getPrototypeOf(view) === global[name].prototype, "prototype of a new " + name);
+    check(view instanceof global[name] && !(view instanceof this[name]), "instanceof " + name);
+}
+
+var global = createGlobalObject();
+var ownNames = Object.getOwnPropertyNames(global);
+for (var i = 0; i < names.length; ++i)
+    check(ownNames.indexOf(names[i]) != -1, "getOwnPropertyNames lists " + names[i]);
+
+global = createGlobalObject();
+for (var property in global)
+    check(names.indexOf(property) == -1, "for-in lists " + property);
+
+global = createGlobalObject();
+check(delete global.Uint16Array, "delete");
+check(!("Uint16Array" in global) && global.Uint16Array === undefined, "deleted constructor came back");
+global.DataView = 42;
+check(global.DataView === 42, "assignment");
+Object.defineProperty(global, "Float32Array", { value: "defined", enumerable: true });
+check(global.Float32Array === "defined" && global.propertyIsEnumerable("Float32Array"), "defineProperty");
+
+global = createGlobalObject();
+global.eval("function Int32Array() { return 'declared'; }");
+check(global.Int32Array() === "declared", "function declaration");
+check(global.eval("var Int8Array; typeof Int8Array") == "function", "var declaration");
+check(global.eval("typeof Float64Array") == "function", "global variable lookup");
+check(global.eval("Uint8Array = 1; Uint8Array") === 1, "global variable assignment");
+
+print("PASS");
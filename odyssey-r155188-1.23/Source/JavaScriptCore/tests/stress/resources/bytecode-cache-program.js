@@ -0,0 +1,52 @@
+// Loaded by bytecode-cache.js. It has to be longer than the 4096 characters below which programs
+// are not cached, so it declares a lot of small functions and sets bytecodeCacheResult.
+
+function step0(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step1(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step2(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step3(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step4(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+function step5(value) { var total = value; for (var i = 0; i < 8; ++i) total = (total * 31 + i) % 65521; return total; }
+function step6(value) { var total = value; for (var i = 0; i < 9; ++i) total = (total * 31 + i) % 65521; return total; }
+function step7(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step8(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step9(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step10(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step11(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+function step12(value) { var total = value; for (var i = 0; i < 8; ++i) total = (total * 31 + i) % 65521; return total; }
+function step13(value) { var total = value; for (var i = 0; i < 9; ++i) total = (total * 31 + i) % 65521; return total; }
+function step14(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step15(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step16(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step17(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step18(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+function step19(value) { var total = value; for (var i = 0; i < 8; ++i) total = (total * 31 + i) % 65521; return total; }
+function step20(value) { var total = value; for (var i = 0; i < 9; ++i) total = (total * 31 + i) % 65521; return total; }
+function step21(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step22(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step23(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step24(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step25(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+function step26(value) { var total = value; for (var i = 0; i < 8; ++i) total = (total * 31 + i) % 65521; return total; }
+function step27(value) { var total = value; for (var i = 0; i < 9; ++i) total = (total * 31 + i) % 65521; return total; }
+function step28(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step29(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step30(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step31(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step32(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+function step33(value) { var total = value; for (var i = 0; i < 8; ++i) total = (total * 31 + i) % 65521; return total; }
+function step34(value) { var total = value; for (var i = 0; i < 9; ++i) total = (total * 31 + i) % 65521; return total; }
+function step35(value) { var total = value; for (var i = 0; i < 3; ++i) total = (total * 31 + i) % 65521; return total; }
+function step36(value) { var total = value; for (var i = 0; i < 4; ++i) total = (total * 31 + i) % 65521; return total; }
+function step37(value) { var total = value; for (var i = 0; i < 5; ++i) total = (total * 31 + i) % 65521; return total; }
+function step38(value) { var total = value; for (var i = 0; i < 6; ++i) total = (total * 31 + i) % 65521; return total; }
+function step39(value) { var total = value; for (var i = 0; i < 7; ++i) total = (total * 31 + i) % 65521; return total; }
+
+function Accumulator(seed) { this.value = seed; }
+Accumulator.prototype.add = function(value) { this.value = (this.value + value) % 65521; return this; };
+
+var accumulator = new Accumulator(1);
+var steps = [step0, step1, step2, step3, step4, step5, step6, step7, step8, step9, step10, step11, step12, step13, step14, step15, step16, step17, step18, step19, step20, step21, step22, step23, step24, step25, step26, step27, step28, step29, step30, step31, step32, step33, step34, step35, step36, step37, step38, step39];
+for (var i = 0; i < steps.length; ++i)
+    accumulator.add(steps[i](i));
+var bytecodeCacheResult = accumulator.value;
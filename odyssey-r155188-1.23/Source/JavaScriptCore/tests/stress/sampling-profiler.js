@@ -0,0 +1,75 @@
+// Runs a hot loop, recursion without loops and a host function under the sampling profiler
+// and checks that the stacks name each of them below their caller. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function hotLoop(iterations)
+{
+    var sum = 0;
+    for (var i = 0; i < iterations; ++i)
+        sum += i % 7;
+    return sum;
+}
+
+function caller()
+{
+    var start = preciseTime();
+    while (preciseTime() - start < 0.2)
+        hotLoop(100000);
+}
+
+function recurse(n)
+{
+    return n < 2 ? n : recurse(n - 1) + recurse(n - 2);
+}
+
+function recursionCaller()
+{
+    var start = preciseTime();
+    while (preciseTime() - start < 0.2)
+        recurse(20);
+}
+
+var records = [];
+for (var i = 0; i < 2000; ++i)
+    records.push({ index: i, name: "record " + i, values: [i, i + 1, i + 2] });
+
+function callsHost()
+{
+    return JSON.stringify(records).length;
+}
+
+function hostCaller()
+{
+    var start = preciseTime();
+    while (preciseTime() - start < 0.2)
+        callsHost();
+}
+
+startSamplingProfiler(1);
+caller();
+recursionCaller();
+hostCaller();
+stopSamplingProfiler();
+
+var folded = samplingProfilerStackTraces();
+check(/caller \([^)]*\);hotLoop \([^)]*\) \d+/.test(folded), "loop in folded stacks:\n" + folded);
+check(/recursionCaller \([^)]*\);recurse \([^)]*\)[; ]/.test(folded), "recursion in folded stacks:\n" + folded);
+check(/hostCaller \([^)]*\);callsHost \([^)]*\) \d+/.test(folded), "host function caller in folded stacks:\n" + folded);
+
+var profile = samplingProfilerStackTraces("json");
+check(profile.sampleCount > 0, "sample count");
+var total = 0;
+for (var i = 0; i < profile.nodes.length; ++i) {
+    var node = profile.nodes[i];
+    check(node.parent < i, "parent of node " + i);
+    check(profile.frames[node.frame], "frame of node " + i);
+    total += node.selfCount;
+}
+check(total === profile.sampleCount, "samples in nodes");
+
+print("PASS");
@@ -0,0 +1,127 @@
+// Takes substrings of ropes, of substrings of ropes and of flat strings of all sizes, and
+// flattens ropes whose left-most fiber is shared with other strings, then checks every
+// character. Prints "PASS" or throws.
+
+function check(condition, message)
+{
+    if (!condition)
+        throw new Error("FAIL: " + message);
+}
+
+function expectedCharacter(index)
+{
+    return String.fromCharCode(97 + (index * 7) % 26);
+}
+
+function verify(string, offset, length, where)
+{
+    check(string.length == length, where + ": length " + string.length + " instead of " + length);
+    for (var i = 0; i < length; i += 1 + (i >> 4))
+        check(string.charAt(i) == expectedCharacter(offset + i), where + ": character " + i);
+    check(string.charAt(length - 1) == expectedCharacter(offset + length - 1), where + ": last character");
+}
+
+function makeRope(offset, length, pieceLength)
+{
+    var rope = "";
+    for (var i = 0; i < length; i += pieceLength) {
+        var piece = "";
+        for (var j = i; j < Math.min(i + pieceLength, length); ++j)
+            piece += expectedCharacter(offset + j);
+        rope += piece;
+    }
+    return rope;
+}
+
+var sizes = [3, 17, 100, 1000, 5000];
+for (var s = 0; s < sizes.length; ++s) {
+    var length = sizes[s] * 10;
+    var rope = makeRope(0, length, sizes[s]);
+    var starts = [0, 1, sizes[s] - 1, length >> 1, length - sizes[s]];
+    for (var i = 0; i < starts.length; ++i) {
+        var start = starts[i];
+        var end = Math.min(length, start + sizes[s]);
+        var slice = rope.slice(start, end);
+        var inner = slice.substr(1, slice.length - 2);
+        var concatenated = slice + inner;
+        verify(slice, start, end - start, "slice of a rope of " + length);
+        verify(inner, start + 1, end - start - 2, "substring of a slice of a rope of " + length);
+        check(concatenated == slice + slice.substring(1, slice.length - 1), "concatenated slices of a rope of " + length);
+    }
+    verify(rope, 0, length, "rope of " + length);
+    verify(rope.substring(5, length - 5), 5, length - 10, "substring of a flattened rope of " + length);
+}
+
+// Flattening a rope leaves its fibers intact, including a fiber that appears more than once.
+var prefix = makeRope(0, 2000, 100);
+verify(prefix, 0, 2000, "prefix");
+var doubled = prefix + prefix;
+check(doubled.length == 4000, "doubled length");
+verify(doubled.substring(0, 2000), 0, 2000, "first half of the doubled prefix");
+verify(doubled.substring(2000), 0, 2000, "second half of the doubled prefix");
+verify(prefix, 0, 2000, "prefix after flattening the doubled prefix");
+
+var accumulated = makeRope(0, 1000, 50);
+accumulated.charAt(0);
+var versions = [];
+for (var i = 1; i < 40; ++i) {
+    versions.push(accumulated);
+    accumulated += makeRope(i * 1000, 1000, 50);
+    accumulated.charAt(0);
+}
+verify(accumulated, 0, 40000, "accumulated string");
+for (var i = 0; i < versions.length; ++i)
+    verify(versions[i], 0, (i + 1) * 1000, "version " + i + " of the accumulated string");
+
+// Ropes that start with the same flattened string keep their own characters, whichever is
+// flattened first, in 8-bit and 16-bit strings, and may repeat characters of that string.
+function checkBranches(first, name)
+{
+    var grown = first + makeRope(1, 2999, 100);
+    grown.charAt(0);
+    grown += makeRope(3000, 1000, 100);
+    grown.charAt(0);
+    var branches = [];
+    for (var i = 0; i < 4; ++i)
+        branches.push(grown + String.fromCharCode(first.charCodeAt(0) + i + 1) + grown.substring(1, 500));
+    for (var i = branches.length - 1; i >= 0; --i) {
+        var branch = branches[i];
+        branch.charAt(0);
+        check(branch.charAt(0) == first, name + " branch " + i + ": first character");
+        verify(branch.substring(1, 4000), 1, 3999, name + " branch " + i);
+        check(branch.charCodeAt(4000) == first.charCodeAt(0) + i + 1, name + " branch " + i + ": appended character");
+        verify(branch.substring(4001), 1, 499, name + " branch " + i + ": repeated characters");
+    }
+    check(grown.charAt(0) == first, name + " string the branches start with: first character");
+    verify(grown.substring(1), 1, 3999, name + " string the branches start with");
+}
+checkBranches(expectedCharacter(0), "8-bit");
+checkBranches("\u0100", "16-bit");
+
+// Native code reading a flat string must see it unchanged while script flattens ropes built
+// on top of it, as replace() does with the string it searches while calling back.
+var searched = makeRope(0, 3000, 100);
+verify(searched, 0, 3000, "searched string");
+var matches = 0;
+var replaced = searched.replace(/a/g, function (match, offset, string) {
+    (string + "x").charAt(0);
+    (searched + searched).charAt(0);
+    ++matches;
+    return match;
+});
+check(matches > 0, "replace callback was called");
+verify(replaced, 0, 3000, "string replaced while flattening ropes of it");
+verify(searched, 0, 3000, "searched string after replace");
+
+// Substrings of a huge flat string do not need it to stay alive.
+var huge = makeRope(0, 100000, 1000);
+verify(huge, 0, 100000, "huge string");
+var pieces = [];
+for (var i = 0; i < 100; ++i)
+    pieces.push(huge.substring(i * 997, i * 997 + 10));
+huge = null;
+gc();
+for (var i = 0; i < pieces.length; ++i)
+    verify(pieces[i], i * 997, 10, "piece " + i + " of the huge string");
+
+print("PASS");
@@ -76,14 +76,18 @@ namespace JSC {
 IdentifierTable::~IdentifierTable()
 {
     HashSet<StringImpl*>::iterator end = m_table.end();
-    for (HashSet<StringImpl*>::iterator iter = m_table.begin(); iter != end; ++iter)
-        (*iter)->setIsIdentifier(false);
+    for (HashSet<StringImpl*>::iterator iter = m_table.begin(); iter != end; ++iter) {
+        // Static strings are in the tables of all threads and stay identifiers.
+        if (!(*iter)->isStatic())
+            (*iter)->setIsIdentifier(false);
+    }
 }
 
 HashSet<StringImpl*>::AddResult IdentifierTable::add(StringImpl* value)
 {
     HashSet<StringImpl*>::AddResult result = m_table.add(value);
-    (*result.iterator)->setIsIdentifier(true);
+    if (!(*result.iterator)->isStatic())
+        (*result.iterator)->setIsIdentifier(true);
     return result;
 }
 
@@ -384,6 +384,14 @@ PassRefPtr<StringImpl> AtomicString::addSlowCase(StringImpl* string)
 
     ASSERT_WITH_MESSAGE(!string->isAtomic(), "AtomicString should not hit the slow case if the string is already atomic.");
 
+    // Static strings are shared by all threads, so they can't be marked as belonging to the
+    // table of this one. Add a copy instead.
+    if (string->isStatic()) {
+        if (string->is8Bit())
+            return add(string->characters8(), string->length());
+        return add(string->characters16(), string->length());
+    }
+
     AtomicStringTableLocker locker;
     HashSet<StringImpl*>::AddResult addResult = stringTable().add(string);
 
@@ -168,6 +168,18 @@ PassRefPtr<StringImpl> StringImpl::createFromLiteral(const char* characters)
     return createFromLiteral(characters, strlen(characters));
 }
 
+StringImpl* StringImpl::createStaticStringImpl(const LChar* characters, unsigned length)
+{
+    ASSERT(length);
+    StringImpl* string = new StringImpl(characters, length, ConstructStaticString);
+    // Static strings are shared by all threads, so the 16-bit copy that characters() returns
+    // is made now rather than on first use.
+    string->m_copyData16 = static_cast<UChar*>(fastMalloc(length * sizeof(UChar)));
+    string->m_hashAndFlags |= s_hashFlagHas16BitShadow;
+    string->upconvertCharacters(0, length);
+    return string;
+}
+
 PassRefPtr<StringImpl> StringImpl::createWithoutCopying(const UChar* characters, unsigned length)
 {
     if (!length)
@@ -314,6 +326,14 @@ const UChar* StringImpl::getData16SlowCase() const
     if (has16BitShadow())
         return m_copyData16;
 
+    // Static strings are shared by all threads and must not be modified here. Only the empty
+    // string gets this far; createStaticStringImpl() makes the copy of the others up front.
+    if (isStatic()) {
+        ASSERT(!length());
+        static const UChar emptyUChar = 0;
+        return &emptyUChar;
+    }
+
     if (bufferOwnership() == BufferSubstring) {
         // If this is a substring, return a pointer into the parent string.
         // TODO: Consider severing this string from the parent string
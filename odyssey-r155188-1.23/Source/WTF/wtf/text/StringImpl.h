@@ -427,6 +427,11 @@ public:
     WTF_EXPORT_STRING_API static PassRefPtr<StringImpl> createWithoutCopying(const UChar* characters, unsigned length);
     WTF_EXPORT_STRING_API static PassRefPtr<StringImpl> createWithoutCopying(const LChar* characters, unsigned length);
 
+    // Creates a string that, like the empty string, is never destroyed and may be shared by all
+    // threads. Its hash and its 16-bit copy are made up front. The characters are not copied and must
+    // never be freed.
+    WTF_EXPORT_STRING_API static StringImpl* createStaticStringImpl(const LChar* characters, unsigned length);
+
     WTF_EXPORT_STRING_API static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
     WTF_EXPORT_STRING_API static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
     template <typename T> static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, T*& output)
@@ -508,7 +513,7 @@ public:
         if (bufferOwnership() == BufferSubstring)
             return m_substringBuffer->cost();
 
-        if (m_hashAndFlags & s_hashFlagDidReportCost)
+        if (isStatic() || m_hashAndFlags & s_hashFlagDidReportCost)
             return 0;
 
         m_hashAndFlags |= s_hashFlagDidReportCost;
@@ -532,6 +537,9 @@ public:
         return divideRoundedUp(result, refCount());
     }
 
+    // The string whose characters this substring shares, or null if this is not a substring.
+    StringImpl* substringBuffer() const { return bufferOwnership() == BufferSubstring ? m_substringBuffer : 0; }
+
     WTF_EXPORT_STRING_API size_t sizeInBytes() const;
 
     bool has16BitShadow() const { return m_hashAndFlags & s_hashFlagHas16BitShadow; }
@@ -46,6 +46,7 @@
 #include "SecurityOriginHash.h"
 #include "SQLiteFileSystem.h"
 #include "SQLiteStatement.h"
+#include "StorageUsageIndex.h"
 #include <wtf/MainThread.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/text/CString.h>
@@ -138,7 +139,7 @@ void DatabaseTracker::openTrackerDatabase(TrackerCreationAction createAction)
 bool DatabaseTracker::hasAdequateQuotaForOrigin(SecurityOrigin* origin, unsigned long estimatedSize, DatabaseError& err)
 {
     ASSERT(!m_databaseGuard.tryLock());
-    unsigned long long usage = usageForOrigin(origin);
+    unsigned long long usage = indexedUsageForOrigin(origin);
 
     // If the database will fit, allow its creation.
     unsigned long long requirement = usage + max(1UL, estimatedSize);
@@ -282,9 +283,9 @@ unsigned long long DatabaseTracker::getMaxSizeForDatabase(const DatabaseBackendB
     SecurityOrigin* origin = database->securityOrigin();
 
     unsigned long long quota = quotaForOriginNoLock(origin);
-    unsigned long long diskUsage = usageForOrigin(origin);
     unsigned long long databaseFileSize = SQLiteFileSystem::getDatabaseFileSize(database->fileName());
-    ASSERT(databaseFileSize <= diskUsage);
+    // The index catches up with the last transaction in the background, so it may not count all of this database yet.
+    unsigned long long diskUsage = max(indexedUsageForOrigin(origin), databaseFileSize);
 
     if (diskUsage > quota)
         return databaseFileSize;
@@ -579,6 +580,8 @@ void DatabaseTracker::addOpenDatabase(DatabaseBackendBase* database)
 
         LOG(StorageAPI, "Added open Database %s (%p)\n", database->stringIdentifier().ascii().data(), database);
     }
+
+    StorageUsageIndex::index().noteOriginUsed(database->securityOrigin()->databaseIdentifier());
 }
 
 void DatabaseTracker::removeOpenDatabase(DatabaseBackendBase* database)
@@ -705,11 +708,32 @@ unsigned long long DatabaseTracker::usageForOrigin(SecurityOrigin* origin)
     return diskUsage;
 }
 
+unsigned long long DatabaseTracker::indexedUsageForOrigin(SecurityOrigin* origin)
+{
+    unsigned long long usage;
+    if (StorageUsageIndex::index().usage(StorageUsageIndex::Database, origin->databaseIdentifier(), usage))
+        return usage;
+
+    // The index has not measured this origin yet, so measure it once here.
+    usage = usageForOrigin(origin);
+    StorageUsageIndex::index().setUsage(StorageUsageIndex::Database, origin->databaseIdentifier(), usage);
+    return usage;
+}
+
+void DatabaseTracker::scheduleUsageUpdate(SecurityOrigin* origin)
+{
+    StorageUsageIndex::index().scheduleUsageUpdate(StorageUsageIndex::Database, origin->databaseIdentifier(), originPath(origin));
+}
+
 unsigned long long DatabaseTracker::quotaForOriginNoLock(SecurityOrigin* origin)
 {
     ASSERT(!m_databaseGuard.tryLock());
     unsigned long long quota = 0;
 
+    QuotaMap::iterator cachedQuota = m_quotaMap.find(origin->databaseIdentifier());
+    if (cachedQuota != m_quotaMap.end())
+        return cachedQuota->value;
+
     openTrackerDatabase(DontCreateIfDoesNotExist);
     if (!m_database.isOpen())
         return quota;
@@ -724,6 +748,7 @@ unsigned long long DatabaseTracker::quotaForOriginNoLock(SecurityOrigin* origin)
     if (statement.step() == SQLResultRow)
         quota = statement.getColumnInt64(0);
 
+    m_quotaMap.set(origin->databaseIdentifier().isolatedCopy(), quota);
     return quota;
 }
 
@@ -773,6 +798,7 @@ void DatabaseTracker::setQuota(SecurityOrigin* origin, unsigned long long quota)
             LOG_ERROR("Failed to set quota %llu in tracker database for origin %s", quota, origin->databaseIdentifier().ascii().data());
 #endif
     }
+    m_quotaMap.remove(origin->databaseIdentifier());
 
     if (m_client)
         m_client->dispatchDidModifyOrigin(origin);
@@ -852,6 +878,8 @@ bool DatabaseTracker::deleteOrigin(SecurityOrigin* origin)
         MutexLocker lockDatabase(m_databaseGuard);
         deleteOriginLockFor(origin);
         doneDeletingOrigin(origin);
+        m_quotaMap.remove(origin->databaseIdentifier());
+        scheduleUsageUpdate(origin);
 
         SQLiteStatement statement(m_database, "DELETE FROM Databases WHERE origin=?");
         if (statement.prepare() != SQLResultOk) {
@@ -1070,6 +1098,7 @@ bool DatabaseTracker::deleteDatabase(SecurityOrigin* origin, const String& name)
         m_client->dispatchDidModifyDatabase(origin, name);
     }
     doneDeletingDatabase(origin, name);
+    scheduleUsageUpdate(origin);
     
     return true;
 }
@@ -1140,6 +1169,8 @@ static NotificationQueue& notificationQueue()
 
 void DatabaseTracker::scheduleNotifyDatabaseChanged(SecurityOrigin* origin, const String& name)
 {
+    scheduleUsageUpdate(origin);
+
     MutexLocker locker(notificationMutex());
 
     notificationQueue().append(pair<RefPtr<SecurityOrigin>, String>(origin->isolatedCopy(), name.isolatedCopy()));
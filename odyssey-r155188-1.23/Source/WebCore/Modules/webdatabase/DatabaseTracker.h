@@ -61,6 +61,7 @@ public:
     // m_openDatabaseMapGuard before quotaManager if both locks are needed.
     // m_databaseGuard and m_openDatabaseMapGuard currently don't overlap.
     // notificationMutex() is currently independent of the other locks.
+    // The lock of StorageUsageIndex is taken after m_databaseGuard if both locks are needed.
 
     bool canEstablishDatabase(DatabaseBackendContext*, const String& name, unsigned long estimatedSize, DatabaseError&);
     bool retryCanEstablishDatabase(DatabaseBackendContext*, const String& name, unsigned long estimatedSize, DatabaseError&);
@@ -114,6 +115,8 @@ private:
     String fullPathForDatabaseNoLock(SecurityOrigin*, const String& name, bool createIfDoesNotExist);
     bool databaseNamesForOriginNoLock(SecurityOrigin* origin, Vector<String>& resultVector);
     unsigned long long quotaForOriginNoLock(SecurityOrigin* origin);
+    unsigned long long indexedUsageForOrigin(SecurityOrigin*);
+    void scheduleUsageUpdate(SecurityOrigin*);
 
     String trackerDatabasePath() const;
 
@@ -140,7 +143,7 @@ private:
     Mutex m_openDatabaseMapGuard;
     mutable OwnPtr<DatabaseOriginMap> m_openDatabaseMap;
 
-    // This lock protects m_database, m_originLockMap, m_databaseDirectoryPath, m_originsBeingDeleted, m_beingCreated, and m_beingDeleted.
+    // This lock protects m_database, m_quotaMap, m_originLockMap, m_databaseDirectoryPath, m_originsBeingDeleted, m_beingCreated, and m_beingDeleted.
     Mutex m_databaseGuard;
     SQLiteDatabase m_database;
 
@@ -149,6 +152,10 @@ private:
 
     String m_databaseDirectoryPath;
 
+    // Quotas of the origins looked up in m_database, so that checking the quota on every transaction needs no query.
+    typedef HashMap<String, unsigned long long> QuotaMap;
+    QuotaMap m_quotaMap;
+
     DatabaseManagerClient* m_client;
 
     typedef HashMap<String, long> NameCountMap;
@@ -77,8 +77,10 @@
 #include "ElementRuleCollector.cpp"
 #include "InspectorCSSOMWrappers.cpp"
 #include "PageRuleCollector.cpp"
+#include "ParallelRuleMatcher.cpp"
 #include "RuleFeature.cpp"
 #include "RuleSet.cpp"
+#include "SelectorBytecode.cpp"
 #include "SelectorCheckerFastPath.cpp"
 #include "SelectorFilter.cpp"
 #include "StylePropertySet.cpp"
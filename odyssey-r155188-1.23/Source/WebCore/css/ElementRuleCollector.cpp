@@ -42,6 +42,7 @@
 #include "StylePropertySet.h"
 #include "StyledElement.h"
 
+#include <algorithm>
 #include <wtf/TemporaryChange.h>
 
 namespace WebCore {
@@ -342,10 +343,22 @@ void ElementRuleCollector::matchUARules(RuleSet* rules)
     sortAndTransferMatchedRules();
 }
 
-inline bool ElementRuleCollector::ruleMatches(const RuleData& ruleData, const ContainerNode* scope, PseudoId& dynamicPseudo)
+inline bool ElementRuleCollector::ruleMatches(const RuleData& ruleData, const MatchRequest& matchRequest, PseudoId& dynamicPseudo)
 {
     const StyleResolver::State& state = m_state;
 
+    if (ruleData.hasCompiledSelector()) {
+        // Compiled selectors never include pseudo elements.
+        if (m_pseudoStyleRequest.pseudoId != NOPSEUDO)
+            return false;
+        if (ruleData.hasRightmostSelectorMatchingHTMLBasedOnRuleHash() && !ruleData.hasMultipartSelector() && state.element()->isHTMLElement())
+            return true;
+        if (m_precomputedMatches && ruleData.compiledSelectorCanMatchOffMainThread() && m_parallelRuleMatcher->coversRuleSet(matchRequest.ruleSet))
+            return std::binary_search(m_precomputedMatches->begin(), m_precomputedMatches->end(), &ruleData);
+        SelectorBytecode::CheckingContext context(m_mode, SelectorChecker::VisitedMatchEnabled, document().isHTMLDocument());
+        return matchRequest.ruleSet->selectorBytecode().matches(ruleData.compiledSelectorOffset(), state.element(), context);
+    }
+
     if (ruleData.hasFastCheckableSelector()) {
         // We know this selector does not include any pseudo elements.
         if (m_pseudoStyleRequest.pseudoId != NOPSEUDO)
@@ -369,7 +382,7 @@ inline bool ElementRuleCollector::ruleMatches(const RuleData& ruleData, const Co
     SelectorChecker selectorChecker(document(), m_mode);
     SelectorChecker::SelectorCheckingContext context(ruleData.selector(), state.element(), SelectorChecker::VisitedMatchEnabled);
     context.elementStyle = state.style();
-    context.scope = scope;
+    context.scope = matchRequest.scope;
     context.pseudoId = m_pseudoStyleRequest.pseudoId;
     context.scrollbar = m_pseudoStyleRequest.scrollbar;
     context.scrollbarPart = m_pseudoStyleRequest.scrollbarPart;
@@ -408,7 +421,7 @@ void ElementRuleCollector::doCollectMatchingRulesForList(const Vector<RuleData>*
         if (hasInspectorFrontends)
             cookie = InspectorInstrumentation::willMatchRule(&document(), rule, m_inspectorCSSOMWrappers, document().styleSheetCollection());
         PseudoId dynamicPseudo = NOPSEUDO;
-        if (ruleMatches(ruleData, matchRequest.scope, dynamicPseudo)) {
+        if (ruleMatches(ruleData, matchRequest, dynamicPseudo)) {
             // If the rule has no properties to apply, then ignore it in the non-debug mode.
             const StylePropertySet& properties = rule->properties();
             if (properties.isEmpty() && !matchRequest.includeEmptyRules) {
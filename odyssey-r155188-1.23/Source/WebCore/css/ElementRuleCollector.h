@@ -23,6 +23,7 @@
 #define ElementRuleCollector_h
 
 #include "MediaQueryEvaluator.h"
+#include "ParallelRuleMatcher.h"
 #include "SelectorChecker.h"
 #include "StyleResolver.h"
 #include <wtf/RefPtr.h>
@@ -51,6 +52,8 @@ public:
         , m_sameOriginOnly(false)
         , m_mode(SelectorChecker::ResolvingStyle)
         , m_canUseFastReject(m_selectorFilter.parentStackIsConsistent(state.parentNode()))
+        , m_parallelRuleMatcher(styleResolver->parallelRuleMatcher())
+        , m_precomputedMatches(m_parallelRuleMatcher ? m_parallelRuleMatcher->matchedRules(state.element()) : 0)
     {
     }
 
@@ -81,7 +84,7 @@ private:
     void collectMatchingRules(const MatchRequest&, StyleResolver::RuleRange&);
     void collectMatchingRulesForRegion(const MatchRequest&, StyleResolver::RuleRange&);
     void collectMatchingRulesForList(const Vector<RuleData>*, const MatchRequest&, StyleResolver::RuleRange&);
-    bool ruleMatches(const RuleData&, const ContainerNode* scope, PseudoId&);
+    bool ruleMatches(const RuleData&, const MatchRequest&, PseudoId&);
 
     void sortMatchedRules();
     void sortAndTransferMatchedRules();
@@ -105,6 +108,10 @@ private:
     SelectorChecker::Mode m_mode;
     bool m_canUseFastReject;
 
+    const ParallelRuleMatcher* m_parallelRuleMatcher;
+    // Results of the rules ParallelRuleMatcher evaluated ahead of time for this element, if any.
+    const Vector<const RuleData*>* m_precomputedMatches;
+
     OwnPtr<Vector<const RuleData*, 32> > m_matchedRules;
 
     // Output.
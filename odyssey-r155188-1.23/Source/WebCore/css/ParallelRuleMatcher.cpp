@@ -0,0 +1,216 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "ParallelRuleMatcher.h"
+
+#include "CSSDefaultStyleSheets.h"
+#include "Document.h"
+#include "DocumentRuleSets.h"
+#include "Element.h"
+#include "InspectorInstrumentation.h"
+#include "RuleSet.h"
+#include "SelectorFilter.h"
+#include "Settings.h"
+#include "StyleResolver.h"
+#include <algorithm>
+#include <wtf/NumberOfCores.h>
+#include <wtf/ParallelJobs.h>
+
+namespace WebCore {
+
+// Below this many elements per job the thread hand-off costs more than the matching.
+static const size_t minimumElementsPerJob = 256;
+
+ParallelRuleMatcher::CoveredRuleSet::CoveredRuleSet(const RuleSet* ruleSet)
+    : ruleSet(ruleSet)
+    , ruleCount(ruleSet->ruleCount())
+{
+}
+
+ParallelRuleMatcher::ParallelRuleMatcher(StyleResolver& styleResolver)
+    : m_document(styleResolver.document())
+    , m_domTreeVersion(0)
+{
+    addCoveredRuleSet(CSSDefaultStyleSheets::defaultStyle);
+    if (styleResolver.document().inQuirksMode())
+        addCoveredRuleSet(CSSDefaultStyleSheets::defaultQuirksStyle);
+    addCoveredRuleSet(styleResolver.ruleSets().userStyle());
+    addCoveredRuleSet(styleResolver.ruleSets().authorStyle());
+}
+
+bool ParallelRuleMatcher::isEnabled(Document& document)
+{
+    Settings* settings = document.settings();
+    if (!settings || !settings->parallelStyleResolutionEnabled())
+        return false;
+    // The inspector is notified about every rule that is tried, in order.
+    if (InspectorInstrumentation::hasFrontends())
+        return false;
+    return WTF::numberOfProcessorCores() > 1;
+}
+
+void ParallelRuleMatcher::addCoveredRuleSet(const RuleSet* ruleSet)
+{
+    if (ruleSet)
+        m_coveredRuleSets.append(CoveredRuleSet(ruleSet));
+}
+
+bool ParallelRuleMatcher::coversRuleSet(const RuleSet* ruleSet) const
+{
+    for (size_t i = 0; i < m_coveredRuleSets.size(); ++i) {
+        if (m_coveredRuleSets[i].ruleSet == ruleSet)
+            return m_coveredRuleSets[i].ruleCount == ruleSet->ruleCount();
+    }
+    return false;
+}
+
+const Vector<const RuleData*>* ParallelRuleMatcher::matchedRules(const Element* element) const
+{
+    // Inserted, removed or changed elements may match differently than they did ahead of time.
+    if (m_document.domTreeVersion() != m_domTreeVersion)
+        return 0;
+
+    HashMap<const Element*, unsigned>::const_iterator it = m_elementIndices.find(element);
+    if (it == m_elementIndices.end())
+        return 0;
+    return &m_matchedRules[it->value];
+}
+
+// Visits the same elements as Style::resolveTree() would for the given change. Elements whose
+// style turns out to need forced propagation later are simply matched serially.
+void ParallelRuleMatcher::collectElements(Element& current, Style::Change change)
+{
+    // willRecalcStyle() can run arbitrary code and mutate the tree, so keep these subtrees serial.
+    if (current.hasCustomStyleResolveCallbacks())
+        return;
+
+    if (change >= Style::Inherit || current.needsStyleRecalc()) {
+        m_elementIndices.add(&current, m_elements.size());
+        m_elements.append(&current);
+    }
+
+    for (Node* child = current.firstChild(); child; child = child->nextSibling()) {
+        if (!child->isElementNode())
+            continue;
+        Element* childElement = toElement(child);
+        if (change >= Style::Inherit || childElement->childNeedsStyleRecalc() || childElement->needsStyleRecalc())
+            collectElements(*childElement, change);
+    }
+}
+
+bool ParallelRuleMatcher::matchTree(Element& root, Style::Change change)
+{
+    if (m_coveredRuleSets.isEmpty())
+        return false;
+
+    m_domTreeVersion = m_document.domTreeVersion();
+    collectElements(root, change);
+    int requestedJobCount = m_elements.size() / minimumElementsPerJob;
+    if (requestedJobCount < 2)
+        return false;
+
+    ParallelJobs<MatchingJob> parallelJobs(&ParallelRuleMatcher::matchElementsWorker, requestedJobCount);
+    size_t jobCount = parallelJobs.numberOfJobs();
+    if (jobCount < 2)
+        return false;
+
+    m_matchedRules.grow(m_elements.size());
+
+    size_t elementsPerJob = m_elements.size() / jobCount;
+    size_t begin = 0;
+    for (size_t i = 0; i < jobCount; ++i) {
+        MatchingJob& job = parallelJobs.parameter(i);
+        job.matcher = this;
+        job.begin = begin;
+        job.end = i == jobCount - 1 ? m_elements.size() : begin + elementsPerJob;
+        begin = job.end;
+    }
+
+    parallelJobs.execute();
+    return true;
+}
+
+void ParallelRuleMatcher::matchElementsWorker(MatchingJob* job)
+{
+    job->matcher->matchElements(job->begin, job->end);
+}
+
+static inline void collectMatchingRulesForList(const Vector<RuleData>* rules, const SelectorBytecode& bytecode, Element* element, const SelectorFilter* selectorFilter, Vector<const RuleData*>& matchedRules)
+{
+    if (!rules)
+        return;
+
+    // Thread-safe programs never depend on the mode or on attribute case sensitivity.
+    SelectorBytecode::CheckingContext context(SelectorChecker::ResolvingStyle, SelectorChecker::VisitedMatchEnabled, true);
+    for (unsigned i = 0, size = rules->size(); i < size; ++i) {
+        const RuleData& ruleData = rules->data()[i];
+        if (!ruleData.hasCompiledSelector() || !ruleData.compiledSelectorCanMatchOffMainThread())
+            continue;
+        // ElementRuleCollector accepts these from the rule hash alone.
+        if (ruleData.hasRightmostSelectorMatchingHTMLBasedOnRuleHash() && !ruleData.hasMultipartSelector() && element->isHTMLElement())
+            continue;
+        if (selectorFilter && selectorFilter->fastRejectSelector<RuleData::maximumIdentifierCount>(ruleData.descendantSelectorIdentifierHashes()))
+            continue;
+        if (bytecode.matches(ruleData.compiledSelectorOffset(), element, context))
+            matchedRules.append(&ruleData);
+    }
+}
+
+// Runs on a worker thread. Only reads the tree, the rule sets and the selectors, and must not
+// create or ref strings: the string tables and reference counts are not thread-safe.
+void ParallelRuleMatcher::matchElements(size_t begin, size_t end) const
+{
+    SelectorFilter selectorFilter;
+    for (size_t i = begin; i < end; ++i) {
+        Element* element = m_elements[i].get();
+
+        // Elements arrive in document order, so the ancestor stack usually only needs a few pops
+        // and at most one push. Anything else (skipped subtrees) rebuilds it from scratch.
+        const SelectorFilter* fastRejectFilter = 0;
+        if (Element* parent = element->parentElement()) {
+            Element* grandparent = parent->parentElement();
+            while (!selectorFilter.parentStackIsEmpty() && !selectorFilter.parentStackIsConsistent(parent) && !selectorFilter.parentStackIsConsistent(grandparent))
+                selectorFilter.popParentStackFrame();
+            if (selectorFilter.parentStackIsEmpty())
+                selectorFilter.setupParentStack(parent);
+            else if (!selectorFilter.parentStackIsConsistent(parent))
+                selectorFilter.pushParentStackFrame(parent);
+            fastRejectFilter = &selectorFilter;
+        }
+
+        Vector<const RuleData*>& matchedRules = m_matchedRules[i];
+        for (size_t j = 0; j < m_coveredRuleSets.size(); ++j) {
+            const RuleSet* ruleSet = m_coveredRuleSets[j].ruleSet;
+            const SelectorBytecode& bytecode = ruleSet->selectorBytecode();
+            if (element->hasID())
+                collectMatchingRulesForList(ruleSet->idRules(element->idForStyleResolution().impl()), bytecode, element, fastRejectFilter, matchedRules);
+            if (element->hasClass()) {
+                const SpaceSplitString& classNames = element->classNames();
+                for (size_t k = 0; k < classNames.size(); ++k)
+                    collectMatchingRulesForList(ruleSet->classRules(classNames[k].impl()), bytecode, element, fastRejectFilter, matchedRules);
+            }
+            if (element->isLink())
+                collectMatchingRulesForList(ruleSet->linkPseudoClassRules(), bytecode, element, fastRejectFilter, matchedRules);
+            collectMatchingRulesForList(ruleSet->tagRules(element->localName().impl()), bytecode, element, fastRejectFilter, matchedRules);
+            collectMatchingRulesForList(ruleSet->universalRules(), bytecode, element, fastRejectFilter, matchedRules);
+        }
+        std::sort(matchedRules.begin(), matchedRules.end());
+    }
+}
+
+} // namespace WebCore
@@ -0,0 +1,94 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ParallelRuleMatcher_h
+#define ParallelRuleMatcher_h
+
+#include "StyleResolveTree.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class Document;
+class Element;
+class RuleData;
+class RuleSet;
+class StyleResolver;
+
+// Runs the selector matching part of a style recalc ahead of time on worker threads.
+//
+// Before the serial tree walk, the elements it is going to resolve are split into contiguous
+// runs of the document order and handed to WTF::ParallelJobs. Each job has its own
+// SelectorFilter and evaluates the compiled selectors that only read element state
+// (RuleData::compiledSelectorCanMatchOffMainThread()) against the UA, user and author rule sets.
+// The main thread is blocked while the jobs run, so the tree is not mutated underneath them.
+// ElementRuleCollector then answers those rules from the precomputed results and keeps
+// matching everything else (sibling-dependent selectors, attribute and dynamic pseudo-class
+// selectors, scoped and region rules) serially, building and committing RenderStyles itself.
+// The matched elements are kept alive until the walk is over. Once the tree is mutated or
+// rules are added, the precomputed results are no longer used.
+class ParallelRuleMatcher {
+    WTF_MAKE_NONCOPYABLE(ParallelRuleMatcher); WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit ParallelRuleMatcher(StyleResolver&);
+
+    static bool isEnabled(Document&);
+
+    // Returns false when there is too little work to split or the tree needs serial resolution.
+    bool matchTree(Element& root, Style::Change);
+
+    bool coversRuleSet(const RuleSet*) const;
+    // Sorted by address, so callers can binary search. Null if the element was not matched ahead
+    // or the tree has been mutated since.
+    const Vector<const RuleData*>* matchedRules(const Element*) const;
+
+private:
+    struct CoveredRuleSet {
+        CoveredRuleSet() : ruleSet(0), ruleCount(0) { }
+        CoveredRuleSet(const RuleSet*);
+
+        const RuleSet* ruleSet;
+        // Rules added during the recalc (lazily loaded UA sheets) invalidate the precomputed results.
+        unsigned ruleCount;
+    };
+
+    struct MatchingJob {
+        const ParallelRuleMatcher* matcher;
+        size_t begin;
+        size_t end;
+    };
+
+    void collectElements(Element&, Style::Change);
+    void addCoveredRuleSet(const RuleSet*);
+    static void matchElementsWorker(MatchingJob*);
+    void matchElements(size_t begin, size_t end) const;
+
+    Document& m_document;
+    uint64_t m_domTreeVersion;
+    Vector<CoveredRuleSet, 4> m_coveredRuleSets;
+    Vector<RefPtr<Element> > m_elements;
+    // Written by the jobs, each to its own range of elements.
+    mutable Vector<Vector<const RuleData*> > m_matchedRules;
+    HashMap<const Element*, unsigned> m_elementIndices;
+};
+
+} // namespace WebCore
+
+#endif // ParallelRuleMatcher_h
@@ -30,9 +30,160 @@
 #include "RuleFeature.h"
 
 #include "CSSSelector.h"
+#include "CSSSelectorList.h"
+#include "Element.h"
 
 namespace WebCore {
 
+static void addToSet(HashSet<AtomicStringImpl*>& set, const HashSet<AtomicStringImpl*>& other)
+{
+    HashSet<AtomicStringImpl*>::const_iterator end = other.end();
+    for (HashSet<AtomicStringImpl*>::const_iterator it = other.begin(); it != end; ++it)
+        set.add(*it);
+}
+
+void DescendantInvalidationSet::combine(const DescendantInvalidationSet& other)
+{
+    addToSet(m_ids, other.m_ids);
+    addToSet(m_classes, other.m_classes);
+    addToSet(m_tagNames, other.m_tagNames);
+    addToSet(m_attributes, other.m_attributes);
+    m_wholeSubtreeInvalid = m_wholeSubtreeInvalid || other.m_wholeSubtreeInvalid;
+    m_affectsSiblings = m_affectsSiblings || other.m_affectsSiblings;
+}
+
+bool DescendantInvalidationSet::invalidatesElement(const Element* element) const
+{
+    if (m_wholeSubtreeInvalid)
+        return true;
+    if (!m_tagNames.isEmpty() && m_tagNames.contains(element->localName().impl()))
+        return true;
+    if (!m_ids.isEmpty() && element->hasID() && m_ids.contains(element->idForStyleResolution().impl()))
+        return true;
+    if (!m_classes.isEmpty() && element->hasClass()) {
+        const SpaceSplitString& classNames = element->classNames();
+        for (size_t i = 0; i < classNames.size(); ++i) {
+            if (m_classes.contains(classNames[i].impl()))
+                return true;
+        }
+    }
+    if (!m_attributes.isEmpty() && element->hasAttributesWithoutUpdate()) {
+        for (unsigned i = 0, count = element->attributeCount(); i < count; ++i) {
+            if (m_attributes.contains(element->attributeAt(i).localName().impl()))
+                return true;
+        }
+    }
+    return false;
+}
+
+static DescendantInvalidationSet& ensureInvalidationSet(RuleFeatureSet::InvalidationSetMap& map, AtomicStringImpl* key)
+{
+    OwnPtr<DescendantInvalidationSet>& set = map.add(key, nullptr).iterator->value;
+    if (!set)
+        set = adoptPtr(new DescendantInvalidationSet);
+    return *set;
+}
+
+// Describes the elements matched by the rightmost compound selector of a selector.
+struct InvalidationTarget {
+    InvalidationTarget()
+        : id(0)
+        , className(0)
+        , tagName(0)
+        , attributeName(0)
+        , unknown(false)
+    { }
+
+    void addTo(DescendantInvalidationSet& set) const
+    {
+        // Every simple selector of the compound has to match, so one of them identifies the elements.
+        if (unknown)
+            set.setWholeSubtreeInvalid();
+        else if (id)
+            set.addId(id);
+        else if (className)
+            set.addClass(className);
+        else if (tagName)
+            set.addTagName(tagName);
+        else if (attributeName)
+            set.addAttribute(attributeName);
+        else
+            set.setWholeSubtreeInvalid();
+    }
+
+    AtomicStringImpl* id;
+    AtomicStringImpl* className;
+    AtomicStringImpl* tagName;
+    AtomicStringImpl* attributeName;
+    bool unknown;
+};
+
+static void addInvalidationFeature(RuleFeatureSet& features, const CSSSelector* selector, const InvalidationTarget& target, bool affectsSiblings)
+{
+    DescendantInvalidationSet* set;
+    if (selector->m_match == CSSSelector::Id)
+        set = &ensureInvalidationSet(features.idInvalidationSets, selector->value().impl());
+    else if (selector->m_match == CSSSelector::Class)
+        set = &ensureInvalidationSet(features.classInvalidationSets, selector->value().impl());
+    else if (selector->isAttributeSelector())
+        set = &ensureInvalidationSet(features.attributeInvalidationSets, selector->attribute().localName().impl());
+    else
+        return;
+
+    if (affectsSiblings)
+        set->setAffectsSiblings();
+    else
+        target.addTo(*set);
+}
+
+void RuleFeatureSet::collectInvalidationSetsFromSelector(const CSSSelector* selector)
+{
+    InvalidationTarget target;
+    for (; selector; selector = selector->tagHistory()) {
+        if (selector->m_match == CSSSelector::Id)
+            target.id = selector->value().impl();
+        else if (selector->m_match == CSSSelector::Class)
+            target.className = selector->value().impl();
+        else if (selector->m_match == CSSSelector::Tag) {
+            if (selector->tagQName().localName() != starAtom)
+                target.tagName = selector->tagQName().localName().impl();
+        } else if (selector->isAttributeSelector())
+            target.attributeName = selector->attribute().localName().impl();
+        else if (selector->m_match == CSSSelector::PseudoElement)
+            target.unknown = true;
+        if (selector->relation() != CSSSelector::SubSelector)
+            break;
+    }
+    if (!selector)
+        return;
+
+    bool affectsSiblings = false;
+    for (; selector->tagHistory(); selector = selector->tagHistory()) {
+        switch (selector->relation()) {
+        case CSSSelector::SubSelector:
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            break;
+        case CSSSelector::DirectAdjacent:
+        case CSSSelector::IndirectAdjacent:
+            affectsSiblings = true;
+            break;
+        case CSSSelector::ShadowDescendant:
+            target.unknown = true;
+            break;
+        }
+
+        const CSSSelector* component = selector->tagHistory();
+        addInvalidationFeature(*this, component, target, affectsSiblings);
+        if (const CSSSelectorList* selectorList = component->selectorList()) {
+            for (const CSSSelector* subSelector = selectorList->first(); subSelector; subSelector = CSSSelectorList::next(subSelector)) {
+                for (const CSSSelector* subComponent = subSelector; subComponent; subComponent = subComponent->tagHistory())
+                    addInvalidationFeature(*this, subComponent, target, affectsSiblings);
+            }
+        }
+    }
+}
+
 void RuleFeatureSet::collectFeaturesFromSelector(const CSSSelector* selector)
 {
     if (selector->m_match == CSSSelector::Id)
@@ -54,6 +205,13 @@ void RuleFeatureSet::collectFeaturesFromSelector(const CSSSelector* selector)
     }
 }
 
+static void addInvalidationSets(RuleFeatureSet::InvalidationSetMap& map, const RuleFeatureSet::InvalidationSetMap& other)
+{
+    RuleFeatureSet::InvalidationSetMap::const_iterator end = other.end();
+    for (RuleFeatureSet::InvalidationSetMap::const_iterator it = other.begin(); it != end; ++it)
+        ensureInvalidationSet(map, it->key).combine(*it->value);
+}
+
 void RuleFeatureSet::add(const RuleFeatureSet& other)
 {
     HashSet<AtomicStringImpl*>::const_iterator end = other.idsInRules.end();
@@ -65,6 +223,9 @@ void RuleFeatureSet::add(const RuleFeatureSet& other)
     end = other.attrsInRules.end();
     for (HashSet<AtomicStringImpl*>::const_iterator it = other.attrsInRules.begin(); it != end; ++it)
         attrsInRules.add(*it);
+    addInvalidationSets(idInvalidationSets, other.idInvalidationSets);
+    addInvalidationSets(classInvalidationSets, other.classInvalidationSets);
+    addInvalidationSets(attributeInvalidationSets, other.attributeInvalidationSets);
     siblingRules.appendVector(other.siblingRules);
     uncommonAttributeRules.appendVector(other.uncommonAttributeRules);
     usesFirstLineRules = usesFirstLineRules || other.usesFirstLineRules;
@@ -76,6 +237,9 @@ void RuleFeatureSet::clear()
     idsInRules.clear();
     classesInRules.clear();
     attrsInRules.clear();
+    idInvalidationSets.clear();
+    classInvalidationSets.clear();
+    attributeInvalidationSets.clear();
     siblingRules.clear();
     uncommonAttributeRules.clear();
     usesFirstLineRules = false;
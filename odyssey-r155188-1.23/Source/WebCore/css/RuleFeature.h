@@ -25,12 +25,49 @@
 #include <wtf/Forward.h>
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/text/AtomicString.h>
 
 namespace WebCore {
 
 class StyleRule;
 class CSSSelector;
+class Element;
+
+// The elements that a change of one id, class or attribute can restyle besides the element
+// itself, collected from the selectors the feature appears in left of a combinator. Descendants
+// are identified by the id, class, tag name or attribute of the rightmost compound selector.
+// Sets that can't be described this way fall back to restyling the whole subtree.
+class DescendantInvalidationSet {
+    WTF_MAKE_NONCOPYABLE(DescendantInvalidationSet); WTF_MAKE_FAST_ALLOCATED;
+public:
+    DescendantInvalidationSet()
+        : m_wholeSubtreeInvalid(false)
+        , m_affectsSiblings(false)
+    { }
+
+    void combine(const DescendantInvalidationSet&);
+
+    void addId(AtomicStringImpl* id) { m_ids.add(id); }
+    void addClass(AtomicStringImpl* className) { m_classes.add(className); }
+    void addTagName(AtomicStringImpl* tagName) { m_tagNames.add(tagName); }
+    void addAttribute(AtomicStringImpl* attributeName) { m_attributes.add(attributeName); }
+    void setWholeSubtreeInvalid() { m_wholeSubtreeInvalid = true; }
+    void setAffectsSiblings() { m_affectsSiblings = true; }
+
+    bool wholeSubtreeInvalid() const { return m_wholeSubtreeInvalid; }
+    // Sibling selectors are left to the FullStyleChange handling in Style::resolveTree().
+    bool affectsSiblings() const { return m_affectsSiblings; }
+    bool invalidatesElement(const Element*) const;
+
+private:
+    HashSet<AtomicStringImpl*> m_ids;
+    HashSet<AtomicStringImpl*> m_classes;
+    HashSet<AtomicStringImpl*> m_tagNames;
+    HashSet<AtomicStringImpl*> m_attributes;
+    bool m_wholeSubtreeInvalid;
+    bool m_affectsSiblings;
+};
 
 struct RuleFeature {
     RuleFeature(StyleRule* rule, unsigned selectorIndex, bool hasDocumentSecurityOrigin)
@@ -54,10 +91,22 @@ struct RuleFeatureSet {
     void clear();
 
     void collectFeaturesFromSelector(const CSSSelector*);
+    // Takes a complete selector, not a component of one.
+    void collectInvalidationSetsFromSelector(const CSSSelector*);
+
+    // Null if a change of the feature can only affect the element having it.
+    const DescendantInvalidationSet* idInvalidationSet(AtomicStringImpl* id) const { return idInvalidationSets.get(id); }
+    const DescendantInvalidationSet* classInvalidationSet(AtomicStringImpl* className) const { return classInvalidationSets.get(className); }
+    const DescendantInvalidationSet* attributeInvalidationSet(AtomicStringImpl* attributeName) const { return attributeInvalidationSets.get(attributeName); }
+
+    typedef HashMap<AtomicStringImpl*, OwnPtr<DescendantInvalidationSet> > InvalidationSetMap;
 
     HashSet<AtomicStringImpl*> idsInRules;
     HashSet<AtomicStringImpl*> classesInRules;
     HashSet<AtomicStringImpl*> attrsInRules;
+    InvalidationSetMap idInvalidationSets;
+    InvalidationSetMap classInvalidationSets;
+    InvalidationSetMap attributeInvalidationSets;
     Vector<RuleFeature> siblingRules;
     Vector<RuleFeature> uncommonAttributeRules;
     bool usesFirstLineRules;
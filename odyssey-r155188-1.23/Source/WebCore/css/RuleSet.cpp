@@ -140,12 +140,53 @@ RuleData::RuleData(StyleRule* rule, unsigned selectorIndex, unsigned position, A
     , m_linkMatchType(SelectorChecker::determineLinkMatchType(selector()))
     , m_hasDocumentSecurityOrigin(addRuleFlags & RuleHasDocumentSecurityOrigin)
     , m_propertyWhitelistType(determinePropertyWhitelistType(addRuleFlags, selector()))
+    , m_compiledSelectorOffset(SelectorBytecode::invalidOffset)
+    , m_compiledSelectorCanMatchOffMainThread(false)
 {
     ASSERT(m_position == position);
     ASSERT(m_selectorIndex == selectorIndex);
     SelectorFilter::collectIdentifierHashes(selector(), m_descendantSelectorIdentifierHashes, maximumIdentifierCount);
 }
 
+RuleData::RuleData(const RuleData& other, unsigned position, bool hasDocumentSecurityOrigin, unsigned compiledSelectorOffset)
+    : m_rule(other.m_rule)
+    , m_selectorIndex(other.m_selectorIndex)
+    , m_position(position)
+    , m_hasFastCheckableSelector(other.m_hasFastCheckableSelector)
+    , m_specificity(other.m_specificity)
+    , m_hasMultipartSelector(other.m_hasMultipartSelector)
+    , m_hasRightmostSelectorMatchingHTMLBasedOnRuleHash(other.m_hasRightmostSelectorMatchingHTMLBasedOnRuleHash)
+    , m_containsUncommonAttributeSelector(other.m_containsUncommonAttributeSelector)
+    , m_linkMatchType(other.m_linkMatchType)
+    , m_hasDocumentSecurityOrigin(hasDocumentSecurityOrigin)
+    , m_propertyWhitelistType(other.m_propertyWhitelistType)
+    , m_compiledSelectorOffset(compiledSelectorOffset)
+    , m_compiledSelectorCanMatchOffMainThread(other.m_compiledSelectorCanMatchOffMainThread)
+{
+    ASSERT(m_position == position);
+    ASSERT(m_compiledSelectorOffset == compiledSelectorOffset);
+    memcpy(m_descendantSelectorIdentifierHashes, other.m_descendantSelectorIdentifierHashes, sizeof(m_descendantSelectorIdentifierHashes));
+}
+
+SharedStyleRules::SharedStyleRules(const StyleSheetContents& sheet)
+{
+    const Vector<RefPtr<StyleRuleBase> >& childRules = sheet.childRules();
+    for (unsigned i = 0; i < childRules.size(); ++i) {
+        if (!childRules[i]->isStyleRule())
+            continue;
+        StyleRule* rule = static_cast<StyleRule*>(childRules[i].get());
+        for (size_t selectorIndex = 0; selectorIndex != notFound; selectorIndex = rule->selectorList().indexOfNextSelectorAfter(selectorIndex)) {
+            RuleData ruleData(rule, selectorIndex, m_rules.size(), RuleCanUseFastCheckSelector);
+            unsigned offset = m_selectorBytecode.compile(ruleData.selector());
+            if (offset != SelectorBytecode::invalidOffset)
+                ruleData.setCompiledSelector(offset, SelectorBytecode::canMatchOffMainThread(ruleData.selector()));
+            m_rules.append(ruleData);
+        }
+    }
+    m_rules.shrinkToFit();
+    m_selectorBytecode.shrinkToFit();
+}
+
 static void collectFeaturesFromRuleData(RuleFeatureSet& features, const RuleData& ruleData)
 {
     bool foundSiblingSelector = false;
@@ -161,6 +202,7 @@ static void collectFeaturesFromRuleData(RuleFeatureSet& features, const RuleData
         } else if (!foundSiblingSelector && selector->isSiblingSelector())
             foundSiblingSelector = true;
     }
+    features.collectInvalidationSetsFromSelector(ruleData.selector());
     if (foundSiblingSelector)
         features.siblingRules.append(RuleFeature(ruleData.rule(), ruleData.selectorIndex(), ruleData.hasDocumentSecurityOrigin()));
     if (ruleData.containsUncommonAttributeSelector())
@@ -235,12 +277,34 @@ void RuleSet::addRule(StyleRule* rule, unsigned selectorIndex, AddRuleFlags addR
     RuleData ruleData(rule, selectorIndex, m_ruleCount++, addRuleFlags);
     collectFeaturesFromRuleData(m_features, ruleData);
 
+    // Scoped rules need the boundary checks of SelectorChecker, like the fast path.
+    if (addRuleFlags & RuleCanUseFastCheckSelector) {
+        unsigned offset = m_selectorBytecode.compile(ruleData.selector());
+        if (offset != SelectorBytecode::invalidOffset)
+            ruleData.setCompiledSelector(offset, SelectorBytecode::canMatchOffMainThread(ruleData.selector()));
+    }
+
     if (!findBestRuleSetAndAdd(ruleData.selector(), ruleData)) {
         // If we didn't find a specialized map to stick it in, file under universal rules.
         m_universalRules.append(ruleData);
     }
 }
 
+unsigned RuleSet::addSharedStyleRule(const SharedStyleRules& sharedRules, unsigned sharedRuleIndex, unsigned sharedBytecodeOffset, StyleRule* rule, bool hasDocumentSecurityOrigin)
+{
+    const Vector<RuleData>& rules = sharedRules.rules();
+    for (; sharedRuleIndex < rules.size() && rules[sharedRuleIndex].rule() == rule; ++sharedRuleIndex) {
+        const RuleData& sharedRuleData = rules[sharedRuleIndex];
+        unsigned compiledSelectorOffset = sharedRuleData.hasCompiledSelector() ? sharedBytecodeOffset + sharedRuleData.compiledSelectorOffset() : SelectorBytecode::invalidOffset;
+        RuleData ruleData(sharedRuleData, m_ruleCount++, hasDocumentSecurityOrigin, compiledSelectorOffset);
+        collectFeaturesFromRuleData(m_features, ruleData);
+
+        if (!findBestRuleSetAndAdd(ruleData.selector(), ruleData))
+            m_universalRules.append(ruleData);
+    }
+    return sharedRuleIndex;
+}
+
 void RuleSet::addPageRule(StyleRulePage* rule)
 {
     m_pageRules.append(rule);
@@ -270,14 +334,21 @@ void RuleSet::addRegionRule(StyleRuleRegion* regionRule, bool hasDocumentSecurit
     m_regionSelectorsAndRuleSets.append(RuleSetSelectorPair(regionRule->selectorList().first(), regionRuleSet.release()));
 }
 
-void RuleSet::addChildRules(const Vector<RefPtr<StyleRuleBase> >& rules, const MediaQueryEvaluator& medium, StyleResolver* resolver, const ContainerNode* scope, bool hasDocumentSecurityOrigin, AddRuleFlags addRuleFlags)
+void RuleSet::addChildRules(const Vector<RefPtr<StyleRuleBase> >& rules, const MediaQueryEvaluator& medium, StyleResolver* resolver, const ContainerNode* scope, bool hasDocumentSecurityOrigin, AddRuleFlags addRuleFlags, const SharedStyleRules* sharedRules)
 {
+    // Shared rules cover the top level style rules only; the programs of all of them are appended at once.
+    unsigned sharedRuleIndex = 0;
+    unsigned sharedBytecodeOffset = sharedRules ? m_selectorBytecode.append(sharedRules->selectorBytecode()) : 0;
+
     for (unsigned i = 0; i < rules.size(); ++i) {
         StyleRuleBase* rule = rules[i].get();
 
         if (rule->isStyleRule()) {
             StyleRule* styleRule = static_cast<StyleRule*>(rule);
-            addStyleRule(styleRule, addRuleFlags);
+            if (sharedRules)
+                sharedRuleIndex = addSharedStyleRule(*sharedRules, sharedRuleIndex, sharedBytecodeOffset, styleRule, hasDocumentSecurityOrigin);
+            else
+                addStyleRule(styleRule, addRuleFlags);
         } else if (rule->isPageRule())
             addPageRule(static_cast<StyleRulePage*>(rule));
         else if (rule->isMediaRule()) {
@@ -339,7 +410,9 @@ void RuleSet::addRulesFromSheet(StyleSheetContents* sheet, const MediaQueryEvalu
     bool hasDocumentSecurityOrigin = resolver && resolver->document().securityOrigin()->canRequest(sheet->baseURL());
     AddRuleFlags addRuleFlags = static_cast<AddRuleFlags>((hasDocumentSecurityOrigin ? RuleHasDocumentSecurityOrigin : 0) | (!scope ? RuleCanUseFastCheckSelector : 0));
 
-    addChildRules(sheet->childRules(), medium, resolver, scope, hasDocumentSecurityOrigin, addRuleFlags);
+    // Unscoped rules of an immutable sheet are analyzed once per sheet instead of once per document.
+    const SharedStyleRules* sharedRules = resolver && !scope && sheet->isCacheable() ? sheet->ensureSharedStyleRules() : 0;
+    addChildRules(sheet->childRules(), medium, resolver, scope, hasDocumentSecurityOrigin, addRuleFlags, sharedRules);
 
     if (m_autoShrinkToFitEnabled)
         shrinkToFit();
@@ -371,6 +444,7 @@ void RuleSet::shrinkToFit()
     m_focusPseudoClassRules.shrinkToFit();
     m_universalRules.shrinkToFit();
     m_pageRules.shrinkToFit();
+    m_selectorBytecode.shrinkToFit();
 }
 
 } // namespace WebCore
@@ -23,6 +23,7 @@
 #define RuleSet_h
 
 #include "RuleFeature.h"
+#include "SelectorBytecode.h"
 #include "StyleRule.h"
 #include <wtf/Forward.h>
 #include <wtf/HashMap.h>
@@ -49,6 +50,7 @@ enum PropertyWhitelistType {
 class CSSSelector;
 class ContainerNode;
 class MediaQueryEvaluator;
+class SharedStyleRules;
 class StyleResolver;
 class StyleRuleRegion;
 class StyleSheetContents;
@@ -58,6 +60,8 @@ public:
     static const unsigned maximumSelectorComponentCount = 8192;
 
     RuleData(StyleRule*, unsigned selectorIndex, unsigned position, AddRuleFlags);
+    // Copies an already analyzed rule into another RuleSet.
+    RuleData(const RuleData&, unsigned position, bool hasDocumentSecurityOrigin, unsigned compiledSelectorOffset);
 
     unsigned position() const { return m_position; }
     StyleRule* rule() const { return m_rule; }
@@ -65,6 +69,15 @@ public:
     unsigned selectorIndex() const { return m_selectorIndex; }
 
     bool hasFastCheckableSelector() const { return m_hasFastCheckableSelector; }
+    bool hasCompiledSelector() const { return m_compiledSelectorOffset != SelectorBytecode::invalidOffset; }
+    unsigned compiledSelectorOffset() const { return m_compiledSelectorOffset; }
+    bool compiledSelectorCanMatchOffMainThread() const { return m_compiledSelectorCanMatchOffMainThread; }
+    void setCompiledSelector(unsigned offset, bool canMatchOffMainThread)
+    {
+        m_compiledSelectorOffset = offset;
+        m_compiledSelectorCanMatchOffMainThread = canMatchOffMainThread;
+        ASSERT(m_compiledSelectorOffset == offset);
+    }
     bool hasMultipartSelector() const { return m_hasMultipartSelector; }
     bool hasRightmostSelectorMatchingHTMLBasedOnRuleHash() const { return m_hasRightmostSelectorMatchingHTMLBasedOnRuleHash; }
     bool containsUncommonAttributeSelector() const { return m_containsUncommonAttributeSelector; }
@@ -90,6 +103,9 @@ private:
     unsigned m_linkMatchType : 2; //  SelectorChecker::LinkMatchMask
     unsigned m_hasDocumentSecurityOrigin : 1;
     unsigned m_propertyWhitelistType : 2;
+    // Offset of the selector program in the owning RuleSet's SelectorBytecode.
+    unsigned m_compiledSelectorOffset : 31;
+    unsigned m_compiledSelectorCanMatchOffMainThread : 1;
     // Use plain array instead of a Vector to minimize memory overhead.
     unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
 };
@@ -98,11 +114,33 @@ struct SameSizeAsRuleData {
     void* a;
     unsigned b;
     unsigned c;
-    unsigned d[4];
+    unsigned d;
+    unsigned e[4];
 };
 
 COMPILE_ASSERT(sizeof(RuleData) == sizeof(SameSizeAsRuleData), RuleData_should_stay_small);
 
+// The top level style rules of an immutable StyleSheetContents, analyzed and compiled once.
+// Every RuleSet built from the sheet afterwards copies these instead of redoing the selector
+// analysis, so documents sharing the contents (through the memory cache or the inline style
+// sheet cache) share the work too. Owned by the StyleSheetContents and dropped when it is
+// made mutable.
+class SharedStyleRules {
+    WTF_MAKE_NONCOPYABLE(SharedStyleRules); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<SharedStyleRules> create(const StyleSheetContents& sheet) { return adoptPtr(new SharedStyleRules(sheet)); }
+
+    // In source order, without a document security origin.
+    const Vector<RuleData>& rules() const { return m_rules; }
+    const SelectorBytecode& selectorBytecode() const { return m_selectorBytecode; }
+
+private:
+    explicit SharedStyleRules(const StyleSheetContents&);
+
+    Vector<RuleData> m_rules;
+    SelectorBytecode m_selectorBytecode;
+};
+
 class RuleSet {
     WTF_MAKE_NONCOPYABLE(RuleSet); WTF_MAKE_FAST_ALLOCATED;
 public:
@@ -129,6 +167,7 @@ public:
     void disableAutoShrinkToFit() { m_autoShrinkToFitEnabled = false; }
 
     const RuleFeatureSet& features() const { return m_features; }
+    const SelectorBytecode& selectorBytecode() const { return m_selectorBytecode; }
 
     const Vector<RuleData>* idRules(AtomicStringImpl* key) const { return m_idRules.get(key); }
     const Vector<RuleData>* classRules(AtomicStringImpl* key) const { return m_classRules.get(key); }
@@ -146,7 +185,8 @@ public:
     unsigned ruleCount() const { return m_ruleCount; }
 
 private:
-    void addChildRules(const Vector<RefPtr<StyleRuleBase> >&, const MediaQueryEvaluator& medium, StyleResolver*, const ContainerNode* scope, bool hasDocumentSecurityOrigin, AddRuleFlags);
+    void addChildRules(const Vector<RefPtr<StyleRuleBase> >&, const MediaQueryEvaluator& medium, StyleResolver*, const ContainerNode* scope, bool hasDocumentSecurityOrigin, AddRuleFlags, const SharedStyleRules* = 0);
+    unsigned addSharedStyleRule(const SharedStyleRules&, unsigned sharedRuleIndex, unsigned sharedBytecodeOffset, StyleRule*, bool hasDocumentSecurityOrigin);
     bool findBestRuleSetAndAdd(const CSSSelector*, RuleData&);
 
     RuleSet();
@@ -165,6 +205,7 @@ private:
     unsigned m_ruleCount;
     bool m_autoShrinkToFitEnabled;
     RuleFeatureSet m_features;
+    SelectorBytecode m_selectorBytecode;
     Vector<RuleSetSelectorPair> m_regionSelectorsAndRuleSets;
 };
 
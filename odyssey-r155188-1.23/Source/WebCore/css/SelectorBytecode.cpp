@@ -0,0 +1,253 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "SelectorBytecode.h"
+
+#include "CSSSelector.h"
+#include "Element.h"
+#include "HTMLDocument.h"
+
+namespace WebCore {
+
+static inline bool isCompilableRelation(CSSSelector::Relation relation)
+{
+    switch (relation) {
+    case CSSSelector::Descendant:
+    case CSSSelector::Child:
+    case CSSSelector::DirectAdjacent:
+    case CSSSelector::IndirectAdjacent:
+    case CSSSelector::SubSelector:
+        return true;
+    case CSSSelector::ShadowDescendant:
+        return false;
+    }
+    return false;
+}
+
+static inline bool isCompilableSimpleSelector(const CSSSelector* selector, bool inRightmostCompound)
+{
+    switch (selector->m_match) {
+    case CSSSelector::Tag:
+    case CSSSelector::Id:
+    case CSSSelector::Class:
+        return true;
+    case CSSSelector::PseudoClass:
+        // :visited matching is only enabled for the compound that matches the element itself.
+        return inRightmostCompound && SelectorChecker::isCommonPseudoClassSelector(selector);
+    default:
+        return selector->isAttributeSelector();
+    }
+}
+
+bool SelectorBytecode::canCompile(const CSSSelector* selector)
+{
+    bool inRightmostCompound = true;
+    for (; selector; selector = selector->tagHistory()) {
+        if (!isCompilableRelation(selector->relation()))
+            return false;
+        if (!isCompilableSimpleSelector(selector, inRightmostCompound))
+            return false;
+        if (selector->relation() != CSSSelector::SubSelector)
+            inRightmostCompound = false;
+    }
+    return true;
+}
+
+bool SelectorBytecode::canMatchOffMainThread(const CSSSelector* selector)
+{
+    ASSERT(canCompile(selector));
+    for (; selector; selector = selector->tagHistory()) {
+        // Sibling combinators update style flags on the parent, attribute matching can synchronize
+        // lazy attributes and :focus consults the inspector.
+        CSSSelector::Relation relation = selector->relation();
+        if (selector->tagHistory() && relation != CSSSelector::Descendant && relation != CSSSelector::Child && relation != CSSSelector::SubSelector)
+            return false;
+        switch (selector->m_match) {
+        case CSSSelector::Tag:
+        case CSSSelector::Id:
+        case CSSSelector::Class:
+            break;
+        case CSSSelector::PseudoClass:
+            if (selector->pseudoType() == CSSSelector::PseudoFocus)
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+void SelectorBytecode::appendSimpleSelector(const CSSSelector* selector)
+{
+    switch (selector->m_match) {
+    case CSSSelector::Tag:
+        if (selector->tagQName() != anyQName())
+            m_instructions.append(Instruction(MatchTag, selector));
+        return;
+    case CSSSelector::Id:
+        m_instructions.append(Instruction(MatchId, selector, selector->value().impl()));
+        return;
+    case CSSSelector::Class:
+        m_instructions.append(Instruction(MatchClass, selector, selector->value().impl()));
+        return;
+    case CSSSelector::PseudoClass:
+        switch (selector->pseudoType()) {
+        case CSSSelector::PseudoLink:
+        case CSSSelector::PseudoAnyLink:
+            m_instructions.append(Instruction(MatchLink, selector));
+            return;
+        case CSSSelector::PseudoVisited:
+            m_instructions.append(Instruction(MatchVisited, selector));
+            return;
+        case CSSSelector::PseudoFocus:
+            m_instructions.append(Instruction(MatchFocus, selector));
+            return;
+        default:
+            ASSERT_NOT_REACHED();
+            return;
+        }
+    default:
+        ASSERT(selector->isAttributeSelector());
+        m_instructions.append(Instruction(MatchAttribute, selector, 0, HTMLDocument::isCaseSensitiveAttribute(selector->attribute())));
+        return;
+    }
+}
+
+unsigned SelectorBytecode::compile(const CSSSelector* selector)
+{
+    if (!canCompile(selector))
+        return invalidOffset;
+
+    unsigned offset = m_instructions.size();
+    for (; selector; selector = selector->tagHistory()) {
+        appendSimpleSelector(selector);
+        if (!selector->tagHistory())
+            break;
+        switch (selector->relation()) {
+        case CSSSelector::SubSelector:
+            break;
+        case CSSSelector::Descendant:
+            m_instructions.append(Instruction(Descendant));
+            break;
+        case CSSSelector::Child:
+            m_instructions.append(Instruction(Child));
+            break;
+        case CSSSelector::DirectAdjacent:
+            m_instructions.append(Instruction(DirectAdjacent));
+            break;
+        case CSSSelector::IndirectAdjacent:
+            m_instructions.append(Instruction(IndirectAdjacent));
+            break;
+        case CSSSelector::ShadowDescendant:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+    m_instructions.append(Instruction(Accept));
+    return offset;
+}
+
+unsigned SelectorBytecode::append(const SelectorBytecode& other)
+{
+    // Programs contain no offsets, so they can be moved as is.
+    unsigned offset = m_instructions.size();
+    m_instructions.appendVector(other.m_instructions);
+    return offset;
+}
+
+// Mirrors the combinator handling of SelectorChecker::match(), including its failure
+// classification, so backtracking is pruned exactly as on the slow path. Combinators that
+// do not backtrack (child, direct adjacent) continue in place instead of recursing.
+SelectorChecker::Match SelectorBytecode::matchFrom(const Instruction* instruction, Element* element, const CheckingContext& context) const
+{
+    for (;; ++instruction) {
+        switch (static_cast<Opcode>(instruction->opcode)) {
+        case MatchTag:
+            if (!SelectorChecker::tagMatches(element, instruction->selector->tagQName()))
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchId:
+            if (!element->hasID() || element->idForStyleResolution().impl() != instruction->value)
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchClass:
+            if (!element->hasClass() || !element->classNames().contains(instruction->selector->value()))
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchAttribute:
+            if (!SelectorChecker::attributeSelectorMatches(element, instruction->selector, !context.documentIsHTML || instruction->caseSensitive))
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchLink:
+            if (!element->isLink())
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchVisited:
+            if (!element->isLink() || context.visitedMatchType != SelectorChecker::VisitedMatchEnabled)
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case MatchFocus:
+            if (!SelectorChecker::matchesFocusPseudoClass(element))
+                return SelectorChecker::SelectorFailsLocally;
+            break;
+        case Descendant:
+            for (Element* ancestor = element->parentElement(); ancestor; ancestor = ancestor->parentElement()) {
+                SelectorChecker::Match match = matchFrom(instruction + 1, ancestor, context);
+                if (match == SelectorChecker::SelectorMatches || match == SelectorChecker::SelectorFailsCompletely)
+                    return match;
+            }
+            return SelectorChecker::SelectorFailsCompletely;
+        case Child:
+            element = element->parentElement();
+            if (!element)
+                return SelectorChecker::SelectorFailsCompletely;
+            break;
+        case DirectAdjacent:
+            if (context.mode == SelectorChecker::ResolvingStyle) {
+                if (Element* parentElement = element->parentElement())
+                    parentElement->setChildrenAffectedByDirectAdjacentRules();
+            }
+            element = element->previousElementSibling();
+            if (!element)
+                return SelectorChecker::SelectorFailsAllSiblings;
+            break;
+        case IndirectAdjacent:
+            if (context.mode == SelectorChecker::ResolvingStyle) {
+                if (Element* parentElement = element->parentElement())
+                    parentElement->setChildrenAffectedByForwardPositionalRules();
+            }
+            for (Element* sibling = element->previousElementSibling(); sibling; sibling = sibling->previousElementSibling()) {
+                SelectorChecker::Match match = matchFrom(instruction + 1, sibling, context);
+                if (match != SelectorChecker::SelectorFailsLocally)
+                    return match;
+            }
+            return SelectorChecker::SelectorFailsAllSiblings;
+        case Accept:
+            return SelectorChecker::SelectorMatches;
+        }
+    }
+}
+
+bool SelectorBytecode::matches(unsigned offset, Element* element, const CheckingContext& context) const
+{
+    ASSERT(offset < m_instructions.size());
+    return matchFrom(m_instructions.data() + offset, element, context) == SelectorChecker::SelectorMatches;
+}
+
+} // namespace WebCore
@@ -0,0 +1,106 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SelectorBytecode_h
+#define SelectorBytecode_h
+
+#include "SelectorChecker.h"
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class CSSSelector;
+class Element;
+
+// Flat, interpreted form of the selectors a RuleSet can match without SelectorChecker.
+// Every compilable selector is lowered once, at RuleSet build time, into a run of
+// instructions stored in a single per-RuleSet arena. A program is a sequence of compound
+// selectors, right to left: the simple selector tests of a compound followed by the
+// combinator that leads to the next compound, terminated by Accept.
+class SelectorBytecode {
+    WTF_MAKE_NONCOPYABLE(SelectorBytecode);
+public:
+    // Offsets are stored in 31 bits of RuleData.
+    static const unsigned invalidOffset = 0x7fffffff;
+
+    struct CheckingContext {
+        CheckingContext(SelectorChecker::Mode mode, SelectorChecker::VisitedMatchType visitedMatchType, bool documentIsHTML)
+            : mode(mode)
+            , visitedMatchType(visitedMatchType)
+            , documentIsHTML(documentIsHTML)
+        { }
+
+        SelectorChecker::Mode mode;
+        SelectorChecker::VisitedMatchType visitedMatchType;
+        bool documentIsHTML;
+    };
+
+    SelectorBytecode() { }
+
+    static bool canCompile(const CSSSelector*);
+    // Whether the compiled program only reads element and tree state that is safe to access
+    // from a worker thread while the main thread is blocked (see ParallelRuleMatcher).
+    static bool canMatchOffMainThread(const CSSSelector*);
+
+    // Returns the offset of the compiled program, or invalidOffset if the selector is not compilable.
+    unsigned compile(const CSSSelector*);
+    // Appends all programs of another arena and returns the offset they were moved by.
+    unsigned append(const SelectorBytecode&);
+    bool matches(unsigned offset, Element*, const CheckingContext&) const;
+
+    unsigned size() const { return m_instructions.size(); }
+    void shrinkToFit() { m_instructions.shrinkToFit(); }
+
+private:
+    enum Opcode {
+        MatchTag,
+        MatchId,
+        MatchClass,
+        MatchAttribute,
+        MatchLink,
+        MatchVisited,
+        MatchFocus,
+        Descendant,
+        Child,
+        DirectAdjacent,
+        IndirectAdjacent,
+        Accept
+    };
+
+    struct Instruction {
+        Instruction(Opcode opcode, const CSSSelector* selector = 0, AtomicStringImpl* value = 0, bool caseSensitive = true)
+            : selector(selector)
+            , value(value)
+            , opcode(opcode)
+            , caseSensitive(caseSensitive)
+        { }
+
+        const CSSSelector* selector;
+        AtomicStringImpl* value;
+        unsigned opcode : 8;
+        unsigned caseSensitive : 1;
+    };
+
+    void appendSimpleSelector(const CSSSelector*);
+    SelectorChecker::Match matchFrom(const Instruction*, Element*, const CheckingContext&) const;
+
+    Vector<Instruction> m_instructions;
+};
+
+} // namespace WebCore
+
+#endif // SelectorBytecode_h
@@ -369,6 +369,14 @@ static bool anyAttributeMatches(Element* element, const CSSSelector* selector, c
     return false;
 }
 
+bool SelectorChecker::attributeSelectorMatches(Element* element, const CSSSelector* selector, bool caseSensitive)
+{
+    ASSERT(selector->isAttributeSelector());
+    if (!element->hasAttributes())
+        return false;
+    return anyAttributeMatches(element, selector, selector->attribute(), caseSensitive);
+}
+
 bool SelectorChecker::checkOne(const SelectorCheckingContext& context) const
 {
     Element* const & element = context.element;
@@ -386,13 +394,8 @@ bool SelectorChecker::checkOne(const SelectorCheckingContext& context) const
         return element->hasID() && element->idForStyleResolution() == selector->value();
 
     if (selector->isAttributeSelector()) {
-        if (!element->hasAttributes())
-            return false;
-
-        const QualifiedName& attr = selector->attribute();
-        bool caseSensitive = !m_documentIsHTML || HTMLDocument::isCaseSensitiveAttribute(attr);
-
-        if (!anyAttributeMatches(element, selector, attr, caseSensitive))
+        bool caseSensitive = !m_documentIsHTML || HTMLDocument::isCaseSensitiveAttribute(selector->attribute());
+        if (!attributeSelectorMatches(element, selector, caseSensitive))
             return false;
     }
 
@@ -82,6 +82,7 @@ class KeyframeList;
 class KeyframeValue;
 class MediaQueryEvaluator;
 class Node;
+class ParallelRuleMatcher;
 class RenderRegion;
 class RenderScrollbar;
 class RuleData;
@@ -204,6 +205,10 @@ public:
     const DocumentRuleSets& ruleSets() const { return m_ruleSets; }
     SelectorFilter& selectorFilter() { return m_selectorFilter; }
 
+    // Set by Style::resolveTree() for the duration of a recalc whose matching ran ahead in parallel.
+    void setParallelRuleMatcher(const ParallelRuleMatcher* matcher) { m_parallelRuleMatcher = matcher; }
+    const ParallelRuleMatcher* parallelRuleMatcher() const { return m_parallelRuleMatcher; }
+
 #if ENABLE(STYLE_SCOPED) || ENABLE(SHADOW_DOM)
     StyleScopeResolver* ensureScopeResolver()
     {
@@ -265,6 +270,7 @@ public:
     bool hasSelectorForId(const AtomicString&) const;
     bool hasSelectorForClass(const AtomicString&) const;
     bool hasSelectorForAttribute(const AtomicString&) const;
+    const RuleFeatureSet& ruleFeatures() const { return m_ruleSets.features(); }
 
     CSSFontSelector* fontSelector() const { return m_fontSelector.get(); }
 #if ENABLE(CSS_DEVICE_ADAPTATION)
@@ -594,6 +600,7 @@ private:
 
     Document& m_document;
     SelectorFilter m_selectorFilter;
+    const ParallelRuleMatcher* m_parallelRuleMatcher;
 
     bool m_matchAuthorAndUserStyles;
 
@@ -192,6 +192,7 @@ void StyleSheetContents::clearRules()
     }
     m_importRules.clear();
     m_childRules.clear();
+    m_sharedStyleRules.clear();
     clearCharsetRule();
 }
 
@@ -500,6 +501,21 @@ void StyleSheetContents::unregisterClient(CSSStyleSheet* sheet)
     m_clients.remove(position);
 }
 
+void StyleSheetContents::setMutable()
+{
+    m_isMutable = true;
+    // The rules may change from now on.
+    m_sharedStyleRules.clear();
+}
+
+const SharedStyleRules* StyleSheetContents::ensureSharedStyleRules()
+{
+    ASSERT(isCacheable());
+    if (!m_sharedStyleRules)
+        m_sharedStyleRules = SharedStyleRules::create(*this);
+    return m_sharedStyleRules.get();
+}
+
 void StyleSheetContents::addedToMemoryCache()
 {
     ASSERT(!m_isInMemoryCache);
@@ -25,6 +25,7 @@
 #include "KURL.h"
 #include <wtf/HashMap.h>
 #include <wtf/ListHashSet.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/RefCounted.h>
 #include <wtf/Vector.h>
 #include <wtf/text/AtomicStringHash.h>
@@ -36,6 +37,7 @@ class CachedCSSStyleSheet;
 class Document;
 class Node;
 class SecurityOrigin;
+class SharedStyleRules;
 class StyleRuleBase;
 class StyleRuleImport;
 
@@ -130,7 +132,10 @@ public:
     bool hasOneClient() { return m_clients.size() == 1; }
 
     bool isMutable() const { return m_isMutable; }
-    void setMutable() { m_isMutable = true; }
+    void setMutable();
+
+    // Only valid while the sheet is cacheable.
+    const SharedStyleRules* ensureSharedStyleRules();
 
     bool isInMemoryCache() const { return m_isInMemoryCache; }
     void addedToMemoryCache();
@@ -165,6 +170,7 @@ private:
     CSSParserContext m_parserContext;
 
     Vector<CSSStyleSheet*> m_clients;
+    OwnPtr<SharedStyleRules> m_sharedStyleRules;
 };
 
 } // namespace
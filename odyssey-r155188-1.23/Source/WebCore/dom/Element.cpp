@@ -993,14 +993,56 @@ static inline AtomicString makeIdForStyleResolution(const AtomicString& value, b
     return value;
 }
 
-static bool checkNeedsStyleInvalidationForIdChange(const AtomicString& oldId, const AtomicString& newId, StyleResolver* styleResolver)
+typedef Vector<const DescendantInvalidationSet*, 4> InvalidationSetVector;
+
+// Restyles the element and the descendants described by the invalidation sets of its changed
+// features. Sibling dependencies and subtrees the sets can't describe still use a FullStyleChange,
+// which restyles the whole subtree and lets Style::resolveTree() check the following siblings.
+static void invalidateStyleForFeatureChange(Element& element, const InvalidationSetVector& invalidationSets)
+{
+    for (size_t i = 0; i < invalidationSets.size(); ++i) {
+        if (invalidationSets[i]->wholeSubtreeInvalid() || invalidationSets[i]->affectsSiblings()) {
+            element.setNeedsStyleRecalc();
+            return;
+        }
+    }
+
+    element.setNeedsStyleRecalc(InlineStyleChange);
+    if (invalidationSets.isEmpty())
+        return;
+
+    Element* descendant = ElementTraversal::firstWithin(&element);
+    while (descendant) {
+        // Subtrees with a FullStyleChange are restyled completely anyway.
+        if (descendant->styleChangeType() >= FullStyleChange) {
+            descendant = ElementTraversal::nextSkippingChildren(descendant, &element);
+            continue;
+        }
+        for (size_t i = 0; i < invalidationSets.size(); ++i) {
+            if (invalidationSets[i]->invalidatesElement(descendant)) {
+                descendant->setNeedsStyleRecalc(InlineStyleChange);
+                break;
+            }
+        }
+        descendant = ElementTraversal::next(descendant, &element);
+    }
+}
+
+static bool collectInvalidationSetForId(const AtomicString& id, const StyleResolver& styleResolver, InvalidationSetVector& invalidationSets)
+{
+    if (id.isEmpty() || !styleResolver.hasSelectorForId(id))
+        return false;
+    if (const DescendantInvalidationSet* invalidationSet = styleResolver.ruleFeatures().idInvalidationSet(id.impl()))
+        invalidationSets.append(invalidationSet);
+    return true;
+}
+
+static bool collectInvalidationSetsForIdChange(const AtomicString& oldId, const AtomicString& newId, const StyleResolver& styleResolver, InvalidationSetVector& invalidationSets)
 {
     ASSERT(newId != oldId);
-    if (!oldId.isEmpty() && styleResolver->hasSelectorForId(oldId))
-        return true;
-    if (!newId.isEmpty() && styleResolver->hasSelectorForId(newId))
-        return true;
-    return false;
+    bool oldIdHasSelectors = collectInvalidationSetForId(oldId, styleResolver, invalidationSets);
+    bool newIdHasSelectors = collectInvalidationSetForId(newId, styleResolver, invalidationSets);
+    return oldIdHasSelectors || newIdHasSelectors;
 }
 
 void Element::attributeChanged(const QualifiedName& name, const AtomicString& newValue, AttributeModificationReason)
@@ -1018,7 +1060,9 @@ void Element::attributeChanged(const QualifiedName& name, const AtomicString& ne
         AtomicString newId = makeIdForStyleResolution(newValue, document().inQuirksMode());
         if (newId != oldId) {
             elementData()->setIdForStyleResolution(newId);
-            shouldInvalidateStyle = testShouldInvalidateStyle && checkNeedsStyleInvalidationForIdChange(oldId, newId, styleResolver);
+            InvalidationSetVector invalidationSets;
+            if (testShouldInvalidateStyle && collectInvalidationSetsForIdChange(oldId, newId, *styleResolver, invalidationSets))
+                invalidateStyleForFeatureChange(*this, invalidationSets);
         }
     } else if (name == classAttr)
         classAttributeChanged(newValue);
@@ -1078,45 +1122,53 @@ static inline bool classStringHasClassName(const AtomicString& newClassString)
     return classStringHasClassName(newClassString.characters16(), length);
 }
 
-template<typename Checker>
-static bool checkSelectorForClassChange(const SpaceSplitString& changedClasses, const Checker& checker)
+static bool collectInvalidationSetForClass(const AtomicString& className, const StyleResolver& styleResolver, InvalidationSetVector& invalidationSets)
+{
+    if (!styleResolver.hasSelectorForClass(className))
+        return false;
+    if (const DescendantInvalidationSet* invalidationSet = styleResolver.ruleFeatures().classInvalidationSet(className.impl()))
+        invalidationSets.append(invalidationSet);
+    return true;
+}
+
+static bool collectInvalidationSetsForClassChange(const SpaceSplitString& changedClasses, const StyleResolver& styleResolver, InvalidationSetVector& invalidationSets)
 {
+    bool hasSelectors = false;
     unsigned changedSize = changedClasses.size();
-    for (unsigned i = 0; i < changedSize; ++i) {
-        if (checker.hasSelectorForClass(changedClasses[i]))
-            return true;
-    }
-    return false;
+    for (unsigned i = 0; i < changedSize; ++i)
+        hasSelectors |= collectInvalidationSetForClass(changedClasses[i], styleResolver, invalidationSets);
+    return hasSelectors;
 }
 
-template<typename Checker>
-static bool checkSelectorForClassChange(const SpaceSplitString& oldClasses, const SpaceSplitString& newClasses, const Checker& checker)
+static bool collectInvalidationSetsForClassChange(const SpaceSplitString& oldClasses, const SpaceSplitString& newClasses, const StyleResolver& styleResolver, InvalidationSetVector& invalidationSets)
 {
     unsigned oldSize = oldClasses.size();
     if (!oldSize)
-        return checkSelectorForClassChange(newClasses, checker);
+        return collectInvalidationSetsForClassChange(newClasses, styleResolver, invalidationSets);
+    bool hasSelectors = false;
     BitVector remainingClassBits;
     remainingClassBits.ensureSize(oldSize);
     // Class vectors tend to be very short. This is faster than using a hash table.
     unsigned newSize = newClasses.size();
     for (unsigned i = 0; i < newSize; ++i) {
+        bool found = false;
         for (unsigned j = 0; j < oldSize; ++j) {
             if (newClasses[i] == oldClasses[j]) {
                 remainingClassBits.quickSet(j);
-                continue;
+                found = true;
             }
         }
-        if (checker.hasSelectorForClass(newClasses[i]))
-            return true;
+        // Classes present in both lists don't change what matches.
+        if (!found)
+            hasSelectors |= collectInvalidationSetForClass(newClasses[i], styleResolver, invalidationSets);
     }
     for (unsigned i = 0; i < oldSize; ++i) {
         // If the bit is not set the the corresponding class has been removed.
         if (remainingClassBits.quickGet(i))
             continue;
-        if (checker.hasSelectorForClass(oldClasses[i]))
-            return true;
+        hasSelectors |= collectInvalidationSetForClass(oldClasses[i], styleResolver, invalidationSets);
     }
-    return false;
+    return hasSelectors;
 }
 
 void Element::classAttributeChanged(const AtomicString& newClassString)
@@ -1124,16 +1176,17 @@ void Element::classAttributeChanged(const AtomicString& newClassString)
     StyleResolver* styleResolver = document().styleResolverIfExists();
     bool testShouldInvalidateStyle = attached() && styleResolver && styleChangeType() < FullStyleChange;
     bool shouldInvalidateStyle = false;
+    InvalidationSetVector invalidationSets;
 
     if (classStringHasClassName(newClassString)) {
         const bool shouldFoldCase = document().inQuirksMode();
         const SpaceSplitString oldClasses = ensureUniqueElementData().classNames();
         elementData()->setClass(newClassString, shouldFoldCase);
         const SpaceSplitString& newClasses = elementData()->classNames();
-        shouldInvalidateStyle = testShouldInvalidateStyle && checkSelectorForClassChange(oldClasses, newClasses, *styleResolver);
+        shouldInvalidateStyle = testShouldInvalidateStyle && collectInvalidationSetsForClassChange(oldClasses, newClasses, *styleResolver, invalidationSets);
     } else if (elementData()) {
         const SpaceSplitString& oldClasses = elementData()->classNames();
-        shouldInvalidateStyle = testShouldInvalidateStyle && checkSelectorForClassChange(oldClasses, *styleResolver);
+        shouldInvalidateStyle = testShouldInvalidateStyle && collectInvalidationSetsForClassChange(oldClasses, *styleResolver, invalidationSets);
         elementData()->clearClass();
     }
 
@@ -1141,7 +1194,7 @@ void Element::classAttributeChanged(const AtomicString& newClassString)
         elementRareData()->clearClassListValueForQuirksMode();
 
     if (shouldInvalidateStyle)
-        setNeedsStyleRecalc();
+        invalidateStyleForFeatureChange(*this, invalidationSets);
 }
 
 // Returns true is the given attribute is an event handler.
@@ -2841,8 +2894,13 @@ void Element::willModifyAttribute(const QualifiedName& name, const AtomicString&
     }
 
     if (oldValue != newValue) {
-        if (attached() && document().styleResolverIfExists() && document().styleResolverIfExists()->hasSelectorForAttribute(name.localName()))
-            setNeedsStyleRecalc();
+        StyleResolver* styleResolver = document().styleResolverIfExists();
+        if (attached() && styleResolver && styleResolver->hasSelectorForAttribute(name.localName())) {
+            InvalidationSetVector invalidationSets;
+            if (const DescendantInvalidationSet* invalidationSet = styleResolver->ruleFeatures().attributeInvalidationSet(name.localName().impl()))
+                invalidationSets.append(invalidationSet);
+            invalidateStyleForFeatureChange(*this, invalidationSets);
+        }
     }
 
     if (OwnPtr<MutationObserverInterestGroup> recipients = MutationObserverInterestGroup::createForAttributesMutation(this, name))
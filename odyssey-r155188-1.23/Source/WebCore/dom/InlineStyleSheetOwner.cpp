@@ -31,11 +31,64 @@
 #include "ScriptableDocumentParser.h"
 #include "StyleSheetContents.h"
 #include "TextNodeTraversal.h"
+#include <wtf/HashMap.h>
 #include <wtf/text/StringBuilder.h>
+#include <wtf/text/StringHash.h>
 #include <wtf/text/TextPosition.h>
 
 namespace WebCore {
 
+// Parsed contents of inline style sheets, shared by every <style> element with the same text in
+// any document. The entries are marked as being in the memory cache, so CSSOM mutation copies
+// them first.
+typedef HashMap<String, RefPtr<StyleSheetContents> > InlineStyleSheetCache;
+
+static InlineStyleSheetCache& inlineStyleSheetCache()
+{
+    DEFINE_STATIC_LOCAL(InlineStyleSheetCache, cache, ());
+    return cache;
+}
+
+static const unsigned maximumInlineStyleSheetCacheSize = 50;
+
+static StyleSheetContents* cachedInlineStyleSheetContents(const String& text, const CSSParserContext& parserContext)
+{
+    InlineStyleSheetCache::iterator it = inlineStyleSheetCache().find(text);
+    if (it == inlineStyleSheetCache().end())
+        return 0;
+    // Contexts must be identical so we know we would get the same exact result if we parsed again.
+    if (it->value->parserContext() != parserContext)
+        return 0;
+    ASSERT(it->value->isCacheable());
+    return it->value.get();
+}
+
+static void addInlineStyleSheetContentsToCache(const String& text, StyleSheetContents* contents)
+{
+    ASSERT(contents->isCacheable());
+    InlineStyleSheetCache& cache = inlineStyleSheetCache();
+    if (cache.size() >= maximumInlineStyleSheetCacheSize) {
+        InlineStyleSheetCache::iterator evicted = cache.begin();
+        evicted->value->removedFromMemoryCache();
+        cache.remove(evicted);
+    }
+    InlineStyleSheetCache::AddResult result = cache.add(text, contents);
+    if (!result.isNewEntry) {
+        result.iterator->value->removedFromMemoryCache();
+        result.iterator->value = contents;
+    }
+    contents->addedToMemoryCache();
+}
+
+void InlineStyleSheetOwner::clearCache()
+{
+    InlineStyleSheetCache& cache = inlineStyleSheetCache();
+    InlineStyleSheetCache::iterator end = cache.end();
+    for (InlineStyleSheetCache::iterator it = cache.begin(); it != end; ++it)
+        it->value->removedFromMemoryCache();
+    cache.clear();
+}
+
 InlineStyleSheetOwner::InlineStyleSheetOwner(Document* document, bool createdByParser)
     : m_isParsingChildren(createdByParser)
     , m_loading(false)
@@ -150,6 +203,17 @@ void InlineStyleSheetOwner::createSheet(Element* element, const String& text)
 
     document.styleSheetCollection()->addPendingSheet();
 
+    CSSParserContext parserContext(&document, KURL(), document.inputEncoding());
+    if (StyleSheetContents* cachedContents = cachedInlineStyleSheetContents(text, parserContext)) {
+        m_sheet = CSSStyleSheet::createInline(cachedContents, element);
+        m_sheet->setMediaQueries(mediaQueries.release());
+        m_sheet->setTitle(element->title());
+
+        element->sheetLoaded();
+        element->notifyLoadedSheetAndAllCriticalSubresources(false);
+        return;
+    }
+
     m_loading = true;
 
     m_sheet = CSSStyleSheet::createInline(element, KURL(), document.inputEncoding());
@@ -159,8 +223,13 @@ void InlineStyleSheetOwner::createSheet(Element* element, const String& text)
 
     m_loading = false;
 
-    if (m_sheet)
-        m_sheet->contents()->checkLoaded();
+    if (!m_sheet)
+        return;
+    RefPtr<StyleSheetContents> contents = m_sheet->contents();
+    contents->checkLoaded();
+    // Sheets with @import rules are not cacheable, so this only sees completely parsed sheets.
+    if (contents->isCacheable())
+        addInlineStyleSheetContentsToCache(text, contents.get());
 }
 
 bool InlineStyleSheetOwner::isLoading() const
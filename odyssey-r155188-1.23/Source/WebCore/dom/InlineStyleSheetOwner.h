@@ -50,6 +50,8 @@ public:
     void childrenChanged(Element*);
     void finishParsingChildren(Element*);
 
+    static void clearCache();
+
 private:
     void createSheet(Element*, const String& text);
     void createSheetFromTextContents(Element*);
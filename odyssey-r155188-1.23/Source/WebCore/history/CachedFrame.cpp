@@ -28,6 +28,7 @@
 
 #include "AnimationController.h"
 #include "CachedFramePlatformData.h"
+#include "CachedResourceLoader.h"
 #include "DOMWindow.h"
 #include "Document.h"
 #include "DocumentLoader.h"
@@ -42,10 +43,12 @@
 #include "HistoryController.h"
 #include "HistoryItem.h"
 #include "Logging.h"
+#include "NodeTraversal.h"
 #include "Page.h"
 #include "PageTransitionEvent.h"
 #include "ScriptController.h"
 #include "SerializedScriptValue.h"
+#include "Text.h"
 #include <wtf/RefCountedLeakCounter.h>
 #include <wtf/text/CString.h>
 
@@ -303,4 +306,46 @@ int CachedFrame::descendantFrameCount() const
     return count;
 }
 
+// Average sizes of a DOM node and of a renderer with their attributes, styles and layout data. The estimate
+// only needs to tell heavy pages from light ones.
+static const size_t estimatedNodeCost = 128;
+static const size_t estimatedRendererCost = 256;
+
+size_t CachedFrame::memoryCost() const
+{
+    size_t cost = 0;
+    for (Node* node = m_document.get(); node; node = NodeTraversal::next(node)) {
+        cost += estimatedNodeCost;
+        if (node->isTextNode())
+            cost += toText(node)->length() * sizeof(UChar);
+        if (node->renderer())
+            cost += estimatedRendererCost;
+    }
+
+    const CachedResourceLoader::DocumentResourceMap& resources = m_document->cachedResourceLoader()->allCachedResources();
+    for (CachedResourceLoader::DocumentResourceMap::const_iterator it = resources.begin(); it != resources.end(); ++it) {
+        if (it->value->type() == CachedResource::ImageResource)
+            cost += it->value->decodedSize();
+    }
+
+    for (size_t i = 0; i < m_childFrames.size(); ++i)
+        cost += m_childFrames[i]->memoryCost();
+
+    return cost;
+}
+
+void CachedFrame::destroyDecodedDataNotAccessedSince(double timeStamp)
+{
+    // Images drawn since then are also used by a page that is not in the cache.
+    const CachedResourceLoader::DocumentResourceMap& resources = m_document->cachedResourceLoader()->allCachedResources();
+    for (CachedResourceLoader::DocumentResourceMap::const_iterator it = resources.begin(); it != resources.end(); ++it) {
+        CachedResource* resource = it->value.get();
+        if (resource->type() == CachedResource::ImageResource && resource->decodedSize() && resource->lastDecodedAccessTime() < timeStamp)
+            resource->destroyDecodedData();
+    }
+
+    for (size_t i = 0; i < m_childFrames.size(); ++i)
+        m_childFrames[i]->destroyDecodedDataNotAccessedSince(timeStamp);
+}
+
 } // namespace WebCore
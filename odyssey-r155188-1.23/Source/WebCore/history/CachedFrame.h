@@ -88,6 +88,11 @@ public:
 
     int descendantFrameCount() const;
 
+    // Rough number of bytes held by this frame and its descendants for their DOM, render tree and decoded images.
+    size_t memoryCost() const;
+    // Drops the decoded images that were not drawn since the given time, they decode again when the frame is restored.
+    void destroyDecodedDataNotAccessedSince(double timeStamp);
+
 private:
     explicit CachedFrame(Frame&);
 };
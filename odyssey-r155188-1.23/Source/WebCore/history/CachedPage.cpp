@@ -54,6 +54,8 @@ CachedPage::CachedPage(Page& page)
     : m_timeStamp(monotonicallyIncreasingTime())
     , m_expirationTime(m_timeStamp + page.settings().backForwardCacheExpirationInterval())
     , m_cachedMainFrame(CachedFrame::create(page.mainFrame()))
+    , m_memoryCost(0)
+    , m_isCold(false)
     , m_needStyleRecalcForVisitedLinks(false)
     , m_needsFullStyleRecalc(false)
     , m_needsCaptionPreferencesChanged(false)
@@ -135,6 +137,13 @@ void CachedPage::destroy()
 	#endif
 }
 
+void CachedPage::makeCold()
+{
+    ASSERT(m_cachedMainFrame);
+    m_cachedMainFrame->destroyDecodedDataNotAccessedSince(m_timeStamp);
+    m_isCold = true;
+}
+
 bool CachedPage::hasExpired() const
 {
     return monotonicallyIncreasingTime() > m_expirationTime;
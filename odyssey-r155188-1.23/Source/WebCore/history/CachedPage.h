@@ -50,6 +50,14 @@ public:
     
     CachedFrame* cachedMainFrame() { return m_cachedMainFrame.get(); }
 
+    // Estimated number of bytes the page keeps alive while it is in the page cache.
+    size_t memoryCost() const { return m_memoryCost; }
+    void setMemoryCost(size_t memoryCost) { m_memoryCost = memoryCost; }
+
+    // A cold page has not been restored for a while and has dropped the decoded data it can recreate.
+    bool isCold() const { return m_isCold; }
+    void makeCold();
+
     void markForVistedLinkStyleRecalc() { m_needStyleRecalcForVisitedLinks = true; }
     void markForFullStyleRecalc() { m_needsFullStyleRecalc = true; }
 #if ENABLE(VIDEO_TRACK)
@@ -67,6 +75,8 @@ private:
     double m_timeStamp;
     double m_expirationTime;
     OwnPtr<CachedFrame> m_cachedMainFrame;
+    size_t m_memoryCost;
+    bool m_isCold;
     bool m_needStyleRecalcForVisitedLinks;
     bool m_needsFullStyleRecalc;
     bool m_needsCaptionPreferencesChanged;
@@ -41,15 +41,20 @@
 #include "FrameLoaderClient.h"
 #include "FrameLoaderStateMachine.h"
 #include "FrameView.h"
+#include "GCController.h"
 #include "HistogramSupport.h"
 #include "HistoryController.h" 
 #include "HistoryItem.h"
+#include "JSDOMWindowBase.h"
 #include "Logging.h"
 #include "Page.h"
 #include "Settings.h"
 #if ENABLE(SHARED_WORKERS)
 #include "SharedWorkerRepository.h"
 #endif
+#include <heap/Heap.h>
+#include <limits>
+#include <runtime/VM.h>
 #include <wtf/CurrentTime.h>
 #include <wtf/text/CString.h>
 #include <wtf/text/StringConcatenate.h>
@@ -62,6 +67,9 @@ using namespace std;
 
 namespace WebCore {
 
+// Cached pages that were not restored for this long drop the decoded data they can recreate.
+static const double coldPageDelay = 60;
+
 #if !defined(NDEBUG)
 
 #define PCLOG(...) LOG(PageCache, "%*s%s", indentLevel*4, "", makeString(__VA_ARGS__).utf8().data())
@@ -295,6 +303,9 @@ PageCache* pageCache()
 PageCache::PageCache()
     : m_capacity(0)
     , m_size(0)
+    , m_memoryBudget(numeric_limits<size_t>::max())
+    , m_memoryCost(0)
+    , m_coldPageTimer(this, &PageCache::coldPageTimerFired)
     , m_head(0)
     , m_tail(0)
 #if USE(ACCELERATED_COMPOSITING)
@@ -379,6 +390,13 @@ void PageCache::setCapacity(int capacity)
     prune();
 }
 
+void PageCache::setMemoryBudget(size_t memoryBudget)
+{
+    m_memoryBudget = memoryBudget;
+
+    prune();
+}
+
 int PageCache::frameCount() const
 {
     int frameCount = 0;
@@ -440,8 +458,25 @@ void PageCache::add(PassRefPtr<HistoryItem> prpItem, Page& page)
     item->m_cachedPage = CachedPage::create(page);
     addToLRUList(item);
     ++m_size;
+
+    // The JavaScript heap is shared by all pages, so each page is charged an even share of it, counting the page being shown.
+    CachedPage* cachedPage = item->m_cachedPage.get();
+    cachedPage->setMemoryCost(cachedPage->cachedMainFrame()->memoryCost() + JSDOMWindowBase::commonVM()->heap.size() / (m_size + 1));
+    m_memoryCost += cachedPage->memoryCost();
+    LOG(PageCache, "Added page for %s to the back/forward cache, it costs %lu bytes", item->url().string().ascii().data(), static_cast<unsigned long>(cachedPage->memoryCost()));
     
     prune();
+    scheduleColdPageTimer();
+}
+
+void PageCache::didLookUpForBackForwardNavigation(CachedPage* cachedPage)
+{
+    if (cachedPage)
+        ++m_statistics.hitCount;
+    else
+        ++m_statistics.missCount;
+
+    HistogramSupport::histogramEnumeration("PageCache.BackForwardNavigationHit", !!cachedPage, 2);
 }
 
 PassOwnPtr<CachedPage> PageCache::take(HistoryItem* item)
@@ -453,6 +488,8 @@ PassOwnPtr<CachedPage> PageCache::take(HistoryItem* item)
 
     removeFromLRUList(item);
     --m_size;
+    if (cachedPage)
+        m_memoryCost -= cachedPage->memoryCost();
 
     item->deref(); // Balanced in add().
 
@@ -461,6 +498,7 @@ PassOwnPtr<CachedPage> PageCache::take(HistoryItem* item)
 
     if (cachedPage->hasExpired()) {
         LOG(PageCache, "Not restoring page for %s from back/forward cache because cache entry has expired", item->url().string().ascii().data());
+        ++m_statistics.expiredCount;
         return nullptr;
     }
 
@@ -477,6 +515,7 @@ CachedPage* PageCache::get(HistoryItem* item)
             return cachedPage;
         
         LOG(PageCache, "Not restoring page for %s from back/forward cache because cache entry has expired", item->url().string().ascii().data());
+        ++m_statistics.expiredCount;
         pageCache()->remove(item);
     }
     return 0;
@@ -488,6 +527,7 @@ void PageCache::remove(HistoryItem* item)
     if (!item || !item->m_cachedPage)
         return;
 
+    m_memoryCost -= item->m_cachedPage->memoryCost();
     item->m_cachedPage.clear();
     removeFromLRUList(item);
     --m_size;
@@ -497,12 +537,64 @@ void PageCache::remove(HistoryItem* item)
 
 void PageCache::prune()
 {
-    while (m_size > m_capacity) {
+    while (m_size > m_capacity || m_memoryCost > m_memoryBudget) {
         ASSERT(m_tail && m_tail->m_cachedPage);
+        if (m_size > m_capacity)
+            ++m_statistics.capacityEvictionCount;
+        else {
+            LOG(PageCache, "Evicting page for %s from back/forward cache to stay within %lu bytes", m_tail->url().string().ascii().data(), static_cast<unsigned long>(m_memoryBudget));
+            ++m_statistics.memoryEvictionCount;
+        }
         remove(m_tail);
     }
 }
 
+void PageCache::scheduleColdPageTimer()
+{
+    if (m_coldPageTimer.isActive())
+        return;
+
+    // The least recently cached pages are at the tail, so the first page that is not cold goes cold next.
+    for (HistoryItem* current = m_tail; current; current = current->m_prev) {
+        CachedPage* cachedPage = current->m_cachedPage.get();
+        if (!cachedPage->isCold()) {
+            m_coldPageTimer.startOneShot(max(0.0, cachedPage->timeStamp() + coldPageDelay - monotonicallyIncreasingTime()));
+            return;
+        }
+    }
+}
+
+void PageCache::coldPageTimerFired(Timer<PageCache>*)
+{
+    double coldTime = monotonicallyIncreasingTime() - coldPageDelay;
+    bool didMakePageCold = false;
+    for (HistoryItem* current = m_tail; current; current = current->m_prev) {
+        CachedPage* cachedPage = current->m_cachedPage.get();
+        if (cachedPage->isCold())
+            continue;
+        if (cachedPage->timeStamp() > coldTime)
+            break;
+
+        size_t frameCost = cachedPage->cachedMainFrame()->memoryCost();
+        cachedPage->makeCold();
+        size_t coldFrameCost = cachedPage->cachedMainFrame()->memoryCost();
+        size_t freedCost = frameCost > coldFrameCost ? frameCost - coldFrameCost : 0;
+        cachedPage->setMemoryCost(cachedPage->memoryCost() - freedCost);
+        m_memoryCost -= freedCost;
+
+        LOG(PageCache, "Page for %s in back/forward cache went cold, freeing %lu bytes", current->url().string().ascii().data(), static_cast<unsigned long>(freedCost));
+        ++m_statistics.coldPageCount;
+        didMakePageCold = true;
+    }
+
+    // JavaScriptCore can only throw compiled code away for the whole VM. Code of the pages that are shown is
+    // generated again when it next runs.
+    if (didMakePageCold)
+        gcController().discardAllCompiledCode();
+
+    scheduleColdPageTimer();
+}
+
 void PageCache::addToLRUList(HistoryItem* item)
 {
     item->m_next = m_head;
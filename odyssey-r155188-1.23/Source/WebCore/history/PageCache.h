@@ -47,8 +47,12 @@ namespace WebCore {
 
         void setCapacity(int); // number of pages to cache
         int capacity() { return m_capacity; }
+
+        void setMemoryBudget(size_t); // number of bytes the cached pages may use
+        size_t memoryBudget() const { return m_memoryBudget; }
+        size_t memoryCost() const { return m_memoryCost; }
         
-        void add(PassRefPtr<HistoryItem>, Page&); // Prunes if capacity() is exceeded.
+        void add(PassRefPtr<HistoryItem>, Page&); // Prunes if capacity() or memoryBudget() is exceeded.
         void remove(HistoryItem*);
         CachedPage* get(HistoryItem* item);
         PassOwnPtr<CachedPage> take(HistoryItem*);
@@ -56,6 +60,27 @@ namespace WebCore {
         int pageCount() const { return m_size; }
         int frameCount() const;
 
+        struct Statistics {
+            Statistics()
+                : hitCount(0)
+                , missCount(0)
+                , expiredCount(0)
+                , capacityEvictionCount(0)
+                , memoryEvictionCount(0)
+                , coldPageCount(0)
+            {
+            }
+
+            unsigned hitCount; // back/forward navigations restored from the cache
+            unsigned missCount; // back/forward navigations that had to load the page
+            unsigned expiredCount;
+            unsigned capacityEvictionCount;
+            unsigned memoryEvictionCount;
+            unsigned coldPageCount;
+        };
+        Statistics statistics() const { return m_statistics; }
+        void didLookUpForBackForwardNavigation(CachedPage*);
+
         void markPagesForVistedLinkStyleRecalc();
 
         // Will mark all cached pages associated with the given page as needing style recalc.
@@ -82,8 +107,15 @@ namespace WebCore {
 
         void prune();
 
+        void scheduleColdPageTimer();
+        void coldPageTimerFired(Timer<PageCache>*);
+
         int m_capacity;
         int m_size;
+        size_t m_memoryBudget;
+        size_t m_memoryCost;
+        Timer<PageCache> m_coldPageTimer;
+        Statistics m_statistics;
 
         // LRU List
         HistoryItem* m_head;
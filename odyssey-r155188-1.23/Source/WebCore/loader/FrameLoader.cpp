@@ -85,6 +85,7 @@
 #include "Page.h"
 #include "PageActivityAssertionToken.h"
 #include "PageCache.h"
+#include "PageGroup.h"
 #include "PageTransitionEvent.h"
 #include "PlatformStrategies.h"
 #include "PluginData.h"
@@ -104,6 +105,8 @@
 #include "SegmentedString.h"
 #include "SerializedScriptValue.h"
 #include "Settings.h"
+#include "StorageArea.h"
+#include "StorageNamespace.h"
 #include "TextResourceDecoder.h"
 #include "WindowFeatures.h"
 #include "XMLDocumentParser.h"
@@ -2221,6 +2224,22 @@ void FrameLoader::checkLoadCompleteForThisFrame()
     ASSERT_NOT_REACHED();
 }
 
+// Starts importing the local storage of the origin a page navigates to, so that it is ready
+// by the time the page's scripts read it.
+static void preloadLocalStorage(Frame& frame, const KURL& url)
+{
+    Page* page = frame.page();
+    if (!page || &page->mainFrame() != &frame || !page->settings().localStorageEnabled())
+        return;
+    if (!url.protocolIsInHTTPFamily())
+        return;
+
+    RefPtr<SecurityOrigin> origin = SecurityOrigin::create(url);
+    if (!origin->canAccessLocalStorage(0))
+        return;
+    page->group().localStorage()->storageArea(origin.release());
+}
+
 void FrameLoader::continueLoadAfterWillSubmitForm()
 {
     if (!m_provisionalDocumentLoader)
@@ -2233,6 +2252,8 @@ void FrameLoader::continueLoadAfterWillSubmitForm()
     if (!m_provisionalDocumentLoader)
         return;
 
+    preloadLocalStorage(m_frame, m_provisionalDocumentLoader->request().url());
+
     DocumentLoader* activeDocLoader = activeDocumentLoader();
     if (activeDocLoader && activeDocLoader->isLoadingMainResource())
         return;
@@ -3141,7 +3162,10 @@ void FrameLoader::loadDifferentDocumentItem(HistoryItem* item, FrameLoadType loa
     // Remember this item so we can traverse any child items as child frames load
     history().setProvisionalItem(item);
 
-    if (CachedPage* cachedPage = pageCache()->get(item)) {
+    CachedPage* cachedPage = pageCache()->get(item);
+    if (!m_frame.tree().parent())
+        pageCache()->didLookUpForBackForwardNavigation(cachedPage);
+    if (cachedPage) {
         loadWithDocumentLoader(cachedPage->documentLoader(), loadType, 0);   
         return;
     }
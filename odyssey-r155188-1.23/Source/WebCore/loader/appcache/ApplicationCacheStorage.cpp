@@ -36,6 +36,7 @@
 #include "SQLiteStatement.h"
 #include "SQLiteTransaction.h"
 #include "SecurityOrigin.h"
+#include "StorageUsageIndex.h"
 #include "UUID.h"
 #include <wtf/text/CString.h>
 #include <wtf/StdLibExtras.h>
@@ -135,6 +136,12 @@ ApplicationCacheGroup* ApplicationCacheStorage::loadCacheGroup(const KURL& manif
     return group;
 }    
 
+// Cache groups are loaded into memory when a document uses them.
+static void noteCacheGroupLoaded(const KURL& manifestURL)
+{
+    StorageUsageIndex::index().noteOriginUsed(SecurityOrigin::create(manifestURL)->databaseIdentifier());
+}
+
 ApplicationCacheGroup* ApplicationCacheStorage::findOrCreateCacheGroup(const KURL& manifestURL)
 {
     ASSERT(!manifestURL.hasFragmentIdentifier());
@@ -156,6 +163,7 @@ ApplicationCacheGroup* ApplicationCacheStorage::findOrCreateCacheGroup(const KUR
     }
     
     result.iterator->value = group;
+    noteCacheGroupLoaded(manifestURL);
     
     return group;
 }
@@ -256,6 +264,7 @@ ApplicationCacheGroup* ApplicationCacheStorage::cacheGroupForURL(const KURL& url
         group->setNewestCache(cache.release());
         
         m_cachesInMemory.set(group->manifestURL(), group);
+        noteCacheGroupLoaded(manifestURL);
         
         return group;
     }
@@ -327,6 +336,7 @@ ApplicationCacheGroup* ApplicationCacheStorage::fallbackCacheGroupForURL(const K
         group->setNewestCache(cache.release());
         
         m_cachesInMemory.set(group->manifestURL(), group);
+        noteCacheGroupLoaded(manifestURL);
         
         return group;
     }
@@ -1047,6 +1057,7 @@ bool ApplicationCacheStorage::storeNewestCache(ApplicationCacheGroup* group, App
     groupStorageIDJournal.commit();
     resourceStorageIDJournal.commit();
     storeCacheTransaction.commit();
+    updateUsageIndex();
     return true;
 }
 
@@ -1235,6 +1246,7 @@ void ApplicationCacheStorage::remove(ApplicationCache* cache)
     }
     
     checkForDeletedResources();
+    updateUsageIndex();
 }    
 
 void ApplicationCacheStorage::empty()
@@ -1257,6 +1269,7 @@ void ApplicationCacheStorage::empty()
         it->value->clearStorageID();
     
     checkForDeletedResources();
+    updateUsageIndex();
 }
     
 void ApplicationCacheStorage::deleteTables()
@@ -1428,6 +1441,7 @@ bool ApplicationCacheStorage::deleteCacheGroup(const String& manifestURL)
     deleteTransaction.commit();
     
     checkForDeletedResources();
+    updateUsageIndex();
     
     return true;
 }
@@ -1529,6 +1543,36 @@ void ApplicationCacheStorage::getOriginsWithCache(HashSet<RefPtr<SecurityOrigin>
     }
 }
 
+void ApplicationCacheStorage::updateUsageIndex()
+{
+    // Copies of a cache made by storeCopyOfCache() are not part of the browser's storage.
+    if (this != &cacheStorage())
+        return;
+
+    openDatabase(false);
+    if (!m_database.isOpen())
+        return;
+
+    SQLiteStatement statement(m_database, "SELECT CacheGroups.origin, SUM(Caches.size)"
+                                          "  FROM CacheGroups"
+                                          " INNER JOIN Caches ON CacheGroups.id = Caches.cacheGroup"
+                                          " GROUP BY CacheGroups.origin");
+    if (statement.prepare() != SQLResultOk)
+        return;
+
+    HashMap<String, unsigned long long> usageByOrigin;
+    int result;
+    while ((result = statement.step()) == SQLResultRow)
+        usageByOrigin.set(statement.getColumnText(0), statement.getColumnInt64(1));
+
+    if (result != SQLResultDone) {
+        LOG_ERROR("Could not get the usage of the origins, error \"%s\"", m_database.lastErrorMsg());
+        return;
+    }
+
+    StorageUsageIndex::index().setUsageOfAllOrigins(StorageUsageIndex::ApplicationCache, usageByOrigin);
+}
+
 void ApplicationCacheStorage::deleteAllEntries()
 {
     empty();
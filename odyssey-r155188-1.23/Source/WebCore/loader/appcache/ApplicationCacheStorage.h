@@ -97,6 +97,9 @@ public:
     void getOriginsWithCache(HashSet<RefPtr<SecurityOrigin>, SecurityOriginHash>&);
     void deleteAllEntries();
 
+    // Reports the usage of every origin to the StorageUsageIndex.
+    void updateUsageIndex();
+
     static int64_t unknownQuota() { return -1; }
     static int64_t noQuota() { return std::numeric_limits<int64_t>::max(); }
 private:
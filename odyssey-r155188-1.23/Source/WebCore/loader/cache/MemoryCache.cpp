@@ -31,6 +31,7 @@
 #include "FrameLoaderTypes.h"
 #include "FrameView.h"
 #include "Image.h"
+#include "InlineStyleSheetOwner.h"
 #include "Logging.h"
 #include "PublicSuffix.h"
 #include "SecurityOrigin.h"
@@ -812,6 +813,8 @@ void MemoryCache::evictResources()
 
     setDisabled(true);
     setDisabled(false);
+
+    InlineStyleSheetOwner::clearCache();
 }
 
 void MemoryCache::prune()
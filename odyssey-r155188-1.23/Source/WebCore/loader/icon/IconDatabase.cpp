@@ -83,11 +83,12 @@ static const int updateTimerDelay = 5;
 
 static bool checkIntegrityOnOpen = false;
 
-#if PLATFORM(GTK)
 // We are not interested in icons that have been unused for more than
 // 30 days, delete them even if they have not been explicitly released.
 static const int notUsedIconExpirationTime = 60*60*24*30;
-#endif
+
+// Number of icons kept decoded, shared by every view that shows icons
+static const int maximumDecodedIconCount = 64;
 
 //#if !LOG_DISABLED || !ERROR_DISABLED
 static String urlForLogging(const String& url)
@@ -206,6 +207,7 @@ void IconDatabase::removeAllIcons()
             
         // Clear the iconURL -> IconRecord map
         m_iconURLToRecordMap.clear();
+        m_decodedIconURLs.clear();
                     
         // Clear all in-memory records of things that need to be synced out to disk
         {
@@ -218,6 +220,8 @@ void IconDatabase::removeAllIcons()
         {
             MutexLocker locker(m_pendingReadingLock);
             m_pageURLsPendingImport.clear();
+            m_iconURLsPendingImport.clear();
+            m_importedIconTimestamps.clear();
             m_pageURLsInterestedInIcons.clear();
             m_iconsPendingReading.clear();
             m_loadersPendingDecision.clear();
@@ -245,36 +249,22 @@ Image* IconDatabase::synchronousIconForPageURL(const String& pageURLOriginal, co
     String pageURLCopy; // Creates a null string for easy testing
     
     PageURLRecord* pageRecord = m_pageURLToRecordMap.get(pageURLOriginal);
-    if (!pageRecord) {
+    if (!pageRecord || (!pageRecord->iconRecord() && !pageRecord->iconURLImported())) {
         pageURLCopy = pageURLOriginal.isolatedCopy();
         pageRecord = getOrCreatePageURLRecord(pageURLCopy);
     }
     
-    // If pageRecord is NULL, one of two things is true -
-    // 1 - The initial url import is incomplete and this pageURL was marked to be notified once it is complete if an iconURL exists
-    // 2 - The initial url import IS complete and this pageURL has no icon
+    // If pageRecord is NULL, the iconURL for this pageURL is being looked up in the database.
+    // Register to be notified when the icon comes in
+    // If we ever reach this condition, we know we've already made the pageURL copy
     if (!pageRecord) {
         MutexLocker locker(m_pendingReadingLock);
-        
-        // Import is ongoing, there might be an icon.  In this case, register to be notified when the icon comes in
-        // If we ever reach this condition, we know we've already made the pageURL copy
-        if (!m_iconURLImportComplete)
-            m_pageURLsInterestedInIcons.add(pageURLCopy);
-        
+        m_pageURLsInterestedInIcons.add(pageURLCopy);
         return 0;
     }
 
+    // The pageURL has been looked up and has no icon
     IconRecord* iconRecord = pageRecord->iconRecord();
-    
-    // If the initial URL import isn't complete, it's possible to have a PageURL record without an associated icon
-    // In this case, the pageURL is already in the set to alert the client when the iconURL mapping is complete so
-    // we can just bail now
-    if (!m_iconURLImportComplete && !iconRecord)
-        return 0;
-    
-    // The only way we should *not* have an icon record is if this pageURL is retained but has no icon yet - make sure of that
-    ASSERT(iconRecord || m_retainedPageURLs.contains(pageURLOriginal));
-    
     if (!iconRecord)
         return 0;
         
@@ -306,6 +296,8 @@ Image* IconDatabase::synchronousIconForPageURL(const String& pageURLOriginal, co
     // This is because we make the assumption that anything in memory is newer than whatever is in the database.
     // So the only time the data will be set from the second thread is when it is INITIALLY being read in from the database, but we would never 
     // delete the image on the secondary thread if the image already exists.
+    // Icons that drop out of the decoded icon cache only lose their decoded frames, so the Image object itself stays valid.
+    touchDecodedIcon(iconRecord);
     return iconRecord->image(size);
 }
 
@@ -340,12 +332,11 @@ String IconDatabase::synchronousIconURLForPageURL(const String& pageURLOriginal)
     MutexLocker locker(m_urlAndIconLock);
     
     PageURLRecord* pageRecord = m_pageURLToRecordMap.get(pageURLOriginal);
-    if (!pageRecord)
+    if (!pageRecord || (!pageRecord->iconRecord() && !pageRecord->iconURLImported()))
         pageRecord = getOrCreatePageURLRecord(pageURLOriginal.isolatedCopy());
     
-    // If pageRecord is NULL, one of two things is true -
-    // 1 - The initial url import is incomplete and this pageURL has already been marked to be notified once it is complete if an iconURL exists
-    // 2 - The initial url import IS complete and this pageURL has no icon
+    // If pageRecord is NULL, the iconURL for this pageURL is being looked up in the database and the
+    // client will be notified if there is one
     if (!pageRecord)
         return String();
     
@@ -431,12 +422,7 @@ void IconDatabase::retainIconForPageURL(const String& pageURL)
         m_retainOrReleaseIconRequested = true;
     }
 
-#if OS(MORPHOS)
-#warning "find something less heavy"
-    performPendingRetainAndReleaseOperations();
-#else
     scheduleOrDeferSyncTimer();
-#endif
 }
 
 void IconDatabase::performRetainIconForPageURL(const String& pageURLOriginal, int retainCount)
@@ -459,11 +445,6 @@ void IconDatabase::performRetainIconForPageURL(const String& pageURLOriginal, in
         // This page just had its retain count bumped from 0 to 1 - Record that fact
         m_retainedPageURLs.add(pageURL);
 
-        // If we read the iconURLs yet, we want to avoid any pageURL->iconURL lookups and the pageURLsPendingDeletion is moot, 
-        // so we bail here and skip those steps
-        if (!m_iconURLImportComplete)
-            return;
-
         MutexLocker locker(m_pendingSyncLock);
         // If this pageURL waiting to be sync'ed, update the sync record
         // This saves us in the case where a page was ready to be deleted from the database but was just retained - so theres no need to delete it!
@@ -523,8 +504,7 @@ void IconDatabase::performReleaseIconForPageURL(const String& pageURLOriginal, i
         MutexLocker locker(m_pendingReadingLock);
         
         // Since this pageURL is going away, there's no reason anyone would ever be interested in its read results    
-        if (!m_iconURLImportComplete)
-            m_pageURLsPendingImport.remove(pageURLOriginal);
+        m_pageURLsPendingImport.remove(pageURLOriginal);
         m_pageURLsInterestedInIcons.remove(pageURLOriginal);
         
         // If this icon is down to it's last retainer, we don't care about reading it in from disk anymore
@@ -679,6 +659,11 @@ void IconDatabase::setIconURLForPageURL(const String& iconURLOriginal, const Str
     }
 }
 
+static IconLoadDecision loadDecisionForTimestamp(int timestamp)
+{
+    return static_cast<int>(currentTime()) - timestamp > iconExpirationTime ? IconLoadYes : IconLoadNo;
+}
+
 IconLoadDecision IconDatabase::synchronousLoadDecisionForIconURL(const String& iconURL, DocumentLoader* notificationDocumentLoader)
 {
     ASSERT_NOT_SYNC_THREAD();
@@ -686,27 +671,31 @@ IconLoadDecision IconDatabase::synchronousLoadDecisionForIconURL(const String& i
     if (!isOpen() || iconURL.isEmpty())
         return IconLoadNo;
     
-    // If we have a IconRecord, it should also have its timeStamp marked because there is only two times when we create the IconRecord:
-    // 1 - When we read the icon urls from disk, getting the timeStamp at the same time
-    // 2 - When we get a new icon from the loader, in which case the timestamp is set at that time
+    // An IconRecord has its timeStamp marked when it is read from disk along with a page URL mapping, or when
+    // we get a new icon from the loader.  A record that was just created for a new page URL mapping doesn't
+    // know its timeStamp until the icon URL has been looked up in the database
     {
         MutexLocker locker(m_urlAndIconLock);
-        if (IconRecord* icon = m_iconURLToRecordMap.get(iconURL)) {
+        IconRecord* icon = m_iconURLToRecordMap.get(iconURL);
+        if (icon && icon->getTimestamp()) {
             LOG(IconDatabase, "Found expiration time on a present icon based on existing IconRecord");
-            return static_cast<int>(currentTime()) - static_cast<int>(icon->getTimestamp()) > iconExpirationTime ? IconLoadYes : IconLoadNo;
+            return loadDecisionForTimestamp(icon->getTimestamp());
         }
     }
     
-    // If we don't have a record for it, but we *have* imported all iconURLs from disk, then we should load it now
+    // If the icon URL was just looked up on disk, use that answer - a timeStamp of 0 means it isn't there and we should load it now
     MutexLocker readingLocker(m_pendingReadingLock);
-    if (m_iconURLImportComplete)
-        return IconLoadYes;
+    HashMap<String, int>::iterator imported = m_importedIconTimestamps.find(iconURL);
+    if (imported != m_importedIconTimestamps.end())
+        return loadDecisionForTimestamp(imported->value);
         
-    // Otherwise - since we refuse to perform I/O on the main thread to find out for sure - we return the answer that says
-    // "You might be asked to load this later, so flag that"
+    // Otherwise - since we refuse to perform I/O on the main thread to find out for sure - we ask the sync thread to look
+    // the icon URL up and return the answer that says "You might be asked to load this later, so flag that"
     LOG(IconDatabase, "Don't know if we should load %s or not - adding %p to the set of document loaders waiting on a decision", iconURL.ascii().data(), notificationDocumentLoader);
+    m_iconURLsPendingImport.add(iconURL.isolatedCopy());
     if (notificationDocumentLoader)
-        m_loadersPendingDecision.add(notificationDocumentLoader);    
+        m_loadersPendingDecision.set(notificationDocumentLoader, iconURL);    
+    wakeSyncThread();
 
     return IconLoadUnknown;
 }
@@ -809,7 +798,6 @@ IconDatabase::IconDatabase()
     , m_privateBrowsingEnabled(false)
     , m_threadTerminationRequested(false)
     , m_removeIconsRequested(false)
-    , m_iconURLImportComplete(false)
     , m_syncThreadHasWorkToDo(false)
     , m_disabledSuddenTerminationForSyncThread(false)
     , m_retainOrReleaseIconRequested(false)
@@ -834,22 +822,32 @@ void IconDatabase::notifyPendingLoadDecisions()
 {
     ASSERT_NOT_SYNC_THREAD();
     
-    // This method should only be called upon completion of the initial url import from the database
-    ASSERT(m_iconURLImportComplete);
-    LOG(IconDatabase, "Notifying all DocumentLoaders that were waiting on a load decision for their icons");
-    
-    HashSet<RefPtr<DocumentLoader> >::iterator i = m_loadersPendingDecision.begin();
-    HashSet<RefPtr<DocumentLoader> >::iterator end = m_loadersPendingDecision.end();
-    
-    for (; i != end; ++i)
-        if ((*i)->refCount() > 1)
-            (*i)->iconLoadDecisionAvailable();
-            
-    m_loadersPendingDecision.clear();
+    // This method is called each time the sync thread has looked icon URLs up in the database.  Only the
+    // DocumentLoaders waiting on one of those icon URLs can get their decision now
+    Vector<String> importedIconURLs;
+    Vector<RefPtr<DocumentLoader> > loaders;
+    {
+        MutexLocker locker(m_pendingReadingLock);
+        copyKeysToVector(m_importedIconTimestamps, importedIconURLs);
 
-#if OS(MORPHOS)
-	m_client->didFinishURLIconImport();
-#endif
+        HashMap<RefPtr<DocumentLoader>, String>::iterator end = m_loadersPendingDecision.end();
+        for (HashMap<RefPtr<DocumentLoader>, String>::iterator i = m_loadersPendingDecision.begin(); i != end; ++i) {
+            if (m_importedIconTimestamps.contains(i->value))
+                loaders.append(i->key);
+        }
+    }
+    LOG(IconDatabase, "Notifying %lu DocumentLoaders that were waiting on a load decision for their icons", static_cast<unsigned long>(loaders.size()));
+
+    for (unsigned i = 0; i < loaders.size(); ++i) {
+        m_loadersPendingDecision.remove(loaders[i]);
+        if (loaders[i]->refCount() > 1)
+            loaders[i]->iconLoadDecisionAvailable();
+    }
+
+    // Lookups that finished while we were notifying are left for the notification that follows them
+    MutexLocker locker(m_pendingReadingLock);
+    for (unsigned i = 0; i < importedIconURLs.size(); ++i)
+        m_importedIconTimestamps.remove(importedIconURLs[i]);
 }
 
 void IconDatabase::wakeSyncThread()
@@ -943,7 +941,7 @@ PassRefPtr<IconRecord> IconDatabase::getOrCreateIconRecord(const String& iconURL
     return newIcon.release();
 }
 
-// This method retrieves the existing PageURLRecord, or creates a new one and marks it as "interested in the import" for later notification
+// This method retrieves the existing PageURLRecord, or asks the sync thread to look the pageURL up in the database for later notification
 PageURLRecord* IconDatabase::getOrCreatePageURLRecord(const String& pageURL)
 {
     // Clients of getOrCreatePageURLRecord() are required to acquire the m_urlAndIconLock before calling this method
@@ -952,27 +950,32 @@ PageURLRecord* IconDatabase::getOrCreatePageURLRecord(const String& pageURL)
     if (!documentCanHaveIcon(pageURL))
         return 0;
 
+    // If the record has an icon or was already looked up in the database, it is as complete as it will get
     PageURLRecord* pageRecord = m_pageURLToRecordMap.get(pageURL);
-    
-    MutexLocker locker(m_pendingReadingLock);
-    if (!m_iconURLImportComplete) {
-        // If the initial import of all URLs hasn't completed and we have no page record, we assume we *might* know about this later and create a record for it
-        if (!pageRecord) {
-            LOG(IconDatabase, "Creating new PageURLRecord for pageURL %s", urlForLogging(pageURL).ascii().data());
-            pageRecord = new PageURLRecord(pageURL);
-            m_pageURLToRecordMap.set(pageURL, pageRecord);
-        }
+    if (pageRecord && (pageRecord->iconRecord() || pageRecord->iconURLImported()))
+        return pageRecord;
 
-        // If the pageRecord for this page does not have an iconRecord attached to it, then it is a new pageRecord still awaiting the initial import
-        // Mark the URL as "interested in the result of the import" then bail
-        if (!pageRecord->iconRecord()) {
-            m_pageURLsPendingImport.add(pageURL);
-            return 0;
-        }
+    // Mark the URL as "interested in the result of the import" then bail
+    LOG(IconDatabase, "Looking up the iconURL for pageURL %s", urlForLogging(pageURL).ascii().data());
+    {
+        MutexLocker locker(m_pendingReadingLock);
+        m_pageURLsPendingImport.add(pageURL);
     }
+    wakeSyncThread();
+    return 0;
+}
+
+void IconDatabase::touchDecodedIcon(IconRecord* iconRecord)
+{
+    // Clients of touchDecodedIcon() are required to acquire the m_urlAndIconLock before calling this method
+    ASSERT(!m_urlAndIconLock.tryLock());
 
-    // We've done the initial import of all URLs known in the database.  If this record doesn't exist now, it never will    
-     return pageRecord;
+    m_decodedIconURLs.appendOrMoveToLast(iconRecord->iconURL());
+    while (m_decodedIconURLs.size() > maximumDecodedIconCount) {
+        // The least recently used icon might have gone away already
+        if (IconRecord* icon = m_iconURLToRecordMap.get(m_decodedIconURLs.takeFirst()))
+            icon->destroyDecodedImage();
+    }
 }
 
 
@@ -1049,25 +1052,11 @@ void IconDatabase::iconDatabaseSyncThread()
 #if !LOG_DISABLED
     double newStamp = monotonicallyIncreasingTime();
     LOG(IconDatabase, "(THREAD) performOpenInitialization() took %.4f seconds, now %.4f seconds from thread start", newStamp - timeStamp, newStamp - startTime);
-    timeStamp = newStamp;
 #endif 
         
-    // Uncomment the following line to simulate a long lasting URL import (*HUGE* icon databases, or network home directories)
-    // while (monotonicallyIncreasingTime() - timeStamp < 10);
-
-    // Read in URL mappings from the database          
-    LOG(IconDatabase, "(THREAD) Starting iconURL import");
-    performURLImport();
-    
-    if (shouldStopThreadActivity()) {
-        syncThreadMainLoop();
-        return;
-    }
-
-#if !LOG_DISABLED
-    newStamp = monotonicallyIncreasingTime();
-    LOG(IconDatabase, "(THREAD) performURLImport() took %.4f seconds.  Entering main loop %.4f seconds from thread start", newStamp - timeStamp, newStamp - startTime);
-#endif 
+    // Page URL to icon URL mappings are looked up on demand, so their lookups can be served from now on.
+    // Notify the client in case it's managing its own pending notifications.
+    dispatchDidFinishURLImportOnMainThread();
 
     LOG(IconDatabase, "(THREAD) Beginning sync");
     syncThreadMainLoop();
@@ -1225,135 +1214,101 @@ bool IconDatabase::checkIntegrity()
     return false;
 }
 
-void IconDatabase::performURLImport()
+// readySQLiteStatement() handles two things
+// 1 - If the SQLDatabase& argument is different, the statement must be destroyed and remade.  This happens when the user
+//     switches to and from private browsing
+// 2 - Lazy construction of the Statement in the first place, in case we've never made this query before
+inline void readySQLiteStatement(OwnPtr<SQLiteStatement>& statement, SQLiteDatabase& db, const String& str)
 {
-    ASSERT_ICON_SYNC_THREAD();
+    if (statement && (statement->database() != &db || statement->isExpired())) {
+        if (statement->isExpired())
+            LOG(IconDatabase, "SQLiteStatement associated with %s is expired", str.ascii().data());
+        statement.clear();
+    }
+    if (!statement) {
+        statement = adoptPtr(new SQLiteStatement(db, str));
+        if (statement->prepare() != SQLResultOk)
+            LOG_ERROR("Preparing statement %s failed", str.ascii().data());
+    }
+}
 
-# if PLATFORM(GTK)
-    // Do not import icons not used in the last 30 days. They will be automatically pruned later if nobody retains them.
-    // Note that IconInfo.stamp is only set when the icon data is retrieved from the server (and thus is not updated whether
-    // we use it or not). This code works anyway because the IconDatabase downloads icons again if they are older than 4 days,
-    // so if the timestamp goes back in time more than those 30 days we can be sure that the icon was not used at all.
-    String importQuery = String::format("SELECT PageURL.url, IconInfo.url, IconInfo.stamp FROM PageURL INNER JOIN IconInfo ON PageURL.iconID=IconInfo.iconID WHERE IconInfo.stamp > %.0f;", floor(currentTime() - notUsedIconExpirationTime));
-#else
-    String importQuery("SELECT PageURL.url, IconInfo.url, IconInfo.stamp FROM PageURL INNER JOIN IconInfo ON PageURL.iconID=IconInfo.iconID;");
-#endif
+bool IconDatabase::performPendingURLImports()
+{
+    ASSERT_ICON_SYNC_THREAD();
 
-    SQLiteStatement query(m_syncDB, importQuery);
-    
-    if (query.prepare() != SQLResultOk) {
-        LOG_ERROR("Unable to prepare icon url import query");
-        return;
+    // Copy the URLs that need to be looked up.  The page URLs stay in their set until we apply the result, so we can
+    // verify then that someone is still interested in it.  This way we won't hold the lock while reading from disk
+    Vector<String> pageURLs;
+    Vector<String> iconURLs;
+    {
+        MutexLocker locker(m_pendingReadingLock);
+        copyToVector(m_pageURLsPendingImport, pageURLs);
+        copyToVector(m_iconURLsPendingImport, iconURLs);
+        m_iconURLsPendingImport.clear();
     }
-    
-    int result = query.step();
-    while (result == SQLResultRow) {
+
+    if (pageURLs.isEmpty() && iconURLs.isEmpty())
+        return false;
+
+    Vector<String> urlsToNotify;
+
+    for (unsigned i = 0; i < pageURLs.size(); ++i) {
         AutodrainedPool pool;
-        String pageURL = query.getColumnText(0);
-        String iconURL = query.getColumnText(1);
+
+        readySQLiteStatement(m_getIconURLForPageURLStatement, m_syncDB, "SELECT IconInfo.url, IconInfo.stamp FROM PageURL INNER JOIN IconInfo ON PageURL.iconID=IconInfo.iconID WHERE PageURL.url = (?);");
+        m_getIconURLForPageURLStatement->bindText(1, pageURLs[i]);
+
+        String iconURL;
+        int timestamp = 0;
+        int result = m_getIconURLForPageURLStatement->step();
+        if (result == SQLResultRow) {
+            iconURL = m_getIconURLForPageURLStatement->getColumnText(0);
+            timestamp = m_getIconURLForPageURLStatement->getColumnInt(1);
+        } else if (result != SQLResultDone)
+            LOG_ERROR("getIconURLForPageURL failed for url %s", urlForLogging(pageURLs[i]).ascii().data());
+        m_getIconURLForPageURLStatement->reset();
 
         {
             MutexLocker locker(m_urlAndIconLock);
-
-            PageURLRecord* pageRecord = m_pageURLToRecordMap.get(pageURL);
-            
-            // If the pageRecord doesn't exist in this map, then no one has retained this pageURL
-            // If the s_databaseCleanupCounter count is non-zero, then we're not supposed to be pruning the database in any manner,
-            // so go ahead and actually create a pageURLRecord for this url even though it's not retained.
-            // If database cleanup *is* allowed, we don't want to bother pulling in a page url from disk that noone is actually interested
-            // in - we'll prune it later instead!
-            if (!pageRecord && databaseCleanupCounter && documentCanHaveIcon(pageURL)) {
-                pageRecord = new PageURLRecord(pageURL);
-                m_pageURLToRecordMap.set(pageURL, pageRecord);
+            MutexLocker readingLocker(m_pendingReadingLock);
+
+            // The pageURL might have been released while we were reading
+            if (!m_pageURLsPendingImport.contains(pageURLs[i]))
+                continue;
+            m_pageURLsPendingImport.remove(pageURLs[i]);
+
+            // Keep a record even for pageURLs without an icon so they aren't looked up again
+            PageURLRecord* pageRecord = m_pageURLToRecordMap.get(pageURLs[i]);
+            if (!pageRecord) {
+                pageRecord = new PageURLRecord(pageURLs[i]);
+                m_pageURLToRecordMap.set(pageURLs[i], pageRecord);
             }
-            
-            if (pageRecord) {
-                IconRecord* currentIcon = pageRecord->iconRecord();
+            pageRecord->setIconURLImported();
 
-                if (!currentIcon || currentIcon->iconURL() != iconURL) {
-                    pageRecord->setIconRecord(getOrCreateIconRecord(iconURL));
-                    currentIcon = pageRecord->iconRecord();
-                }
-            
-                // Regardless, the time stamp from disk still takes precedence.  Until we read this icon from disk, we didn't think we'd seen it before
-                // so we marked the timestamp as "now", but it's really much older
-                currentIcon->setTimestamp(query.getColumnInt(2));
-            }            
-        }
-        
-        // FIXME: Currently the WebKit API supports 1 type of notification that is sent whenever we get an Icon URL for a Page URL.  We might want to re-purpose it to work for 
-        // getting the actually icon itself also (so each pageurl would get this notification twice) or we might want to add a second type of notification -
-        // one for the URL and one for the Image itself
-        // Note that WebIconDatabase is not neccessarily API so we might be able to make this change
-        {
-            MutexLocker locker(m_pendingReadingLock);
-            if (m_pageURLsPendingImport.contains(pageURL)) {
-                dispatchDidImportIconURLForPageURLOnMainThread(pageURL);
-                m_pageURLsPendingImport.remove(pageURL);
+            // An icon set by the loader in the meantime is newer than what is on disk
+            if (iconURL.isEmpty() || pageRecord->iconRecord()) {
+                m_pageURLsInterestedInIcons.remove(pageURLs[i]);
+                continue;
             }
-        }
-        
-        // Stop the import at any time of the thread has been asked to shutdown
-        if (shouldStopThreadActivity()) {
-            LOG(IconDatabase, "IconDatabase asked to terminate during performURLImport()");
-            return;
-        }
-        
-        result = query.step();
-    }
-    
-    if (result != SQLResultDone)
-        LOG(IconDatabase, "Error reading page->icon url mappings from database");
 
-    // Clear the m_pageURLsPendingImport set - either the page URLs ended up with an iconURL (that we'll notify about) or not, 
-    // but after m_iconURLImportComplete is set to true, we don't care about this set anymore
-    Vector<String> urls;
-    {
-        MutexLocker locker(m_pendingReadingLock);
+            pageRecord->setIconRecord(getOrCreateIconRecord(iconURL));
+            IconRecord* iconRecord = pageRecord->iconRecord();
 
-        urls.appendRange(m_pageURLsPendingImport.begin(), m_pageURLsPendingImport.end());
-        m_pageURLsPendingImport.clear();        
-        m_iconURLImportComplete = true;
-    }
-    
-    Vector<String> urlsToNotify;
-    
-    // Loop through the urls pending import
-    // Remove unretained ones if database cleanup is allowed
-    // Keep a set of ones that are retained and pending notification
-    {
-        MutexLocker locker(m_urlAndIconLock);
+            // Until we read this icon URL from disk, we didn't know its time stamp
+            if (!iconRecord->getTimestamp())
+                iconRecord->setTimestamp(timestamp);
 
-        performPendingRetainAndReleaseOperations();
+            // If someone is waiting for the image, read it in the same pass
+            if (m_pageURLsInterestedInIcons.contains(pageURLs[i]) && iconRecord->imageDataStatus() == ImageDataStatusUnknown)
+                m_iconsPendingReading.add(iconRecord);
+        }
 
-        for (unsigned i = 0; i < urls.size(); ++i) {
-            if (!m_retainedPageURLs.contains(urls[i])) {
-                PageURLRecord* record = m_pageURLToRecordMap.get(urls[i]);
-                if (record && !databaseCleanupCounter) {
-                    m_pageURLToRecordMap.remove(urls[i]);
-                    IconRecord* iconRecord = record->iconRecord();
-                    
-                    // If this page is the only remaining retainer of its icon, mark that icon for deletion and don't bother
-                    // reading anything related to it 
-                    if (iconRecord && iconRecord->hasOneRef()) {
-                        m_iconURLToRecordMap.remove(iconRecord->iconURL());
-                        
-                        {
-                            MutexLocker locker(m_pendingReadingLock);
-                            m_pageURLsInterestedInIcons.remove(urls[i]);
-                            m_iconsPendingReading.remove(iconRecord);
-                        }
-                        {
-                            MutexLocker locker(m_pendingSyncLock);
-                            m_iconsPendingSync.set(iconRecord->iconURL(), iconRecord->snapshot(true));                    
-                        }
-                    }
-                    
-                    delete record;
-                }
-            } else {
-                urlsToNotify.append(urls[i]);
-            }
+        urlsToNotify.append(pageURLs[i]);
+
+        // Stop the import at any time of the thread has been asked to shutdown
+        if (shouldStopThreadActivity()) {
+            LOG(IconDatabase, "IconDatabase asked to terminate during performPendingURLImports()");
+            return true;
         }
     }
 
@@ -1365,14 +1320,38 @@ void IconDatabase::performURLImport()
         LOG(IconDatabase, "Notifying icon info known for pageURL %s", urlsToNotify[i].ascii().data());
         dispatchDidImportIconURLForPageURLOnMainThread(urlsToNotify[i]);
         if (shouldStopThreadActivity())
-            return;
+            return true;
     }
-    
-    // Notify the client that the URL import is complete in case it's managing its own pending notifications.
-    dispatchDidFinishURLImportOnMainThread();
-    
-    // Notify all DocumentLoaders that were waiting for an icon load decision on the main thread
+
+    if (iconURLs.isEmpty())
+        return true;
+
+    for (unsigned i = 0; i < iconURLs.size(); ++i) {
+        readySQLiteStatement(m_getTimestampForIconURLStatement, m_syncDB, "SELECT stamp FROM IconInfo WHERE url = (?);");
+        m_getTimestampForIconURLStatement->bindText(1, iconURLs[i]);
+
+        // A time stamp of 0 means the icon isn't on disk
+        int timestamp = 0;
+        int result = m_getTimestampForIconURLStatement->step();
+        if (result == SQLResultRow)
+            timestamp = m_getTimestampForIconURLStatement->getColumnInt(0);
+        else if (result != SQLResultDone)
+            LOG_ERROR("getTimestampForIconURL failed for url %s", urlForLogging(iconURLs[i]).ascii().data());
+        m_getTimestampForIconURLStatement->reset();
+
+        MutexLocker locker(m_urlAndIconLock);
+        IconRecord* icon = m_iconURLToRecordMap.get(iconURLs[i]);
+        if (icon && !icon->getTimestamp())
+            icon->setTimestamp(timestamp);
+
+        MutexLocker readingLocker(m_pendingReadingLock);
+        m_importedIconTimestamps.set(iconURLs[i], timestamp);
+    }
+
+    // Notify the DocumentLoaders that were waiting for an icon load decision on the main thread
     callOnMainThread(notifyPendingLoadDecisionsOnMainThread, this);
+
+    return true;
 }
 
 void IconDatabase::syncThreadMainLoop()
@@ -1417,8 +1396,12 @@ void IconDatabase::syncThreadMainLoop()
             bool didWrite = writeToDatabase();
             if (shouldStopThreadActivity())
                 break;
+
+            bool didImport = performPendingURLImports();
+            if (shouldStopThreadActivity())
+                break;
                 
-            didAnyWork = readFromDatabase();
+            didAnyWork = readFromDatabase() || didImport;
             if (shouldStopThreadActivity())
                 break;
                 
@@ -1701,14 +1684,17 @@ void IconDatabase::pruneUnretainedIcons()
     // This method should only be called once per run
     ASSERT(!m_initialPruningComplete);
 
-    // This method relies on having read in all page URLs from the database earlier.
-    ASSERT(m_iconURLImportComplete);
-
-    // Get the known PageURLs from the db, and record the ID of any that are not in the retain count set.
+    // Page URLs are only read in when someone asks for them, so we can't tell the unretained ones from the
+    // ones nobody asked about yet.  Instead, record the ID of the PageURLs whose icon has not been used for
+    // notUsedIconExpirationTime and that are not in memory.
+    // Note that IconInfo.stamp is only set when the icon data is retrieved from the server (and thus is not updated whether
+    // we use it or not). This works anyway because the IconDatabase downloads icons again if they are older than 4 days,
+    // so if the timestamp goes back in time more than those 30 days we can be sure that the icon was not used at all.
     Vector<int64_t> pageIDsToDelete; 
 
-    SQLiteStatement pageSQL(m_syncDB, "SELECT rowid, url FROM PageURL;");
+    SQLiteStatement pageSQL(m_syncDB, "SELECT PageURL.rowid, PageURL.url FROM PageURL INNER JOIN IconInfo ON PageURL.iconID=IconInfo.iconID WHERE IconInfo.stamp < (?);");
     pageSQL.prepare();
+    pageSQL.bindInt64(1, static_cast<int64_t>(currentTime()) - notUsedIconExpirationTime);
     
     int result;
     while ((result = pageSQL.step()) == SQLResultRow) {
@@ -1721,7 +1707,7 @@ void IconDatabase::pruneUnretainedIcons()
         LOG_ERROR("Error reading PageURL table from on-disk DB");
     pageSQL.finalize();
     
-    // Delete page URLs that were in the table, but not in our retain count set.
+    // Delete page URLs that were in the table, but not in memory.
     size_t numToDelete = pageIDsToDelete.size();
     if (numToDelete) {
         SQLiteTransaction pruningTransaction(m_syncDB);
@@ -1824,6 +1810,8 @@ void IconDatabase::deleteAllPreparedStatements()
     m_removePageURLStatement.clear();
     m_getIconIDForIconURLStatement.clear();
     m_getImageDataForIconURLStatement.clear();
+    m_getIconURLForPageURLStatement.clear();
+    m_getTimestampForIconURLStatement.clear();
     m_addIconToIconInfoStatement.clear();
     m_addIconToIconDataStatement.clear();
     m_getImageDataStatement.clear();
@@ -1868,24 +1856,6 @@ void* IconDatabase::cleanupSyncThread()
     return 0;
 }
 
-// readySQLiteStatement() handles two things
-// 1 - If the SQLDatabase& argument is different, the statement must be destroyed and remade.  This happens when the user
-//     switches to and from private browsing
-// 2 - Lazy construction of the Statement in the first place, in case we've never made this query before
-inline void readySQLiteStatement(OwnPtr<SQLiteStatement>& statement, SQLiteDatabase& db, const String& str)
-{
-    if (statement && (statement->database() != &db || statement->isExpired())) {
-        if (statement->isExpired())
-            LOG(IconDatabase, "SQLiteStatement associated with %s is expired", str.ascii().data());
-        statement.clear();
-    }
-    if (!statement) {
-        statement = adoptPtr(new SQLiteStatement(db, str));
-        if (statement->prepare() != SQLResultOk)
-            LOG_ERROR("Preparing statement %s failed", str.ascii().data());
-    }
-}
-
 void IconDatabase::setIconURLForPageURLInSQLDatabase(const String& iconURL, const String& pageURL)
 {
     ASSERT_ICON_SYNC_THREAD();
@@ -32,6 +32,7 @@
 #include <wtf/HashCountedSet.h>
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
+#include <wtf/ListHashSet.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
@@ -133,7 +134,8 @@ private:
     ThreadIdentifier m_syncThread;
     bool m_syncThreadRunning;
     
-    HashSet<RefPtr<DocumentLoader> > m_loadersPendingDecision;
+    // Maps each loader waiting for a load decision to the icon URL it asked about
+    HashMap<RefPtr<DocumentLoader>, String> m_loadersPendingDecision;
 
     RefPtr<IconRecord> m_defaultIconRecord;
 
@@ -151,6 +153,7 @@ public:
 private:
     PassRefPtr<IconRecord> getOrCreateIconRecord(const String& iconURL);
     PageURLRecord* getOrCreatePageURLRecord(const String& pageURL);
+    void touchDecodedIcon(IconRecord*);
     
     bool m_isEnabled;
     bool m_privateBrowsingEnabled;
@@ -163,7 +166,6 @@ private:
 
     bool m_threadTerminationRequested;
     bool m_removeIconsRequested;
-    bool m_iconURLImportComplete;
     bool m_syncThreadHasWorkToDo;
     bool m_disabledSuddenTerminationForSyncThread;
 
@@ -172,6 +174,8 @@ private:
     HashMap<String, IconRecord*> m_iconURLToRecordMap;
     HashMap<String, PageURLRecord*> m_pageURLToRecordMap;
     HashSet<String> m_retainedPageURLs;
+    // Icons whose image may be decoded, least recently used first
+    ListHashSet<String> m_decodedIconURLs;
 
     Mutex m_pendingSyncLock;
     // Holding m_pendingSyncLock is required when accessing any of the following data structures
@@ -181,6 +185,8 @@ private:
     Mutex m_pendingReadingLock;    
     // Holding m_pendingSyncLock is required when accessing any of the following data structures - when dealing with IconRecord*s, holding m_urlAndIconLock is also required
     HashSet<String> m_pageURLsPendingImport;
+    HashSet<String> m_iconURLsPendingImport;
+    HashMap<String, int> m_importedIconTimestamps;
     HashSet<String> m_pageURLsInterestedInIcons;
     HashSet<IconRecord*> m_iconsPendingReading;
 
@@ -202,7 +208,7 @@ private:
     // Each method should periodically monitor m_threadTerminationRequested when it makes sense to return early on shutdown
     void performOpenInitialization();
     bool checkIntegrity();
-    void performURLImport();
+    bool performPendingURLImports();
     void syncThreadMainLoop();
     bool readFromDatabase();
     bool writeToDatabase();
@@ -245,6 +251,8 @@ private:
     OwnPtr<SQLiteStatement> m_removePageURLStatement;
     OwnPtr<SQLiteStatement> m_getIconIDForIconURLStatement;
     OwnPtr<SQLiteStatement> m_getImageDataForIconURLStatement;
+    OwnPtr<SQLiteStatement> m_getIconURLForPageURLStatement;
+    OwnPtr<SQLiteStatement> m_getTimestampForIconURLStatement;
     OwnPtr<SQLiteStatement> m_addIconToIconInfoStatement;
     OwnPtr<SQLiteStatement> m_addIconToIconDataStatement;
     OwnPtr<SQLiteStatement> m_getImageDataStatement;
@@ -77,6 +77,12 @@ void IconRecord::setImageData(PassRefPtr<SharedBuffer> data)
     m_dataSet = true;
 }
 
+void IconRecord::destroyDecodedImage()
+{
+    if (m_image)
+        m_image->destroyDecodedData();
+}
+
 void IconRecord::loadImageFromResource(const char* resource)
 {
     if (!resource)
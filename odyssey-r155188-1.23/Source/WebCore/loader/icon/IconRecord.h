@@ -86,6 +86,9 @@ public:
         
     void setImageData(PassRefPtr<SharedBuffer> data);
     Image* image(const IntSize&);    
+
+    // Frees the decoded frames but keeps the image data, so the image decodes again when it is next drawn
+    void destroyDecodedImage();
     
     String iconURL() { return m_iconURL; }
 
@@ -36,6 +36,7 @@ namespace WebCore {
 PageURLRecord::PageURLRecord(const String& pageURL)
     : m_pageURL(pageURL)
     , m_retainCount(0)
+    , m_iconURLImported(false)
 {
 }
 
@@ -84,10 +84,15 @@ public:
     }
 
     inline int retainCount() const { return m_retainCount; }
+
+    // True once the sync thread has looked the page URL up in the database
+    bool iconURLImported() const { return m_iconURLImported; }
+    void setIconURLImported() { m_iconURLImported = true; }
 private:
     String m_pageURL;
     RefPtr<IconRecord> m_iconRecord;
     int m_retainCount;
+    bool m_iconURLImported;
 };
 
 }
@@ -1046,14 +1046,13 @@ void Page::removeAllVisitedLinks()
 
 void Page::allVisitedStateChanged(PageGroup* group)
 {
-    ASSERT(group);
     if (!allPages)
         return;
 
     HashSet<Page*>::iterator pagesEnd = allPages->end();
     for (HashSet<Page*>::iterator it = allPages->begin(); it != pagesEnd; ++it) {
         Page* page = *it;
-        if (page->m_group != group)
+        if (group && page->m_group != group)
             continue;
         for (Frame* frame = page->m_mainFrame.get(); frame; frame = frame->tree().traverseNext())
             frame->document()->visitedLinkState().invalidateStyleForAllLinks();
@@ -1062,14 +1061,13 @@ void Page::allVisitedStateChanged(PageGroup* group)
 
 void Page::visitedStateChanged(PageGroup* group, LinkHash linkHash)
 {
-    ASSERT(group);
     if (!allPages)
         return;
 
     HashSet<Page*>::iterator pagesEnd = allPages->end();
     for (HashSet<Page*>::iterator it = allPages->begin(); it != pagesEnd; ++it) {
         Page* page = *it;
-        if (page->m_group != group)
+        if (group && page->m_group != group)
             continue;
         for (Frame* frame = page->m_mainFrame.get(); frame; frame = frame->tree().traverseNext())
             frame->document()->visitedLinkState().invalidateStyleForLink(linkHash);
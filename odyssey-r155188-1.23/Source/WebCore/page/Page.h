@@ -323,6 +323,7 @@ public:
 
     static void removeAllVisitedLinks();
 
+    // A null group stands for the pages of all groups.
     static void allVisitedStateChanged(PageGroup*);
     static void visitedStateChanged(PageGroup*, LinkHash visitedHash);
 
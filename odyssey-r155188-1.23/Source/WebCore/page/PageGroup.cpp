@@ -249,6 +249,11 @@ void PageGroup::removeAllVisitedLinks()
     pageCache()->markPagesForVistedLinkStyleRecalc();
 }
 
+bool PageGroup::isTrackingVisitedLinks()
+{
+    return shouldTrackVisitedLinks;
+}
+
 void PageGroup::setShouldTrackVisitedLinks(bool shouldTrack)
 {
     if (shouldTrackVisitedLinks == shouldTrack)
@@ -79,6 +79,7 @@ namespace WebCore {
         void removeVisitedLinks();
 
         static void setShouldTrackVisitedLinks(bool);
+        static bool isTrackingVisitedLinks();
         static void removeAllVisitedLinks();
 
         const String& name() { return m_name; }
@@ -133,7 +133,17 @@ String StorageAreaImpl::key(unsigned index)
 String StorageAreaImpl::item(const String& key)
 {
     ASSERT(!m_isShutdown);
-    blockUntilImportComplete();
+
+    // While the import runs, an item is either among those imported so far or looked up in the
+    // database, so that the first script to read an item does not wait for the whole origin.
+    if (m_storageAreaSync && !m_storageAreaSync->deliverImportedItems()) {
+        String value = m_storageMap->getItem(key);
+        if (!value.isNull())
+            return value;
+        if (m_storageAreaSync->lookUpItem(key, value))
+            return value;
+        blockUntilImportComplete();
+    }
 
     return m_storageMap->getItem(key);
 }
@@ -200,13 +210,14 @@ void StorageAreaImpl::clear(Frame* sourceFrame)
 bool StorageAreaImpl::contains(const String& key)
 {
     ASSERT(!m_isShutdown);
-    blockUntilImportComplete();
 
-    return m_storageMap->contains(key);
+    // Values are never null.
+    return !item(key).isNull();
 }
 
 void StorageAreaImpl::importItems(const HashMap<String, String>& items)
 {
+    ASSERT(isMainThread());
     ASSERT(!m_isShutdown);
 
     m_storageMap->importItems(items);
@@ -36,6 +36,7 @@
 #include "StorageAreaImpl.h"
 #include "StorageSyncManager.h"
 #include "StorageTracker.h"
+#include "StorageUsageIndex.h"
 #include "SuddenTermination.h"
 #include <wtf/Functional.h>
 #include <wtf/MainThread.h>
@@ -51,6 +52,9 @@ static const double StorageSyncInterval = 1.0;
 // much harder to starve the rest of LocalStorage and the OS's IO subsystem in general.
 static const int MaxiumItemsToSync = 100;
 
+// The import hands the items it has read to the main thread in chunks of this many items.
+static const int ImportChunkSize = 256;
+
 inline StorageAreaSync::StorageAreaSync(PassRefPtr<StorageSyncManager> storageSyncManager, PassRefPtr<StorageAreaImpl> storageArea, const String& databaseIdentifier)
     : m_syncTimer(this, &StorageAreaSync::syncTimerFired)
     , m_itemsCleared(false)
@@ -265,6 +269,8 @@ void StorageAreaSync::openDatabase(OpenDatabaseParamType openingStrategy)
     }
 
     StorageTracker::tracker().setOriginDetails(m_databaseIdentifier, databaseFilename);
+    StorageUsageIndex::index().noteOriginUsed(m_databaseIdentifier);
+    m_databaseFilename = databaseFilename;
 }
 
 void StorageAreaSync::migrateItemTableIfNeeded()
@@ -333,6 +339,8 @@ void StorageAreaSync::performImport()
     int result = query.step();
     while (result == SQLResultRow) {
         itemMap.set(query.getColumnText(0), query.getColumnBlobAsString(1));
+        if (itemMap.size() >= ImportChunkSize)
+            addImportedItems(itemMap);
         result = query.step();
     }
 
@@ -342,25 +350,124 @@ void StorageAreaSync::performImport()
         return;
     }
 
-    m_storageArea->importItems(itemMap);
+    addImportedItems(itemMap);
 
     markImported();
 }
 
+void StorageAreaSync::addImportedItems(HashMap<String, String>& items)
+{
+    ASSERT(!isMainThread());
+    if (items.isEmpty())
+        return;
+
+    bool shouldSchedule;
+    {
+        MutexLocker locker(m_importLock);
+        shouldSchedule = m_importedItems.isEmpty();
+        if (shouldSchedule)
+            m_importedItems.swap(items);
+        else {
+            HashMap<String, String>::const_iterator end = items.end();
+            for (HashMap<String, String>::const_iterator it = items.begin(); it != end; ++it)
+                m_importedItems.set(it->key, it->value);
+            // The strings are shared with m_importedItems now. Drop our references before the
+            // main thread can take them, since StringImpl reference counts are not atomic.
+            items.clear();
+        }
+    }
+
+    if (shouldSchedule)
+        scheduleDeliverImportedItems();
+}
+
 void StorageAreaSync::markImported()
 {
-    MutexLocker locker(m_importLock);
-    m_importComplete = true;
-    m_importCondition.signal();
+    {
+        MutexLocker locker(m_importLock);
+        m_importComplete = true;
+        m_importCondition.signal();
+    }
+    scheduleDeliverImportedItems();
+}
+
+void StorageAreaSync::scheduleDeliverImportedItems()
+{
+    // Balanced in deliverImportedItemsOnMainThread().
+    ref();
+    callOnMainThread(deliverImportedItemsOnMainThread, this);
+}
+
+void StorageAreaSync::deliverImportedItemsOnMainThread(void* context)
+{
+    StorageAreaSync* storageAreaSync = static_cast<StorageAreaSync*>(context);
+    storageAreaSync->deliverImportedItems();
+    storageAreaSync->deref();
 }
 
-// FIXME: In the future, we should allow use of StorageAreas while it's importing (when safe to do so).
-// Blocking everything until the import is complete is by far the simplest and safest thing to do, but
-// there is certainly room for safe optimization: Key/length will never be able to make use of such an
-// optimization (since the order of iteration can change as items are being added). Get can return any
-// item currently in the map. Get/remove can work whether or not it's in the map, but we'll need a list
-// of items the import should not overwrite. Clear can also work, but it'll need to kill the import
-// job first.
+bool StorageAreaSync::deliverImportedItems()
+{
+    ASSERT(isMainThread());
+
+    // We set m_storageArea to 0 only after all items have been handed over.
+    if (!m_storageArea)
+        return true;
+
+    HashMap<String, String> items;
+    bool importComplete;
+    {
+        MutexLocker locker(m_importLock);
+        m_importedItems.swap(items);
+        importComplete = m_importComplete;
+    }
+
+    RefPtr<StorageAreaImpl> storageArea = m_storageArea;
+    if (!items.isEmpty())
+        storageArea->importItems(items);
+
+    if (importComplete) {
+        m_storageArea = 0;
+        m_lookupDatabase.close();
+    }
+    return importComplete;
+}
+
+bool StorageAreaSync::lookUpItem(const String& key, String& value)
+{
+    ASSERT(isMainThread());
+
+    if (!m_lookupDatabase.isOpen()) {
+        String databaseFilename = m_syncManager->fullDatabaseFilename(m_databaseIdentifier);
+        if (databaseFilename.isEmpty())
+            return false;
+        if (!fileExists(databaseFilename)) {
+            value = String();
+            return true;
+        }
+        if (!m_lookupDatabase.open(databaseFilename))
+            return false;
+    }
+
+    // The key is unique, so this is a single index lookup. A table that has yet to be
+    // migrated, or one that is locked by the import, is left to the import.
+    SQLiteStatement query(m_lookupDatabase, "SELECT value FROM ItemTable WHERE key=?");
+    if (query.prepare() != SQLResultOk || !query.isColumnDeclaredAsBlob(0) || query.bindText(1, key) != SQLResultOk)
+        return false;
+
+    int result = query.step();
+    if (result == SQLResultDone) {
+        value = String();
+        return true;
+    }
+    if (result != SQLResultRow)
+        return false;
+    value = query.getColumnBlobAsString(0);
+    return true;
+}
+
+// Key and length can only be answered once all items are imported, and writes wait for the
+// import as well, so that the import never has to merge with changes made meanwhile. Reading
+// a single item does not wait, see StorageAreaImpl::item().
 void StorageAreaSync::blockUntilImportComplete()
 {
     ASSERT(isMainThread());
@@ -369,10 +476,13 @@ void StorageAreaSync::blockUntilImportComplete()
     if (!m_storageArea)
         return;
 
-    MutexLocker locker(m_importLock);
-    while (!m_importComplete)
-        m_importCondition.wait(m_importLock);
-    m_storageArea = 0;
+    {
+        MutexLocker locker(m_importLock);
+        while (!m_importComplete)
+            m_importCondition.wait(m_importLock);
+    }
+    deliverImportedItems();
+    ASSERT(!m_storageArea);
 }
 
 void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items)
@@ -453,6 +563,8 @@ void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items
         query.reset();
     }
     transaction.commit();
+
+    StorageUsageIndex::index().scheduleUsageUpdate(StorageUsageIndex::LocalStorage, m_databaseIdentifier, m_databaseFilename);
 }
 
 void StorageAreaSync::performSync()
@@ -515,6 +627,7 @@ void StorageAreaSync::deleteEmptyDatabase()
             if (!SQLiteFileSystem::deleteDatabaseFile(databaseFilename))
                 LOG_ERROR("Failed to delete database file %s\n", databaseFilename.utf8().data());
         }
+        StorageUsageIndex::index().setUsage(StorageUsageIndex::LocalStorage, m_databaseIdentifier, 0);
     }
 }
 
@@ -45,6 +45,13 @@ public:
     void scheduleFinalSync();
     void blockUntilImportComplete();
 
+    // The import hands the items to the storage area in chunks, on the main thread.
+    // deliverImportedItems() hands over the items read so far and returns true once all
+    // items have been handed over. Until then, lookUpItem() reads a single item straight
+    // from the database; it returns false if it could not, and the caller has to block.
+    bool deliverImportedItems();
+    bool lookUpItem(const String& key, String& value);
+
     void scheduleItemForSync(const String& key, const String& value);
     void scheduleClear();
     void scheduleCloseDatabase();
@@ -67,6 +74,10 @@ private:
 
     // The database handle will only ever be opened and used on the background thread.
     SQLiteDatabase m_database;
+    String m_databaseFilename;
+
+    // Used on the main thread by lookUpItem() while the import runs.
+    SQLiteDatabase m_lookupDatabase;
 
     // The following members are subject to thread synchronization issues.
 public:
@@ -99,7 +110,11 @@ private:
     mutable Mutex m_importLock;
     mutable ThreadCondition m_importCondition;
     mutable bool m_importComplete;
+    HashMap<String, String> m_importedItems;
+    void addImportedItems(HashMap<String, String>&);
     void markImported();
+    void scheduleDeliverImportedItems();
+    static void deliverImportedItemsOnMainThread(void*);
     void migrateItemTableIfNeeded();
 };
 
@@ -36,8 +36,9 @@ PassRefPtr<StorageMap> StorageMap::create(unsigned quota)
 }
 
 StorageMap::StorageMap(unsigned quota)
-    : m_iterator(m_map.end())
-    , m_iteratorIndex(UINT_MAX)
+    : m_tombstoneCount(0)
+    , m_cursorIndex(0)
+    , m_cursorPosition(0)
     , m_quotaSize(quota)  // quota measured in bytes
     , m_currentLength(0)
 {
@@ -46,43 +47,99 @@ StorageMap::StorageMap(unsigned quota)
 PassRefPtr<StorageMap> StorageMap::copy()
 {
     RefPtr<StorageMap> newMap = create(m_quotaSize);
-    newMap->m_map = m_map;
+    newMap->m_entries.reserveInitialCapacity(length());
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (!m_entries[i].key.isNull())
+            newMap->appendEntry(m_entries[i].key, m_entries[i].value);
+    }
     newMap->m_currentLength = m_currentLength;
     return newMap.release();
 }
 
-void StorageMap::invalidateIterator()
+void StorageMap::appendEntry(const String& key, const String& value)
 {
-    m_iterator = m_map.end();
-    m_iteratorIndex = UINT_MAX;
+    // The cursor stays valid: if it was at the end, it now points at the new entry, whose index is the old length.
+    HashMap<String, unsigned>::AddResult result = m_positions.add(key, m_entries.size());
+    ASSERT_UNUSED(result, result.isNewEntry);
+    m_entries.append(Entry(key, value));
 }
 
-void StorageMap::setIteratorToIndex(unsigned index)
+void StorageMap::removeEntryAt(unsigned position)
 {
-    // FIXME: Once we have bidirectional iterators for HashMap we can be more intelligent about this.
-    // The requested index will be closest to begin(), our current iterator, or end(), and we
-    // can take the shortest route.
-    // Until that mechanism is available, we'll always increment our iterator from begin() or current.
-
-    if (m_iteratorIndex == index)
-        return;
-
-    if (index < m_iteratorIndex) {
-        m_iteratorIndex = 0;
-        m_iterator = m_map.begin();
-        ASSERT(m_iterator != m_map.end());
+    ASSERT(!m_entries[position].key.isNull());
+    m_entries[position] = Entry();
+    ++m_tombstoneCount;
+
+    if (m_cursorPosition > position)
+        --m_cursorIndex;
+    else if (m_cursorPosition == position) {
+        // The next remaining item takes the removed item's index.
+        do
+            ++m_cursorPosition;
+        while (m_cursorPosition < m_entries.size() && m_entries[m_cursorPosition].key.isNull());
     }
 
-    while (m_iteratorIndex < index) {
-        ++m_iteratorIndex;
-        ++m_iterator;
-        ASSERT(m_iterator != m_map.end());
+    // Compacting costs at most twice the number of tombstones, which keeps removal amortized constant time.
+    if (m_tombstoneCount > length())
+        compact();
+}
+
+void StorageMap::compact()
+{
+    unsigned position = 0;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].key.isNull())
+            continue;
+        if (i != position) {
+            m_entries[position] = m_entries[i];
+            m_positions.find(m_entries[position].key)->value = position;
+        }
+        ++position;
     }
+    m_entries.shrink(position);
+    m_tombstoneCount = 0;
+    m_cursorIndex = 0;
+    m_cursorPosition = 0;
+}
+
+unsigned StorageMap::positionOfIndex(unsigned index)
+{
+    ASSERT(index < length());
+    if (!m_tombstoneCount)
+        return index;
+
+    // Start from whichever of the first item, the cursor or the last item is closest.
+    unsigned lastIndex = length() - 1;
+    if (index < m_cursorIndex && index < m_cursorIndex - index) {
+        m_cursorIndex = 0;
+        m_cursorPosition = 0;
+        while (m_entries[m_cursorPosition].key.isNull())
+            ++m_cursorPosition;
+    } else if (index > m_cursorIndex && lastIndex - index < index - m_cursorIndex) {
+        m_cursorIndex = lastIndex;
+        m_cursorPosition = m_entries.size() - 1;
+        while (m_entries[m_cursorPosition].key.isNull())
+            --m_cursorPosition;
+    }
+
+    while (m_cursorIndex < index) {
+        ++m_cursorIndex;
+        do
+            ++m_cursorPosition;
+        while (m_entries[m_cursorPosition].key.isNull());
+    }
+    while (m_cursorIndex > index) {
+        --m_cursorIndex;
+        do
+            --m_cursorPosition;
+        while (m_entries[m_cursorPosition].key.isNull());
+    }
+    return m_cursorPosition;
 }
 
 unsigned StorageMap::length() const
 {
-    return m_map.size();
+    return m_positions.size();
 }
 
 String StorageMap::key(unsigned index)
@@ -90,13 +147,15 @@ String StorageMap::key(unsigned index)
     if (index >= length())
         return String();
 
-    setIteratorToIndex(index);
-    return m_iterator->key;
+    return m_entries[positionOfIndex(index)].key;
 }
 
 String StorageMap::getItem(const String& key) const
 {
-    return m_map.get(key);
+    HashMap<String, unsigned>::const_iterator it = m_positions.find(key);
+    if (it == m_positions.end())
+        return String();
+    return m_entries[it->value].value;
 }
 
 PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& value, String& oldValue, bool& quotaException)
@@ -117,7 +176,8 @@ PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& valu
     bool overflow = newLength + value.length() < newLength;
     newLength += value.length();
 
-    oldValue = m_map.get(key);
+    HashMap<String, unsigned>::iterator position = m_positions.find(key);
+    oldValue = position == m_positions.end() ? String() : m_entries[position->value].value;
     overflow |= newLength - oldValue.length() > newLength;
     newLength -= oldValue.length();
 
@@ -133,11 +193,10 @@ PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& valu
     }
     m_currentLength = newLength;
 
-    HashMap<String, String>::AddResult addResult = m_map.add(key, value);
-    if (!addResult.isNewEntry)
-        addResult.iterator->value = value;
-
-    invalidateIterator();
+    if (position == m_positions.end())
+        appendEntry(key, value);
+    else
+        m_entries[position->value].value = value;
 
     return 0;
 }
@@ -165,9 +224,14 @@ PassRefPtr<StorageMap> StorageMap::removeItem(const String& key, String& oldValu
         return newStorage.release();
     }
 
-    oldValue = m_map.take(key);
-    if (!oldValue.isNull()) {
-        invalidateIterator();
+    HashMap<String, unsigned>::iterator position = m_positions.find(key);
+    if (position == m_positions.end())
+        oldValue = String();
+    else {
+        unsigned entryPosition = position->value;
+        m_positions.remove(position);
+        oldValue = m_entries[entryPosition].value;
+        removeEntryAt(entryPosition);
         ASSERT(m_currentLength - key.length() <= m_currentLength);
         m_currentLength -= key.length();
     }
@@ -179,17 +243,18 @@ PassRefPtr<StorageMap> StorageMap::removeItem(const String& key, String& oldValu
 
 bool StorageMap::contains(const String& key) const
 {
-    return m_map.contains(key);
+    return m_positions.contains(key);
 }
 
 void StorageMap::importItems(const HashMap<String, String>& items)
 {
+    // Local storage hands the imported items over in chunks while the map is in use. They are
+    // appended, so the indices key() has already handed out stay valid.
     for (HashMap<String, String>::const_iterator it = items.begin(), end = items.end(); it != end; ++it) {
         const String& key = it->key;
         const String& value = it->value;
 
-        HashMap<String, String>::AddResult result = m_map.add(key, value);
-        ASSERT_UNUSED(result, result.isNewEntry); // True if the key didn't exist previously.
+        appendEntry(key, value);
 
         ASSERT(m_currentLength + key.length() >= m_currentLength);
         m_currentLength += key.length();
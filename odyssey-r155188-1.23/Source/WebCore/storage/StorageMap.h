@@ -29,6 +29,7 @@
 #include <wtf/HashMap.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
 #include <wtf/text/StringHash.h>
 #include <wtf/text/WTFString.h>
 
@@ -49,21 +50,42 @@ public:
     bool contains(const String& key) const;
 
     void importItems(const HashMap<String, String>&);
-    const HashMap<String, String>& items() const { return m_map; }
 
     unsigned quota() const { return m_quotaSize; }
 
     static const unsigned noQuota = UINT_MAX;
 
 private:
+    struct Entry {
+        Entry() { }
+        Entry(const String& key, const String& value)
+            : key(key)
+            , value(value)
+        {
+        }
+
+        String key; // Null once the item has been removed.
+        String value;
+    };
+
     explicit StorageMap(unsigned quota);
     PassRefPtr<StorageMap> copy();
-    void invalidateIterator();
-    void setIteratorToIndex(unsigned);
+    void appendEntry(const String& key, const String& value);
+    void removeEntryAt(unsigned position);
+    unsigned positionOfIndex(unsigned);
+    void compact();
+
+    // The items in insertion order, so that key() can index them directly. Removed items are
+    // left in place as tombstones until they outnumber the remaining ones.
+    Vector<Entry> m_entries;
+    HashMap<String, unsigned> m_positions;
+    unsigned m_tombstoneCount;
 
-    HashMap<String, String> m_map;
-    HashMap<String, String>::iterator m_iterator;
-    unsigned m_iteratorIndex;
+    // The position in m_entries of the item with index m_cursorIndex, or m_entries.size() if
+    // that index is length(). It keeps walking key() forwards or backwards constant time while
+    // there are tombstones.
+    unsigned m_cursorIndex;
+    unsigned m_cursorPosition;
 
     unsigned m_quotaSize; // Measured in bytes.
     unsigned m_currentLength; // Measured in UChars.
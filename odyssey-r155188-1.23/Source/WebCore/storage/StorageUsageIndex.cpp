@@ -0,0 +1,424 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "StorageUsageIndex.h"
+
+#include "ApplicationCache.h"
+#include "ApplicationCacheStorage.h"
+#include "FileSystem.h"
+#include "Logging.h"
+#include "SQLiteFileSystem.h"
+#include "SecurityOrigin.h"
+#include "StorageTracker.h"
+#include <algorithm>
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/text/CString.h>
+
+#if ENABLE(SQL_DATABASE)
+#include "DatabaseManager.h"
+#include "DatabaseTracker.h"
+#endif
+
+namespace WebCore {
+
+StorageUsageIndex& StorageUsageIndex::index()
+{
+    AtomicallyInitializedStatic(StorageUsageIndex&, index = *new StorageUsageIndex);
+    return index;
+}
+
+StorageUsageIndex::StorageUsageIndex()
+    : m_threadID(0)
+    , m_totalUsage(0)
+    , m_budget(noBudget())
+    , m_evictionScheduled(false)
+    , m_needsDatabaseOriginScan(false)
+    , m_needsLocalStorageOriginScan(false)
+{
+}
+
+void StorageUsageIndex::initialize()
+{
+    ASSERT(isMainThread());
+
+    {
+        MutexLocker locker(m_mutex);
+#if ENABLE(SQL_DATABASE)
+        m_needsDatabaseOriginScan = true;
+#endif
+        if (!m_threadID)
+            m_threadID = createThread(StorageUsageIndex::indexThreadStart, this, "[OWB] WebCore: StorageUsageIndex");
+        m_condition.signal();
+    }
+
+    if (StorageTracker::tracker().isActive())
+        setLocalStorageDirectoryPath(StorageTracker::tracker().databaseDirectoryPath());
+
+    // The application cache keeps the size of its caches in its database.
+    cacheStorage().updateUsageIndex();
+}
+
+void StorageUsageIndex::setLocalStorageDirectoryPath(const String& path)
+{
+    MutexLocker locker(m_mutex);
+    if (path.isEmpty() || path == m_localStorageDirectoryPath)
+        return;
+
+    m_localStorageDirectoryPath = path.isolatedCopy();
+    m_needsLocalStorageOriginScan = true;
+    if (!m_threadID)
+        m_threadID = createThread(StorageUsageIndex::indexThreadStart, this, "[OWB] WebCore: StorageUsageIndex");
+    m_condition.signal();
+}
+
+void StorageUsageIndex::scheduleUsageUpdate(StorageType type, const String& originIdentifier, const String& path)
+{
+    ASSERT(type != ApplicationCache);
+
+    MutexLocker locker(m_mutex);
+    m_pendingUpdates[type].set(originIdentifier.isolatedCopy(), path.isolatedCopy());
+    if (!m_threadID)
+        m_threadID = createThread(StorageUsageIndex::indexThreadStart, this, "[OWB] WebCore: StorageUsageIndex");
+    m_condition.signal();
+}
+
+void StorageUsageIndex::setUsage(StorageType type, const String& originIdentifier, unsigned long long usage)
+{
+    MutexLocker locker(m_mutex);
+    setUsageNoLock(type, originIdentifier, usage, String());
+    scheduleEvictionIfNeededNoLock();
+}
+
+void StorageUsageIndex::setUsageOfAllOrigins(StorageType type, const HashMap<String, unsigned long long>& usageByOrigin)
+{
+    MutexLocker locker(m_mutex);
+
+    Vector<String> originsWithoutUsage;
+    for (OriginUsageMap::iterator it = m_origins.begin(), end = m_origins.end(); it != end; ++it) {
+        if (it->value.usage[type] && !usageByOrigin.contains(it->key))
+            originsWithoutUsage.append(it->key);
+    }
+    for (size_t i = 0; i < originsWithoutUsage.size(); ++i)
+        setUsageNoLock(type, originsWithoutUsage[i], 0, String());
+
+    for (HashMap<String, unsigned long long>::const_iterator it = usageByOrigin.begin(), end = usageByOrigin.end(); it != end; ++it)
+        setUsageNoLock(type, it->key, it->value, String());
+    scheduleEvictionIfNeededNoLock();
+}
+
+void StorageUsageIndex::setUsageNoLock(StorageType type, const String& originIdentifier, unsigned long long usage, const String& path)
+{
+    ASSERT(!m_mutex.tryLock());
+
+    OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+    if (it == m_origins.end()) {
+        if (!usage)
+            return;
+        it = m_origins.add(originIdentifier.isolatedCopy(), OriginUsage()).iterator;
+    }
+
+    OriginUsage& originUsage = it->value;
+    ASSERT(m_totalUsage >= originUsage.usage[type]);
+    m_totalUsage += usage - originUsage.usage[type];
+    originUsage.usage[type] = usage;
+    originUsage.isMeasured[type] = true;
+    if (!path.isEmpty())
+        originUsage.path[type] = path;
+
+    if (originUsage.isInUse)
+        return;
+    for (int i = 0; i < StorageTypeCount; ++i) {
+        if (originUsage.usage[i])
+            return;
+    }
+    m_origins.remove(it);
+}
+
+void StorageUsageIndex::noteOriginUsed(const String& originIdentifier)
+{
+    MutexLocker locker(m_mutex);
+    OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+    if (it == m_origins.end())
+        it = m_origins.add(originIdentifier.isolatedCopy(), OriginUsage()).iterator;
+    it->value.lastUsedTime = currentTime();
+    it->value.isInUse = true;
+}
+
+bool StorageUsageIndex::usage(StorageType type, const String& originIdentifier, unsigned long long& usage)
+{
+    MutexLocker locker(m_mutex);
+    OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+    if (it == m_origins.end() || !it->value.isMeasured[type])
+        return false;
+    usage = it->value.usage[type];
+    return true;
+}
+
+unsigned long long StorageUsageIndex::usageForOrigin(const String& originIdentifier)
+{
+    MutexLocker locker(m_mutex);
+    OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+    if (it == m_origins.end())
+        return 0;
+
+    unsigned long long usage = 0;
+    for (int i = 0; i < StorageTypeCount; ++i)
+        usage += it->value.usage[i];
+    return usage;
+}
+
+unsigned long long StorageUsageIndex::totalUsage()
+{
+    MutexLocker locker(m_mutex);
+    return m_totalUsage;
+}
+
+static bool lessRecentlyUsed(const std::pair<double, String>& a, const std::pair<double, String>& b)
+{
+    return a.first < b.first;
+}
+
+void StorageUsageIndex::originIdentifiers(Vector<String>& result)
+{
+    Vector<std::pair<double, String> > origins;
+    {
+        MutexLocker locker(m_mutex);
+        origins.reserveInitialCapacity(m_origins.size());
+        for (OriginUsageMap::iterator it = m_origins.begin(), end = m_origins.end(); it != end; ++it)
+            origins.append(std::make_pair(it->value.lastUsedTime, it->key.isolatedCopy()));
+    }
+    std::sort(origins.begin(), origins.end(), lessRecentlyUsed);
+
+    result.reserveCapacity(result.size() + origins.size());
+    for (size_t i = 0; i < origins.size(); ++i)
+        result.append(origins[i].second);
+}
+
+double StorageUsageIndex::lastUsedTime(const String& originIdentifier)
+{
+    MutexLocker locker(m_mutex);
+    OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+    return it == m_origins.end() ? 0 : it->value.lastUsedTime;
+}
+
+void StorageUsageIndex::setBudget(unsigned long long budget)
+{
+    MutexLocker locker(m_mutex);
+    m_budget = budget;
+    scheduleEvictionIfNeededNoLock();
+}
+
+unsigned long long StorageUsageIndex::budget()
+{
+    MutexLocker locker(m_mutex);
+    return m_budget;
+}
+
+void StorageUsageIndex::scheduleEvictionIfNeededNoLock()
+{
+    ASSERT(!m_mutex.tryLock());
+    if (m_totalUsage <= m_budget || m_evictionScheduled)
+        return;
+
+    m_evictionScheduled = true;
+    callOnMainThread(StorageUsageIndex::evictOriginsOverBudget, this);
+}
+
+// Returns the size of the local storage file or of the databases in the directory of an origin, and the time the
+// latest of them was modified.
+static unsigned long long measureUsage(StorageUsageIndex::StorageType type, const String& path, time_t& lastModificationTime)
+{
+    Vector<String> fileNames;
+    if (type == StorageUsageIndex::Database)
+        fileNames = listDirectory(path, String("*.db"));
+    else
+        fileNames.append(path);
+
+    unsigned long long usage = 0;
+    lastModificationTime = 0;
+    for (size_t i = 0; i < fileNames.size(); ++i) {
+        long long size;
+        if (!getFileSize(fileNames[i], size))
+            continue;
+        usage += size;
+
+        time_t modificationTime;
+        if (getFileModificationTime(fileNames[i], modificationTime))
+            lastModificationTime = std::max(lastModificationTime, modificationTime);
+    }
+    return usage;
+}
+
+void StorageUsageIndex::indexThreadStart(void* index)
+{
+    static_cast<StorageUsageIndex*>(index)->indexThreadBody();
+}
+
+void StorageUsageIndex::indexThreadBody()
+{
+    MutexLocker locker(m_mutex);
+    while (true) {
+#if ENABLE(SQL_DATABASE)
+        if (m_needsDatabaseOriginScan) {
+            m_needsDatabaseOriginScan = false;
+            m_mutex.unlock();
+            measureDatabaseOrigins();
+            m_mutex.lock();
+        }
+#endif
+        if (m_needsLocalStorageOriginScan) {
+            m_needsLocalStorageOriginScan = false;
+            String directoryPath = m_localStorageDirectoryPath.isolatedCopy();
+            m_mutex.unlock();
+            measureLocalStorageOrigins(directoryPath);
+            m_mutex.lock();
+        }
+
+        PendingUpdateMap updates[StorageTypeCount];
+        bool hasUpdates = false;
+        for (int i = 0; i < StorageTypeCount; ++i) {
+            updates[i].swap(m_pendingUpdates[i]);
+            hasUpdates |= !updates[i].isEmpty();
+        }
+        if (!hasUpdates) {
+            m_condition.wait(m_mutex);
+            continue;
+        }
+
+        for (int i = 0; i < StorageTypeCount; ++i) {
+            StorageType type = static_cast<StorageType>(i);
+            for (PendingUpdateMap::iterator it = updates[i].begin(), end = updates[i].end(); it != end; ++it) {
+                m_mutex.unlock();
+                time_t lastModificationTime;
+                unsigned long long usage = measureUsage(type, it->value, lastModificationTime);
+                m_mutex.lock();
+
+                setUsageNoLock(type, it->key, usage, it->value);
+                // Until an origin is used, the files tell when it was last used.
+                OriginUsageMap::iterator origin = m_origins.find(it->key);
+                if (origin != m_origins.end() && !origin->value.isInUse)
+                    origin->value.lastUsedTime = std::max(origin->value.lastUsedTime, static_cast<double>(lastModificationTime));
+            }
+        }
+        scheduleEvictionIfNeededNoLock();
+    }
+}
+
+#if ENABLE(SQL_DATABASE)
+void StorageUsageIndex::measureDatabaseOrigins()
+{
+    ASSERT(!isMainThread());
+
+    Vector<RefPtr<SecurityOrigin> > origins;
+    DatabaseTracker::tracker().origins(origins);
+
+    for (size_t i = 0; i < origins.size(); ++i) {
+        String path = SQLiteFileSystem::appendDatabaseFileNameToPath(DatabaseTracker::tracker().databaseDirectoryPath(), origins[i]->databaseIdentifier());
+        MutexLocker locker(m_mutex);
+        m_pendingUpdates[Database].add(origins[i]->databaseIdentifier().isolatedCopy(), path.isolatedCopy());
+    }
+}
+#endif
+
+// Local storage files are named after the database identifier of their origin, see StorageSyncManager.
+void StorageUsageIndex::measureLocalStorageOrigins(const String& directoryPath)
+{
+    ASSERT(!isMainThread());
+
+    static const char fileExtension[] = ".localstorage";
+    static const unsigned fileExtensionLength = sizeof(fileExtension) - 1;
+    Vector<String> paths = listDirectory(directoryPath, String("*") + fileExtension);
+
+    MutexLocker locker(m_mutex);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        String fileName = pathGetFileName(paths[i]);
+        if (fileName.length() <= fileExtensionLength || !fileName.endsWith(fileExtension, false))
+            continue;
+        String originIdentifier = fileName.substring(0, fileName.length() - fileExtensionLength);
+        // An update the storage area scheduled in the meantime measures the same file.
+        m_pendingUpdates[LocalStorage].add(originIdentifier.isolatedCopy(), paths[i].isolatedCopy());
+    }
+}
+
+void StorageUsageIndex::evictOriginsOverBudget(void* index)
+{
+    static_cast<StorageUsageIndex*>(index)->evictOriginsOverBudget();
+}
+
+void StorageUsageIndex::evictOriginsOverBudget()
+{
+    ASSERT(isMainThread());
+
+    // Origins used since the browser started may have open databases and storage areas, they are never evicted.
+    Vector<std::pair<double, String> > candidates;
+    unsigned long long usageOverBudget;
+    {
+        MutexLocker locker(m_mutex);
+        m_evictionScheduled = false;
+        if (m_totalUsage <= m_budget)
+            return;
+
+        usageOverBudget = m_totalUsage - m_budget;
+        for (OriginUsageMap::iterator it = m_origins.begin(), end = m_origins.end(); it != end; ++it) {
+            if (!it->value.isInUse)
+                candidates.append(std::make_pair(it->value.lastUsedTime, it->key));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), lessRecentlyUsed);
+
+    for (size_t i = 0; i < candidates.size() && usageOverBudget; ++i) {
+        const String& originIdentifier = candidates[i].second;
+        unsigned long long originUsage = 0;
+        String localStoragePath;
+        {
+            MutexLocker locker(m_mutex);
+            OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+            if (it == m_origins.end() || it->value.isInUse)
+                continue;
+            for (int type = 0; type < StorageTypeCount; ++type)
+                originUsage += it->value.usage[type];
+            localStoragePath = it->value.path[LocalStorage];
+        }
+
+        LOG(StorageAPI, "Evicting the storage of %s, %llu bytes over the budget", originIdentifier.ascii().data(), usageOverBudget);
+
+        RefPtr<SecurityOrigin> origin = SecurityOrigin::createFromDatabaseIdentifier(originIdentifier);
+#if ENABLE(SQL_DATABASE)
+        DatabaseManager::manager().deleteOrigin(origin.get());
+#endif
+        if (StorageTracker::tracker().isActive())
+            StorageTracker::tracker().deleteOrigin(origin.get());
+        else if (!localStoragePath.isEmpty())
+            SQLiteFileSystem::deleteDatabaseFile(localStoragePath);
+        ApplicationCache::deleteCacheForOrigin(origin.get());
+
+        {
+            MutexLocker locker(m_mutex);
+            OriginUsageMap::iterator it = m_origins.find(originIdentifier);
+            if (it != m_origins.end() && !it->value.isInUse) {
+                for (int type = 0; type < StorageTypeCount; ++type)
+                    m_totalUsage -= it->value.usage[type];
+                m_origins.remove(it);
+            }
+        }
+        usageOverBudget = originUsage < usageOverBudget ? usageOverBudget - originUsage : 0;
+    }
+}
+
+} // namespace WebCore
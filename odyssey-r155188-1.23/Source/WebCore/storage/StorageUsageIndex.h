@@ -0,0 +1,126 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef StorageUsageIndex_h
+#define StorageUsageIndex_h
+
+#include <limits>
+#include <wtf/HashMap.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// Disk usage of web SQL databases, local storage and the application cache, by origin. The trackers report
+// which files changed and the files are measured on the index thread, so looking up the usage of an origin
+// does not touch the disk. When the usage of all origins goes over the budget, the least recently used
+// origins that were not used since the browser started are deleted.
+class StorageUsageIndex {
+    WTF_MAKE_NONCOPYABLE(StorageUsageIndex); WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum StorageType {
+        Database,
+        LocalStorage,
+        ApplicationCache,
+        StorageTypeCount
+    };
+
+    static StorageUsageIndex& index();
+
+    static unsigned long long noBudget() { return std::numeric_limits<unsigned long long>::max(); }
+
+    // Measures the usage of the origins that already have storage. Must be called on the main thread,
+    // after the database tracker and the application cache storage are set up.
+    void initialize();
+    // Measures the local storage files in the directory, once for each directory it is given. Local storage
+    // is only opened when a page uses it, so without this the origins that are not visited would not count.
+    void setLocalStorageDirectoryPath(const String&);
+
+    // These can be called from any thread. For databases, the path is the directory of the origin.
+    void scheduleUsageUpdate(StorageType, const String& originIdentifier, const String& path);
+    void setUsage(StorageType, const String& originIdentifier, unsigned long long usage);
+    // Origins that are not in the map no longer use this type of storage.
+    void setUsageOfAllOrigins(StorageType, const HashMap<String, unsigned long long>&);
+    void noteOriginUsed(const String& originIdentifier);
+
+    // Returns false if the usage of this type of storage was never measured for the origin.
+    bool usage(StorageType, const String& originIdentifier, unsigned long long& usage);
+    unsigned long long usageForOrigin(const String& originIdentifier);
+    unsigned long long totalUsage();
+
+    // Least recently used first.
+    void originIdentifiers(Vector<String>&);
+    double lastUsedTime(const String& originIdentifier);
+
+    void setBudget(unsigned long long);
+    unsigned long long budget();
+
+private:
+    StorageUsageIndex();
+
+    struct OriginUsage {
+        OriginUsage()
+            : lastUsedTime(0)
+            , isInUse(false)
+        {
+            for (int i = 0; i < StorageTypeCount; ++i) {
+                usage[i] = 0;
+                isMeasured[i] = false;
+            }
+        }
+
+        unsigned long long usage[StorageTypeCount];
+        bool isMeasured[StorageTypeCount];
+        String path[StorageTypeCount];
+        double lastUsedTime;
+        bool isInUse;
+    };
+
+    void setUsageNoLock(StorageType, const String& originIdentifier, unsigned long long usage, const String& path);
+    void scheduleEvictionIfNeededNoLock();
+
+    static void indexThreadStart(void*);
+    void indexThreadBody();
+    void measureDatabaseOrigins();
+    void measureLocalStorageOrigins(const String& directoryPath);
+
+    static void evictOriginsOverBudget(void*);
+    void evictOriginsOverBudget();
+
+    Mutex m_mutex;
+    ThreadCondition m_condition;
+    ThreadIdentifier m_threadID;
+
+    typedef HashMap<String, OriginUsage> OriginUsageMap;
+    OriginUsageMap m_origins;
+    unsigned long long m_totalUsage;
+    unsigned long long m_budget;
+    bool m_evictionScheduled;
+
+    // Path to measure by origin, for each type of storage.
+    typedef HashMap<String, String> PendingUpdateMap;
+    PendingUpdateMap m_pendingUpdates[StorageTypeCount];
+    bool m_needsDatabaseOriginScan;
+    String m_localStorageDirectoryPath;
+    bool m_needsLocalStorageOriginScan;
+};
+
+} // namespace WebCore
+
+#endif // StorageUsageIndex_h
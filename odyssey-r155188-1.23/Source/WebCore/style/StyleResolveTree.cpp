@@ -35,6 +35,7 @@
 #include "NodeRenderStyle.h"
 #include "NodeRenderingTraversal.h"
 #include "NodeTraversal.h"
+#include "ParallelRuleMatcher.h"
 #include "RenderFullScreen.h"
 #include "RenderNamedFlowThread.h"
 #include "RenderObject.h"
@@ -815,6 +816,20 @@ void resolveTree(Document& document, Change change)
         return;
     if (change < Inherit && !documentElement->childNeedsStyleRecalc() && !documentElement->needsStyleRecalc())
         return;
+
+    if (ParallelRuleMatcher::isEnabled(document)) {
+        StyleResolver& styleResolver = document.ensureStyleResolver();
+        ParallelRuleMatcher parallelRuleMatcher(styleResolver);
+        if (parallelRuleMatcher.matchTree(*documentElement, change)) {
+            styleResolver.setParallelRuleMatcher(&parallelRuleMatcher);
+            resolveTree(*documentElement, change);
+            // The resolver may have been replaced while resolving.
+            if (StyleResolver* currentStyleResolver = document.styleResolverIfExists())
+                currentStyleResolver->setParallelRuleMatcher(0);
+            return;
+        }
+    }
+
     resolveTree(*documentElement, change);
 }
 
@@ -68,6 +68,7 @@
 #include "ScriptGCEvent.h"
 #include "Scrollbar.h"
 #include "Settings.h"
+#include "ShapedRunCache.h"
 #include "SharedTimer.h"
 #include "TopSitesManager.h"
 #include "WebDocumentLoader.h"
@@ -1203,6 +1204,19 @@ bool WebViewPrivate::onKeyDown(BalEventKey event)
 				D(bug("\tscripts: count=%d - size=%d - liveSize=%d - decodedSize=%d\n", stats.scripts.count, stats.scripts.size, stats.scripts.liveSize, stats.scripts.decodedSize));
 				D(bug("\tfonts: count=%d - size=%d - liveSize=%d - decodedSize=%d\n", stats.fonts.count, stats.fonts.size, stats.fonts.liveSize, stats.fonts.decodedSize));
 
+				PageCache::Statistics pageCacheStats = pageCache()->statistics();
+
+				D(bug("Statistics about page cache:\n"));
+				D(bug("\tpages: count=%d - cost=%lu - budget=%lu\n", pageCache()->pageCount(), (unsigned long)pageCache()->memoryCost(), (unsigned long)pageCache()->memoryBudget()));
+				D(bug("\tnavigations: hits=%u - misses=%u\n", pageCacheStats.hitCount, pageCacheStats.missCount));
+				D(bug("\tevictions: expired=%u - capacity=%u - memory=%u - cold=%u\n", pageCacheStats.expiredCount, pageCacheStats.capacityEvictionCount, pageCacheStats.memoryEvictionCount, pageCacheStats.coldPageCount));
+
+				const ShapedRunCache::Statistics& shapedRunStats = shapedRunCache().statistics();
+
+				D(bug("Statistics about shaped run cache:\n"));
+				D(bug("\truns: count=%lu - cost=%lu\n", (unsigned long)shapedRunCache().size(), (unsigned long)shapedRunCache().totalCost()));
+				D(bug("\tlookups: hits=%u - misses=%u - evictions=%u\n", shapedRunStats.hitCount, shapedRunStats.missCount, shapedRunStats.evictionCount));
+
 				D(bug("Statistics about JavaScript:\n"));
 
 				HeapInfo heapInfo;
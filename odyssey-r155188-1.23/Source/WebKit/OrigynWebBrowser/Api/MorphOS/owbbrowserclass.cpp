@@ -1551,6 +1551,8 @@ DEFMMETHOD(Show)
 	data->dirty = TRUE;
 	DoMethod(obj, MM_OWBBrowser_Expose, FALSE);
 
+	data->view->webView->setPageVisible(true);
+
 	if(data->autofillCalltip)
 	{
 		DoMethod(data->autofillCalltip, MUIM_Calltips_ParentShow);
@@ -1596,6 +1598,9 @@ DEFMMETHOD(Hide)
 			DoMethod(data->datetimechooserCalltip, MUIM_Calltips_ParentHide);
 		}
 
+	/* Background tabs and iconified windows get their DOM timers throttled */
+	data->view->webView->setPageVisible(false);
+
 	return DOSUPER;
 }
 
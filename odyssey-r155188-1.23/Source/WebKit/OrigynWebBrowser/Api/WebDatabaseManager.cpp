@@ -40,6 +40,7 @@
 #include <DatabaseManagerClient.h>
 #include <FileSystem.h>
 #include <SecurityOrigin.h>
+#include <StorageUsageIndex.h>
 #include "ObserverServiceData.h"
 
 using namespace WebCore;
@@ -86,6 +87,11 @@ WebDatabaseDetails::~WebDatabaseDetails()
         delete m_displayName;
 }
 
+WebOriginStorageUsage* WebOriginStorageUsage::createInstance(unsigned long long databaseUsage, unsigned long long localStorageUsage, unsigned long long applicationCacheUsage, double lastUsedTime)
+{
+    return new WebOriginStorageUsage(databaseUsage, localStorageUsage, applicationCacheUsage, lastUsedTime);
+}
+
 static WebDatabaseManager* s_sharedWebDatabaseManager;
 
 WebDatabaseManager* WebDatabaseManager::createInstance()
@@ -209,6 +215,51 @@ void WebDatabaseManager::deleteDatabase(const char* databaseName, WebSecurityOri
 
     delete webSecurityOrigin;
 }
+vector<WebSecurityOrigin*> WebDatabaseManager::originsWithStorage()
+{
+    vector<WebSecurityOrigin*> ori;
+    if (this != s_sharedWebDatabaseManager)
+        return ori;
+
+    Vector<String> originIdentifiers;
+    StorageUsageIndex::index().originIdentifiers(originIdentifiers);
+    for (size_t i = 0; i < originIdentifiers.size(); i++)
+        ori.push_back(WebSecurityOrigin::createInstance(SecurityOrigin::createFromDatabaseIdentifier(originIdentifiers[i]).get()));
+
+    return ori;
+}
+
+WebOriginStorageUsage* WebDatabaseManager::storageUsageForOrigin(WebSecurityOrigin* origin)
+{
+    if (this != s_sharedWebDatabaseManager || !origin)
+        return 0;
+
+    StorageUsageIndex& index = StorageUsageIndex::index();
+    String originIdentifier = origin->securityOrigin()->databaseIdentifier();
+    unsigned long long usage[StorageUsageIndex::StorageTypeCount];
+    for (int i = 0; i < StorageUsageIndex::StorageTypeCount; i++) {
+        if (!index.usage(static_cast<StorageUsageIndex::StorageType>(i), originIdentifier, usage[i]))
+            usage[i] = 0;
+    }
+
+    return WebOriginStorageUsage::createInstance(usage[StorageUsageIndex::Database], usage[StorageUsageIndex::LocalStorage], usage[StorageUsageIndex::ApplicationCache], index.lastUsedTime(originIdentifier));
+}
+
+unsigned long long WebDatabaseManager::totalStorageUsage()
+{
+    return StorageUsageIndex::index().totalUsage();
+}
+
+void WebDatabaseManager::setStorageBudget(unsigned long long budget)
+{
+    StorageUsageIndex::index().setBudget(budget);
+}
+
+unsigned long long WebDatabaseManager::storageBudget()
+{
+    return StorageUsageIndex::index().budget();
+}
+
 /*
 class DidModifyOriginData : public Noncopyable {
 public:
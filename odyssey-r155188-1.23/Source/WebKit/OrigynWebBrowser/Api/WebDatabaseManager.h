@@ -84,6 +84,34 @@ private:
     unsigned long long m_currentUsage;
 };
 
+class WEBKIT_OWB_API WebOriginStorageUsage {
+protected:
+    friend class WebDatabaseManager;
+    static WebOriginStorageUsage* createInstance(unsigned long long databaseUsage, unsigned long long localStorageUsage, unsigned long long applicationCacheUsage, double lastUsedTime);
+
+public:
+    ~WebOriginStorageUsage() {}
+
+    unsigned long long databaseUsage() const { return m_databaseUsage; }
+    unsigned long long localStorageUsage() const { return m_localStorageUsage; }
+    unsigned long long applicationCacheUsage() const { return m_applicationCacheUsage; }
+    unsigned long long totalUsage() const { return m_databaseUsage + m_localStorageUsage + m_applicationCacheUsage; }
+    double lastUsedTime() const { return m_lastUsedTime; }
+
+private:
+    WebOriginStorageUsage(unsigned long long databaseUsage, unsigned long long localStorageUsage, unsigned long long applicationCacheUsage, double lastUsedTime)
+    : m_databaseUsage(databaseUsage)
+    , m_localStorageUsage(localStorageUsage)
+    , m_applicationCacheUsage(applicationCacheUsage)
+    , m_lastUsedTime(lastUsedTime)
+    {}
+
+    unsigned long long m_databaseUsage;
+    unsigned long long m_localStorageUsage;
+    unsigned long long m_applicationCacheUsage;
+    double m_lastUsedTime;
+};
+
 
 class WEBKIT_OWB_API WebDatabaseManager {
 public:
@@ -167,6 +195,42 @@ public:
      */
     virtual void deleteDatabase(const char* databaseName, WebSecurityOrigin* origin);
 
+    /**
+     * get origins with web storage, least recently used first
+     * @param[out]: security origins
+     * @code
+     * std::vector<WebSecurityOrigin*> s = d->originsWithStorage();
+     * @endcode
+     */
+    virtual std::vector<WebSecurityOrigin*> originsWithStorage();
+
+    /**
+     * get the disk usage of the databases, local storage and application cache of an origin
+     * @param[in]: WebSecurityOrigin
+     * @param[out]: WebOriginStorageUsage, deleted by the caller
+     * @code
+     * WebOriginStorageUsage* u = d->storageUsageForOrigin(o);
+     * @endcode
+     */
+    virtual WebOriginStorageUsage* storageUsageForOrigin(WebSecurityOrigin* origin);
+
+    /**
+     * get the disk usage of the web storage of all origins
+     */
+    virtual unsigned long long totalStorageUsage();
+
+    /**
+     * set the disk budget of the web storage of all origins
+     * When the usage goes over it, the storage of the least recently used origins is deleted.
+     * @param[in]: budget in bytes
+     */
+    virtual void setStorageBudget(unsigned long long budget);
+
+    /**
+     * get the disk budget of the web storage of all origins
+     */
+    virtual unsigned long long storageBudget();
+
 
     /**
      * dispatch did modify origin
@@ -32,15 +32,28 @@
 #include "WebHistory.h"
 
 #include "WebHistoryItem.h"
+#include "WebHistoryItem_p.h"
 #include "WebPreferences.h"
+#include "WebVisitedLinkTable.h"
 #include "SQLiteDatabase.h"
 #include "SQLiteStatement.h"
+#include "SQLiteTransaction.h"
 #include "CurrentTime.h"
+#include "wtf/HashMap.h"
+#include "wtf/MainThread.h"
+#include "wtf/OwnPtr.h"
+#include "wtf/StdLibExtras.h"
+#include "wtf/Threading.h"
 #include "wtf/Vector.h"
+#include "wtf/text/StringHash.h"
 #include "KURL.h"
+#include "LinkHash.h"
+#include "Page.h"
+#include "PageCache.h"
 #include "PageGroup.h"
 #include "HistoryItem.h"
-#include "IconDatabase.h"
+
+#include <algorithm>
 
 #if OS(MORPHOS)
 #include "gui.h"
@@ -60,184 +73,428 @@
 using namespace WebCore;
 using namespace std;
 
-#if ENABLE(SQL_DATABASE)
-#define HISTORYDB "PROGDIR:Conf/History.db"
-static SQLiteDatabase m_historyDB;
-#endif
-
+// Oldest visit first. m_historyIndex finds an item by URL without scanning the list.
 static std::vector<WebHistoryItem *> m_historyList;
+static HashMap<String, WebHistoryItem*> m_historyIndex;
 
 std::vector<WebHistoryItem *> *WebHistory::historyList()
 {
 	return &m_historyList;
 }
 
-#if ENABLE(SQL_DATABASE)
-bool WebHistory::loadHistoryFromDatabase(int sortCriterium, bool desc, std::vector<WebHistoryItem *> *destList)
+static void allVisitedLinksChanged()
 {
-	unsigned int maxItems =  historyItemLimit();
-	unsigned int maxAge = historyAgeInDaysLimit();
+    Page::allVisitedStateChanged(0);
+    pageCache()->markPagesForVistedLinkStyleRecalc();
+}
 
-	if(!m_historyDB.isOpen() && !m_historyDB.open(HISTORYDB))
-	{
-		LOG_ERROR("Cannot open the history database");
-		return false;
-    }
+// Set once the list holds the whole stored history.
+#if ENABLE(SQL_DATABASE)
+static bool m_historyIsComplete = false;
+#else
+static bool m_historyIsComplete = true;
+#endif
+// Set when items were removed before the list held the whole stored history.
+static bool m_visitedLinksNeedRebuilding = false;
 
-    // Check that the database is correctly initialized.
-	if(!m_historyDB.tableExists(String("history")))
-	{
-		m_historyDB.close();
-		return false;
+// Links leave the visited link table only when it is rebuilt from the history, so removed
+// items stop being shown as visited and the table does not grow past the history limits.
+static void rebuildVisitedLinks()
+{
+    if (!m_historyIsComplete) {
+        m_visitedLinksNeedRebuilding = true;
+        return;
     }
+    m_visitedLinksNeedRebuilding = false;
+
+    HashSet<LinkHash, LinkHashHash> hashes;
+    HashMap<String, WebHistoryItem*>::const_iterator end = m_historyIndex.end();
+    for (HashMap<String, WebHistoryItem*>::const_iterator it = m_historyIndex.begin(); it != end; ++it)
+        hashes.add(visitedLinkHash(it->key));
+    WebVisitedLinkTable::shared().rebuild(hashes);
+    allVisitedLinksChanged();
+}
+
+static WebHistoryItem* appendHistoryItem(const String& url, const String& title, double lastAccessed)
+{
+    WebHistoryItem* item = WebHistoryItem::createInstance();
+    item->initWithURLString(url, title, lastAccessed);
+    m_historyList.push_back(item);
+    m_historyIndex.set(url, item);
+
+#if OS(MORPHOS)
+    DoMethod(app, MM_History_Insert, item);
+#endif
+    return item;
+}
 
-	/* Prune older entries */
-	double minAge = currentTime() - maxAge*24*3600;
-	SQLiteStatement deleteStmt(m_historyDB, String("DELETE FROM history WHERE lastAccessed < ?1;"));
+static void removeHistoryItem(WebHistoryItem* item)
+{
+    // Only the pointers are compared, the URLs are not copied.
+    std::vector<WebHistoryItem *>::iterator it = std::find(m_historyList.begin(), m_historyList.end(), item);
+    ASSERT(it != m_historyList.end());
+    m_historyList.erase(it);
 
-	if(deleteStmt.prepare())
-	{
-		return false;
+#if OS(MORPHOS)
+    DoMethod(app, MM_History_Remove, item);
+#endif
+    delete item; // Careful with that one
+}
+
+#if ENABLE(SQL_DATABASE)
+#define HISTORYDB "PROGDIR:Conf/History.db"
+
+// Visits are written after this many seconds, so that the visits of a page and its frames
+// and the title update that follows go into one transaction.
+static const double historyWriteDelay = 2;
+// The stored history reaches the main thread in pages of this many items.
+static const size_t historyLoadPageSize = 200;
+
+struct HistoryRow {
+    HistoryRow()
+        : lastAccessed(0)
+        , isRemoval(false)
+    {
     }
 
-    // Binds all the values
-	if(deleteStmt.bindDouble(1, minAge))
-	{
-		LOG_ERROR("Cannot save history");
-		//return false;
+    HistoryRow(const String& url, const String& title, double lastAccessed, bool isRemoval = false)
+        : url(url)
+        , title(title)
+        , lastAccessed(lastAccessed)
+        , isRemoval(isRemoval)
+    {
     }
 
-	if(!deleteStmt.executeCommand()) {
-		LOG_ERROR("Cannot save history");
-		//return false;
+    String url;
+    String title;
+    double lastAccessed;
+    bool isRemoval;
+};
+
+struct LoadedHistoryPage {
+    LoadedHistoryPage()
+        : isLastPage(false)
+        , wasPruned(false)
+    {
     }
 
-	/* Remove extranumerous entries */
-	char deleteStmt2buf[512];
-	snprintf(deleteStmt2buf, sizeof(deleteStmt2buf), "DELETE FROM history WHERE lastAccessed < (SELECT lastAccessed FROM history ORDER BY lastAccessed ASC LIMIT 1 OFFSET (SELECT count(*) FROM history) - min(%d, (SELECT count(*) FROM history)));", maxItems);
-	m_historyDB.executeCommand(String(deleteStmt2buf));
+    // Most recent visit first.
+    Vector<HistoryRow> rows;
+    bool isLastPage;
+    // Set on the last page when items past the age or item limit were deleted.
+    bool wasPruned;
+};
 
-	String request = "SELECT url, title, lastAccessed FROM history";
-	String end = ";";
-	String direction;
+// Set when all items are removed while the stored history is still being loaded.
+static bool m_ignoreLoadedHistory = false;
 
-	if(desc)
-		direction = " DESC";
-	else
-		direction = " ASC";
+static void didLoadHistoryPage(void* context)
+{
+    OwnPtr<LoadedHistoryPage> page = adoptPtr(static_cast<LoadedHistoryPage*>(context));
+    if (m_ignoreLoadedHistory)
+        return;
 
-	switch(sortCriterium)
-	{
-		default:
-		case HISTORY_SORT_NONE:
-			break;
-
-		case HISTORY_SORT_BY_URL:
-		        request.append(" ORDER BY length(url), url");
-			request.append(direction);
-			break;
-
-		case HISTORY_SORT_BY_TITLE:
-		        request.append(" ORDER BY title");
-			request.append(direction);
-			break;
-
-		case HISTORY_SORT_BY_ACCESSTIME:
-		        request.append(" ORDER BY lastAccessed");
-			request.append(direction);
-			break;
-	}
+    // Everything loaded is older than what the list already holds, except for the URLs
+    // visited again since startup, which are already in the list.
+    WebVisitedLinkTable& visitedLinks = WebVisitedLinkTable::shared();
+    bool populateVisitedLinks = visitedLinks.needsPopulating();
+    std::vector<WebHistoryItem *> items;
+    items.reserve(page->rows.size());
+    for (size_t i = page->rows.size(); i > 0; --i) {
+        const HistoryRow& row = page->rows[i - 1];
+        if (m_historyIndex.contains(row.url))
+            continue;
+
+        WebHistoryItem* item = WebHistoryItem::createInstance();
+        item->initWithURLString(row.url, row.title, row.lastAccessed);
+        m_historyIndex.set(row.url, item);
+        items.push_back(item);
+
+        if (populateVisitedLinks)
+            visitedLinks.add(visitedLinkHash(row.url));
+    }
+    m_historyList.insert(m_historyList.begin(), items.begin(), items.end());
 
-	request.append(end);
+#if OS(MORPHOS)
+    for (size_t i = 0; i < items.size(); ++i)
+        DoMethod(app, MM_History_Insert, items[i]);
+#endif
 
-    // Problem if the database is not connected
-	SQLiteStatement select(m_historyDB, request);
+    if (!page->isLastPage)
+        return;
+    m_historyIsComplete = true;
+
+    // The visited link table is only filled from the history when it could not be opened.
+    if (populateVisitedLinks) {
+        visitedLinks.didPopulate();
+        allVisitedLinksChanged();
+    } else if (page->wasPruned || m_visitedLinksNeedRebuilding)
+        rebuildVisitedLinks();
+}
 
-	if(select.prepare())
-	{
-		LOG_ERROR("Cannot retrieve history in the database");
-		return false;
+// Owns the history database, which only its thread touches, so that a navigation never
+// waits on SQLite. The thread first prunes the stored history and hands it to the main
+// thread in pages, most recent first. It then writes the changes the main thread
+// schedules, a batch per transaction; only the last change to a URL is written.
+class HistoryStore {
+    WTF_MAKE_NONCOPYABLE(HistoryStore);
+public:
+    HistoryStore()
+        : m_thread(0)
+        , m_threadShouldQuit(false)
+        , m_hasLoaded(false)
+        , m_shouldLoad(false)
+        , m_maxItems(0)
+        , m_minLastAccessed(0)
+        , m_pendingRemoveAll(false)
+    {
     }
 
-	while(select.step() == SQLResultRow)
-	{
-        // There is a row to fetch
-		WebHistoryItem *item = WebHistoryItem::createInstance();
+    // Loads the stored history the first time it is called.
+    void open(unsigned maxItems, double minLastAccessed);
+    void close();
 
-		if(item)
-		{
-			item->initWithURLString(select.getColumnText(0),
-									select.getColumnText(1),
-									select.getColumnDouble(2));
+    void scheduleWrite(const HistoryRow&);
+    void scheduleRemoveAll();
 
-			char *title = (char *) item->title();
-			free(title);
+private:
+    void ensureThread();
+    static void threadStartFunc(void*);
+    void threadMain();
 
-			if(!destList)
-			{
-				destList = &m_historyList;
-			}
+    bool openDatabase();
+    void loadHistory();
+    void writeChanges(bool removeAll, const HashMap<String, HistoryRow>&);
 
-			destList->push_back(item);
+    SQLiteDatabase m_database;
 
-			// Retain it for icondatabase
-			iconDatabase().retainIconForPageURL(select.getColumnText(0));
-		}
-	}
+    Mutex m_lock;
+    ThreadCondition m_condition;
+    ThreadIdentifier m_thread;
+    bool m_threadShouldQuit;
+
+    bool m_hasLoaded;
+    bool m_shouldLoad;
+    unsigned m_maxItems;
+    double m_minLastAccessed;
 
-	return true;
+    bool m_pendingRemoveAll;
+    HashMap<String, HistoryRow> m_pendingWrites;
+};
+
+static HistoryStore& historyStore()
+{
+    DEFINE_STATIC_LOCAL(HistoryStore, store, ());
+    return store;
 }
 
-bool WebHistory::insertHistoryItemIntoDatabase(String& url, String& title, double lastAccessed)
+void HistoryStore::open(unsigned maxItems, double minLastAccessed)
 {
-	if(!m_historyDB.isOpen() && !m_historyDB.open(HISTORYDB))
-	{
-		LOG_ERROR("Cannot open the history database");
-		return false;
+    if (m_hasLoaded)
+        return;
+    m_hasLoaded = true;
+    m_maxItems = maxItems;
+    m_minLastAccessed = minLastAccessed;
+
+    MutexLocker locker(m_lock);
+    m_shouldLoad = true;
+    ensureThread();
+}
+
+void HistoryStore::close()
+{
+    {
+        MutexLocker locker(m_lock);
+        if (!m_thread)
+            return;
+        m_threadShouldQuit = true;
+        m_condition.signal();
     }
+    // The thread writes the pending changes before it quits.
+    waitForThreadCompletion(m_thread);
+    m_thread = 0;
+    m_threadShouldQuit = false;
+}
 
-	if(!m_historyDB.tableExists(String("history")))
-	{
-		m_historyDB.executeCommand(String("CREATE TABLE history (url TEXT, title TEXT, lastAccessed DOUBLE);"));
-	}
+void HistoryStore::scheduleWrite(const HistoryRow& row)
+{
+    MutexLocker locker(m_lock);
+    HistoryRow isolatedRow(row.url.isolatedCopy(), row.title.isolatedCopy(), row.lastAccessed, row.isRemoval);
+    m_pendingWrites.set(isolatedRow.url, isolatedRow);
+    ensureThread();
+    m_condition.signal();
+}
 
-	SQLiteStatement deleteStmt(m_historyDB, String("DELETE FROM history WHERE url=?1;"));
+void HistoryStore::scheduleRemoveAll()
+{
+    MutexLocker locker(m_lock);
+    m_pendingRemoveAll = true;
+    m_pendingWrites.clear();
+    ensureThread();
+    m_condition.signal();
+}
 
-	if(deleteStmt.prepare())
-	{
-		return false;
+void HistoryStore::ensureThread()
+{
+    if (m_thread)
+        return;
+    m_thread = createThread(threadStartFunc, this, "[OWB] History");
+}
+
+void HistoryStore::threadStartFunc(void* store)
+{
+    static_cast<HistoryStore*>(store)->threadMain();
+}
+
+void HistoryStore::threadMain()
+{
+    bool isOpen = openDatabase();
+
+    MutexLocker locker(m_lock);
+    if (m_shouldLoad) {
+        m_shouldLoad = false;
+        m_lock.unlock();
+        if (isOpen)
+            loadHistory();
+        else
+            callOnMainThread(didLoadHistoryPage, new LoadedHistoryPage);
+        m_lock.lock();
     }
 
-    // Binds all the values
-	if(deleteStmt.bindText(1, url))
-	{
-		LOG_ERROR("Cannot save history");
+    while (true) {
+        while (!m_threadShouldQuit && !m_pendingRemoveAll && m_pendingWrites.isEmpty())
+            m_condition.wait(m_lock);
+
+        double deadline = currentTime() + historyWriteDelay;
+        while (!m_threadShouldQuit && currentTime() < deadline)
+            m_condition.timedWait(m_lock, deadline);
+
+        bool removeAll = m_pendingRemoveAll;
+        m_pendingRemoveAll = false;
+        HashMap<String, HistoryRow> writes;
+        writes.swap(m_pendingWrites);
+
+        if (isOpen && (removeAll || !writes.isEmpty())) {
+            m_lock.unlock();
+            writeChanges(removeAll, writes);
+            m_lock.lock();
+        }
+
+        if (m_threadShouldQuit && !m_pendingRemoveAll && m_pendingWrites.isEmpty())
+            break;
     }
 
-	if(!deleteStmt.executeCommand()) {
-		LOG_ERROR("Cannot save history");
+    if (isOpen)
+        m_database.close();
+}
+
+bool HistoryStore::openDatabase()
+{
+    if (!m_database.open(HISTORYDB)) {
+        LOG_ERROR("Cannot open the history database");
+        return false;
     }
 
-	SQLiteStatement insert(m_historyDB, String("INSERT INTO history (url, title, lastAccessed) VALUES (?1, ?2, ?3);"));
+    if (!m_database.tableExists("history")) {
+        if (!m_database.executeCommand("CREATE TABLE history (url TEXT NOT NULL, title TEXT, lastAccessed DOUBLE);")) {
+            LOG_ERROR("Cannot create the history table");
+            m_database.close();
+            return false;
+        }
+    }
 
-	if(insert.prepare())
-	{
-		return false;
+    if (m_database.returnsAtLeastOneResult("SELECT name FROM sqlite_master WHERE type='index' AND name='history_url';"))
+        return true;
+
+    // Older databases have neither index and may store a URL several times. Keep its latest visit.
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+    if (!m_database.executeCommand("CREATE TEMPORARY TABLE history_latest AS SELECT url, title, max(lastAccessed) AS lastAccessed FROM history WHERE url IS NOT NULL GROUP BY url;")
+        || !m_database.executeCommand("DELETE FROM history;")
+        || !m_database.executeCommand("INSERT INTO history (url, title, lastAccessed) SELECT url, title, lastAccessed FROM history_latest;")
+        || !m_database.executeCommand("DROP TABLE history_latest;")
+        || !m_database.executeCommand("CREATE UNIQUE INDEX history_url ON history (url);")
+        || !m_database.executeCommand("CREATE INDEX history_lastAccessed ON history (lastAccessed);")) {
+        LOG_ERROR("Cannot index the history database");
+        transaction.rollback();
+        m_database.close();
+        return false;
     }
+    transaction.commit();
+    return true;
+}
 
-    // Binds all the values
-	if(insert.bindText(1, url) || insert.bindText(2, title) || insert.bindDouble(3, lastAccessed))
-	{
-		LOG_ERROR("Cannot save history");
-		return false;
+void HistoryStore::loadHistory()
+{
+    // lastChanges() only counts the rows changed by the most recent statement, so it is read
+    // after each one.
+    bool wasPruned = false;
+    SQLiteStatement prune(m_database, "DELETE FROM history WHERE lastAccessed < ?1;");
+    if (prune.prepare() != SQLResultOk || prune.bindDouble(1, m_minLastAccessed) != SQLResultOk || !prune.executeCommand())
+        LOG_ERROR("Cannot prune history");
+    else if (m_database.lastChanges() > 0)
+        wasPruned = true;
+
+    /* Remove extranumerous entries */
+    if (m_maxItems) {
+        SQLiteStatement trim(m_database, "DELETE FROM history WHERE lastAccessed < (SELECT lastAccessed FROM history ORDER BY lastAccessed DESC LIMIT 1 OFFSET ?1);");
+        if (trim.prepare() != SQLResultOk || trim.bindInt(1, m_maxItems - 1) != SQLResultOk || !trim.executeCommand())
+            LOG_ERROR("Cannot prune history");
+        else if (m_database.lastChanges() > 0)
+            wasPruned = true;
+    }
+
+    OwnPtr<LoadedHistoryPage> page = adoptPtr(new LoadedHistoryPage);
+    SQLiteStatement select(m_database, "SELECT url, title, lastAccessed FROM history ORDER BY lastAccessed DESC;");
+    if (select.prepare() == SQLResultOk) {
+        while (select.step() == SQLResultRow) {
+            page->rows.append(HistoryRow(select.getColumnText(0), select.getColumnText(1), select.getColumnDouble(2)));
+            if (page->rows.size() == historyLoadPageSize) {
+                callOnMainThread(didLoadHistoryPage, page.leakPtr());
+                page = adoptPtr(new LoadedHistoryPage);
+            }
+        }
+    } else
+        LOG_ERROR("Cannot retrieve history in the database");
+
+    page->isLastPage = true;
+    page->wasPruned = wasPruned;
+    callOnMainThread(didLoadHistoryPage, page.leakPtr());
+}
+
+void HistoryStore::writeChanges(bool removeAll, const HashMap<String, HistoryRow>& writes)
+{
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+
+    if (removeAll && !m_database.executeCommand("DELETE FROM history;"))
+        LOG_ERROR("Cannot clear history");
+
+    SQLiteStatement insert(m_database, "INSERT OR REPLACE INTO history (url, title, lastAccessed) VALUES (?1, ?2, ?3);");
+    SQLiteStatement remove(m_database, "DELETE FROM history WHERE url = ?1;");
+    if (insert.prepare() != SQLResultOk || remove.prepare() != SQLResultOk) {
+        LOG_ERROR("Cannot save history");
+        transaction.commit();
+        return;
     }
 
-	if(!insert.executeCommand()) {
-		LOG_ERROR("Cannot save history");
-		return false;
+    HashMap<String, HistoryRow>::const_iterator end = writes.end();
+    for (HashMap<String, HistoryRow>::const_iterator it = writes.begin(); it != end; ++it) {
+        const HistoryRow& row = it->value;
+        bool succeeded;
+        if (row.isRemoval) {
+            succeeded = remove.bindText(1, row.url) == SQLResultOk && remove.step() == SQLResultDone;
+            remove.reset();
+        } else {
+            succeeded = insert.bindText(1, row.url) == SQLResultOk && insert.bindText(2, row.title) == SQLResultOk
+                && insert.bindDouble(3, row.lastAccessed) == SQLResultOk && insert.step() == SQLResultDone;
+            insert.reset();
+        }
+        if (!succeeded)
+            LOG_ERROR("Cannot save history");
     }
 
-	return true;
+    transaction.commit();
 }
 #endif
 
@@ -249,15 +506,16 @@ WebHistory::WebHistory()
 	PageGroup::setShouldTrackVisitedLinks(true);
 
 #if ENABLE(SQL_DATABASE)
-	loadHistoryFromDatabase(HISTORY_SORT_BY_ACCESSTIME, false);
+    historyStore().open(historyItemLimit(), currentTime() - historyAgeInDaysLimit() * 24 * 3600);
 #endif
 }
 
 WebHistory::~WebHistory()
 {
 #if ENABLE(SQL_DATABASE)
-	m_historyDB.close();
+    historyStore().close();
 #endif
+    WebVisitedLinkTable::shared().synchronize();
 
 /*
 	for(unsigned int i = 0; i < m_historyList.size(); i++)
@@ -310,47 +568,83 @@ WebError* WebHistory::saveToURL(const char* url)
 
 void WebHistory::addItems(vector<WebHistoryItem*> items)
 {
+    for (size_t i = 0; i < items.size(); ++i) {
+        WebHistoryItem* item = items[i];
+        String url = item->getPrivateItem()->m_historyItem->urlString();
+        if (url.isEmpty() || m_historyIndex.contains(url))
+            continue;
+
+        m_historyList.push_back(item);
+        m_historyIndex.set(url, item);
+#if OS(MORPHOS)
+        DoMethod(app, MM_History_Insert, item);
+#endif
+#if ENABLE(SQL_DATABASE)
+        historyStore().scheduleWrite(HistoryRow(url, item->getPrivateItem()->m_historyItem->title(), item->lastVisitedTimeInterval()));
+#endif
+    }
 }
 
 void WebHistory::removeItems(vector<WebHistoryItem*> items)
 {
+    bool removedItems = false;
+    for (size_t i = 0; i < items.size(); ++i) {
+        String url = items[i]->getPrivateItem()->m_historyItem->urlString();
+        HashMap<String, WebHistoryItem*>::iterator it = m_historyIndex.find(url);
+        if (it == m_historyIndex.end() || it->value != items[i])
+            continue;
+
+        m_historyIndex.remove(it);
+        removeHistoryItem(items[i]);
+        removedItems = true;
+#if ENABLE(SQL_DATABASE)
+        historyStore().scheduleWrite(HistoryRow(url, String(), 0, true));
+#endif
+    }
+
+    if (removedItems)
+        rebuildVisitedLinks();
 }
 
 void WebHistory::removeAllItems()
 {
-    PageGroup::removeAllVisitedLinks();
+    while (!m_historyList.empty())
+        removeHistoryItem(m_historyList.back());
+    m_historyIndex.clear();
+
+#if ENABLE(SQL_DATABASE)
+    m_ignoreLoadedHistory = true;
+    historyStore().scheduleRemoveAll();
+#endif
+    // The rest of the stored history is ignored, so the list is now all there is.
+    m_historyIsComplete = true;
+    m_visitedLinksNeedRebuilding = false;
+
+    removeAllVisitedLinks();
 }
 
 WebHistoryItem* WebHistory::itemForURL(const char* url)
 {
-	//D(bug("WebHistory::itemForURL(%s)\n", url.latin1().data()));
-
-	for(unsigned int i=0; i < m_historyList.size(); i++)
-	{
-		char *wurl = (char *) m_historyList[i]->URLString();
-		WTF::String itemURL = wurl;
-		free(wurl);
-
-		if(itemURL == url)
-		{
-
-			return m_historyList[i];
-		}
-	}
+	//D(bug("WebHistory::itemForURL(%s)\n", url));
 
+    WebHistoryItem* item = m_historyIndex.get(String::fromUTF8(url));
 	free((char *)url);
-
-    return 0;
+    return item;
 }
 
 void WebHistory::setVisitedLinkTrackingEnabled(bool visitedLinkTrackingEnabled)
 {
+    if (PageGroup::isTrackingVisitedLinks() == visitedLinkTrackingEnabled)
+        return;
     PageGroup::setShouldTrackVisitedLinks(visitedLinkTrackingEnabled);
+    allVisitedLinksChanged();
 }
 
 void WebHistory::removeAllVisitedLinks()
 {
+    WebVisitedLinkTable::shared().removeAll();
     PageGroup::removeAllVisitedLinks();
+    allVisitedLinksChanged();
 }
 
 void WebHistory::setHistoryItemLimit(int limit)
@@ -385,54 +679,20 @@ int WebHistory::historyAgeInDaysLimit()
 void WebHistory::visitedURL(const char* url, const char* title, const char* httpMethod, bool wasFailure)
 {
 	double lastAccessed = currentTime();
+    String urlString = String::fromUTF8(url);
+    String titleString = String::fromUTF8(title);
 
 	// Don't allow duplicates
-	for(std::vector<WebHistoryItem *>::iterator it = m_historyList.begin(); it != m_historyList.end(); it++)
-	{
-		WebHistoryItem *item = *(it);
-		char *wurl = (char *) item->URLString();
-		WTF::String itemURL = wurl;
-		free(wurl);
-
-		if(itemURL == url)
-		{
-			m_historyList.erase(it, it+1);
-#if OS(MORPHOS)
-			DoMethod(app, MM_History_Remove, item);
-#endif
-			delete item; // Careful with that one
-			break;
-		}
-	}
-
-	WebHistoryItem *item = WebHistoryItem::createInstance();
+    if (WebHistoryItem* item = m_historyIndex.take(urlString))
+        removeHistoryItem(item);
 
-	if(item)
-	{
-		item->initWithURLString(String::fromUTF8(url), String::fromUTF8(title), lastAccessed);
-		m_historyList.push_back(item);
-
-#if OS(MORPHOS)
-		DoMethod(app, MM_History_Insert, item);
-#endif
+    appendHistoryItem(urlString, titleString, lastAccessed);
 
 #if ENABLE(SQL_DATABASE)
-		if(getv(app, MA_OWBApp_SaveHistory))
-		{
-			char *wurl   = (char *) item->URLString();
-			char *wtitle = (char *) item->title();
-
-			String u = String::fromUTF8(wurl);
-			String t = String::fromUTF8(wtitle);
-
-			insertHistoryItemIntoDatabase(u, t, lastAccessed);
-			free(wurl);
-			free(wtitle);
-		}
+    if (getv(app, MA_OWBApp_SaveHistory))
+        historyStore().scheduleWrite(HistoryRow(urlString, titleString, lastAccessed));
 #endif
 
-	}
-
 	free((char *)url);
 	free((char *)title);
 	free((char *)httpMethod);
@@ -440,24 +700,21 @@ void WebHistory::visitedURL(const char* url, const char* title, const char* http
 
 void WebHistory::addVisitedLinksToPageGroup(PageGroup& group)
 {
-	for(unsigned int i = 0; i < m_historyList.size(); i++)
-	{
-		char *wurl = (char *) m_historyList[i]->URLString();
-		WTF::String itemURL = wurl;
-		free(wurl);
-		group.addVisitedLink(itemURL.characters(), itemURL.length());
-	}
+    HashMap<String, WebHistoryItem*>::const_iterator end = m_historyIndex.end();
+    for (HashMap<String, WebHistoryItem*>::const_iterator it = m_historyIndex.begin(); it != end; ++it)
+        group.addVisitedLink(it->key.characters(), it->key.length());
 }
 
 WebHistoryItem* WebHistory::itemForURLString(const char* urlString) const
 {
-	//D(bug("WebHistory::itemForURLString(%s)\n", urlString.latin1().data()));
+	//D(bug("WebHistory::itemForURLString(%s)\n", urlString));
+
+    WebHistoryItem* item = m_historyIndex.get(String::fromUTF8(urlString));
 	free((char *)urlString);
-    return 0;
+    return item;
 }
 
 std::vector<WebHistoryItem*> WebHistory::allItems()
 {
-    vector<WebHistoryItem*> items;
-    return items;
+    return m_historyList;
 }
@@ -198,6 +198,11 @@ protected:
 
 #if OS(MORPHOS)
 public:
+    /**
+     * @brief returns the history items, oldest visit first.
+     * The stored history is added in pages after startup, most recent first; every item added
+     * or removed is announced with MM_History_Insert or MM_History_Remove.
+     */
 	std::vector<WebHistoryItem *> *historyList();
 #endif
 
@@ -212,16 +217,6 @@ private:
     };
 
     WebPreferences *m_preferences;
-
-#if OS(MORPHOS)
-
-#if ENABLE(SQL_DATABASE)
-public:
-	bool loadHistoryFromDatabase(int sortCriterium, bool desc = false, std::vector<WebHistoryItem *> *destList = NULL);
-	bool insertHistoryItemIntoDatabase(WTF::String& url, WTF::String& title, double lastAccessed);
-#endif
-
-#endif
 };
 
 #endif
@@ -156,3 +156,7 @@
 #define WebKitShouldInvertColorsPreferenceKey "WebKitShouldInvertColors"
 #define WebKitMediaPlaybackRequiresUserGesturePreferenceKey "WebKitMediaPlaybackRequiresUserGesture"
 #define WebKitMediaPlaybackAllowsInlinePreferenceKey "WebKitMediaPlaybackAllowsInline"
+#define WebKitParallelStyleResolutionEnabledPreferenceKey "WebKitParallelStyleResolutionEnabled" // default: false
+#define WebKitTimerCoalescingIntervalPreferenceKey "WebKitTimerCoalescingInterval" // milliseconds, default: 4
+#define WebKitHiddenPageDOMTimerThrottlingEnabledPreferenceKey "WebKitHiddenPageDOMTimerThrottlingEnabled" // default: true
+#define WebKitHiddenPageDOMTimerAlignmentIntervalPreferenceKey "WebKitHiddenPageDOMTimerAlignmentInterval" // milliseconds, default: 1000
@@ -225,6 +225,10 @@ void WebPreferences::initializeDefaultSettings()
 
     m_privatePrefs[WebKitHixie76WebSocketProtocolEnabledPreferenceKey] = "0";
     m_privatePrefs[WebKitShouldInvertColorsPreferenceKey] = "0";
+    m_privatePrefs[WebKitParallelStyleResolutionEnabledPreferenceKey] = "0";
+    m_privatePrefs[WebKitTimerCoalescingIntervalPreferenceKey] = "4";
+    m_privatePrefs[WebKitHiddenPageDOMTimerThrottlingEnabledPreferenceKey] = "1";
+    m_privatePrefs[WebKitHiddenPageDOMTimerAlignmentIntervalPreferenceKey] = "1000";
 
 #if ENABLE(VIDEO_TRACK)
     m_privatePrefs[WebKitShouldDisplaySubtitlesPreferenceKey] = "1";
@@ -1198,6 +1202,46 @@ bool WebPreferences::mediaPlaybackAllowsInline()
 	return boolValueForKey(WebKitMediaPlaybackAllowsInlinePreferenceKey);
 }
 
+bool WebPreferences::parallelStyleResolutionEnabled()
+{
+    return boolValueForKey(WebKitParallelStyleResolutionEnabledPreferenceKey);
+}
+
+void WebPreferences::setParallelStyleResolutionEnabled(bool enabled)
+{
+    setBoolValue(WebKitParallelStyleResolutionEnabledPreferenceKey, enabled);
+}
+
+int WebPreferences::timerCoalescingInterval()
+{
+    return integerValueForKey(WebKitTimerCoalescingIntervalPreferenceKey);
+}
+
+void WebPreferences::setTimerCoalescingInterval(int interval)
+{
+    setIntegerValue(WebKitTimerCoalescingIntervalPreferenceKey, interval);
+}
+
+bool WebPreferences::hiddenPageDOMTimerThrottlingEnabled()
+{
+    return boolValueForKey(WebKitHiddenPageDOMTimerThrottlingEnabledPreferenceKey);
+}
+
+void WebPreferences::setHiddenPageDOMTimerThrottlingEnabled(bool enabled)
+{
+    setBoolValue(WebKitHiddenPageDOMTimerThrottlingEnabledPreferenceKey, enabled);
+}
+
+int WebPreferences::hiddenPageDOMTimerAlignmentInterval()
+{
+    return integerValueForKey(WebKitHiddenPageDOMTimerAlignmentIntervalPreferenceKey);
+}
+
+void WebPreferences::setHiddenPageDOMTimerAlignmentInterval(int interval)
+{
+    setIntegerValue(WebKitHiddenPageDOMTimerAlignmentIntervalPreferenceKey, interval);
+}
+
 
 void WebPreferences::setShouldDisplaySubtitles(bool enabled)
 {
@@ -750,6 +750,51 @@ public:
 	virtual bool mediaPlaybackAllowsInline();
 	virtual void setMediaPlaybackAllowsInline(bool);
 
+    /**
+     *  parallelStyleResolutionEnabled
+     */
+    virtual bool parallelStyleResolutionEnabled();
+
+    /**
+     *  setParallelStyleResolutionEnabled
+     */
+    virtual void setParallelStyleResolutionEnabled(bool);
+
+    /**
+     *  timerCoalescingInterval
+     *  Timers of the main thread that come due within the same multiple of
+     *  this interval, in milliseconds, fire together. 0 fires each on time.
+     */
+    virtual int timerCoalescingInterval();
+
+    /**
+     *  setTimerCoalescingInterval
+     */
+    virtual void setTimerCoalescingInterval(int);
+
+    /**
+     *  hiddenPageDOMTimerThrottlingEnabled
+     *  Whether the DOM timers of a page that is hidden are aligned to
+     *  hiddenPageDOMTimerAlignmentInterval.
+     */
+    virtual bool hiddenPageDOMTimerThrottlingEnabled();
+
+    /**
+     *  setHiddenPageDOMTimerThrottlingEnabled
+     */
+    virtual void setHiddenPageDOMTimerThrottlingEnabled(bool);
+
+    /**
+     *  hiddenPageDOMTimerAlignmentInterval
+     *  The alignment of the DOM timers of hidden pages, in milliseconds.
+     */
+    virtual int hiddenPageDOMTimerAlignmentInterval();
+
+    /**
+     *  setHiddenPageDOMTimerAlignmentInterval
+     */
+    virtual void setHiddenPageDOMTimerAlignmentInterval(int);
+
     /**
      * get the topic to notify a change on webPreference
      */
@@ -47,10 +47,15 @@ WebSecurityOrigin* WebSecurityOrigin::createInstance(SecurityOrigin* securityOri
 WebSecurityOrigin::WebSecurityOrigin(SecurityOrigin* securityOrigin)
     : m_securityOrigin(securityOrigin)
 {
+    // Origins are often handed out from a list that does not outlive the call.
+    if (m_securityOrigin)
+        m_securityOrigin->ref();
 }
 
 WebSecurityOrigin::~WebSecurityOrigin()
 {
+    if (m_securityOrigin)
+        m_securityOrigin->deref();
 }
 
 const char* WebSecurityOrigin::protocol()
@@ -127,6 +127,7 @@
 #include <Page.h>
 #include <PageCache.h>
 #include <PageGroup.h>
+#include <PageThrottler.h>
 #include <PlatformKeyboardEvent.h>
 #include <PlatformMouseEvent.h>
 #include <PlatformWheelEvent.h>
@@ -146,11 +147,17 @@
 #include <SecurityPolicy.h>
 #include <Settings.h>
 #include <SimpleFontData.h>
+#include <StorageUsageIndex.h>
+#include <ThreadGlobalData.h>
+#include <ThreadTimers.h>
 #include <TypingCommand.h>
 #include <WindowsKeyboardCodes.h>
 
+#include <CodeCache.h>
 #include <JSCell.h>
+#include <JSDOMWindowBase.h>
 #include <JSLock.h>
+#include <SamplingProfiler.h>
 #include <JSValue.h>
 
 #include <CString.h>
@@ -334,6 +341,20 @@ static void WebKitSetApplicationCachePathIfNecessary()
 }
 #endif
 
+static void WebKitSetBytecodeCachePathIfNecessary()
+{
+    static bool initialized = false;
+    if (initialized)
+        return;
+
+    WTF::String path = WebCore::pathByAppendingComponent("PROGDIR:conf", "BytecodeCache");
+
+    if (!path.isNull() && WebCore::makeAllDirectories(path))
+        WebCore::JSDOMWindowBase::commonVM()->codeCache()->setDiskCacheDirectory(path);
+
+    initialized = true;
+}
+
 WebView::WebView()
 	: m_viewWindow(0)
     , m_mainFrame(0)
@@ -380,6 +401,7 @@ WebView::WebView()
     , m_statusbarVisible(true)
     , m_menubarVisible(true)
     , m_locationbarVisible(true)
+    , m_pageVisible(true)
     , m_inputState(false)
     , m_dragTargetDispatch(false)
     , m_dragIdentity(0)
@@ -446,6 +468,9 @@ WebView::WebView()
 WebView::~WebView()
 {
     close();
+
+    // Keep the function bodies this view compiled for the next session.
+    WebCore::JSDOMWindowBase::commonVM()->codeCache()->synchronizeDiskCache();
     
     if (m_preferences)
         if (m_preferences != WebPreferences::sharedStandardPreferences())
@@ -505,6 +530,7 @@ void WebView::setCacheModel(WebCacheModel cacheModel)
     double deadDecodedDataDeletionInterval = 0;
 
     unsigned pageCacheCapacity = 0;
+    size_t pageCacheMemoryBudget = 0;
 
     switch (cacheModel) {
     case WebCacheModelDocumentViewer: {
@@ -541,6 +567,9 @@ void WebView::setCacheModel(WebCacheModel cacheModel)
         else
             pageCacheCapacity = 0;
 
+        // Page cache budget (in bytes)
+        pageCacheMemoryBudget = min<unsigned long long>(memSize / 16, 64) * 1024 * 1024;
+
         // Object cache capacities (in bytes)
         if (memSize >= 2048)
             cacheTotalCapacity = 96 * 1024 * 1024;
@@ -574,6 +603,9 @@ void WebView::setCacheModel(WebCacheModel cacheModel)
         else
             pageCacheCapacity = 1;
 
+        // Page cache budget (in bytes)
+        pageCacheMemoryBudget = min<unsigned long long>(memSize / 8, 128) * 1024 * 1024;
+
         // Object cache capacities (in bytes)
         // (Testing indicates that value / MB depends heavily on content and
         // browsing pattern. Even growth above 128MB can have substantial 
@@ -611,6 +643,7 @@ void WebView::setCacheModel(WebCacheModel cacheModel)
 	memoryCache()->setCapacities(cacheMinDeadCapacity, cacheMaxDeadCapacity, cacheTotalCapacity);
 	memoryCache()->setDeadDecodedDataDeletionInterval(deadDecodedDataDeletionInterval);
     pageCache()->setCapacity(pageCacheCapacity);
+    pageCache()->setMemoryBudget(pageCacheMemoryBudget);
 
     s_didSetCacheModel = true;
     s_cacheModel = cacheModel;
@@ -1204,6 +1237,8 @@ void WebView::initWithFrame(BalRectangle& frame, const char* frameName, const ch
 		WebKitSetApplicationCachePathIfNecessary();
 #endif
 #endif
+		StorageUsageIndex::index().initialize();
+		WebKitSetBytecodeCachePathIfNecessary();
 		Settings::setDefaultMinDOMTimerInterval(0.004);
 
 		didOneTimeInitialization = true;
@@ -2774,6 +2809,7 @@ void WebView::notifyPreferencesChanged(WebPreferences* preferences)
 
     str = preferences->localStorageDatabasePath();
     settings->setLocalStorageDatabasePath(str);
+    StorageUsageIndex::index().setLocalStorageDirectoryPath(str);
 
 	/*
     enabled = preferences->localStorageEnabled();
@@ -2806,6 +2842,15 @@ void WebView::notifyPreferencesChanged(WebPreferences* preferences)
     enabled = preferences->mediaPlaybackAllowsInline();
     settings->setMediaPlaybackAllowsInline(enabled);
 
+    settings->setParallelStyleResolutionEnabled(preferences->parallelStyleResolutionEnabled());
+
+    // The timers of the main thread and the alignment of hidden pages are shared by all views.
+    threadGlobalData().threadTimers().setCoalescingInterval(max(preferences->timerCoalescingInterval(), 0) / 1000.0);
+#if ENABLE(HIDDEN_PAGE_DOM_TIMER_THROTTLING)
+    Settings::setHiddenPageDOMTimerAlignmentInterval(max(preferences->hiddenPageDOMTimerAlignmentInterval(), 0) / 1000.0);
+    settings->setHiddenPageDOMTimerThrottlingEnabled(preferences->hiddenPageDOMTimerThrottlingEnabled());
+#endif
+
 #if ENABLE(FULLSCREEN_API)
 	settings->setFullScreenEnabled(false);
 #endif
@@ -2819,6 +2864,18 @@ void updateSharedSettingsFromPreferencesIfNeeded(WebPreferences* preferences)
         return ;
 }
 
+void WebView::setPageVisible(bool visible)
+{
+    if (m_pageVisible == visible)
+        return;
+    m_pageVisible = visible;
+
+    // The throttler waits a couple of seconds before throttling, so briefly hiding the view,
+    // as a relayout does, costs nothing.
+    if (m_page)
+        m_page->pageThrottler()->setThrottled(!visible);
+}
+
 void WebView::setInViewSourceMode(bool flag)
 {
     if (!m_mainFrame)
@@ -3138,6 +3195,38 @@ void WebView::setJavaScriptURLsAreAllowed(bool areAllowed)
   //    m_page->setJavaScriptURLsAreAllowed(areAllowed);
 }
 
+void WebView::startJavaScriptSamplingProfiler(double intervalMilliseconds)
+{
+    if (!(intervalMilliseconds > 0))
+        return;
+
+    JSC::VM* vm = WebCore::JSDOMWindowBase::commonVM();
+    JSC::JSLockHolder lock(vm);
+    vm->ensureSamplingProfiler().start(intervalMilliseconds / 1000);
+}
+
+bool WebView::stopJavaScriptSamplingProfiler(const char* path, bool asJSON)
+{
+    JSC::VM* vm = WebCore::JSDOMWindowBase::commonVM();
+    JSC::JSLockHolder lock(vm);
+    JSC::SamplingProfiler* profiler = vm->samplingProfiler();
+    if (!profiler)
+        return false;
+
+    profiler->stop();
+    CString profile = (asJSON ? profiler->toJSON() : profiler->foldedStacks()).utf8();
+    profiler->clear();
+    if (!path)
+        return false;
+
+    PlatformFileHandle file = openFile(path, OpenForWrite);
+    if (!isHandleValid(file))
+        return false;
+    bool written = writeToFile(file, profile.data(), profile.length()) == static_cast<int>(profile.length());
+    closeFile(file);
+    return written;
+}
+
 void WebView::resize(BalRectangle r)
 {
     d->resize(r);
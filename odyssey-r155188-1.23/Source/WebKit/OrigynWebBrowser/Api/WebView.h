@@ -1169,6 +1169,17 @@ public:
      */
     void setJavaScriptURLsAreAllowed(bool areAllowed);
 
+    /**
+     * start sampling where the scripts of all pages spend their time, every intervalMilliseconds
+     */
+    void startJavaScriptSamplingProfiler(double intervalMilliseconds);
+
+    /**
+     * stop sampling scripts and write the samples taken so far to path, as folded stacks or, if asJSON is set, as JSON
+     * @result whether the profile could be written
+     */
+    bool stopJavaScriptSamplingProfiler(const char* path, bool asJSON);
+
     /**
      *  give on expose event to the webview
      */
@@ -1603,6 +1614,13 @@ void exitFullScreenForElement(WebCore::Element* element);
     bool locationbarVisible() { return m_locationbarVisible; }
     void setLocationbarVisible(bool flag) { m_locationbarVisible = flag; }
 
+    /*
+     * Tells whether the view is shown. The DOM timers of a page that stays
+     * hidden, like one in a background tab, are throttled.
+     */
+    bool isPageVisible() { return m_pageVisible; }
+    void setPageVisible(bool);
+
     void setInputMethodState(bool inputState) { m_inputState = inputState; }
     bool inputMethodState() { return m_inputState; }
 
@@ -1882,6 +1900,7 @@ protected:
     bool m_statusbarVisible;
     bool m_menubarVisible;
     bool m_locationbarVisible;
+    bool m_pageVisible;
     bool m_inputState;
 
         // True while dispatching system drag and drop events to drag/drop targets
@@ -29,10 +29,12 @@
 
 #include "NotImplemented.h"
 #include "Page.h"
+#include "PageCache.h"
 #include "PageGroup.h"
 #include "PlatformCookieJar.h"
 #include "PluginDatabase.h"
 #include "PluginPackage.h"
+#include "WebVisitedLinkTable.h"
 
 using namespace WebCore;
 
@@ -161,13 +163,18 @@ void PlatformStrategiesMorphOS::getPluginInfo(const Page*, Vector<PluginInfo>& o
 }
 
 // VisitedLinkStrategy
-bool PlatformStrategiesMorphOS::isLinkVisited(Page* page, LinkHash hash, const KURL&, const AtomicString&)
+// The visited links live in the WebVisitedLinkTable, which all page groups share, rather
+// than in the page groups, which would have to be filled from the history first.
+bool PlatformStrategiesMorphOS::isLinkVisited(Page*, LinkHash hash, const KURL&, const AtomicString&)
 {
-    return page->group().isLinkVisited(hash);
+    return PageGroup::isTrackingVisitedLinks() && WebVisitedLinkTable::shared().contains(hash);
 }
 
-void PlatformStrategiesMorphOS::addVisitedLink(Page* page, LinkHash hash)
+void PlatformStrategiesMorphOS::addVisitedLink(Page*, LinkHash hash)
 {
-    page->group().addVisitedLinkHash(hash);
+    if (!PageGroup::isTrackingVisitedLinks() || !WebVisitedLinkTable::shared().add(hash))
+        return;
+    Page::visitedStateChanged(0, hash);
+    pageCache()->markPagesForVistedLinkStyleRecalc();
 }
 
@@ -0,0 +1,292 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+#include "WebVisitedLinkTable.h"
+
+#include <string.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/text/CString.h>
+
+#if HAVE(MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace WebCore;
+
+#define VISITEDLINKSTABLE "PROGDIR:Conf/VisitedLinks.table"
+
+static const uint32_t visitedLinkTableMagic = 0x4f57424c; // 'OWBL'
+static const uint32_t visitedLinkTableVersion = 1;
+static const unsigned minimumCapacity = 1024;
+
+WebVisitedLinkTable& WebVisitedLinkTable::shared()
+{
+    DEFINE_STATIC_LOCAL(WebVisitedLinkTable, table, (VISITEDLINKSTABLE));
+    return table;
+}
+
+WebVisitedLinkTable::WebVisitedLinkTable(const String& path)
+    : m_path(path)
+    , m_slots(0)
+    , m_capacity(0)
+    , m_count(0)
+    , m_mappedData(0)
+    , m_mappedSize(0)
+    , m_appendFile(0)
+    , m_needsPopulating(false)
+{
+    open();
+}
+
+WebVisitedLinkTable::~WebVisitedLinkTable()
+{
+    if (m_appendFile)
+        fclose(m_appendFile);
+    unmap();
+}
+
+void WebVisitedLinkTable::open()
+{
+    if (!map()) {
+        unmap();
+        m_needsPopulating = true;
+        if (!write(Vector<uint64_t>(minimumCapacity, 0), 0) || !map()) {
+            unmap();
+            return;
+        }
+    }
+    m_appendFile = fopen(m_path.utf8().data(), "ab");
+}
+
+bool WebVisitedLinkTable::map()
+{
+    CString fileSystemPath = m_path.utf8();
+    const uint8_t* data = 0;
+    size_t size = 0;
+#if HAVE(MMAP)
+    int fd = ::open(fileSystemPath.data(), O_RDONLY);
+    if (fd != -1) {
+        struct stat fileStat;
+        if (!fstat(fd, &fileStat) && fileStat.st_size > 0) {
+            void* mappedData = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mappedData != MAP_FAILED) {
+                m_mappedData = mappedData;
+                m_mappedSize = fileStat.st_size;
+                data = static_cast<const uint8_t*>(mappedData);
+                size = m_mappedSize;
+            }
+        }
+        close(fd);
+    }
+#else
+    if (FILE* handle = fopen(fileSystemPath.data(), "rb")) {
+        long fileSize = -1;
+        if (!fseek(handle, 0, SEEK_END))
+            fileSize = ftell(handle);
+        if (fileSize > 0 && !fseek(handle, 0, SEEK_SET) && !(fileSize % sizeof(uint64_t))) {
+            m_buffer.resize(fileSize / sizeof(uint64_t));
+            if (fread(m_buffer.data(), 1, fileSize, handle) == static_cast<size_t>(fileSize)) {
+                data = reinterpret_cast<const uint8_t*>(m_buffer.data());
+                size = fileSize;
+            }
+        }
+        fclose(handle);
+    }
+#endif
+
+    Header header;
+    bool isValid = size >= sizeof(Header);
+    if (isValid) {
+        memcpy(&header, data, sizeof(Header));
+        isValid = header.magic == visitedLinkTableMagic && header.version == visitedLinkTableVersion
+            && header.capacity >= minimumCapacity && !(header.capacity & (header.capacity - 1))
+            && header.count < header.capacity
+            && (size - sizeof(Header)) / sizeof(uint64_t) >= header.capacity
+            && !((size - sizeof(Header)) % sizeof(uint64_t));
+    }
+
+    // Lookups probe until they reach an empty slot, so a damaged table with none would never
+    // let them finish.
+    if (isValid) {
+        const uint64_t* slots = reinterpret_cast<const uint64_t*>(data + sizeof(Header));
+        unsigned usedSlots = 0;
+        for (unsigned i = 0; i < header.capacity; ++i) {
+            if (slots[i])
+                ++usedSlots;
+        }
+        isValid = usedSlots == header.count;
+    }
+
+    if (!isValid)
+        return false;
+
+    m_slots = reinterpret_cast<const uint64_t*>(data + sizeof(Header));
+    m_capacity = header.capacity;
+    m_count = header.count;
+
+    // The links appended since the table was last written.
+    const uint64_t* appended = m_slots + m_capacity;
+    size_t appendedCount = (size - sizeof(Header)) / sizeof(uint64_t) - m_capacity;
+    for (size_t i = 0; i < appendedCount; ++i) {
+        if (appended[i] && !contains(appended[i]))
+            m_appendedHashes.add(appended[i]);
+    }
+    return true;
+}
+
+void WebVisitedLinkTable::unmap()
+{
+#if HAVE(MMAP)
+    if (m_mappedData)
+        munmap(m_mappedData, m_mappedSize);
+#endif
+    m_mappedData = 0;
+    m_mappedSize = 0;
+    m_buffer.clear();
+    m_slots = 0;
+    m_capacity = 0;
+    m_count = 0;
+}
+
+bool WebVisitedLinkTable::contains(LinkHash hash) const
+{
+    uint64_t value = slotValue(hash);
+    if (m_slots) {
+        unsigned mask = m_capacity - 1;
+        for (unsigned i = static_cast<unsigned>(value) & mask; m_slots[i]; i = (i + 1) & mask) {
+            if (m_slots[i] == value)
+                return true;
+        }
+    }
+    return m_appendedHashes.contains(value);
+}
+
+bool WebVisitedLinkTable::add(LinkHash hash)
+{
+    if (contains(hash))
+        return false;
+
+    uint64_t value = slotValue(hash);
+    m_appendedHashes.add(value);
+    if (m_appendFile) {
+        fwrite(&value, sizeof(value), 1, m_appendFile);
+        fflush(m_appendFile);
+    }
+    return true;
+}
+
+void WebVisitedLinkTable::removeAll()
+{
+    if (m_appendFile) {
+        fclose(m_appendFile);
+        m_appendFile = 0;
+    }
+    unmap();
+    m_appendedHashes.clear();
+    if (write(Vector<uint64_t>(minimumCapacity, 0), 0))
+        open();
+    m_needsPopulating = false;
+}
+
+void WebVisitedLinkTable::synchronize()
+{
+    if (m_appendedHashes.isEmpty())
+        return;
+
+    unsigned count = m_count + m_appendedHashes.size();
+    unsigned capacity = minimumCapacity;
+    // Keep the table at most half full, so that probes stay short.
+    while (capacity < 2 * count)
+        capacity *= 2;
+
+    Vector<uint64_t> slots(capacity, 0);
+    for (unsigned i = 0; i < m_capacity; ++i) {
+        if (m_slots[i])
+            insert(slots.data(), capacity, m_slots[i]);
+    }
+    HashSet<LinkHash, LinkHashHash>::const_iterator end = m_appendedHashes.end();
+    for (HashSet<LinkHash, LinkHashHash>::const_iterator it = m_appendedHashes.begin(); it != end; ++it)
+        insert(slots.data(), capacity, *it);
+
+    if (write(slots, count))
+        reopen();
+}
+
+void WebVisitedLinkTable::rebuild(const HashSet<LinkHash, LinkHashHash>& hashes)
+{
+    unsigned capacity = minimumCapacity;
+    while (capacity < 2 * hashes.size())
+        capacity *= 2;
+
+    Vector<uint64_t> slots(capacity, 0);
+    HashSet<LinkHash, LinkHashHash>::const_iterator end = hashes.end();
+    for (HashSet<LinkHash, LinkHashHash>::const_iterator it = hashes.begin(); it != end; ++it)
+        insert(slots.data(), capacity, slotValue(*it));
+
+    if (write(slots, hashes.size()))
+        reopen();
+}
+
+void WebVisitedLinkTable::reopen()
+{
+    if (m_appendFile) {
+        fclose(m_appendFile);
+        m_appendFile = 0;
+    }
+    unmap();
+    m_appendedHashes.clear();
+    open();
+}
+
+void WebVisitedLinkTable::insert(uint64_t* slots, unsigned capacity, uint64_t value)
+{
+    unsigned mask = capacity - 1;
+    unsigned i = static_cast<unsigned>(value) & mask;
+    while (slots[i])
+        i = (i + 1) & mask;
+    slots[i] = value;
+}
+
+bool WebVisitedLinkTable::write(const Vector<uint64_t>& slots, unsigned count)
+{
+    Header header;
+    header.magic = visitedLinkTableMagic;
+    header.version = visitedLinkTableVersion;
+    header.capacity = slots.size();
+    header.count = count;
+
+    CString fileSystemPath = m_path.utf8();
+    CString temporaryPath = String(m_path + ".tmp").utf8();
+    FILE* handle = fopen(temporaryPath.data(), "wb");
+    if (!handle)
+        return false;
+    bool written = fwrite(&header, sizeof(header), 1, handle) == 1
+        && fwrite(slots.data(), sizeof(uint64_t), slots.size(), handle) == slots.size();
+    written = !fclose(handle) && written;
+    if (written && rename(temporaryPath.data(), fileSystemPath.data())) {
+        // Not every file system replaces an existing file on rename.
+        remove(fileSystemPath.data());
+        written = !rename(temporaryPath.data(), fileSystemPath.data());
+    }
+    if (!written)
+        remove(temporaryPath.data());
+    return written;
+}
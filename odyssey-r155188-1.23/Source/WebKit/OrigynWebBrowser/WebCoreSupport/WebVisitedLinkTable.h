@@ -0,0 +1,87 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef WebVisitedLinkTable_h
+#define WebVisitedLinkTable_h
+
+#include "LinkHash.h"
+#include <stdio.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+// The visited links of all page groups, kept in a file across runs.
+//
+// The file holds an open-addressing hash table of LinkHashes, which is mapped read-only
+// when the table is opened: looking up a link takes no lock and nothing has to be rebuilt
+// from the history at startup. Links visited since are appended to the end of the file and
+// kept in a HashSet until synchronize() rewrites the table with them.
+class WebVisitedLinkTable {
+    WTF_MAKE_NONCOPYABLE(WebVisitedLinkTable);
+public:
+    static WebVisitedLinkTable& shared();
+
+    bool contains(WebCore::LinkHash) const;
+    // Returns false if the link was visited already.
+    bool add(WebCore::LinkHash);
+    void removeAll();
+
+    // True if there was no table to open, so that it has to be filled from the history.
+    bool needsPopulating() const { return m_needsPopulating; }
+    void didPopulate() { m_needsPopulating = false; }
+
+    // Rewrites the table with the appended links. Called when the browser quits.
+    void synchronize();
+    // Replaces the table with the given links, once links were removed from the history.
+    void rebuild(const HashSet<WebCore::LinkHash, WebCore::LinkHashHash>&);
+
+private:
+    explicit WebVisitedLinkTable(const String& path);
+    ~WebVisitedLinkTable();
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t count;
+    };
+
+    void open();
+    bool map();
+    void unmap();
+    bool write(const Vector<uint64_t>& slots, unsigned count);
+    void reopen();
+
+    static uint64_t slotValue(WebCore::LinkHash hash) { return hash ? hash : 1; }
+    static void insert(uint64_t* slots, unsigned capacity, uint64_t value);
+
+    String m_path;
+
+    const uint64_t* m_slots;
+    unsigned m_capacity;
+    unsigned m_count;
+    void* m_mappedData;
+    size_t m_mappedSize;
+    Vector<uint64_t> m_buffer;
+
+    HashSet<WebCore::LinkHash, WebCore::LinkHashHash> m_appendedHashes;
+    FILE* m_appendFile;
+    bool m_needsPopulating;
+};
+
+#endif // WebVisitedLinkTable_h
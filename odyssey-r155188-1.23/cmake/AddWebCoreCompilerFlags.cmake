@@ -160,7 +160,7 @@ if(ENABLE_TESTS)
     add_definitions(-DENABLE_TESTS=1)
 endif(ENABLE_TESTS)
 
-add_definitions(-DENABLE_ANIMATION_API=1 -DENABLE_CHANNEL_MESSAGING=1 -DENABLE_DATALIST_ELEMENT=1 -DENABLE_DATA_TRANSFER_ITEMS=0 -DENABLE_DETAILS_ELEMENT=1 -DENABLE_IFRAME_SEAMLESS=1 -DENABLE_INPUT_TYPE_COLOR=1 -DENABLE_INPUT_TYPE_DATE=1 -DENABLE_INPUT_TYPE_DATETIME_INCOMPLETE=1 -DENABLE_INPUT_TYPE_DATETIMELOCAL=1 -DENABLE_INPUT_TYPE_MONTH=1 -DENABLE_INPUT_TYPE_WEEK=1 -DENABLE_INPUT_TYPE_TIME=1 -DENABLE_DATE_AND_TIME_INPUT_TYPES=1 -DENABLE_LEGACY_NOTIFICATIONS=1 -DENABLE_MEDIA_SOURCE=0 -DENABLE_MEDIA_STATISTICS=1 -DENABLE_METER_ELEMENT=1 -DENABLE_PROGRESS_ELEMENT=1 -DENABLE_STYLE_SCOPED=1 -DENABLE_VIDEO_TRACK=1 -DENABLE_VIEW_MODE_CSS_MEDIA=1 -DENABLE_POINTER_LOCK=1 -DENABLE_PAGE_VISIBILITY_API=1 -DENABLE_REQUEST_ANIMATION_FRAME=0)
+add_definitions(-DENABLE_ANIMATION_API=1 -DENABLE_CHANNEL_MESSAGING=1 -DENABLE_DATALIST_ELEMENT=1 -DENABLE_DATA_TRANSFER_ITEMS=0 -DENABLE_DETAILS_ELEMENT=1 -DENABLE_IFRAME_SEAMLESS=1 -DENABLE_INPUT_TYPE_COLOR=1 -DENABLE_INPUT_TYPE_DATE=1 -DENABLE_INPUT_TYPE_DATETIME_INCOMPLETE=1 -DENABLE_INPUT_TYPE_DATETIMELOCAL=1 -DENABLE_INPUT_TYPE_MONTH=1 -DENABLE_INPUT_TYPE_WEEK=1 -DENABLE_INPUT_TYPE_TIME=1 -DENABLE_DATE_AND_TIME_INPUT_TYPES=1 -DENABLE_LEGACY_NOTIFICATIONS=1 -DENABLE_MEDIA_SOURCE=0 -DENABLE_MEDIA_STATISTICS=1 -DENABLE_METER_ELEMENT=1 -DENABLE_PROGRESS_ELEMENT=1 -DENABLE_STYLE_SCOPED=1 -DENABLE_VIDEO_TRACK=1 -DENABLE_VIEW_MODE_CSS_MEDIA=1 -DENABLE_POINTER_LOCK=1 -DENABLE_PAGE_VISIBILITY_API=1 -DENABLE_HIDDEN_PAGE_DOM_TIMER_THROTTLING=1 -DENABLE_REQUEST_ANIMATION_FRAME=0)
 
 
 add_definitions("-DBUILDING_WebCore=1")